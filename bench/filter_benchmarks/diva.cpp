@@ -48,9 +48,24 @@ inline size_t size(const Diva<false> *filter) {
     return filter->Size();
 }
 
+inline void set_huge_pages(const std::string &page_size) {
+    if (page_size == "none")
+        pages_set_huge(PAGES_HUGE_NONE);
+    else if (page_size == "2mb")
+        pages_set_huge(PAGES_HUGE_2MB);
+    else if (page_size == "1gb")
+        pages_set_huge(PAGES_HUGE_1GB);
+    else
+        pages_set_huge(PAGES_HUGE_AUTO);
+}
+
 
 int main(int argc, char const *argv[]) {
     auto parser = init_parser("bench-diva");
+    parser.add_argument("--huge-pages")
+            .help("Page size backing the filter: none, auto, 2mb or 1gb")
+            .default_value(std::string("auto"))
+            .nargs(1);
 
     try {
         parser.parse_args(argc, argv);
@@ -61,6 +76,7 @@ int main(int argc, char const *argv[]) {
         std::exit(1);
     }
     memory_budget = parser.get<double>("arg");
+    set_huge_pages(parser.get<std::string>("--huge-pages"));
     read_workload(parser.get<std::string>("--workload"));
 
     experiment_string(pass_fun(init), pass_fun(insert), pass_fun(del), pass_fun(query), pass_fun(size));
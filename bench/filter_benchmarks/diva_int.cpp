@@ -20,36 +20,78 @@
 #include <cstdint>
 #include "diva.hpp"
 
-template <typename t_itr>
-inline Diva<true> *init(const t_itr begin, const t_itr end, const double bpk) {
+// Workload keys are 64-bit, narrower key types keep their top bits, which
+// preserves the order of keys and range endpoints
+template <class t_int>
+using IntDiva = Diva<true, 1024, t_int>;
+
+template <class t_int>
+inline t_int narrow_key(const uint64_t key) {
+    return key >> (64 - 8 * sizeof(t_int));
+}
+
+template <class t_int, typename t_itr>
+inline IntDiva<t_int> *init(const t_itr begin, const t_itr end, const double bpk) {
     const uint32_t rng_seed = 1024;
     const double load_factor = 0.95;
     const uint32_t infix_size = std::round(load_factor * (bpk - 1));
     
-    Diva<true> *filter = new Diva<true>(infix_size, begin, end, sizeof(uint64_t),
-                                        rng_seed, load_factor);
-    return filter;
+    if constexpr (std::is_same_v<t_int, uint64_t>)
+        return new IntDiva<t_int>(infix_size, begin, end, sizeof(t_int), rng_seed, load_factor);
+    else {
+        std::vector<t_int> keys;
+        keys.reserve(std::distance(begin, end));
+        for (t_itr it = begin; it != end; ++it)
+            keys.push_back(narrow_key<t_int>(*it));
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        return new IntDiva<t_int>(infix_size, keys.begin(), keys.end(), sizeof(t_int), rng_seed, load_factor);
+    }
 }
 
-inline void insert(Diva<true> *filter, uint64_t key) {
-    filter->Insert(key);
+template <class t_int>
+inline void insert(IntDiva<t_int> *filter, uint64_t key) {
+    filter->Insert(narrow_key<t_int>(key));
 }
 
-inline void del(Diva<true> *filter, uint64_t key) {
-    filter->Delete(key);
+template <class t_int>
+inline void del(IntDiva<t_int> *filter, uint64_t key) {
+    filter->Delete(narrow_key<t_int>(key));
 }
 
-inline bool query(const Diva<true> *filter, uint64_t l_key, uint64_t r_key) {
-    return filter->RangeQuery(l_key, r_key);
+template <class t_int>
+inline bool query(const IntDiva<t_int> *filter, uint64_t l_key, uint64_t r_key) {
+    return filter->RangeQuery(narrow_key<t_int>(l_key), narrow_key<t_int>(r_key));
 }
 
-inline size_t size(const Diva<true> *filter) {
+template <class t_int>
+inline size_t size(const IntDiva<t_int> *filter) {
     return filter->Size();
 }
 
+inline void set_huge_pages(const std::string &page_size) {
+    if (page_size == "none")
+        pages_set_huge(PAGES_HUGE_NONE);
+    else if (page_size == "2mb")
+        pages_set_huge(PAGES_HUGE_2MB);
+    else if (page_size == "1gb")
+        pages_set_huge(PAGES_HUGE_1GB);
+    else
+        pages_set_huge(PAGES_HUGE_AUTO);
+}
+
 
 int main(int argc, char const *argv[]) {
     auto parser = init_parser("bench-diva-int");
+    parser.add_argument("--huge-pages")
+            .help("Page size backing the filter: none, auto, 2mb or 1gb")
+            .default_value(std::string("auto"))
+            .nargs(1);
+    parser.add_argument("--key-bits")
+            .help("Key width, 32 or 64. 32-bit keys are the top halves of the workload keys, so false "
+                  "positives are counted against the 64-bit ground truth and overstated")
+            .default_value(64)
+            .nargs(1)
+            .scan<'i', int>();
 
     try {
         parser.parse_args(argc, argv);
@@ -60,9 +102,18 @@ int main(int argc, char const *argv[]) {
         std::exit(1);
     }
     memory_budget = parser.get<double>("arg");
+    set_huge_pages(parser.get<std::string>("--huge-pages"));
     read_workload(parser.get<std::string>("--workload"));
 
-    experiment(pass_fun(init), pass_fun(insert), pass_fun(del), pass_fun(query), pass_fun(size));
+    const int key_bits = parser.get<int>("--key-bits");
+    if (key_bits == 32)
+        experiment(pass_fun(init<uint32_t>), pass_fun(insert), pass_fun(del), pass_fun(query), pass_fun(size));
+    else if (key_bits == 64)
+        experiment(pass_fun(init<uint64_t>), pass_fun(insert), pass_fun(del), pass_fun(query), pass_fun(size));
+    else {
+        std::cerr << "Unsupported key width " << key_bits << std::endl;
+        std::exit(1);
+    }
 
     return 0;
 }
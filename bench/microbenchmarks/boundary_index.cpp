@@ -0,0 +1,144 @@
+/*
+ * This file is part of --- <>.
+ * Copyright (C) 2024 ---.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "diva.hpp"
+
+// Throughput of the same filter over each boundary index: the wormhole, the
+// sorted array with its Eytzinger search layout and the B+-tree, for both the
+// integer and the string boundary keys.
+
+using timer = std::chrono::high_resolution_clock;
+
+constexpr uint32_t infix_size = 8;
+constexpr uint32_t seed = 1;
+constexpr float load_factor = 0.95;
+constexpr uint32_t rounds = 3;
+
+
+template <typename t_fun>
+static double time_ops(const std::vector<uint64_t> &keys, t_fun op, uint64_t &checksum) {
+    const timer::time_point start = timer::now();
+    for (const uint64_t key : keys)
+        checksum += op(key);
+    return keys.size() / std::chrono::duration<double, std::micro>(timer::now() - start).count();
+}
+
+
+struct Result {
+    double positive_mops, negative_mops, range_mops, insert_mops, delete_mops;
+};
+
+
+template <bool int_optimized, template <class> class t_index>
+static Result run(const std::vector<uint64_t> &keys, const std::vector<uint64_t> &positive_queries,
+                  const std::vector<uint64_t> &negative_queries, const std::vector<uint64_t> &inserts) {
+    // The string tree orders keys by their bytes
+    std::vector<uint64_t> load_keys(keys);
+    if constexpr (!int_optimized) {
+        for (uint64_t &key : load_keys)
+            key = __builtin_bswap64(key);
+    }
+    Diva<int_optimized, 1024, uint64_t, ThreadPolicy::Concurrent, t_index> s(infix_size, load_keys.begin(), load_keys.end(),
+                                                                            sizeof(uint64_t), seed, load_factor);
+
+    Result res;
+    uint64_t checksum = 0;
+    res.positive_mops = time_ops(positive_queries, [&](uint64_t key) { return s.PointQuery(key); }, checksum);
+    res.negative_mops = time_ops(negative_queries, [&](uint64_t key) { return s.PointQuery(key); }, checksum);
+    res.range_mops = time_ops(negative_queries,
+                              [&](uint64_t key) { return s.RangeQuery(key, key + (1ULL << 40)); }, checksum);
+    res.insert_mops = time_ops(inserts, [&](uint64_t key) { s.Insert(key); return 0; }, checksum);
+    res.delete_mops = time_ops(inserts, [&](uint64_t key) { s.Delete(key); return 0; }, checksum);
+    std::fprintf(stderr, "checksum %lu\n", checksum);
+    return res;
+}
+
+
+static void keep_best(Result &best, const Result &res) {
+    best.positive_mops = std::max(best.positive_mops, res.positive_mops);
+    best.negative_mops = std::max(best.negative_mops, res.negative_mops);
+    best.range_mops = std::max(best.range_mops, res.range_mops);
+    best.insert_mops = std::max(best.insert_mops, res.insert_mops);
+    best.delete_mops = std::max(best.delete_mops, res.delete_mops);
+}
+
+
+static void print(const char *tree, const char *index, const Result &res) {
+    std::printf("%6s %13s %14.2f %14.2f %11.2f %12.2f %12.2f\n", tree, index,
+                res.positive_mops, res.negative_mops, res.range_mops, res.insert_mops, res.delete_mops);
+}
+
+
+template <bool int_optimized>
+static void compare(const char *tree, const std::vector<uint64_t> &keys, const std::vector<uint64_t> &positive_queries,
+                    const std::vector<uint64_t> &negative_queries, const std::vector<uint64_t> &inserts) {
+    // Whichever instance runs later inherits a fragmented heap, so the order
+    // rotates between rounds and each index keeps its best round
+    Result wormhole = {}, sorted_array = {}, btree = {};
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (uint32_t i = 0; i < 3; i++) {
+            switch ((round + i) % 3) {
+                case 0:
+                    keep_best(wormhole, run<int_optimized, WormholeIndex>(keys, positive_queries, negative_queries, inserts));
+                    break;
+                case 1:
+                    keep_best(sorted_array, run<int_optimized, SortedArrayIndex>(keys, positive_queries, negative_queries, inserts));
+                    break;
+                case 2:
+                    keep_best(btree, run<int_optimized, BTreeIndex>(keys, positive_queries, negative_queries, inserts));
+                    break;
+            }
+        }
+    }
+    print(tree, "wormhole", wormhole);
+    print(tree, "sorted_array", sorted_array);
+    print(tree, "btree", btree);
+}
+
+
+int main(int argc, char **argv) {
+    const uint32_t key_count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const uint32_t query_count = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(key_count);
+    for (uint64_t &key : keys)
+        key = rng();
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<uint64_t> positive_queries(query_count), negative_queries(query_count), inserts(query_count);
+    for (uint32_t i = 0; i < query_count; i++) {
+        positive_queries[i] = keys[rng() % keys.size()];
+        negative_queries[i] = rng();
+        inserts[i] = rng();
+    }
+
+    std::printf("%6s %13s %14s %14s %11s %12s %12s\n",
+                "tree", "index", "positive_mops", "negative_mops", "range_mops", "insert_mops", "delete_mops");
+    compare<true>("int", keys, positive_queries, negative_queries, inserts);
+    compare<false>("string", keys, positive_queries, negative_queries, inserts);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * This file is part of --- <>.
+ * Copyright (C) 2024 ---.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "diva.hpp"
+
+// Size and query throughput of a filter before and after Freeze, for both the
+// integer and the string boundary keys. The live filter is measured through
+// its serialized size and its allocator footprint, which includes the slack of
+// the size grades, while the frozen one is a single buffer.
+
+using timer = std::chrono::high_resolution_clock;
+
+constexpr uint32_t infix_size = 8;
+constexpr uint32_t seed = 1;
+constexpr float load_factor = 0.95;
+constexpr uint32_t rounds = 3;
+
+
+template <typename t_fun>
+static double time_ops(const std::vector<uint64_t> &keys, t_fun op, uint64_t &checksum) {
+    const timer::time_point start = timer::now();
+    for (const uint64_t key : keys)
+        checksum += op(key);
+    return keys.size() / std::chrono::duration<double, std::micro>(timer::now() - start).count();
+}
+
+
+struct Result {
+    double bits_per_key, positive_mops, negative_mops, range_mops, sorted_mops;
+};
+
+
+template <bool int_optimized>
+static Result run(const std::vector<uint64_t> &keys, const std::vector<uint64_t> &inserts,
+                  const std::vector<uint64_t> &positive_queries, const std::vector<uint64_t> &negative_queries,
+                  const std::vector<uint64_t> &sorted_queries, const bool frozen) {
+    // The string tree orders keys by their bytes
+    std::vector<uint64_t> load_keys(keys);
+    if constexpr (!int_optimized) {
+        for (uint64_t &key : load_keys)
+            key = __builtin_bswap64(key);
+    }
+    Diva<int_optimized> s(infix_size, load_keys.begin(), load_keys.end(), sizeof(uint64_t), seed, load_factor);
+    // Inserts after the bulk load leave stores at assorted size grades
+    for (const uint64_t key : inserts)
+        s.Insert(key);
+    if (frozen)
+        s.Freeze();
+    const uint64_t key_count = keys.size() + inserts.size();
+
+    Result res;
+    uint64_t checksum = 0;
+    res.bits_per_key = 8.0 * (frozen ? s.Size() : s.AllocatorStats().reserved_bytes) / key_count;
+    res.positive_mops = time_ops(positive_queries, [&](uint64_t key) { return s.PointQuery(key); }, checksum);
+    res.negative_mops = time_ops(negative_queries, [&](uint64_t key) { return s.PointQuery(key); }, checksum);
+    res.range_mops = time_ops(negative_queries,
+                              [&](uint64_t key) { return s.RangeQuery(key, key + (1ULL << 40)); }, checksum);
+    bool *out = new bool[sorted_queries.size()];
+    const timer::time_point start = timer::now();
+    s.PointQuerySorted(sorted_queries.begin(), sorted_queries.end(), out);
+    res.sorted_mops = sorted_queries.size() / std::chrono::duration<double, std::micro>(timer::now() - start).count();
+    checksum += std::count(out, out + sorted_queries.size(), true);
+    delete[] out;
+    std::fprintf(stderr, "checksum %lu\n", checksum);
+    return res;
+}
+
+
+static void keep_best(Result &best, const Result &res) {
+    best.bits_per_key = res.bits_per_key;
+    best.positive_mops = std::max(best.positive_mops, res.positive_mops);
+    best.negative_mops = std::max(best.negative_mops, res.negative_mops);
+    best.range_mops = std::max(best.range_mops, res.range_mops);
+    best.sorted_mops = std::max(best.sorted_mops, res.sorted_mops);
+}
+
+
+static void print(const char *tree, const char *state, const Result &res) {
+    std::printf("%6s %7s %12.2f %14.2f %14.2f %11.2f %12.2f\n", tree, state, res.bits_per_key,
+                res.positive_mops, res.negative_mops, res.range_mops, res.sorted_mops);
+}
+
+
+template <bool int_optimized>
+static void compare(const char *tree, const std::vector<uint64_t> &keys, const std::vector<uint64_t> &inserts,
+                    const std::vector<uint64_t> &positive_queries, const std::vector<uint64_t> &negative_queries,
+                    const std::vector<uint64_t> &sorted_queries) {
+    // Whichever instance runs second inherits a fragmented heap, so the order
+    // alternates between rounds and each state keeps its best round
+    Result live = {}, frozen = {};
+    for (uint32_t round = 0; round < rounds; round++) {
+        for (uint32_t i = 0; i < 2; i++) {
+            if ((round + i) % 2 == 0)
+                keep_best(live, run<int_optimized>(keys, inserts, positive_queries, negative_queries, sorted_queries, false));
+            else
+                keep_best(frozen, run<int_optimized>(keys, inserts, positive_queries, negative_queries, sorted_queries, true));
+        }
+    }
+    print(tree, "live", live);
+    print(tree, "frozen", frozen);
+}
+
+
+int main(int argc, char **argv) {
+    const uint32_t key_count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const uint32_t query_count = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(key_count);
+    for (uint64_t &key : keys)
+        key = rng();
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<uint64_t> inserts(key_count / 10);
+    for (uint64_t &key : inserts)
+        key = rng();
+    std::vector<uint64_t> positive_queries(query_count), negative_queries(query_count);
+    for (uint32_t i = 0; i < query_count; i++) {
+        positive_queries[i] = keys[rng() % keys.size()];
+        negative_queries[i] = rng();
+    }
+    std::vector<uint64_t> sorted_queries(negative_queries);
+    std::sort(sorted_queries.begin(), sorted_queries.end());
+
+    std::printf("%6s %7s %12s %14s %14s %11s %12s\n",
+                "tree", "state", "bits_per_key", "positive_mops", "negative_mops", "range_mops", "sorted_mops");
+    compare<true>("int", keys, inserts, positive_queries, negative_queries, sorted_queries);
+    compare<false>("string", keys, inserts, positive_queries, negative_queries, sorted_queries);
+    return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of --- <>.
+ * Copyright (C) 2024 ---.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "diva.hpp"
+
+// Query and insert latency against memory for one rank directory density.
+// Each bench_rank_directory_<block size> binary is compiled with a different
+// DIVA_RANK_BLOCK_SIZE, so running them in turn gives the whole trade-off.
+
+using timer = std::chrono::high_resolution_clock;
+
+constexpr uint32_t infix_size = 8;
+constexpr uint32_t seed = 1;
+constexpr float load_factor = 0.95;
+
+
+template <typename t_fun>
+static double time_ops(const std::vector<uint64_t> &keys, t_fun op, uint64_t &checksum) {
+    const timer::time_point start = timer::now();
+    for (const uint64_t key : keys)
+        checksum += op(key);
+    return std::chrono::duration<double, std::nano>(timer::now() - start).count() / keys.size();
+}
+
+
+int main(int argc, char **argv) {
+    const uint32_t key_count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const uint32_t query_count = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(key_count);
+    for (uint64_t &key : keys)
+        key = rng();
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    Diva<true> s(infix_size, keys.begin(), keys.end(), sizeof(uint64_t), seed, load_factor);
+
+    std::vector<uint64_t> positive_queries(query_count), negative_queries(query_count), inserts(query_count);
+    for (uint32_t i = 0; i < query_count; i++) {
+        positive_queries[i] = keys[rng() % keys.size()];
+        negative_queries[i] = rng();
+        inserts[i] = rng();
+    }
+
+    uint64_t checksum = 0;
+    const double positive_ns = time_ops(positive_queries, [&](uint64_t key) { return s.PointQuery(key); }, checksum);
+    const double negative_ns = time_ops(negative_queries, [&](uint64_t key) { return s.PointQuery(key); }, checksum);
+    const double range_ns = time_ops(negative_queries,
+                                     [&](uint64_t key) { return s.RangeQuery(key, key + (1ULL << 40)); }, checksum);
+    const double bits_per_key = s.Size() * 8.0 / keys.size();
+    const double insert_ns = time_ops(inserts, [&](uint64_t key) { s.Insert(key); return 0; }, checksum);
+
+    std::printf("%10s %12s %12s %12s %12s %12s\n",
+                "block_size", "bits_per_key", "positive_ns", "negative_ns", "range_ns", "insert_ns");
+    std::printf("%10u %12.3f %12.1f %12.1f %12.1f %12.1f\n",
+                DIVA_RANK_BLOCK_SIZE, bits_per_key, positive_ns, negative_ns, range_ns, insert_ns);
+    std::fprintf(stderr, "checksum %lu\n", checksum);
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * This file is part of --- <>.
+ * Copyright (C) 2024 ---.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "util.hpp"
+
+// Rank and select over the short word ranges that infix stores scan, for
+// every kernel the host can run. The AVX2 select kernel is not used by Diva,
+// it is kept here to show that pshufb popcounts lose to POPCNT for select.
+
+using timer = std::chrono::high_resolution_clock;
+
+constexpr uint32_t bitmap_count = 1024;
+constexpr uint32_t query_count = 1 << 20;
+constexpr uint32_t repetitions = 10;
+
+
+__attribute__((target("avx2")))
+static uint32_t select_word_avx2(const uint64_t *words, const uint32_t word_count, const uint32_t rank,
+                                 uint32_t &rank_before) {
+    if (word_count == 0)
+        return select_word_scalar(words, word_count, rank, rank_before);
+
+    const __m256i lane = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i target = _mm256_set1_epi64x(rank);
+    __m256i carry = _mm256_setzero_si256();
+    alignas(32) uint64_t before[4];
+    uint32_t res = 0;
+    for (uint32_t i = 0; i < word_count; i += 4) {
+        const __m256i valid = _mm256_cmpgt_epi64(_mm256_set1_epi64x(word_count - i), lane);
+        const __m256i words_vec = _mm256_maskload_epi64(reinterpret_cast<const long long *>(words + i), valid);
+        const __m256i counts = popcount_epi64_avx2(words_vec);
+        __m256i prefix = _mm256_add_epi64(counts, _mm256_blend_epi32(_mm256_permute4x64_epi64(counts, 0x90),
+                                                                     _mm256_setzero_si256(), 0x03));
+        prefix = _mm256_add_epi64(prefix, _mm256_blend_epi32(_mm256_permute4x64_epi64(prefix, 0x40),
+                                                             _mm256_setzero_si256(), 0x0F));
+        prefix = _mm256_add_epi64(prefix, carry);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(before), _mm256_sub_epi64(prefix, counts));
+        const __m256i below = _mm256_andnot_si256(_mm256_cmpgt_epi64(prefix, target), valid);
+        const uint32_t below_count = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(below)));
+        res += below_count;
+        if (below_count < 4)
+            break;
+        carry = _mm256_permute4x64_epi64(prefix, 0xFF);
+    }
+    res = std::min(res, word_count - 1);
+    rank_before = before[res % 4];
+    return res;
+}
+
+
+struct Workload {
+    uint32_t word_count;
+    std::vector<uint64_t> bitmaps;
+    std::vector<uint32_t> ranks;
+};
+
+
+static Workload generate_workload(const uint32_t word_count, std::mt19937_64 &rng) {
+    Workload res {word_count, std::vector<uint64_t>(bitmap_count * word_count), std::vector<uint32_t>(query_count)};
+    // Runends are sparser than occupieds, so mix both densities
+    for (uint32_t i = 0; i < res.bitmaps.size(); i++)
+        res.bitmaps[i] = (i / word_count) % 2 ? rng() : rng() & rng();
+    for (uint32_t i = 0; i < query_count; i++) {
+        const uint64_t *words = res.bitmaps.data() + (i % bitmap_count) * word_count;
+        res.ranks[i] = rng() % (popcount_words_scalar(words, word_count) + 1);
+    }
+    return res;
+}
+
+
+static void check(const uint64_t checksum, const uint64_t expected, const char *kernel) {
+    if (checksum != expected) {
+        std::fprintf(stderr, "%s kernel disagrees with the scalar kernel\n", kernel);
+        std::exit(1);
+    }
+}
+
+
+template <typename t_fun>
+static double time_rank(const Workload &workload, t_fun rank_f, uint64_t &checksum) {
+    const timer::time_point start = timer::now();
+    for (uint32_t rep = 0; rep < repetitions; rep++) {
+        for (uint32_t i = 0; i < query_count; i++) {
+            const uint64_t *words = workload.bitmaps.data() + (i % bitmap_count) * workload.word_count;
+            checksum += rank_f(words, workload.ranks[i] % (workload.word_count + 1));
+        }
+    }
+    return std::chrono::duration<double, std::nano>(timer::now() - start).count() / (repetitions * query_count);
+}
+
+
+template <typename t_fun>
+static double time_select(const Workload &workload, t_fun select_f, uint64_t &checksum) {
+    const timer::time_point start = timer::now();
+    for (uint32_t rep = 0; rep < repetitions; rep++) {
+        for (uint32_t i = 0; i < query_count; i++) {
+            const uint64_t *words = workload.bitmaps.data() + (i % bitmap_count) * workload.word_count;
+            uint32_t rank_before;
+            checksum += select_f(words, workload.word_count, workload.ranks[i], rank_before) + rank_before;
+        }
+    }
+    return std::chrono::duration<double, std::nano>(timer::now() - start).count() / (repetitions * query_count);
+}
+
+
+int main() {
+    const bool has_avx2 = cpu_features.avx2;
+    const bool has_avx512 = cpu_features.avx512_popcnt;
+    std::printf("avx2: %s, avx512 vpopcntq: %s\n", has_avx2 ? "yes" : "no", has_avx512 ? "yes" : "no");
+    std::printf("%6s %8s %10s %10s %10s\n", "words", "op", "scalar", "avx2", "avx512");
+
+    std::mt19937_64 rng(1);
+    for (const uint32_t word_count : {2, 4, 8, 12, 16, 24, 32}) {
+        const Workload workload = generate_workload(word_count, rng);
+        uint64_t expected = 0, checksum;
+        const double rank_scalar = time_rank(workload, popcount_words_scalar, expected);
+        double rank_avx2 = 0, rank_avx512 = 0;
+        if (has_avx2) {
+            checksum = 0;
+            rank_avx2 = time_rank(workload, popcount_words_avx2, checksum);
+            check(checksum, expected, "avx2");
+        }
+        if (has_avx512) {
+            checksum = 0;
+            rank_avx512 = time_rank(workload, popcount_words_avx512, checksum);
+            check(checksum, expected, "avx512");
+        }
+        std::printf("%6u %8s %10.2f %10.2f %10.2f\n", word_count, "rank", rank_scalar, rank_avx2, rank_avx512);
+
+        expected = 0;
+        const double select_scalar = time_select(workload, select_word_scalar, expected);
+        double select_avx2 = 0, select_avx512 = 0;
+        if (has_avx2) {
+            checksum = 0;
+            select_avx2 = time_select(workload, select_word_avx2, checksum);
+            check(checksum, expected, "avx2");
+        }
+        if (has_avx512) {
+            checksum = 0;
+            select_avx512 = time_select(workload, select_word_avx512, checksum);
+            check(checksum, expected, "avx512");
+        }
+        std::printf("%6u %8s %10.2f %10.2f %10.2f\n", word_count, "select", select_scalar, select_avx2, select_avx512);
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of --- <>.
+ * Copyright (C) 2024 ---.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "diva.hpp"
+
+// Space and throughput of string keys with whole boundary keys against
+// boundary keys cut to their shortest separators. The keys are URLs with a
+// binary identifier, so adjacent keys share long prefixes and suffixes.
+
+using timer = std::chrono::high_resolution_clock;
+
+constexpr uint32_t infix_size = 8;
+constexpr uint32_t seed = 1;
+constexpr float load_factor = 0.95;
+
+
+template <typename t_fun>
+static double time_ops(const std::vector<std::string> &keys, t_fun op, uint64_t &checksum) {
+    const timer::time_point start = timer::now();
+    for (const std::string &key : keys)
+        checksum += op(key);
+    return keys.size() / std::chrono::duration<double, std::micro>(timer::now() - start).count();
+}
+
+
+static void run(const bool shortest_separators, const std::vector<std::string> &keys,
+                const std::vector<std::string> &positive_queries, const std::vector<std::string> &negative_queries,
+                const std::vector<std::string> &inserts) {
+    const timer::time_point start = timer::now();
+    Diva<false> s(infix_size, keys.begin(), keys.end(), seed, load_factor, 1, shortest_separators);
+    const double bulk_load_mops = keys.size() / std::chrono::duration<double, std::micro>(timer::now() - start).count();
+
+    uint64_t checksum = 0, false_positives = 0;
+    const double positive_mops = time_ops(positive_queries, [&](const std::string &key) { return s.PointQuery(key); },
+                                          checksum);
+    const double negative_mops = time_ops(negative_queries, [&](const std::string &key) { return s.PointQuery(key); },
+                                          false_positives);
+    const double range_mops = time_ops(negative_queries,
+                                       [&](const std::string &key) { return s.RangeQuery(key, key + "\xff"); },
+                                       checksum);
+    const double bits_per_key = s.Size() * 8.0 / keys.size();
+    const double insert_mops = time_ops(inserts, [&](const std::string &key) { s.Insert(key); return 0; }, checksum);
+
+    std::printf("%9s %12.3f %10.2f %14.2f %14.2f %11.2f %12.2f %10.5f\n", shortest_separators ? "shortest" : "whole",
+                bits_per_key, bulk_load_mops, positive_mops, negative_mops, range_mops, insert_mops,
+                static_cast<double>(false_positives) / negative_queries.size());
+    std::fprintf(stderr, "checksum %lu\n", checksum);
+}
+
+
+int main(int argc, char **argv) {
+    const uint32_t key_count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const uint32_t query_count = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+    std::mt19937_64 rng(seed);
+    auto random_key = [&rng]() {
+        const uint64_t host = rng() % 16, id = rng();
+        return "https://www.host-" + std::to_string(host) + ".com/items/"
+               + std::string(reinterpret_cast<const char *>(&id), sizeof(id)) + "/details.html";
+    };
+    std::vector<std::string> keys(key_count);
+    for (std::string &key : keys)
+        key = random_key();
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<std::string> positive_queries(query_count), negative_queries(query_count), inserts(query_count);
+    for (uint32_t i = 0; i < query_count; i++) {
+        positive_queries[i] = keys[rng() % keys.size()];
+        negative_queries[i] = random_key();
+        inserts[i] = random_key();
+    }
+
+    std::printf("%9s %12s %10s %14s %14s %11s %12s %10s\n", "boundary", "bits_per_key", "load_mops",
+                "positive_mops", "negative_mops", "range_mops", "insert_mops", "fpr");
+    run(false, keys, positive_queries, negative_queries, inserts);
+    run(true, keys, positive_queries, negative_queries, inserts);
+    return 0;
+}
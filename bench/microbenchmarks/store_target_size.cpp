@@ -0,0 +1,91 @@
+/*
+ * This file is part of --- <>.
+ * Copyright (C) 2024 ---.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "diva.hpp"
+
+// Throughput against memory for each infix store target size. Smaller stores
+// shift less per insert, while larger ones put fewer boundary keys in the tree.
+
+using timer = std::chrono::high_resolution_clock;
+
+constexpr uint32_t infix_size = 8;
+constexpr uint32_t seed = 1;
+constexpr float load_factor = 0.95;
+
+
+template <typename t_fun>
+static double time_ops(const std::vector<uint64_t> &keys, t_fun op, uint64_t &checksum) {
+    const timer::time_point start = timer::now();
+    for (const uint64_t key : keys)
+        checksum += op(key);
+    return keys.size() / std::chrono::duration<double, std::micro>(timer::now() - start).count();
+}
+
+
+template <uint32_t target_size>
+static void run(const std::vector<uint64_t> &keys, const std::vector<uint64_t> &positive_queries,
+                const std::vector<uint64_t> &negative_queries, const std::vector<uint64_t> &inserts) {
+    Diva<true, target_size> s(infix_size, keys.begin(), keys.end(), sizeof(uint64_t), seed, load_factor);
+
+    uint64_t checksum = 0;
+    const double positive_mops = time_ops(positive_queries, [&](uint64_t key) { return s.PointQuery(key); }, checksum);
+    const double negative_mops = time_ops(negative_queries, [&](uint64_t key) { return s.PointQuery(key); }, checksum);
+    const double range_mops = time_ops(negative_queries,
+                                       [&](uint64_t key) { return s.RangeQuery(key, key + (1ULL << 40)); }, checksum);
+    const double bits_per_key = s.Size() * 8.0 / keys.size();
+    const double insert_mops = time_ops(inserts, [&](uint64_t key) { s.Insert(key); return 0; }, checksum);
+
+    std::printf("%11u %12.3f %14.2f %14.2f %11.2f %12.2f\n",
+                target_size, bits_per_key, positive_mops, negative_mops, range_mops, insert_mops);
+    std::fprintf(stderr, "checksum %lu\n", checksum);
+}
+
+
+int main(int argc, char **argv) {
+    const uint32_t key_count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const uint32_t query_count = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(key_count);
+    for (uint64_t &key : keys)
+        key = rng();
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<uint64_t> positive_queries(query_count), negative_queries(query_count), inserts(query_count);
+    for (uint32_t i = 0; i < query_count; i++) {
+        positive_queries[i] = keys[rng() % keys.size()];
+        negative_queries[i] = rng();
+        inserts[i] = rng();
+    }
+
+    std::printf("%11s %12s %14s %14s %11s %12s\n",
+                "target_size", "bits_per_key", "positive_mops", "negative_mops", "range_mops", "insert_mops");
+    run<512>(keys, positive_queries, negative_queries, inserts);
+    run<1024>(keys, positive_queries, negative_queries, inserts);
+    run<2048>(keys, positive_queries, negative_queries, inserts);
+    run<4096>(keys, positive_queries, negative_queries, inserts);
+    return 0;
+}
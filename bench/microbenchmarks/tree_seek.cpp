@@ -0,0 +1,149 @@
+/*
+ * This file is part of --- <>.
+ * Copyright (C) 2024 ---.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "diva.hpp"
+
+// Cost of finding the two boundary keys around a query key in the boundary
+// trees: seek, peek, skip back and peek again, against a single seek_near.
+// The Diva rows time the point and range queries built on top of it.
+
+using timer = std::chrono::high_resolution_clock;
+
+constexpr uint32_t infix_size = 8;
+constexpr uint32_t seed = 1;
+constexpr float load_factor = 0.95;
+constexpr uint32_t value_size = 8;
+
+
+template <typename t_fun>
+static double time_ops(const std::vector<uint64_t> &keys, t_fun op, uint64_t &checksum) {
+    const timer::time_point start = timer::now();
+    for (const uint64_t key : keys)
+        checksum += op(key);
+    return std::chrono::duration<double, std::nano>(timer::now() - start).count() / keys.size();
+}
+
+
+template <typename t_iter, typename t_seek, typename t_peek, typename t_skip1_rev, typename t_seek_near>
+static void run_tree(const char *name, t_iter *it, const std::vector<uint64_t> &queries,
+                     t_seek seek, t_peek peek, t_skip1_rev skip1_rev, t_seek_near seek_near) {
+    uint64_t checksum = 0;
+    const double walk_ns = time_ops(queries, [&](uint64_t key) {
+            const uint64_t key_rev = __builtin_bswap64(key);
+            const void *next_key, *prev_key;
+            void *value;
+            uint32_t next_len, prev_len, value_len;
+            seek(it, &key_rev, sizeof(key_rev));
+            peek(it, &next_key, &next_len, &value, &value_len);
+            skip1_rev(it);
+            peek(it, &prev_key, &prev_len, &value, &value_len);
+            return next_len + prev_len;
+        }, checksum);
+    const double near_ns = time_ops(queries, [&](uint64_t key) {
+            const uint64_t key_rev = __builtin_bswap64(key);
+            const void *next_key, *prev_key;
+            void *next_value, *prev_value;
+            uint32_t next_len, prev_len;
+            seek_near(it, &key_rev, sizeof(key_rev), &prev_key, &prev_len, &prev_value,
+                      &next_key, &next_len, &next_value);
+            return next_len + prev_len;
+        }, checksum);
+    std::printf("%-8s %12.1f %12.1f\n", name, walk_ns, near_ns);
+    std::fprintf(stderr, "checksum %lu\n", checksum);
+}
+
+
+int main(int argc, char **argv) {
+    const uint32_t key_count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const uint32_t query_count = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> keys(key_count);
+    for (uint64_t &key : keys)
+        key = rng();
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<uint64_t> queries(query_count);
+    for (uint64_t &query : queries)
+        query = rng();
+
+    // As many boundary keys as a filter over the keys has infix stores,
+    // between the minimum and maximum sentinels
+    const uint32_t boundary_count = keys.size() / 1024;
+    uint8_t value[value_size] = {};
+    wormhole *wh = wh_create();
+    wormref *ref = wh_ref(wh);
+    wormhole_int *wh_int = wh_int_create();
+    wormref_int *ref_int = wh_int_ref(wh_int);
+    std::vector<uint64_t> boundaries {0, ~0ULL};
+    for (uint32_t i = 0; i < boundary_count; i++)
+        boundaries.push_back(keys[i * 1024]);
+    for (const uint64_t key : boundaries) {
+        const uint64_t key_rev = __builtin_bswap64(key);
+        wh_put(ref, &key_rev, sizeof(key_rev), value, value_size);
+        wh_int_put(ref_int, &key_rev, sizeof(key_rev), value, value_size);
+    }
+
+    std::printf("%-8s %12s %12s\n", "tree", "walk_ns", "near_ns");
+    wormhole_iter *it = wh_iter_create(ref);
+    run_tree("string", it, queries, wh_iter_seek, wh_iter_peek_ref, wh_iter_skip1_rev, wh_iter_seek_near);
+    wh_iter_destroy(it);
+    wormhole_int_iter *it_int = wh_int_iter_create(ref_int);
+    // The integer tree calls are overloaded on the key width
+    run_tree("int", it_int, queries,
+             [](auto... args) { wh_int_iter_seek(args...); }, [](auto... args) { wh_int_iter_peek_ref(args...); },
+             [](auto... args) { wh_int_iter_skip1_rev(args...); }, [](auto... args) { wh_int_iter_seek_near(args...); });
+    wh_int_iter_destroy(it_int);
+    wh_unref(ref);
+    wh_destroy(wh);
+    wh_int_unref(ref_int);
+    wh_int_destroy(wh_int);
+
+    std::vector<uint64_t> string_keys(keys);
+    for (uint64_t &key : string_keys)
+        key = __builtin_bswap64(key);
+    Diva<true> s_int(infix_size, keys.begin(), keys.end(), sizeof(uint64_t), seed, load_factor);
+    Diva<false> s_string(infix_size, string_keys.begin(), string_keys.end(), sizeof(uint64_t), seed, load_factor);
+
+    uint64_t checksum = 0;
+    std::printf("\n%-8s %12s %12s\n", "diva", "point_ns", "range_ns");
+    std::printf("%-8s %12.1f %12.1f\n", "int",
+                time_ops(queries, [&](uint64_t key) { return s_int.PointQuery(key); }, checksum),
+                time_ops(queries, [&](uint64_t key) { return s_int.RangeQuery(key, key + (1ULL << 40)); }, checksum));
+    std::printf("%-8s %12.1f %12.1f\n", "string",
+                time_ops(queries, [&](uint64_t key) {
+                        const uint64_t key_rev = __builtin_bswap64(key);
+                        return s_string.PointQuery(std::string_view(reinterpret_cast<const char *>(&key_rev), sizeof(key_rev)));
+                    }, checksum),
+                time_ops(queries, [&](uint64_t key) {
+                        const uint64_t l_rev = __builtin_bswap64(key), r_rev = __builtin_bswap64(key + (1ULL << 40));
+                        return s_string.RangeQuery(std::string_view(reinterpret_cast<const char *>(&l_rev), sizeof(l_rev)),
+                                                   std::string_view(reinterpret_cast<const char *>(&r_rev), sizeof(r_rev)));
+                    }, checksum));
+    std::fprintf(stderr, "checksum %lu\n", checksum);
+    return 0;
+}
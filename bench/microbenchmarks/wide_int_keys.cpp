@@ -0,0 +1,98 @@
+/*
+ * This file is part of --- <>.
+ * Copyright (C) 2024 ---.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "diva.hpp"
+
+// Throughput of 16-byte integer keys in the integer optimized mode, with its
+// own boundary tree, against the same keys as 16-byte strings.
+
+using timer = std::chrono::high_resolution_clock;
+using u128 = unsigned __int128;
+
+constexpr uint32_t infix_size = 8;
+constexpr uint32_t seed = 1;
+constexpr float load_factor = 0.95;
+
+
+template <typename t_fun>
+static double time_ops(const std::vector<u128> &keys, t_fun op, uint64_t &checksum) {
+    const timer::time_point start = timer::now();
+    for (const u128 key : keys)
+        checksum += op(key);
+    return keys.size() / std::chrono::duration<double, std::micro>(timer::now() - start).count();
+}
+
+
+template <bool int_optimized>
+static void run(const std::vector<u128> &keys, const std::vector<u128> &positive_queries,
+                const std::vector<u128> &negative_queries, const std::vector<u128> &inserts) {
+    // The string mode takes integer keys as raw bytes
+    std::vector<u128> conv_keys(keys);
+    if constexpr (!int_optimized) {
+        for (u128 &key : conv_keys)
+            key = to_big_endian_order(key);
+    }
+    const timer::time_point start = timer::now();
+    Diva<int_optimized, 1024, u128> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(u128), seed, load_factor);
+    const double bulk_load_mops = keys.size() / std::chrono::duration<double, std::micro>(timer::now() - start).count();
+
+    uint64_t checksum = 0;
+    const double positive_mops = time_ops(positive_queries, [&](u128 key) { return s.PointQuery(key); }, checksum);
+    const double negative_mops = time_ops(negative_queries, [&](u128 key) { return s.PointQuery(key); }, checksum);
+    const double range_mops = time_ops(negative_queries,
+                                       [&](u128 key) { return s.RangeQuery(key, key + (1ULL << 40)); }, checksum);
+    const double bits_per_key = s.Size() * 8.0 / keys.size();
+    const double insert_mops = time_ops(inserts, [&](u128 key) { s.Insert(key); return 0; }, checksum);
+
+    std::printf("%7s %12.3f %10.2f %14.2f %14.2f %11.2f %12.2f\n", int_optimized ? "int128" : "string",
+                bits_per_key, bulk_load_mops, positive_mops, negative_mops, range_mops, insert_mops);
+    std::fprintf(stderr, "checksum %lu\n", checksum);
+}
+
+
+int main(int argc, char **argv) {
+    const uint32_t key_count = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const uint32_t query_count = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+    std::mt19937_64 rng(seed);
+    auto random_key = [&rng]() { return (static_cast<u128>(rng()) << 64) | rng(); };
+    std::vector<u128> keys(key_count);
+    for (u128 &key : keys)
+        key = random_key();
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<u128> positive_queries(query_count), negative_queries(query_count), inserts(query_count);
+    for (uint32_t i = 0; i < query_count; i++) {
+        positive_queries[i] = keys[rng() % keys.size()];
+        negative_queries[i] = random_key();
+        inserts[i] = random_key();
+    }
+
+    std::printf("%7s %12s %10s %14s %14s %11s %12s\n", "keys", "bits_per_key", "load_mops",
+                "positive_mops", "negative_mops", "range_mops", "insert_mops");
+    run<true>(keys, positive_queries, negative_queries, inserts);
+    run<false>(keys, positive_queries, negative_queries, inserts);
+    return 0;
+}
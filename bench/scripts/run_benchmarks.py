@@ -8,11 +8,13 @@ global benchmarks_dir
 global output_prefix
 RANGE_FIXED_FILTERS = ["memento", "memento_expandable", "rosetta", "proteus"]
 
-def execute_benchmark(build_dir, output_base, workload_subdir, workload, filter, bpk, force_range_size=None, wiredtiger=False):
+def execute_benchmark(build_dir, output_base, workload_subdir, workload, filter, bpk, force_range_size=None, wiredtiger=False, huge_pages=None):
     file_to_execute = f"bench/bench_{filter}_wiredtiger" if wiredtiger else f"bench/bench_{filter}"
     range_size_option = f"--range-size {force_range_size}" if force_range_size else ""
-    command = f"{build_dir}/{file_to_execute} {bpk} -w {workload} {range_size_option} | tee {output_base}/{filter}_{bpk}_{workload.name}.json"
-    cli_message_command = f"<build_dir>/{file_to_execute} {bpk} -w <workload_dir>/{workload_subdir}/{workload.name} {range_size_option} | tee <output_dir>/{workload_subdir}/{filter}_{bpk}_{workload.name}.json"
+    huge_pages_option = f"--huge-pages {huge_pages}" if huge_pages else ""
+    output_name = f"{filter}_{bpk}_{huge_pages}_{workload.name}" if huge_pages else f"{filter}_{bpk}_{workload.name}"
+    command = f"{build_dir}/{file_to_execute} {bpk} -w {workload} {range_size_option} {huge_pages_option} | tee {output_base}/{output_name}.json"
+    cli_message_command = f"<build_dir>/{file_to_execute} {bpk} -w <workload_dir>/{workload_subdir}/{workload.name} {range_size_option} {huge_pages_option} | tee <output_dir>/{workload_subdir}/{output_name}.json"
 
     print(f"[ Executing: {cli_message_command} ]")
     subprocess.run(command, shell=True)
@@ -94,6 +96,21 @@ def true_bench():
                     execute_benchmark(build_dir, output_base, workload_subdir, workload, filter, DEFAULT_MEMORY_FOOTPRINT, 
                                       MEDIAN_RANGE_SIZE if filter in RANGE_FIXED_FILTERS else None)
 
+def huge_pages_bench():
+    filters = ["diva", "diva_int"]
+    memory_footprints = [16]
+    page_sizes = ["none", "2mb", "1gb"]
+    workload_subdir = "true_bench"
+    output_base = Path(f"./{output_prefix}/huge_pages_bench/")
+    output_base.mkdir(parents=True, exist_ok=True)
+
+    workload_path = Path(f"{workload_dir}/{workload_subdir}")
+    for workload in workload_path.iterdir():
+        if workload.is_file():
+            for filter, bpk, page_size in itertools.product(filters, memory_footprints, page_sizes):
+                execute_benchmark(build_dir, output_base, workload_subdir, workload, filter, bpk,
+                                  huge_pages=page_size)
+
 def expansion_bench():
     filters = ["diva", "diva_int", "memento_expandable", "rosetta",
                "rencoder", "snarf"]
@@ -179,6 +196,7 @@ def mixed_bench():
 RUNNERS = {"fpr": fpr_bench,
            "fpr_string": fpr_string_bench,
            "true": true_bench,
+           "huge_pages": huge_pages_bench,
            "construction": construction_bench,
            "expansion": expansion_bench,
            "delete": delete_bench,
@@ -0,0 +1,649 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+/**
+ * Ordered maps from boundary keys to infix stores that Diva can keep in place
+ * of its wormholes, picked with its `t_index` template parameter. Keys are byte
+ * strings ordered lexicographically, like the keys of the string wormhole.
+ *
+ * Every index offers, through an `Iter` whose `index` member points back at it:
+ * - `Seek`: positions the iterator on the first key not less than the given one
+ * - `SeekNear`: positions it on the last key not greater than the given one,
+ *   and returns that key and its successor along with their values
+ * - `Valid`, `Peek`, `Next` and `Prev` for ordered iteration
+ * - `Insert`, which overwrites the value of a key already present, and `Erase`
+ * Keys and values returned by `Peek` and `SeekNear` stay valid until the next
+ * `Insert` of a new key or `Erase`. None of them take locks, so Diva sessions
+ * need the wormholes.
+ */
+template <class t_value>
+struct WormholeIndex {
+    // Diva keeps its own code paths for the wormholes, so this only marks them
+    struct Iter;
+};
+
+
+/**
+ * Boundary key owning its bytes. Comparisons look at the first eight bytes,
+ * read as a big-endian integer, before anything else, and keys of up to eight
+ * bytes, such as those of the integer optimized mode, are stored inline.
+ */
+class BoundaryKey {
+public:
+    BoundaryKey() = default;
+    BoundaryKey(const uint8_t *str, const uint32_t length);
+    BoundaryKey(const BoundaryKey &other): BoundaryKey(other.data(), other.length_) {};
+    BoundaryKey(BoundaryKey &&other) noexcept;
+    BoundaryKey &operator=(const BoundaryKey &other);
+    BoundaryKey &operator=(BoundaryKey &&other) noexcept;
+    ~BoundaryKey();
+
+    static uint64_t GetHead(const uint8_t *str, const uint32_t length);
+    const uint8_t *data() const {
+        return length_ <= sizeof(inline_) ? inline_ : heap_;
+    }
+    uint32_t length() const {
+        return length_;
+    }
+    uint64_t head() const {
+        return head_;
+    }
+    int32_t Compare(const uint64_t head, const uint8_t *str, const uint32_t length) const;
+
+private:
+    uint64_t head_ = 0;
+    uint32_t length_ = 0;
+    union {
+        uint8_t inline_[8];
+        uint8_t *heap_;
+    };
+};
+
+
+inline BoundaryKey::BoundaryKey(const uint8_t *str, const uint32_t length):
+        head_(GetHead(str, length)),
+        length_(length) {
+    if (length_ <= sizeof(inline_))
+        memcpy(inline_, str, length_);
+    else {
+        heap_ = new uint8_t[length_];
+        memcpy(heap_, str, length_);
+    }
+}
+
+
+inline BoundaryKey::BoundaryKey(BoundaryKey &&other) noexcept:
+        head_(other.head_),
+        length_(other.length_) {
+    memcpy(inline_, other.inline_, sizeof(inline_));
+    other.length_ = 0;
+}
+
+
+inline BoundaryKey &BoundaryKey::operator=(const BoundaryKey &other) {
+    if (this != &other)
+        *this = BoundaryKey(other);
+    return *this;
+}
+
+
+inline BoundaryKey &BoundaryKey::operator=(BoundaryKey &&other) noexcept {
+    if (this != &other) {
+        if (length_ > sizeof(inline_))
+            delete[] heap_;
+        head_ = other.head_;
+        length_ = other.length_;
+        memcpy(inline_, other.inline_, sizeof(inline_));
+        other.length_ = 0;
+    }
+    return *this;
+}
+
+
+inline BoundaryKey::~BoundaryKey() {
+    if (length_ > sizeof(inline_))
+        delete[] heap_;
+}
+
+
+__attribute__((always_inline))
+inline uint64_t BoundaryKey::GetHead(const uint8_t *str, const uint32_t length) {
+    uint64_t res = 0;
+    if (length >= sizeof(res))
+        memcpy(&res, str, sizeof(res));
+    else if (length > 0)
+        memcpy(&res, str, length);
+    return __builtin_bswap64(res);
+}
+
+
+__attribute__((always_inline))
+inline int32_t BoundaryKey::Compare(const uint64_t head, const uint8_t *str, const uint32_t length) const {
+    if (head_ != head)
+        return head_ < head ? -1 : 1;
+    // Equal heads leave the first eight bytes, or all of the shorter key, equal
+    const uint32_t min_length = std::min(length_, length);
+    if (min_length > sizeof(head_)) {
+        const int32_t cmp = memcmp(data() + sizeof(head_), str + sizeof(head_), min_length - sizeof(head_));
+        if (cmp != 0)
+            return cmp;
+    }
+    return length_ == length ? 0 : (length_ < length ? -1 : 1);
+}
+
+
+/**
+ * Boundary keys and values in two sorted arrays. Updates binary search the
+ * key array, while lookups go through a copy of the key heads in Eytzinger
+ * (BFS) order, whose first levels share cache lines. New keys and erases shift
+ * the arrays and leave the copy to be rebuilt by the next lookup, which suits
+ * filters that are read far more often than their stores split or merge.
+ */
+template <class t_value>
+class SortedArrayIndex {
+public:
+    struct Iter {
+        SortedArrayIndex *index;
+        uint32_t pos = 0;
+    };
+
+    void Seek(Iter &it, const uint8_t *key, const uint32_t key_len);
+    void SeekNear(Iter &it, const uint8_t *key, const uint32_t key_len,
+                  const uint8_t *&prev_key, uint32_t &prev_key_len, t_value *&prev_value,
+                  const uint8_t *&next_key, uint32_t &next_key_len, t_value *&next_value);
+    bool Valid(const Iter &it) const {
+        return it.pos < keys_.size();
+    }
+    void Peek(const Iter &it, const uint8_t *&key, uint32_t &key_len, t_value *&value);
+    void Next(Iter &it) const {
+        if (Valid(it))
+            it.pos++;
+    }
+    void Prev(Iter &it) const {
+        // Stepping back from the first key wraps around to an invalid position
+        if (Valid(it))
+            it.pos--;
+    }
+    void Insert(const uint8_t *key, const uint32_t key_len, const t_value &value);
+    void Erase(const uint8_t *key, const uint32_t key_len);
+    uint32_t Count() const {
+        return keys_.size();
+    }
+
+private:
+    struct LayoutNode {
+        uint64_t head;
+        uint32_t pos;
+    };
+
+    std::vector<BoundaryKey> keys_;
+    std::vector<t_value> values_;
+    std::vector<LayoutNode> layout_;    // 1-indexed Eytzinger order
+    bool layout_stale_ = true;
+
+    uint32_t LowerBound(const uint8_t *key, const uint32_t key_len) const;
+    uint32_t LayoutLowerBound(const uint8_t *key, const uint32_t key_len);
+    uint32_t FillLayout(uint32_t pos, const uint32_t node);
+    void BuildLayout();
+};
+
+
+template <class t_value>
+inline uint32_t SortedArrayIndex<t_value>::LowerBound(const uint8_t *key, const uint32_t key_len) const {
+    const uint64_t head = BoundaryKey::GetHead(key, key_len);
+    return std::lower_bound(keys_.begin(), keys_.end(), 0,
+                            [&](const BoundaryKey &lhs, int) { return lhs.Compare(head, key, key_len) < 0; })
+           - keys_.begin();
+}
+
+
+template <class t_value>
+inline uint32_t SortedArrayIndex<t_value>::FillLayout(uint32_t pos, const uint32_t node) {
+    // An in-order walk of the implicit tree visits the keys in sorted order
+    if (node < layout_.size()) {
+        pos = FillLayout(pos, 2 * node);
+        layout_[node] = {keys_[pos].head(), pos};
+        pos = FillLayout(pos + 1, 2 * node + 1);
+    }
+    return pos;
+}
+
+
+template <class t_value>
+inline void SortedArrayIndex<t_value>::BuildLayout() {
+    layout_.resize(keys_.size() + 1);
+    FillLayout(0, 1);
+    layout_stale_ = false;
+}
+
+
+template <class t_value>
+__attribute__((always_inline))
+inline uint32_t SortedArrayIndex<t_value>::LayoutLowerBound(const uint8_t *key, const uint32_t key_len) {
+    if (layout_stale_)
+        BuildLayout();
+    const uint64_t head = BoundaryKey::GetHead(key, key_len);
+    const uint32_t n = keys_.size();
+    const LayoutNode *layout = layout_.data();
+    uint32_t node = 1;
+    while (node <= n) {
+        // Four nodes fit in a cache line, and their grandchildren start there
+        __builtin_prefetch(layout + 4 * node);
+        const LayoutNode &cur = layout[node];
+        const bool less = cur.head < head
+                          || (cur.head == head && keys_[cur.pos].Compare(head, key, key_len) < 0);
+        node = 2 * node + less;
+    }
+    // Drop the trailing right turns and the left turn before them
+    node >>= __builtin_ffs(~node);
+    return node == 0 ? n : layout[node].pos;
+}
+
+
+template <class t_value>
+inline void SortedArrayIndex<t_value>::Seek(Iter &it, const uint8_t *key, const uint32_t key_len) {
+    it.pos = LayoutLowerBound(key, key_len);
+}
+
+
+template <class t_value>
+inline void SortedArrayIndex<t_value>::SeekNear(Iter &it, const uint8_t *key, const uint32_t key_len,
+                                                const uint8_t *&prev_key, uint32_t &prev_key_len, t_value *&prev_value,
+                                                const uint8_t *&next_key, uint32_t &next_key_len, t_value *&next_value) {
+    uint32_t pos = LayoutLowerBound(key, key_len);
+    if (pos == keys_.size() || keys_[pos].Compare(BoundaryKey::GetHead(key, key_len), key, key_len) != 0)
+        pos--;
+    it.pos = pos;
+    Peek(it, prev_key, prev_key_len, prev_value);
+    Iter next_it {this, pos + 1};
+    Peek(next_it, next_key, next_key_len, next_value);
+}
+
+
+template <class t_value>
+__attribute__((always_inline))
+inline void SortedArrayIndex<t_value>::Peek(const Iter &it, const uint8_t *&key, uint32_t &key_len, t_value *&value) {
+    if (!Valid(it)) {
+        key = nullptr;
+        key_len = 0;
+        value = nullptr;
+        return;
+    }
+    key = keys_[it.pos].data();
+    key_len = keys_[it.pos].length();
+    value = &values_[it.pos];
+}
+
+
+template <class t_value>
+inline void SortedArrayIndex<t_value>::Insert(const uint8_t *key, const uint32_t key_len, const t_value &value) {
+    // Bulk loads add their keys in increasing order
+    uint32_t pos = keys_.size();
+    const uint64_t head = BoundaryKey::GetHead(key, key_len);
+    if (!keys_.empty() && keys_.back().Compare(head, key, key_len) >= 0) {
+        pos = LowerBound(key, key_len);
+        if (keys_[pos].Compare(head, key, key_len) == 0) {
+            values_[pos] = value;
+            return;
+        }
+    }
+    BoundaryKey new_key(key, key_len);
+    keys_.insert(keys_.begin() + pos, std::move(new_key));
+    values_.insert(values_.begin() + pos, value);
+    layout_stale_ = true;
+}
+
+
+template <class t_value>
+inline void SortedArrayIndex<t_value>::Erase(const uint8_t *key, const uint32_t key_len) {
+    const uint32_t pos = LowerBound(key, key_len);
+    if (pos == keys_.size() || keys_[pos].Compare(BoundaryKey::GetHead(key, key_len), key, key_len) != 0)
+        return;
+    keys_.erase(keys_.begin() + pos);
+    values_.erase(values_.begin() + pos);
+    layout_stale_ = true;
+}
+
+
+/**
+ * B+-tree over the boundary keys, with the leaves linked both ways for
+ * ordered iteration. Nodes are split when they overflow. Erases only drop the
+ * nodes they empty, since boundary keys are mostly inserted and Diva merges
+ * stores far less often than it splits them.
+ */
+template <class t_value>
+class BTreeIndex {
+public:
+    static constexpr uint32_t leaf_capacity = 32;
+    static constexpr uint32_t inner_capacity = 32;
+
+private:
+    struct Node {
+        bool is_leaf;
+        uint32_t count = 0;     // keys in a leaf, children in an inner node
+    };
+
+    // One spare slot in every array lets an insert go in before the split
+    struct Leaf: Node {
+        Leaf *prev = nullptr, *next = nullptr;
+        BoundaryKey keys[leaf_capacity + 1];
+        t_value values[leaf_capacity + 1];
+
+        Leaf(): Node{true} {};
+    };
+
+    // keys[i] is no greater than the keys under children[i + 1], and greater
+    // than those under children[i]
+    struct Inner: Node {
+        BoundaryKey keys[inner_capacity];
+        Node *children[inner_capacity + 1];
+
+        Inner(): Node{false} {};
+    };
+
+public:
+    struct Iter {
+        BTreeIndex *index;
+        Leaf *leaf = nullptr;
+        uint32_t pos = 0;
+    };
+
+    BTreeIndex(): root_(new Leaf()) {};
+    BTreeIndex(const BTreeIndex &other) = delete;
+    BTreeIndex &operator=(const BTreeIndex &other) = delete;
+    ~BTreeIndex();
+
+    void Seek(Iter &it, const uint8_t *key, const uint32_t key_len) const;
+    void SeekNear(Iter &it, const uint8_t *key, const uint32_t key_len,
+                  const uint8_t *&prev_key, uint32_t &prev_key_len, t_value *&prev_value,
+                  const uint8_t *&next_key, uint32_t &next_key_len, t_value *&next_value) const;
+    bool Valid(const Iter &it) const {
+        return it.leaf != nullptr;
+    }
+    void Peek(const Iter &it, const uint8_t *&key, uint32_t &key_len, t_value *&value) const;
+    void Next(Iter &it) const;
+    void Prev(Iter &it) const;
+    void Insert(const uint8_t *key, const uint32_t key_len, const t_value &value);
+    void Erase(const uint8_t *key, const uint32_t key_len);
+    uint32_t Count() const {
+        return count_;
+    }
+
+private:
+    Node *root_;
+    uint32_t count_ = 0;
+
+    static uint32_t UpperBound(const BoundaryKey *keys, const uint32_t key_count,
+                               const uint64_t head, const uint8_t *key, const uint32_t key_len);
+    void Floor(Iter &it, const uint64_t head, const uint8_t *key, const uint32_t key_len) const;
+    Node *InsertInto(Node *node, const uint64_t head, const uint8_t *key, const uint32_t key_len,
+                     const t_value &value, BoundaryKey &split_key);
+    bool EraseFrom(Node *node, const uint64_t head, const uint8_t *key, const uint32_t key_len);
+    static void Destroy(Node *node);
+};
+
+
+template <class t_value>
+inline BTreeIndex<t_value>::~BTreeIndex() {
+    Destroy(root_);
+}
+
+
+template <class t_value>
+inline void BTreeIndex<t_value>::Destroy(Node *node) {
+    if (node->is_leaf) {
+        delete static_cast<Leaf *>(node);
+        return;
+    }
+    Inner *inner = static_cast<Inner *>(node);
+    for (uint32_t i = 0; i < inner->count; i++)
+        Destroy(inner->children[i]);
+    delete inner;
+}
+
+
+template <class t_value>
+__attribute__((always_inline))
+inline uint32_t BTreeIndex<t_value>::UpperBound(const BoundaryKey *keys, const uint32_t key_count,
+                                                const uint64_t head, const uint8_t *key, const uint32_t key_len) {
+    uint32_t l = 0, r = key_count;
+    while (l < r) {
+        const uint32_t mid = (l + r) / 2;
+        if (keys[mid].Compare(head, key, key_len) <= 0)
+            l = mid + 1;
+        else
+            r = mid;
+    }
+    return l;
+}
+
+
+template <class t_value>
+inline void BTreeIndex<t_value>::Floor(Iter &it, const uint64_t head, const uint8_t *key, const uint32_t key_len) const {
+    // Leaves the iterator on the last key not greater than the given one, or
+    // invalid if there is none
+    const Node *node = root_;
+    while (!node->is_leaf) {
+        const Inner *inner = static_cast<const Inner *>(node);
+        node = inner->children[UpperBound(inner->keys, inner->count - 1, head, key, key_len)];
+    }
+    Leaf *leaf = const_cast<Leaf *>(static_cast<const Leaf *>(node));
+    const uint32_t pos = UpperBound(leaf->keys, leaf->count, head, key, key_len);
+    it.leaf = leaf;
+    it.pos = pos;
+    Prev(it);
+}
+
+
+template <class t_value>
+inline void BTreeIndex<t_value>::Seek(Iter &it, const uint8_t *key, const uint32_t key_len) const {
+    const uint64_t head = BoundaryKey::GetHead(key, key_len);
+    Floor(it, head, key, key_len);
+    if (!Valid(it)) {
+        // Everything is greater, so start from the first leaf
+        const Node *node = root_;
+        while (!node->is_leaf)
+            node = static_cast<const Inner *>(node)->children[0];
+        it.leaf = const_cast<Leaf *>(static_cast<const Leaf *>(node));
+        it.pos = 0;
+        if (it.leaf->count == 0)
+            it.leaf = nullptr;
+    }
+    else if (it.leaf->keys[it.pos].Compare(head, key, key_len) != 0)
+        Next(it);
+}
+
+
+template <class t_value>
+inline void BTreeIndex<t_value>::SeekNear(Iter &it, const uint8_t *key, const uint32_t key_len,
+                                          const uint8_t *&prev_key, uint32_t &prev_key_len, t_value *&prev_value,
+                                          const uint8_t *&next_key, uint32_t &next_key_len, t_value *&next_value) const {
+    Floor(it, BoundaryKey::GetHead(key, key_len), key, key_len);
+    Peek(it, prev_key, prev_key_len, prev_value);
+    Iter next_it = it;
+    if (Valid(next_it))
+        Next(next_it);
+    else
+        Seek(next_it, key, key_len);
+    Peek(next_it, next_key, next_key_len, next_value);
+}
+
+
+template <class t_value>
+__attribute__((always_inline))
+inline void BTreeIndex<t_value>::Peek(const Iter &it, const uint8_t *&key, uint32_t &key_len, t_value *&value) const {
+    if (!Valid(it)) {
+        key = nullptr;
+        key_len = 0;
+        value = nullptr;
+        return;
+    }
+    key = it.leaf->keys[it.pos].data();
+    key_len = it.leaf->keys[it.pos].length();
+    value = &it.leaf->values[it.pos];
+}
+
+
+template <class t_value>
+__attribute__((always_inline))
+inline void BTreeIndex<t_value>::Next(Iter &it) const {
+    if (it.leaf != nullptr && ++it.pos == it.leaf->count) {
+        it.leaf = it.leaf->next;
+        it.pos = 0;
+    }
+}
+
+
+template <class t_value>
+__attribute__((always_inline))
+inline void BTreeIndex<t_value>::Prev(Iter &it) const {
+    if (it.leaf == nullptr)
+        return;
+    if (it.pos == 0) {
+        it.leaf = it.leaf->prev;
+        if (it.leaf != nullptr)
+            it.pos = it.leaf->count;
+    }
+    it.pos--;
+}
+
+
+template <class t_value>
+inline void BTreeIndex<t_value>::Insert(const uint8_t *key, const uint32_t key_len, const t_value &value) {
+    BoundaryKey split_key;
+    Node *split_node = InsertInto(root_, BoundaryKey::GetHead(key, key_len), key, key_len, value, split_key);
+    if (split_node != nullptr) {
+        Inner *new_root = new Inner();
+        new_root->keys[0] = std::move(split_key);
+        new_root->children[0] = root_;
+        new_root->children[1] = split_node;
+        new_root->count = 2;
+        root_ = new_root;
+    }
+}
+
+
+template <class t_value>
+inline typename BTreeIndex<t_value>::Node *BTreeIndex<t_value>::InsertInto(Node *node, const uint64_t head,
+                                                                           const uint8_t *key, const uint32_t key_len,
+                                                                           const t_value &value, BoundaryKey &split_key) {
+    // Returns the new right sibling if the node split, with the smallest key
+    // under it in split_key
+    if (node->is_leaf) {
+        Leaf *leaf = static_cast<Leaf *>(node);
+        const uint32_t pos = UpperBound(leaf->keys, leaf->count, head, key, key_len);
+        if (pos > 0 && leaf->keys[pos - 1].Compare(head, key, key_len) == 0) {
+            leaf->values[pos - 1] = value;
+            return nullptr;
+        }
+        // The key may point into this leaf, so it is copied before the shift
+        BoundaryKey new_key(key, key_len);
+        std::move_backward(leaf->keys + pos, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        std::move_backward(leaf->values + pos, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        leaf->keys[pos] = std::move(new_key);
+        leaf->values[pos] = value;
+        leaf->count++;
+        count_++;
+        if (leaf->count <= leaf_capacity)
+            return nullptr;
+
+        Leaf *right = new Leaf();
+        const uint32_t left_count = leaf->count / 2;
+        right->count = leaf->count - left_count;
+        std::move(leaf->keys + left_count, leaf->keys + leaf->count, right->keys);
+        std::move(leaf->values + left_count, leaf->values + leaf->count, right->values);
+        leaf->count = left_count;
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next != nullptr)
+            leaf->next->prev = right;
+        leaf->next = right;
+        split_key = right->keys[0];
+        return right;
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    const uint32_t child_pos = UpperBound(inner->keys, inner->count - 1, head, key, key_len);
+    BoundaryKey child_split_key;
+    Node *child_split = InsertInto(inner->children[child_pos], head, key, key_len, value, child_split_key);
+    if (child_split == nullptr)
+        return nullptr;
+    std::move_backward(inner->keys + child_pos, inner->keys + inner->count - 1, inner->keys + inner->count);
+    std::move_backward(inner->children + child_pos + 1, inner->children + inner->count,
+                       inner->children + inner->count + 1);
+    inner->keys[child_pos] = std::move(child_split_key);
+    inner->children[child_pos + 1] = child_split;
+    inner->count++;
+    if (inner->count <= inner_capacity)
+        return nullptr;
+
+    // The separator between the halves moves up instead of staying in either
+    Inner *right = new Inner();
+    const uint32_t left_count = inner->count / 2;
+    right->count = inner->count - left_count;
+    split_key = std::move(inner->keys[left_count - 1]);
+    std::move(inner->keys + left_count, inner->keys + inner->count - 1, right->keys);
+    std::copy(inner->children + left_count, inner->children + inner->count, right->children);
+    inner->count = left_count;
+    return right;
+}
+
+
+template <class t_value>
+inline void BTreeIndex<t_value>::Erase(const uint8_t *key, const uint32_t key_len) {
+    EraseFrom(root_, BoundaryKey::GetHead(key, key_len), key, key_len);
+    // Inner roots left with a single child give way to it, and an emptied
+    // tree starts over from a leaf
+    while (!root_->is_leaf && root_->count <= 1) {
+        Inner *old_root = static_cast<Inner *>(root_);
+        root_ = old_root->count == 1 ? old_root->children[0] : new Leaf();
+        delete old_root;
+    }
+}
+
+
+template <class t_value>
+inline bool BTreeIndex<t_value>::EraseFrom(Node *node, const uint64_t head, const uint8_t *key, const uint32_t key_len) {
+    // Returns whether the node was emptied and freed
+    if (node->is_leaf) {
+        Leaf *leaf = static_cast<Leaf *>(node);
+        const uint32_t pos = UpperBound(leaf->keys, leaf->count, head, key, key_len);
+        if (pos == 0 || leaf->keys[pos - 1].Compare(head, key, key_len) != 0)
+            return false;
+        std::move(leaf->keys + pos, leaf->keys + leaf->count, leaf->keys + pos - 1);
+        std::move(leaf->values + pos, leaf->values + leaf->count, leaf->values + pos - 1);
+        leaf->keys[--leaf->count] = BoundaryKey();
+        count_--;
+        if (leaf->count > 0 || leaf == root_)
+            return false;
+        if (leaf->prev != nullptr)
+            leaf->prev->next = leaf->next;
+        if (leaf->next != nullptr)
+            leaf->next->prev = leaf->prev;
+        delete leaf;
+        return true;
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    const uint32_t child_pos = UpperBound(inner->keys, inner->count - 1, head, key, key_len);
+    if (!EraseFrom(inner->children[child_pos], head, key, key_len))
+        return false;
+    // The separator to the left of the child goes with it, or the one to its
+    // right for the first child
+    const uint32_t key_pos = child_pos > 0 ? child_pos - 1 : 0;
+    if (inner->count > 1)
+        std::move(inner->keys + key_pos + 1, inner->keys + inner->count - 1, inner->keys + key_pos);
+    std::copy(inner->children + child_pos + 1, inner->children + inner->count, inner->children + child_pos);
+    inner->count--;
+    if (inner->count > 0)
+        inner->keys[inner->count - 1] = BoundaryKey();
+    if (inner->count > 0 || inner == root_)
+        return false;
+    delete inner;
+    return true;
+}
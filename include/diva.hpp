@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <bitset>
 #include <cassert>
 #include <cmath>
@@ -8,19 +9,39 @@
 #include <cstdlib>
 #include <cstring>
 #include <endian.h>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <mutex>
 #include <random>
+#include <string>
 #include <string_view>
+#include <thread>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <x86intrin.h>
 
 #include "wormhole/wh.h"
+#include "boundary_index.hpp"
+#include "slab_allocator.hpp"
 #include "util.hpp"
 #include "wormhole/wh_int.h"
+#include "wormhole/wh_int32.h"
+#include "wormhole/wh_int128.h"
+
+// Bits of the occupieds and runends bitmaps covered by each rank directory
+// counter in an infix store header. Smaller blocks shorten rank and select
+// scans at the cost of larger headers.
+#ifndef DIVA_RANK_BLOCK_SIZE
+#define DIVA_RANK_BLOCK_SIZE 512
+#endif
 
 // TODO: We have a pointer that goes out of the arrays bounds when calling
 // `GetSharedIgnoreImplicitLengths`. Okay, maybe?
@@ -45,54 +66,123 @@ static void print_key(const char *key, const uint32_t key_len, const bool binary
 
 
 template <bool int_optimized>
+class ShardedDiva;
+
+// Concurrent trees take locks and go through qsbr on every access, which a
+// filter used by a single thread can skip altogether
+enum class ThreadPolicy { Concurrent, Single };
+
+template <bool int_optimized, uint32_t target_size=1024, class t_int=uint64_t,
+          ThreadPolicy thread_policy=ThreadPolicy::Concurrent, template <class> class t_index=WormholeIndex>
 class Diva {
     friend class DivaTests;
     friend class InfixStoreTests;
+    friend class ShardedDiva<int_optimized>;
 
 public:
-    Diva(const uint32_t infix_size, const uint32_t rng_seed, const float load_factor);
+    class Session;
+
+    // With `shortest_separators` set, string boundary keys are cut down to the
+    // shortest prefix that still separates their infix stores
+    Diva(const uint32_t infix_size, const uint32_t rng_seed, const float load_factor,
+         const bool shortest_separators=false);
 
     template <class t_itr>
     Diva(const uint32_t infix_size, const t_itr begin, const t_itr end, const uint32_t key_len,
-         const uint32_t rng_seed, const float load_factor);
+         const uint32_t rng_seed, const float load_factor, const uint32_t thread_count=1);
 
     template <class t_itr>
     Diva(const uint32_t infix_size, const t_itr begin, const t_itr end, 
-         const uint32_t rng_seed, const float load_factor);
+         const uint32_t rng_seed, const float load_factor, const uint32_t thread_count=1,
+         const bool shortest_separators=false);
 
     Diva(char *deser_buf);
 
+    // Maps a serialized file read-only, stores are copied when first modified.
+    // With `map` unset the file is streamed in from the current offset instead
+    Diva(const int fd, const bool map=true);
+    Diva(std::istream &in);
+    Diva(const std::function<size_t(char *, size_t)> &read);
+
     ~Diva();
 
-    void Insert(uint64_t key);
+    void Insert(t_int key);
     void Insert(std::string_view key);
     void Insert(const uint8_t *key, const uint32_t key_len);
-    void Delete(uint64_t key);
+    template <class t_itr>
+    void InsertBatch(t_itr begin, t_itr end);
+    void Delete(t_int key);
     void Delete(std::string_view input_key);
     void Delete(const uint8_t *input_key, const uint32_t input_key_len);
-    bool RangeQuery(uint64_t l, uint64_t r) const;
+    template <class t_itr>
+    void DeleteBatch(t_itr begin, t_itr end);
+    bool RangeQuery(t_int l, t_int r) const;
     bool RangeQuery(std::string_view input_l, std::string_view input_r) const;
     bool RangeQuery(const uint8_t *input_l, const uint32_t input_l_len,
                     const uint8_t *input_r, const uint32_t input_r_len) const;
-    bool PointQuery(uint64_t key) const;
+    template <class t_itr>
+    void RangeQueryBatch(t_itr begin, t_itr end, bool *out) const;
+    bool PointQuery(t_int key) const;
     bool PointQuery(std::string_view key) const;
     bool PointQuery(const uint8_t *key, const uint32_t key_len) const;
+    template <class t_itr>
+    void PointQuerySorted(t_itr begin, t_itr end, bool *out) const;
     void ShrinkInfixSize(const uint32_t new_infix_size);
-    uint32_t Size() const;
-    uint32_t Serialize(char *out) const;
-    void BulkLoadStreaming(uint64_t key);
+    uint64_t Size() const;
+    SlabAllocator::Stats AllocatorStats() const;
+    uint64_t Serialize(char *out) const;
+    uint64_t SerializeTo(const int fd) const;
+    uint64_t SerializeTo(std::ostream &out) const;
+    uint64_t SerializeTo(const std::function<void(const char *, size_t)> &write) const;
+    void BulkLoadStreaming(t_int key);
     void BulkLoadStreaming(std::string_view key);
     void BulkLoadStreaming(const uint8_t *key, const uint32_t key_len);
     void BulkLoadStreamingFinish();
 
+    // Packs the boundary keys and the infix stores into one read-only buffer
+    // that queries, Size and Serialize use until Thaw brings the tree back.
+    // Updates need a thawed filter, and no session may be open while freezing.
+    void Freeze();
+    void Thaw();
+    bool IsFrozen() const;
+
 private:
-    static constexpr uint32_t infix_store_target_size = 1024;
-    static_assert(infix_store_target_size % 64 == 0);
+    // Expected key count of a store, which sets the number of boundary keys in
+    // the tree, the implicit part of the infixes and how far inserts shift
+    static constexpr uint32_t infix_store_target_size = target_size;
+    static_assert(infix_store_target_size >= 128 && (infix_store_target_size & (infix_store_target_size - 1)) == 0);
     static constexpr uint32_t base_implicit_size = __builtin_ctz(infix_store_target_size);
+    static constexpr uint32_t rank_block_size = std::min<uint32_t>(DIVA_RANK_BLOCK_SIZE, infix_store_target_size / 2);
+    static_assert(rank_block_size % 64 == 0 && rank_block_size < infix_store_target_size
+                  && infix_store_target_size % rank_block_size == 0);
+    // The header holds one 16-bit prefix popcount per block boundary for the
+    // occupieds, followed by as many for the runends
+    static constexpr uint32_t rank_directory_size = infix_store_target_size / rank_block_size - 1;
+    static constexpr uint32_t header_word_count = (rank_directory_size + 1) / 2;
     static constexpr uint32_t scale_shift = 15;
     static constexpr uint32_t scale_implicit_shift = 15;
     static constexpr uint32_t size_scalar_count = 500;
     static constexpr uint32_t size_scalar_shrink_grow_sep = 55; // vs. 55 for load_factor_alt_=0.95
+    static constexpr uint32_t query_batch_group_size = 16;
+    static constexpr uint32_t sorted_query_max_skips = 8;
+    static constexpr uint32_t store_lock_count = 4096;
+    static_assert((store_lock_count & (store_lock_count - 1)) == 0);
+    static constexpr uint32_t reclaim_threshold = 256;
+    static constexpr uint32_t stream_buffer_size = 1 << 20;
+    static constexpr uint32_t frozen_block_size = 16;
+    // Stands in for the first key length of a serialized frozen Diva
+    static constexpr uint32_t frozen_marker = std::numeric_limits<uint32_t>::max() - 1;
+
+    // Integer keys are 4, 8 or 16 bytes wide, and each width has its own tree
+    // keeping the boundary keys inline
+    static_assert(std::is_same_v<t_int, uint32_t> || std::is_same_v<t_int, uint64_t>
+                  || std::is_same_v<t_int, unsigned __int128>);
+    static constexpr int32_t int_key_bits = 8 * sizeof(t_int);
+    template <class t_32, class t_64, class t_128>
+    using IntWidthType = std::conditional_t<sizeof(t_int) == 4, t_32, std::conditional_t<sizeof(t_int) == 8, t_64, t_128>>;
+    using IntTree = IntWidthType<wormhole_int32, wormhole_int, wormhole_int128>;
+    using IntTreeRef = IntWidthType<wormref_int32, wormref_int, wormref_int128>;
+    using IntTreeIter = IntWidthType<wormhole_int32_iter, wormhole_int_iter, wormhole_int128_iter>;
 
     struct InfiniteByteString {
         const uint8_t *str;
@@ -161,10 +251,11 @@ private:
         uint32_t status = 0;
         uint64_t *ptr = nullptr;
 
-        InfixStore(const uint32_t slot_count, const uint32_t slot_size, const uint32_t size_grade=size_scalar_shrink_grow_sep) {
+        InfixStore(SlabAllocator &allocator, const uint32_t slot_count, const uint32_t slot_size,
+                   const uint32_t size_grade=size_scalar_shrink_grow_sep) {
             SetSizeGrade(size_grade);
             const uint32_t word_count = GetPtrWordCount(slot_count, slot_size);
-            ptr = new uint64_t[word_count];
+            ptr = allocator.Allocate(word_count);
             memset(ptr, 0, sizeof(uint64_t) * word_count);
         }
         InfixStore(const char *deser_buf);
@@ -180,7 +271,7 @@ private:
         }
 
         static uint32_t GetPtrWordCount(const uint32_t slot_count, const uint32_t slot_size) {
-            return 1 + (Diva::infix_store_target_size + slot_count * (slot_size + 1) + 63) / 64;
+            return Diva::header_word_count + (Diva::infix_store_target_size + slot_count * (slot_size + 1) + 63) / 64;
         }
 
         uint32_t GetElemCount() const {
@@ -226,11 +317,102 @@ private:
         }
     };
 
+    // Boundary indexes other than the wormholes are reached through their own
+    // references and iterators
+    using Index = t_index<InfixStore>;
+    static constexpr bool wormhole_index = std::is_same_v<Index, WormholeIndex<InfixStore>>;
+    using TreeRef = std::conditional_t<!wormhole_index, Index, std::conditional_t<int_optimized, IntTreeRef, wormref>>;
+    using TreeIter = std::conditional_t<!wormhole_index, typename Index::Iter,
+                                        std::conditional_t<int_optimized, IntTreeIter, wormhole_iter>>;
+
+    struct BufferSink {
+        char *out;
+        uint64_t size = 0;
+
+        BufferSink(char *out): out(out) {};
+
+        void Write(const void *data, const size_t len) {
+            memcpy(out + size, data, len);
+            size += len;
+        }
+    };
+
+    // Stages writes so the callback sees large chunks
+    struct StreamSink {
+        const std::function<void(const char *, size_t)> &write;
+        std::vector<char> buf;
+        uint64_t size = 0;
+
+        StreamSink(const std::function<void(const char *, size_t)> &write): write(write) {
+            buf.reserve(stream_buffer_size);
+        }
+
+        void Write(const void *data, const size_t len) {
+            if (buf.size() + len > stream_buffer_size)
+                Flush();
+            if (len >= stream_buffer_size)
+                write(static_cast<const char *>(data), len);
+            else
+                buf.insert(buf.end(), static_cast<const char *>(data), static_cast<const char *>(data) + len);
+            size += len;
+        }
+
+        void Flush() {
+            if (!buf.empty())
+                write(buf.data(), buf.size());
+            buf.clear();
+        }
+    };
+
+    // Sources return views that stay valid until the next call to `Take`
+    struct BufferSource {
+        const char *buf;
+
+        BufferSource(const char *buf): buf(buf) {};
+
+        const char *Take(const size_t len) {
+            const char *res = buf;
+            buf += len;
+            return res;
+        }
+    };
+
+    // Unless `greedy` is set, never asks `read` for bytes past the end of
+    // the serialized Diva
+    struct StreamSource {
+        const std::function<size_t(char *, size_t)> &read;
+        const bool greedy;
+        std::vector<char> buf;
+        size_t begin = 0, end = 0;
+
+        StreamSource(const std::function<size_t(char *, size_t)> &read, const bool greedy):
+            read(read), greedy(greedy), buf(greedy ? stream_buffer_size : 0) {};
+
+        const char *Take(const size_t len) {
+            if (end - begin < len) {
+                memmove(buf.data(), buf.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+                if (buf.size() < len)
+                    buf.resize(len);
+                while (end < len) {
+                    const size_t read_len = read(buf.data() + end, (greedy ? buf.size() : len) - end);
+                    assert(read_len > 0 && "Truncated serialized Diva");
+                    end += read_len;
+                }
+            }
+            const char *res = buf.data() + begin;
+            begin += len;
+            return res;
+        }
+    };
+
     uint32_t infix_size_;
     wormhole *wh_;
     wormref *better_tree_;
-    wormhole_int *wh_int_;
-    wormref_int *better_tree_int_;
+    IntTree *wh_int_;
+    IntTreeRef *better_tree_int_;
+    Index *index_ = nullptr;
     std::mt19937 rng_;
     uint32_t rng_seed_;
     const float load_factor_ = 0.95;
@@ -240,23 +422,141 @@ private:
 
     uint32_t bulk_load_streaming_ind_, bulk_load_streaming_max_len_;
     InfiniteByteString bulk_load_left_key_, bulk_load_key_list_[infix_store_target_size];
+    // Bits of the left boundary key that are kept, zero if it is kept whole
+    uint32_t bulk_load_left_cut_ = 0;
+    bool shortest_separators_ = false;
+
+    // Concurrency state, only set up once the first session is opened
+    // Seqlock-style store versions, odd while a writer holds the store
+    struct alignas(64) StoreLock {
+        std::atomic<uint64_t> version;
+    };
+    StoreLock *store_locks_ = nullptr;
+    struct qsbr *qsbr_ = nullptr;
+    uint64_t reclaim_epoch_ = 0;
+    uint32_t session_count_ = 0;
+    std::mutex session_mutex_, retire_mutex_, reclaim_mutex_;
+    std::vector<std::pair<uint64_t *, uint32_t>> retired_ptrs_;
+    std::atomic<uint32_t> retired_count_ {0};
+
+    const char *mapped_buf_ = nullptr;
+    size_t mapped_size_ = 0;
+
+    // A frozen Diva keeps everything in one buffer of words: this header, the
+    // boundary keys front coded in blocks of `frozen_block_size`, the first
+    // eight bytes of the first key of each block, the offsets of each block in
+    // the keys and in the store words, the status of every infix store, and
+    // the words of the infix stores back to back at their smallest size grade
+    struct FrozenHeader {
+        uint64_t word_count;
+        uint64_t key_count;
+        uint64_t block_count;
+        uint64_t key_bytes;
+        uint64_t store_word_count;
+        uint64_t max_key_length;
+    };
+    const uint64_t *frozen_buf_ = nullptr;
+    uint64_t frozen_alloc_size_ = 0;    // zero when the buffer lies in a mapped file
+    FrozenHeader frozen_header_ {};
+    const uint8_t *frozen_keys_ = nullptr;
+    const uint64_t *frozen_heads_ = nullptr, *frozen_key_offsets_ = nullptr, *frozen_word_offsets_ = nullptr;
+    const uint32_t *frozen_statuses_ = nullptr;
+    uint64_t *frozen_words_ = nullptr;
+
+    // GetSlot and SetSlot touch whole words, which can run past the end of a store
+    mutable SlabAllocator allocator_ {1};
 
     void AddTreeKey(const uint8_t *key, const uint32_t key_len);
+    void LocateInfixStore(const InfiniteByteString key, InfiniteByteString &prev_key,
+                          InfiniteByteString &next_key, InfixStore *&infix_store_ptr) const;
     void InsertSimple(const InfiniteByteString key);
+    void InsertWithBoundaries(const InfiniteByteString key, const InfiniteByteString prev_key,
+                              const InfiniteByteString next_key, InfixStore &infix_store);
     void InsertSplit(const InfiniteByteString key);
+    bool InsertSplitInfixStore(const InfiniteByteString key, const InfiniteByteString prev_key,
+                               const InfiniteByteString next_key, const InfixStore &infix_store, TreeRef *ref);
+    bool DeleteWithBoundaries(const InfiniteByteString key, const InfiniteByteString prev_key,
+                              const InfiniteByteString next_key, InfixStore &infix_store);
     void DeleteMerge(void *const it_inp);
+    void DeleteMergeInfixStores(const InfiniteByteString left_key, const InfiniteByteString middle_key,
+                                const InfiniteByteString right_key, const InfixStore store_l,
+                                const InfixStore store_r, TreeRef *ref);
     template <class t_itr>
-    void BulkLoadFixedLength(t_itr begin, t_itr end, const uint32_t key_len);
+    void BulkLoadFixedLength(t_itr begin, t_itr end, const uint32_t key_len, const uint32_t thread_count);
     template <class t_itr>
-    void BulkLoad(t_itr begin, t_itr end);
+    void BulkLoad(t_itr begin, t_itr end, const uint32_t thread_count);
+    template <class t_itr, class t_key_fn>
+    uint32_t BulkLoadFullStores(t_itr begin, const uint64_t store_count, const uint32_t thread_count,
+                                t_key_fn get_key);
     void SetupScaleFactors();
+    template <class t_key>
+    static InfiniteByteString ToByteString(const t_key &key, t_int &int_buf);
+    static t_int LoadIntKey(const uint8_t *str);
+    static IntTree *CreateIntTree();
+    static wormhole *CreateStringTree();
+    void CreateTree();
+    void DestroyTree();
     std::tuple<uint32_t, uint32_t, uint32_t> 
         GetSharedIgnoreImplicitLengths(const InfiniteByteString key_1,
                                        const InfiniteByteString key_2) const;
+    uint32_t GetSeparatorLength(const InfiniteByteString prev_key, const InfiniteByteString key,
+                                const InfiniteByteString next_key, const uint32_t min_length=0) const;
+    static InfiniteByteString TruncateKey(const InfiniteByteString key, const uint32_t bit_len, uint8_t *buf);
+    static void SetPartialBoundary(InfixStore &store, const uint32_t bit_len);
     uint64_t ExtractPartialKey(const InfiniteByteString key,
                                const uint32_t shared, const uint32_t ignore,
                                const uint32_t implicit_size, const uint64_t msb) const;
-
+    bool RangeQueryLocate(const InfiniteByteString l_key, const InfiniteByteString r_key,
+                          InfiniteByteString &prev_key, InfiniteByteString &next_key,
+                          InfixStore *&infix_store_ptr) const;
+    bool RangeQueryWithBoundaries(const InfiniteByteString l_key, const InfiniteByteString r_key,
+                                  const InfiniteByteString prev_key, const InfiniteByteString next_key,
+                                  InfixStore &infix_store) const;
+    bool PointQueryWithBoundaries(const InfiniteByteString key, const InfiniteByteString prev_key,
+                                  const InfiniteByteString next_key, InfixStore &infix_store) const;
+
+    void SetFrozenViews(const uint64_t *buf);
+    void ReleaseFrozen();
+    InfiniteByteString GetFrozenBlockHead(const uint64_t block, const uint8_t *&pos) const;
+    static InfiniteByteString DecodeFrozenKey(const uint8_t *&pos, const InfiniteByteString prev_key, uint8_t *buf);
+    void FrozenSeekNear(const InfiniteByteString key, InfiniteByteString &prev_key, InfiniteByteString &next_key,
+                        InfixStore &infix_store, uint8_t *key_bufs) const;
+
+    TreeRef *GetTreeRef() const;
+    static void TreeIterInit(TreeIter &it, TreeRef *ref);
+    static void TreeIterSeek(TreeIter &it, const InfiniteByteString key);
+    static void TreeIterSeekNear(TreeIter &it, const InfiniteByteString key,
+                                 InfiniteByteString &prev_key, InfixStore *&prev_store_ptr,
+                                 InfiniteByteString &next_key, InfixStore *&next_store_ptr);
+    static void TreeIterPeek(TreeIter &it, InfiniteByteString &key, InfixStore *&infix_store_ptr);
+    static bool TreeIterValid(TreeIter &it);
+    static void TreeIterSkip1(TreeIter &it);
+    static void TreeIterSkip1Rev(TreeIter &it);
+    static void TreeIterUnlock(TreeIter &it);
+    static void TreePut(TreeRef *ref, const InfiniteByteString key, const InfixStore &infix_store);
+    static void TreeDel(TreeRef *ref, const InfiniteByteString key);
+    static void TreePark(TreeRef *ref);
+
+    void SetupConcurrency();
+    StoreLock *GetStoreLock(const InfiniteByteString key) const;
+    static bool TryLockStore(StoreLock *lock);
+    static void UnlockStore(StoreLock *lock);
+    static uint64_t ReadStoreVersion(const StoreLock *lock);
+    static bool ValidateStoreVersion(const StoreLock *lock, const uint64_t version);
+    uint32_t GetInfixStoreWordCount(const InfixStore &store) const;
+    void FreeInfixStorePtr(uint64_t *ptr, const uint32_t word_count);
+    void ReclaimInfixStorePtrs();
+    bool IsMappedPtr(const uint64_t *ptr) const;
+    void CopyMappedInfixStore(InfixStore &store) const;
+
+    Diva *SplitUpperHalf(std::string &split_key, uint64_t &moved_key_count);
+
+    static uint16_t *GetOccupiedsDirectory(const InfixStore &store);
+    static uint16_t *GetRunendsDirectory(const InfixStore &store);
+    static void UpdateRankDirectory(uint16_t *directory, const int32_t pos, const int32_t delta);
+    static void ShiftRankDirectoryRight(uint16_t *directory, const uint64_t *runends, const int32_t l, const int32_t r);
+    static void ShiftRankDirectoryLeft(uint16_t *directory, const uint64_t *runends, const int32_t l, const int32_t r);
+    void ComputeRankDirectory(const InfixStore &store, uint16_t *occupieds_directory, uint16_t *runends_directory) const;
     uint32_t RankOccupieds(const InfixStore &store, const uint32_t pos) const;
     uint32_t SelectRunends(const InfixStore &store, const uint32_t rank) const;
     int32_t NextOccupied(const InfixStore &store, const uint32_t pos) const;
@@ -265,25 +565,37 @@ private:
     int32_t PreviousRunend(const InfixStore &store, const uint32_t pos) const;
 
     int32_t GetMappedPos(const uint32_t implicit_part, const uint32_t size_grade, const uint64_t implicit_scalar) const;
+    void PrefetchInfixStore(const InfixStore &store, const uint32_t implicit_part, const uint64_t implicit_scalar) const;
+    template <uint32_t width=0>
     uint64_t GetSlot(const InfixStore &store, const uint32_t pos) const;
+    template <uint32_t width=0>
     void SetSlot(InfixStore &store, const uint32_t pos, const uint64_t value);
     void SetSlot(InfixStore &store, const uint32_t pos, const uint64_t value, const uint32_t width);
 
+    template <uint32_t width=0>
     void ShiftSlotsRight(const InfixStore &store, const uint32_t l, const uint32_t r, const uint32_t shamt);
+    template <uint32_t width=0>
     void ShiftSlotsLeft(const InfixStore &store, const uint32_t l, const uint32_t r, const uint32_t shamt);
     void ShiftRunendsRight(const InfixStore &store, const uint32_t l, const uint32_t r, const uint32_t shamt);
     void ShiftRunendsLeft(const InfixStore &store, const uint32_t l, const uint32_t r, const uint32_t shamt);
 
+    template <uint32_t width=0>
     int32_t FindEmptySlotAfter(const InfixStore &store, const uint32_t runend_pos) const;
+    template <uint32_t width=0>
     int32_t FindEmptySlotBefore(const InfixStore &store, const uint32_t runend_pos) const;
+    template <uint32_t width=0>
     void InsertRawIntoInfixStore(InfixStore &store, const uint64_t key,
                                  const uint32_t total_implicit=infix_store_target_size);
+    template <uint32_t width=0>
     void DeleteRawFromInfixStore(InfixStore &store, const uint64_t key,
                                  const uint32_t total_implicit=infix_store_target_size);
+    template <uint32_t width=0>
     uint32_t GetLongestMatchingInfixSize(const InfixStore &store, const uint64_t key,
                                          const uint32_t total_implicit=infix_store_target_size) const;
+    template <uint32_t width=0>
     bool RangeQueryInfixStore(InfixStore &store, const uint64_t l_key, const uint64_t r_key,
                               const uint32_t total_implicit=infix_store_target_size) const;
+    template <uint32_t width=0>
     bool PointQueryInfixStore(InfixStore &store, const uint64_t key,
                               const uint32_t total_implicit=infix_store_target_size) const;
     void ResizeInfixStore(InfixStore &store, const bool expand=true,
@@ -294,6 +606,8 @@ private:
     InfixStore AllocateInfixStoreWithList(const uint64_t *list, const uint32_t list_len,
                                           const uint32_t total_implicit=infix_store_target_size);
     uint32_t GetInfixList(const InfixStore &store, uint64_t *res) const;
+    template <uint32_t width>
+    uint32_t GetSlotWidth() const;
     std::tuple<uint32_t, bool> GetExpandedInfixListLength(const uint64_t *list, const uint32_t list_len,
                                                           const uint32_t implicit_size, const uint32_t shamt,
                                                           const uint64_t lower_lim, const uint64_t upper_lim);
@@ -305,15 +619,70 @@ private:
                                const InfiniteByteString left_key, const InfiniteByteString right_key,
                                uint64_t *infix_list, const uint32_t infix_list_len);
 
+    static constexpr uint32_t SerializedMetadataSize();
+    template <class t_sink>
+    void SerializeToSink(t_sink &sink) const;
     uint32_t SerializeMetadata(char *out) const;
-    uint32_t SerializeInfixStore(char *out, const InfixStore& store) const;
-    uint32_t DeserializeMetadata(char *deser_buf);
-    uint32_t DeserializeInfixStore(char *deser_buf, InfixStore& store) const;
+    template <class t_sink>
+    void SerializeInfixStore(t_sink &sink, const InfixStore& store) const;
+    template <class t_source>
+    void Deserialize(t_source &source, const bool in_place);
+    uint32_t DeserializeMetadata(const char *deser_buf);
+    template <class t_source>
+    void DeserializeInfixStore(t_source &source, InfixStore& store, const bool in_place) const;
+    template <class t_source>
+    void DeserializeFrozen(t_source &source, const bool in_place);
 };
 
 
-template <bool int_optimized>
-inline Diva<int_optimized>::Diva(const uint32_t infix_size, const uint32_t rng_seed, const float load_factor):
+// Per-thread handle for using a Diva instance concurrently. Each thread opens
+// its own session and issues all of its operations through it; the plain Diva
+// methods remain single-threaded. Sessions must be closed before the Diva
+// instance is destroyed, and are only available under ThreadPolicy::Concurrent.
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+class Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session {
+public:
+    Session(Diva &diva);
+    Session(const Session &other) = delete;
+    Session &operator=(const Session &other) = delete;
+    ~Session();
+
+    void Insert(t_int key);
+    void Insert(std::string_view key);
+    void Insert(const uint8_t *key, const uint32_t key_len);
+    void Delete(t_int key);
+    void Delete(std::string_view input_key);
+    void Delete(const uint8_t *input_key, const uint32_t input_key_len);
+    bool RangeQuery(t_int l, t_int r);
+    bool RangeQuery(std::string_view input_l, std::string_view input_r);
+    bool RangeQuery(const uint8_t *input_l, const uint32_t input_l_len,
+                    const uint8_t *input_r, const uint32_t input_r_len);
+    bool PointQuery(t_int key);
+    bool PointQuery(std::string_view key);
+    bool PointQuery(const uint8_t *key, const uint32_t key_len);
+
+private:
+    Diva &diva_;
+    TreeRef *ref_;
+    struct qsbr_ref qref_;
+    std::mt19937 rng_;
+    std::string left_key_buf_, prev_key_buf_, next_key_buf_;
+
+    void Enter();
+    void Exit();
+    void Backoff();
+    static InfiniteByteString CopyKey(const InfiniteByteString key, std::string &buf);
+    static bool TryLockInfixStore(StoreLock *lock, const bool write, uint64_t &version);
+    bool LockInfixStore(TreeIter &it, const InfiniteByteString key, const bool write,
+                        InfiniteByteString &prev_key, InfiniteByteString &next_key,
+                        InfixStore *&infix_store_ptr, StoreLock *&lock, uint64_t &version);
+    bool MergeInfixStores(TreeIter &it, StoreLock *middle_lock);
+};
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Diva(const uint32_t infix_size, const uint32_t rng_seed, const float load_factor,
+                                                                   const bool shortest_separators):
             wh_(nullptr),
             better_tree_(nullptr),
             wh_int_(nullptr),
@@ -321,24 +690,18 @@ inline Diva<int_optimized>::Diva(const uint32_t infix_size, const uint32_t rng_s
             infix_size_(infix_size),
             rng_seed_(rng_seed),
             load_factor_(load_factor),
-            bulk_load_streaming_ind_(0) {
-    if constexpr (int_optimized) {
-        wh_int_ = wh_int_create();
-        better_tree_int_ = wh_int_ref(wh_int_);
-    }
-    else {
-        wh_ = wh_create();
-        better_tree_ = wh_ref(wh_);
-    }
+            bulk_load_streaming_ind_(0),
+            shortest_separators_(shortest_separators && !int_optimized) {
+    CreateTree();
     rng_.seed(rng_seed_);
     SetupScaleFactors();
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 template <class t_itr>
-Diva<int_optimized>::Diva(const uint32_t infix_size, const t_itr begin, const t_itr end, const uint32_t key_len,
-                          const uint32_t rng_seed, const float load_factor):
+Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Diva(const uint32_t infix_size, const t_itr begin, const t_itr end, const uint32_t key_len,
+                          const uint32_t rng_seed, const float load_factor, const uint32_t thread_count):
         wh_(nullptr),
         better_tree_(nullptr),
         wh_int_(nullptr),
@@ -347,14 +710,7 @@ Diva<int_optimized>::Diva(const uint32_t infix_size, const t_itr begin, const t_
         rng_seed_(rng_seed),
         load_factor_(load_factor),
         bulk_load_streaming_ind_(0) {
-    if constexpr (int_optimized) {
-        wh_int_ = wh_int_create();
-        better_tree_int_ = wh_int_ref(wh_int_);
-    }
-    else {
-        wh_ = wh_create();
-        better_tree_ = wh_ref(wh_);
-    }
+    CreateTree();
 
     rng_.seed(rng_seed_);
     SetupScaleFactors();
@@ -365,14 +721,15 @@ Diva<int_optimized>::Diva(const uint32_t infix_size, const t_itr begin, const t_
     memset(key, 0xFF, key_len);
     AddTreeKey(key, key_len);
 
-    BulkLoadFixedLength(begin, end, key_len);
+    BulkLoadFixedLength(begin, end, key_len, thread_count);
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 template <class t_itr>
-Diva<int_optimized>::Diva(const uint32_t infix_size, const t_itr begin, const t_itr end, 
-                          const uint32_t rng_seed, const float load_factor):
+Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Diva(const uint32_t infix_size, const t_itr begin, const t_itr end, 
+                          const uint32_t rng_seed, const float load_factor, const uint32_t thread_count,
+                          const bool shortest_separators):
         wh_(nullptr),
         better_tree_(nullptr),
         wh_int_(nullptr),
@@ -380,15 +737,9 @@ Diva<int_optimized>::Diva(const uint32_t infix_size, const t_itr begin, const t_
         infix_size_(infix_size),
         rng_seed_(rng_seed),
         load_factor_(load_factor),
-        bulk_load_streaming_ind_(0) {
-    if constexpr (int_optimized) {
-        wh_int_ = wh_int_create();
-        better_tree_int_ = wh_int_ref(wh_int_);
-    }
-    else {
-        wh_ = wh_create();
-        better_tree_ = wh_ref(wh_);
-    }
+        bulk_load_streaming_ind_(0),
+        shortest_separators_(shortest_separators && !int_optimized) {
+    CreateTree();
 
     rng_.seed(rng_seed_);
     SetupScaleFactors();
@@ -397,13 +748,13 @@ Diva<int_optimized>::Diva(const uint32_t infix_size, const t_itr begin, const t_
     memset(key, 0x00, 8);
     AddTreeKey(key, 8);
 
-    BulkLoad(begin, end);
+    BulkLoad(begin, end, thread_count);
 }
 
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::SetupScaleFactors() {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SetupScaleFactors() {
     double pw = 1.0;
     for (int32_t i = size_scalar_shrink_grow_sep - 1; i >= 0; i--) {
         size_scalars_[i] = static_cast<uint64_t>(pw * (1ULL << scale_shift));
@@ -426,21 +777,118 @@ inline void Diva<int_optimized>::SetupScaleFactors() {
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::Insert(uint64_t key) {
-    key = __builtin_bswap64(key);
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_key>
+__attribute__((always_inline))
+inline typename Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InfiniteByteString Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ToByteString(const t_key &key,
+                                                                                                            t_int &int_buf) {
+    // Integer keys are compared in big-endian byte order, as in the t_int overloads
+    if constexpr (std::is_integral_v<t_key>) {
+        int_buf = to_big_endian_order(static_cast<t_int>(key));
+        return {reinterpret_cast<const uint8_t *>(&int_buf), sizeof(int_buf)};
+    }
+    else
+        return {reinterpret_cast<const uint8_t *>(std::data(key)), static_cast<uint32_t>(std::size(key))};
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline t_int Diva<int_optimized, target_size, t_int, thread_policy, t_index>::LoadIntKey(const uint8_t *str) {
+    // Boundary keys in the integer trees are zero-padded to the full width,
+    // but are not necessarily aligned to it
+    t_int res;
+    memcpy(&res, str, sizeof(res));
+    return to_big_endian_order(res);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline typename Diva<int_optimized, target_size, t_int, thread_policy, t_index>::IntTree *Diva<int_optimized, target_size, t_int, thread_policy, t_index>::CreateIntTree() {
+    // A tree only ever updated through the unsafe API keeps a single copy of
+    // its meta hash table
+    if constexpr (thread_policy == ThreadPolicy::Single) {
+        if constexpr (sizeof(t_int) == 4)
+            return whunsafe_int32_create(&kvmap_mm_ndf);
+        else if constexpr (sizeof(t_int) == 8)
+            return whunsafe_int_create(&kvmap_mm_ndf);
+        else
+            return whunsafe_int128_create(&kvmap_mm_ndf);
+    }
+    else if constexpr (sizeof(t_int) == 4)
+        return wh_int32_create();
+    else if constexpr (sizeof(t_int) == 8)
+        return wh_int_create();
+    else
+        return wh_int128_create();
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline wormhole *Diva<int_optimized, target_size, t_int, thread_policy, t_index>::CreateStringTree() {
+    if constexpr (thread_policy == ThreadPolicy::Single)
+        return whunsafe_create(&kvmap_mm_ndf);
+    else
+        return wh_create();
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::CreateTree() {
+    if constexpr (!wormhole_index)
+        index_ = new Index();
+    else if constexpr (int_optimized) {
+        wh_int_ = CreateIntTree();
+        better_tree_int_ = wh_int_ref(wh_int_);
+    }
+    else {
+        wh_ = CreateStringTree();
+        better_tree_ = wh_ref(wh_);
+    }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DestroyTree() {
+    if constexpr (!wormhole_index) {
+        delete index_;
+        index_ = nullptr;
+    }
+    else if constexpr (int_optimized) {
+        if (wh_int_ != nullptr) {
+            wh_int_unref(better_tree_int_);
+            wh_int_destroy(wh_int_);
+        }
+        wh_int_ = nullptr;
+        better_tree_int_ = nullptr;
+    }
+    else {
+        if (wh_ != nullptr) {
+            wh_unref(better_tree_);
+            wh_destroy(wh_);
+        }
+        wh_ = nullptr;
+        better_tree_ = nullptr;
+    }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Insert(t_int key) {
+    key = to_big_endian_order(key);
     Insert(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::Insert(std::string_view key) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Insert(std::string_view key) {
     Insert(reinterpret_cast<const uint8_t *>(key.data()), key.size());
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::Insert(const uint8_t *key, const uint32_t key_len) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Insert(const uint8_t *key, const uint32_t key_len) {
+    assert(!IsFrozen() && "Thaw a frozen Diva before updating it");
     const InfiniteByteString converted_key {key, static_cast<uint32_t>(key_len)};
     if (rng_() % infix_store_target_size == 0)
         InsertSplit(converted_key);
@@ -448,70 +896,118 @@ inline void Diva<int_optimized>::Insert(const uint8_t *key, const uint32_t key_l
         InsertSimple(converted_key);
 }
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::InsertSimple(const InfiniteByteString key) {
-    InfixStore *infix_store_ptr, *dummy_infix_store_ptr;
-    uint32_t dummy_val;
-
-    InfiniteByteString next_key {};
-    InfiniteByteString prev_key {};
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_itr>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InsertBatch(const t_itr begin, const t_itr end) {
+    assert(!IsFrozen() && "Thaw a frozen Diva before updating it");
+    t_int int_buf;
+    auto get_key = [&int_buf](const t_itr key_it) {
+        return ToByteString(*key_it, int_buf);
+    };
 
-    if constexpr (int_optimized) {
-        wormhole_int_iter it_int;
-        it_int.ref = better_tree_int_;
-        it_int.map = better_tree_int_->map;
-        it_int.leaf = nullptr;
-        it_int.is = 0;
-        wh_int_iter_seek(&it_int, key.str, key.length);
-
-        wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                      reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key == key) {
-            prev_key = next_key;
-            wh_int_iter_skip1(&it_int);
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                          reinterpret_cast<void **>(&dummy_infix_store_ptr), &dummy_val);
-        }
-        else {
-            wh_int_iter_skip1_rev(&it_int);
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
-                                          reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        }
-        if (it_int.leaf)
-            wormleaf_int_unlock_read(it_int.leaf);
+    // Keys sampled as new boundary keys go in first, so that the rest of the
+    // batch lands directly on the final infix stores
+    const uint32_t key_count = std::distance(begin, end);
+    bool is_split[key_count];
+    uint32_t ind = 0;
+    for (t_itr key_it = begin; key_it != end; ++key_it, ind++) {
+        is_split[ind] = rng_() % infix_store_target_size == 0;
+        if (is_split[ind])
+            InsertSplit(get_key(key_it));
     }
-    else {
-        wormhole_iter it;
-        it.ref = better_tree_;
-        it.map = better_tree_->map;
-        it.leaf = nullptr;
-        it.is = 0;
-        wh_iter_seek(&it, key.str, key.length);
 
-        wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                              reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key == key) {
-            prev_key = next_key;
-            wh_iter_skip1(&it);
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                  reinterpret_cast<void **>(&dummy_infix_store_ptr), &dummy_val);
+    // Every touched infix store is then rebuilt once with all of its new infixes
+    auto comp = [](const uint64_t a, const uint64_t b) {
+        return a - (a & -a) < b - (b & -b);
+    };
+    t_itr key_it = begin;
+    ind = 0;
+    while (key_it != end) {
+        if (is_split[ind]) {
+            ++key_it;
+            ind++;
+            continue;
         }
-        else {
-            wh_iter_skip1_rev(&it);
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
-                                  reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
+
+        InfixStore *infix_store_ptr;
+        InfiniteByteString next_key {};
+        InfiniteByteString prev_key {};
+        LocateInfixStore(get_key(key_it), prev_key, next_key, infix_store_ptr);
+        InfixStore& infix_store = *infix_store_ptr;
+
+        uint32_t group_len = 0, group_end = ind;
+        for (t_itr group_it = key_it; group_it != end && get_key(group_it) < next_key; ++group_it, group_end++)
+            group_len += !is_split[group_end];
+
+        auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(prev_key, next_key);
+        const uint64_t next_implicit = ExtractPartialKey(next_key, shared, ignore, implicit_size, 1) >> infix_size_;
+        const uint64_t prev_implicit = ExtractPartialKey(prev_key, shared, ignore, implicit_size, 0) >> infix_size_;
+        const uint32_t total_implicit = next_implicit - prev_implicit + 1;
+
+        uint64_t new_infix_list[group_len];
+        uint32_t new_infix_count = 0;
+        for (; ind < group_end; ++key_it, ind++) {
+            if (is_split[ind])
+                continue;
+            const InfiniteByteString key = get_key(key_it);
+#ifdef DEBUG
+            assert(prev_key <= key);
+            assert(key < next_key);
+#endif
+            const uint64_t extraction = ExtractPartialKey(key, shared, ignore, implicit_size, key.GetBit(shared));
+            new_infix_list[new_infix_count++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
         }
-        if (it.leaf)
-            wormleaf_unlock_read(it.leaf);
+
+        const uint32_t old_infix_count = infix_store.ptr ? infix_store.GetElemCount() : 0;
+        uint64_t old_infix_list[old_infix_count + 1];
+        if (old_infix_count)
+            GetInfixList(infix_store, old_infix_list);
+        uint64_t infix_list[old_infix_count + new_infix_count];
+        std::merge(old_infix_list, old_infix_list + old_infix_count,
+                   new_infix_list, new_infix_list + new_infix_count, infix_list, comp);
+
+        InfixStore new_store = AllocateInfixStoreWithList(infix_list, old_infix_count + new_infix_count,
+                                                          total_implicit);
+        new_store.SetInvalidBits(infix_store.GetInvalidBits());
+        new_store.SetPartialKey(infix_store.IsPartialKey());
+        FreeInfixStorePtr(infix_store.ptr, GetInfixStoreWordCount(infix_store));
+        infix_store = new_store;
     }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::LocateInfixStore(const InfiniteByteString key, InfiniteByteString &prev_key,
+                                                                                      InfiniteByteString &next_key, InfixStore *&infix_store_ptr) const {
+    InfixStore *dummy_infix_store_ptr;
+
+    TreeIter it;
+    TreeIterInit(it, GetTreeRef());
+    TreeIterSeekNear(it, key, prev_key, infix_store_ptr, next_key, dummy_infix_store_ptr);
+    TreeIterUnlock(it);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InsertSimple(const InfiniteByteString key) {
+    InfixStore *infix_store_ptr;
+    InfiniteByteString next_key {};
+    InfiniteByteString prev_key {};
+    LocateInfixStore(key, prev_key, next_key, infix_store_ptr);
 
 #ifdef DEBUG
     assert(prev_key <= key);
     assert(key < next_key);
 #endif
 
-    InfixStore& infix_store = *infix_store_ptr;
+    InsertWithBoundaries(key, prev_key, next_key, *infix_store_ptr);
+}
+
 
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InsertWithBoundaries(const InfiniteByteString key, const InfiniteByteString prev_key,
+                                                                                                  const InfiniteByteString next_key, InfixStore &infix_store) {
     auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(prev_key, next_key);
 
     const uint64_t extraction = ExtractPartialKey(key, shared, ignore, implicit_size, key.GetBit(shared));
@@ -523,76 +1019,116 @@ inline void Diva<int_optimized>::InsertSimple(const InfiniteByteString key) {
 }
 
 
-template <bool int_optimized>
-inline bool Diva<int_optimized>::RangeQuery(uint64_t l, uint64_t r) const {
-    l = __builtin_bswap64(l);
-    r = __builtin_bswap64(r);
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::RangeQuery(t_int l, t_int r) const {
+    l = to_big_endian_order(l);
+    r = to_big_endian_order(r);
     return RangeQuery(reinterpret_cast<const uint8_t *>(&l), sizeof(l),
                       reinterpret_cast<const uint8_t *>(&r), sizeof(r));
 }
 
 
-template <bool int_optimized>
-inline bool Diva<int_optimized>::RangeQuery(std::string_view input_l, std::string_view input_r) const {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::RangeQuery(std::string_view input_l, std::string_view input_r) const {
     return RangeQuery(reinterpret_cast<const uint8_t *>(input_l.data()), input_l.size(),
                       reinterpret_cast<const uint8_t *>(input_r.data()), input_r.size());
 }
 
 
-template <bool int_optimized>
-inline bool Diva<int_optimized>::RangeQuery(const uint8_t *input_l, const uint32_t input_l_len,
-                                            const uint8_t *input_r, const uint32_t input_r_len) const {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::RangeQuery(const uint8_t *input_l, const uint32_t input_l_len,
+                                                                                        const uint8_t *input_r, const uint32_t input_r_len) const {
     const InfiniteByteString l_key {input_l, static_cast<uint32_t>(input_l_len)};
     const InfiniteByteString r_key {input_r, static_cast<uint32_t>(input_r_len)};
 
     InfixStore *infix_store_ptr;
-    uint32_t dummy_val;
     InfiniteByteString next_key {};
     InfiniteByteString prev_key {};
+    if (IsFrozen()) {
+        uint8_t key_bufs[2 * frozen_header_.max_key_length];
+        InfixStore infix_store;
+        FrozenSeekNear(l_key, prev_key, next_key, infix_store, key_bufs);
+        return prev_key == l_key || next_key <= r_key
+            || RangeQueryWithBoundaries(l_key, r_key, prev_key, next_key, infix_store);
+    }
+    if (RangeQueryLocate(l_key, r_key, prev_key, next_key, infix_store_ptr))
+        return true;
+    return RangeQueryWithBoundaries(l_key, r_key, prev_key, next_key, *infix_store_ptr);
+}
 
-    if constexpr (int_optimized) {
-        wormhole_int_iter it_int;
-        it_int.ref = better_tree_int_;
-        it_int.map = better_tree_int_->map;
-        it_int.leaf = nullptr;
-        it_int.is = 0;
-        wh_int_iter_seek(&it_int, l_key.str, l_key.length);
-
-        wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                      reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key <= r_key) {
-            if (it_int.leaf)
-                wormleaf_int_unlock_read(it_int.leaf);
-            return true;
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_itr>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::RangeQueryBatch(t_itr begin, t_itr end, bool *out) const {
+    // Queries are processed in groups: first all tree lookups of a group are
+    // done while prefetching the infix stores they land on, then the infix
+    // stores are probed, by which point their bitmaps should be in cache.
+    t_int int_buf[2 * query_batch_group_size];
+    InfiniteByteString l_keys[query_batch_group_size], r_keys[query_batch_group_size];
+    InfiniteByteString prev_keys[query_batch_group_size], next_keys[query_batch_group_size];
+    InfixStore *infix_store_ptrs[query_batch_group_size];
+    bool resolved[query_batch_group_size];
+    // Frozen boundary keys are decoded into per-query buffers
+    const uint32_t key_bufs_len = 2 * frozen_header_.max_key_length;
+    uint8_t key_bufs[query_batch_group_size * key_bufs_len + 1];
+    InfixStore frozen_stores[query_batch_group_size];
+
+    while (begin != end) {
+        uint32_t group_len = 0;
+        for (; group_len < query_batch_group_size && begin != end; group_len++, ++begin) {
+            const auto& [l, r] = *begin;
+            l_keys[group_len] = ToByteString(l, int_buf[2 * group_len]);
+            r_keys[group_len] = ToByteString(r, int_buf[2 * group_len + 1]);
         }
-        wh_int_iter_skip1_rev(&it_int);
-        wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
-                                      reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (it_int.leaf)
-            wormleaf_int_unlock_read(it_int.leaf);
-    }
-    else {
-        wormhole_iter it;
-        it.ref = better_tree_;
-        it.map = better_tree_->map;
-        it.leaf = nullptr;
-        it.is = 0;
-        wh_iter_seek(&it, l_key.str, l_key.length);
-        wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                              reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key <= r_key) {
-            if (it.leaf)
-                wormleaf_unlock_read(it.leaf);
-            return true;
+
+        for (uint32_t i = 0; i < group_len; i++) {
+            if (IsFrozen()) {
+                FrozenSeekNear(l_keys[i], prev_keys[i], next_keys[i], frozen_stores[i], key_bufs + i * key_bufs_len);
+                infix_store_ptrs[i] = &frozen_stores[i];
+                resolved[i] = prev_keys[i] == l_keys[i] || next_keys[i] <= r_keys[i];
+            }
+            else
+                resolved[i] = RangeQueryLocate(l_keys[i], r_keys[i], prev_keys[i], next_keys[i], infix_store_ptrs[i]);
+            if (!resolved[i])
+                __builtin_prefetch(infix_store_ptrs[i]);
         }
-        wh_iter_skip1_rev(&it);
-        wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
-                              reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (it.leaf)
-            wormleaf_unlock_read(it.leaf);
+        for (uint32_t i = 0; i < group_len; i++) {
+            if (resolved[i] || infix_store_ptrs[i]->ptr == nullptr)
+                continue;
+            // Popcount checkpoints and the occupieds bitmap span the first
+            // three cache lines of the store
+            const char *store_words = reinterpret_cast<const char *>(infix_store_ptrs[i]->ptr);
+            __builtin_prefetch(store_words);
+            __builtin_prefetch(store_words + 64);
+            __builtin_prefetch(store_words + 128);
+        }
+        for (uint32_t i = 0; i < group_len; i++)
+            out[i] = resolved[i] || RangeQueryWithBoundaries(l_keys[i], r_keys[i], prev_keys[i], next_keys[i],
+                                                             *infix_store_ptrs[i]);
+        out += group_len;
     }
-    
-    InfixStore& infix_store = *infix_store_ptr;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::RangeQueryLocate(const InfiniteByteString l_key, const InfiniteByteString r_key,
+                                                                                              InfiniteByteString &prev_key, InfiniteByteString &next_key,
+                                                                                              InfixStore *&infix_store_ptr) const {
+    InfixStore *dummy_infix_store_ptr;
+
+    TreeIter it;
+    TreeIterInit(it, GetTreeRef());
+    TreeIterSeekNear(it, l_key, prev_key, infix_store_ptr, next_key, dummy_infix_store_ptr);
+    TreeIterUnlock(it);
+    return prev_key == l_key || next_key <= r_key;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::RangeQueryWithBoundaries(const InfiniteByteString l_key, const InfiniteByteString r_key,
+                                                                                                      const InfiniteByteString prev_key,
+                                                                                                      const InfiniteByteString next_key,
+                                                                                                      InfixStore &infix_store) const {
     if (infix_store.ptr == nullptr)
         return false;
 
@@ -604,19 +1140,19 @@ inline bool Diva<int_optimized>::RangeQuery(const uint8_t *input_l, const uint32
     auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(prev_key, next_key);
 
     if constexpr (int_optimized) {
-        const uint64_t l_key_int = __builtin_bswap64(*((uint64_t *) l_key.str));
-        const uint64_t r_key_int = __builtin_bswap64(*((uint64_t *) r_key.str));
-        const uint64_t prev_key_int = __builtin_bswap64(*((uint64_t *) prev_key.str));
-        const uint64_t next_key_int = __builtin_bswap64(*((uint64_t *) next_key.str));
+        const t_int l_key_int = LoadIntKey(l_key.str);
+        const t_int r_key_int = LoadIntKey(r_key.str);
+        const t_int prev_key_int = LoadIntKey(prev_key.str);
+        const t_int next_key_int = LoadIntKey(next_key.str);
 
-        const uint32_t shamt_left = std::max<int>(0, shared + ignore + implicit_size + infix_size_ - 64);
-        const uint32_t shamt_right = std::max<int>(0, 64 - shared - ignore - implicit_size - infix_size_);
-        const uint32_t shamt_left_impl = std::max<int>(0, shared + ignore + implicit_size - 64);
-        const uint32_t shamt_right_impl = std::max<int>(0, 64 - shared - ignore - implicit_size);
+        const uint32_t shamt_left = std::max<int>(0, shared + ignore + implicit_size + infix_size_ - int_key_bits);
+        const uint32_t shamt_right = std::max<int>(0, int_key_bits - shared - ignore - implicit_size - infix_size_);
+        const uint32_t shamt_left_impl = std::max<int>(0, shared + ignore + implicit_size - int_key_bits);
+        const uint32_t shamt_right_impl = std::max<int>(0, int_key_bits - shared - ignore - implicit_size);
 
-        const uint64_t l_extraction = (((l_key_int >> (63 - shared)) & 1) << (implicit_size - 1 + infix_size_)) 
+        const uint64_t l_extraction = (static_cast<uint64_t>((l_key_int >> (int_key_bits - 1 - shared)) & 1) << (implicit_size - 1 + infix_size_)) 
                                     | (((l_key_int << shamt_left) >> shamt_right) & BITMASK(implicit_size - 1 + infix_size_));
-        const uint64_t r_extraction = (((r_key_int >> (63 - shared)) & 1) << (implicit_size - 1 + infix_size_)) 
+        const uint64_t r_extraction = (static_cast<uint64_t>((r_key_int >> (int_key_bits - 1 - shared)) & 1) << (implicit_size - 1 + infix_size_)) 
                                     | (((r_key_int << shamt_left) >> shamt_right) & BITMASK(implicit_size - 1 + infix_size_));
 
         const uint64_t prev_implicit = ((prev_key_int << shamt_left_impl) >> shamt_right_impl) & BITMASK(implicit_size - 1);
@@ -640,79 +1176,56 @@ inline bool Diva<int_optimized>::RangeQuery(const uint8_t *input_l, const uint32
 }
 
 
-template <bool int_optimized>
-inline bool Diva<int_optimized>::PointQuery(uint64_t key) const {
-    key = __builtin_bswap64(key);
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::PointQuery(t_int key) const {
+    key = to_big_endian_order(key);
     return PointQuery(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
 }
 
 
-template <bool int_optimized>
-inline bool Diva<int_optimized>::PointQuery(std::string_view key) const {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::PointQuery(std::string_view key) const {
     return PointQuery(reinterpret_cast<const uint8_t *>(key.data()), key.size());
 }
 
 
-template <bool int_optimized>
-inline bool Diva<int_optimized>::PointQuery(const uint8_t *input_key, const uint32_t key_len) const {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::PointQuery(const uint8_t *input_key, const uint32_t key_len) const {
     const InfiniteByteString key {input_key, static_cast<uint32_t>(key_len)};
     
-    InfixStore *infix_store_ptr;
-    uint32_t dummy_val;
+    InfixStore *infix_store_ptr, *dummy_infix_store_ptr;
 
     InfiniteByteString next_key {};
     InfiniteByteString prev_key {};
 
-    if constexpr (int_optimized) {
-        wormhole_int_iter it_int;
-        it_int.ref = better_tree_int_;
-        it_int.map = better_tree_int_->map;
-        it_int.leaf = nullptr;
-        it_int.is = 0;
-        wh_int_iter_seek(&it_int, input_key, key_len);
-
-        wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                      reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key == key) {
-            if (it_int.leaf)
-                wormleaf_int_unlock_read(it_int.leaf);
-            return true;
-        }
-        wh_int_iter_skip1_rev(&it_int);
-        wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
-                                      reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (it_int.leaf)
-            wormleaf_int_unlock_read(it_int.leaf);
+    if (IsFrozen()) {
+        uint8_t key_bufs[2 * frozen_header_.max_key_length];
+        InfixStore infix_store;
+        FrozenSeekNear(key, prev_key, next_key, infix_store, key_bufs);
+        return prev_key == key || PointQueryWithBoundaries(key, prev_key, next_key, infix_store);
     }
-    else {
-        wormhole_iter it;
-        it.ref = better_tree_;
-        it.map = better_tree_->map;
-        it.leaf = nullptr;
-        it.is = 0;
-        wh_iter_seek(&it, input_key, key_len);
 
-        wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                              reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key == key) {
-            if (it.leaf)
-                wormleaf_unlock_read(it.leaf);
-            return true;
-        }
-        wh_iter_skip1_rev(&it);
-        wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
-                              reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (it.leaf)
-            wormleaf_unlock_read(it.leaf);
-    }
+    TreeIter it;
+    TreeIterInit(it, GetTreeRef());
+    TreeIterSeekNear(it, key, prev_key, infix_store_ptr, next_key, dummy_infix_store_ptr);
+    TreeIterUnlock(it);
+    if (prev_key == key)
+        return true;
     
 #ifdef DEBUG
     assert(prev_key <= key);
     assert(key < next_key);
 #endif
 
-    InfixStore& infix_store = *infix_store_ptr;
+    return PointQueryWithBoundaries(key, prev_key, next_key, *infix_store_ptr);
+}
+
 
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::PointQueryWithBoundaries(const InfiniteByteString key, const InfiniteByteString prev_key,
+                                                                                                      const InfiniteByteString next_key,
+                                                                                                      InfixStore &infix_store) const {
     if (infix_store.IsPartialKey() && prev_key.IsPrefixOf(key, infix_store.GetInvalidBits())) {
         // Previous key was a partial key and a prefix of the query key
         return true;
@@ -728,85 +1241,690 @@ inline bool Diva<int_optimized>::PointQuery(const uint8_t *input_key, const uint
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::AddTreeKey(const uint8_t *key, const uint32_t key_len) {
-    InfixStore infix_store(scaled_sizes_[size_scalar_shrink_grow_sep], infix_size_);
-    if constexpr (int_optimized)
-        wh_int_put(better_tree_int_, key, key_len, &infix_store, sizeof(infix_store));
-    else
-        wh_put(better_tree_, key, key_len, &infix_store, sizeof(infix_store));
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_itr>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::PointQuerySorted(t_itr begin, t_itr end, bool *out) const {
+    // A single iterator walks the boundary keys alongside the sorted queries,
+    // parked on the successor boundary key of the current infix store. Keys
+    // landing in the same store reuse its shared/ignore/implicit decomposition.
+    t_int int_buf;
+    InfiniteByteString prev_key {}, next_key {};
+    InfixStore *infix_store_ptr = nullptr, *next_infix_store_ptr = nullptr;
+    bool has_next = false;
+    uint32_t shared = 0, ignore = 0, implicit_size = 0, total_implicit = 0;
+    uint64_t prev_implicit = 0;
+
+    if (IsFrozen()) {
+        // Frozen boundary keys are only searched again once a query passes
+        // the successor of the current store
+        uint8_t key_bufs[2 * frozen_header_.max_key_length];
+        InfixStore infix_store;
+        for (; begin != end; ++begin, ++out) {
+            const InfiniteByteString key = ToByteString(*begin, int_buf);
+            if (infix_store.ptr == nullptr || !(key < next_key)) {
+                FrozenSeekNear(key, prev_key, next_key, infix_store, key_bufs);
+                if (next_key.str != nullptr) {
+                    std::tie(shared, ignore, implicit_size) = GetSharedIgnoreImplicitLengths(prev_key, next_key);
+                    prev_implicit = ExtractPartialKey(prev_key, shared, ignore, implicit_size, 0) >> infix_size_;
+                    const uint64_t next_implicit = ExtractPartialKey(next_key, shared, ignore, implicit_size, 1) >> infix_size_;
+                    total_implicit = next_implicit - prev_implicit + 1;
+                }
+            }
+            if (prev_key == key || (infix_store.IsPartialKey() && prev_key.IsPrefixOf(key, infix_store.GetInvalidBits()))) {
+                *out = true;
+                continue;
+            }
+            const uint64_t extraction = ExtractPartialKey(key, shared, ignore, implicit_size, key.GetBit(shared));
+            *out = PointQueryInfixStore(infix_store, extraction - (prev_implicit << infix_size_), total_implicit);
+        }
+        return;
+    }
+
+    TreeIter it;
+    TreeIterInit(it, GetTreeRef());
+
+    for (; begin != end; ++begin, ++out) {
+        const InfiniteByteString key = ToByteString(*begin, int_buf);
+
+        if (infix_store_ptr == nullptr || !has_next || next_key <= key) {
+            uint32_t skips = 0;
+            while (infix_store_ptr != nullptr && has_next && next_key <= key && skips < sorted_query_max_skips) {
+                prev_key = next_key;
+                infix_store_ptr = next_infix_store_ptr;
+                TreeIterSkip1(it);
+                has_next = TreeIterValid(it);
+                if (has_next)
+                    TreeIterPeek(it, next_key, next_infix_store_ptr);
+                skips++;
+            }
+            if (infix_store_ptr == nullptr || (has_next && next_key <= key)) {
+                TreeIterSeekNear(it, key, prev_key, infix_store_ptr, next_key, next_infix_store_ptr);
+                TreeIterSkip1(it);
+                has_next = TreeIterValid(it);
+            }
+            if (has_next) {
+                std::tie(shared, ignore, implicit_size) = GetSharedIgnoreImplicitLengths(prev_key, next_key);
+                prev_implicit = ExtractPartialKey(prev_key, shared, ignore, implicit_size, 0) >> infix_size_;
+                const uint64_t next_implicit = ExtractPartialKey(next_key, shared, ignore, implicit_size, 1) >> infix_size_;
+                total_implicit = next_implicit - prev_implicit + 1;
+            }
+        }
+
+        if (prev_key == key) {
+            *out = true;
+            continue;
+        }
+#ifdef DEBUG
+        assert(has_next);
+        assert(prev_key <= key);
+        assert(key < next_key);
+#endif
+
+        InfixStore& infix_store = *infix_store_ptr;
+        if (infix_store.IsPartialKey() && prev_key.IsPrefixOf(key, infix_store.GetInvalidBits())) {
+            // Previous key was a partial key and a prefix of the query key
+            *out = true;
+            continue;
+        }
+        const uint64_t extraction = ExtractPartialKey(key, shared, ignore, implicit_size, key.GetBit(shared));
+        const uint64_t query_key = extraction - (prev_implicit << infix_size_);
+        *out = PointQueryInfixStore(infix_store, query_key, total_implicit);
+    }
+    TreeIterUnlock(it);
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::InsertSplit(const InfiniteByteString key) {
-    InfixStore *infix_store_ptr, *dummy_infix_store_ptr;
-    uint32_t dummy_val;
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Freeze() {
+    assert(!IsFrozen() && "Diva is already frozen");
 
-    InfiniteByteString next_key {};
-    InfiniteByteString prev_key {};
+    std::vector<std::string> keys;
+    std::vector<InfixStore> stores;
+    InfiniteByteString tree_key;
+    InfixStore *store;
+    TreeIter it;
+    TreeIterInit(it, GetTreeRef());
+    for (TreeIterSeek(it, {}); TreeIterValid(it); TreeIterSkip1(it)) {
+        TreeIterPeek(it, tree_key, store);
+        keys.emplace_back(reinterpret_cast<const char *>(tree_key.str), tree_key.length);
+        stores.push_back(*store);
+    }
+    TreeIterUnlock(it);
+    const uint64_t key_count = keys.size();
+
+    // Stores drop to the smallest size grade an insert could have left them
+    // at, so that they stay valid once thawed
+    for (uint64_t i = 0; i + 1 < key_count; i++) {
+        InfixStore &cur = stores[i];
+        const uint32_t elem_count = cur.GetElemCount();
+        uint32_t size_grade = 0;
+        while (elem_count > (size_grade ? scaled_sizes_[size_grade - 1] : exception_scaled_size_))
+            size_grade++;
+        if (size_grade >= cur.GetSizeGrade())
+            continue;
+
+        const InfiniteByteString prev_key {reinterpret_cast<const uint8_t *>(keys[i].data()), static_cast<uint32_t>(keys[i].size())};
+        const InfiniteByteString next_key {reinterpret_cast<const uint8_t *>(keys[i + 1].data()), static_cast<uint32_t>(keys[i + 1].size())};
+        auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(prev_key, next_key);
+        const uint64_t prev_implicit = ExtractPartialKey(prev_key, shared, ignore, implicit_size, 0) >> infix_size_;
+        const uint64_t next_implicit = ExtractPartialKey(next_key, shared, ignore, implicit_size, 1) >> infix_size_;
 
-    if constexpr (int_optimized) {
-        wormhole_int_iter it_int;
-        it_int.ref = better_tree_int_;
-        it_int.map = better_tree_int_->map;
-        it_int.leaf = nullptr;
-        it_int.is = 0;
-        wh_int_iter_seek(&it_int, key.str, key.length);
-
-        wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                      reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key == key) {
-            prev_key = next_key;
-            wh_int_iter_skip1(&it_int);
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                          reinterpret_cast<void **>(&dummy_infix_store_ptr), &dummy_val);
+        uint64_t infix_list[elem_count + 1];
+        GetInfixList(cur, infix_list);
+        InfixStore resized(allocator_, scaled_sizes_[size_grade], infix_size_);
+        resized.status = cur.status;
+        resized.SetSizeGrade(size_grade);
+        LoadListToInfixStore(resized, infix_list, elem_count, next_implicit - prev_implicit + 1);
+        cur = resized;
+    }
+
+    const uint64_t block_count = (key_count + frozen_block_size - 1) / frozen_block_size;
+    std::vector<uint8_t> key_bytes;
+    std::vector<uint64_t> heads(block_count), key_offsets(block_count), word_offsets(block_count);
+    uint64_t store_word_count = 0, max_key_length = sizeof(t_int);
+    uint8_t varint_buf[16];
+    for (uint64_t i = 0; i < key_count; i++) {
+        const uint8_t *key = reinterpret_cast<const uint8_t *>(keys[i].data());
+        const uint32_t key_len = keys[i].size();
+        max_key_length = std::max<uint64_t>(max_key_length, key_len);
+        uint32_t shared = 0;
+        if (i % frozen_block_size == 0) {
+            heads[i / frozen_block_size] = BoundaryKey::GetHead(key, key_len);
+            key_offsets[i / frozen_block_size] = key_bytes.size();
+            word_offsets[i / frozen_block_size] = store_word_count;
         }
         else {
-            wh_int_iter_skip1_rev(&it_int);
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
-                                          reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
+            const uint32_t max_shared = std::min(keys[i - 1].size(), keys[i].size());
+            while (shared < max_shared && keys[i - 1][shared] == keys[i][shared])
+                shared++;
+            key_bytes.insert(key_bytes.end(), varint_buf, put_varint(varint_buf, shared));
         }
-        if (it_int.leaf)
-            wormleaf_int_unlock_read(it_int.leaf);
+        key_bytes.insert(key_bytes.end(), varint_buf, put_varint(varint_buf, key_len - shared));
+        key_bytes.insert(key_bytes.end(), key + shared, key + key_len);
+        store_word_count += GetInfixStoreWordCount(stores[i]);
     }
-    else {
-        wormhole_iter it;
-        it.ref = better_tree_;
-        it.map = better_tree_->map;
+
+    // One spare word at the end, as GetSlot reads whole words
+    FrozenHeader header = {0, key_count, block_count, key_bytes.size(), store_word_count, max_key_length};
+    header.word_count = sizeof(header) / sizeof(uint64_t) + (key_bytes.size() + 7) / 8 + 3 * block_count
+                      + (key_count + 1) / 2 + store_word_count + 1;
+    u64 alloc_size;
+    uint64_t *buf = static_cast<uint64_t *>(pages_alloc_best(header.word_count * sizeof(uint64_t), false, &alloc_size));
+    assert(buf != nullptr && "Could not allocate the frozen Diva");
+    memset(buf, 0, header.word_count * sizeof(uint64_t));
+    memcpy(buf, &header, sizeof(header));
+    SetFrozenViews(buf);
+    memcpy(const_cast<uint8_t *>(frozen_keys_), key_bytes.data(), key_bytes.size());
+    memcpy(const_cast<uint64_t *>(frozen_heads_), heads.data(), block_count * sizeof(uint64_t));
+    memcpy(const_cast<uint64_t *>(frozen_key_offsets_), key_offsets.data(), block_count * sizeof(uint64_t));
+    memcpy(const_cast<uint64_t *>(frozen_word_offsets_), word_offsets.data(), block_count * sizeof(uint64_t));
+    uint64_t word_offset = 0;
+    for (uint64_t i = 0; i < key_count; i++) {
+        const uint32_t word_count = GetInfixStoreWordCount(stores[i]);
+        const_cast<uint32_t *>(frozen_statuses_)[i] = stores[i].status;
+        memcpy(frozen_words_ + word_offset, stores[i].ptr, word_count * sizeof(uint64_t));
+        word_offset += word_count;
+    }
+    frozen_alloc_size_ = alloc_size;
+
+    DestroyTree();
+    allocator_.Release();
+    retired_ptrs_.clear();
+    retired_count_.store(0, std::memory_order_relaxed);
+    if (mapped_buf_ != nullptr) {
+        munmap(const_cast<char *>(mapped_buf_), mapped_size_);
+        mapped_buf_ = nullptr;
+        mapped_size_ = 0;
+    }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Thaw() {
+    assert(IsFrozen() && "Diva is not frozen");
+    CreateTree();
+
+    uint8_t key_bufs[2 * frozen_header_.max_key_length];
+    const uint8_t *pos;
+    uint64_t word_offset = 0;
+    for (uint64_t block = 0; block < frozen_header_.block_count; block++) {
+        InfiniteByteString key = GetFrozenBlockHead(block, pos);
+        const uint64_t block_end = std::min<uint64_t>((block + 1) * frozen_block_size, frozen_header_.key_count);
+        for (uint64_t ind = block * frozen_block_size; ind < block_end; ind++) {
+            if (ind % frozen_block_size)
+                key = DecodeFrozenKey(pos, key, key_bufs + (ind % 2) * frozen_header_.max_key_length);
+            InfixStore store;
+            store.status = frozen_statuses_[ind];
+            const uint32_t word_count = GetInfixStoreWordCount(store);
+            store.ptr = allocator_.Allocate(word_count);
+            memcpy(store.ptr, frozen_words_ + word_offset, word_count * sizeof(uint64_t));
+            word_offset += word_count;
+            TreePut(GetTreeRef(), key, store);
+        }
+    }
+    ReleaseFrozen();
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::IsFrozen() const {
+    return frozen_buf_ != nullptr;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SetFrozenViews(const uint64_t *buf) {
+    frozen_buf_ = buf;
+    memcpy(&frozen_header_, buf, sizeof(frozen_header_));
+    const uint64_t *pos = buf + sizeof(frozen_header_) / sizeof(uint64_t);
+    frozen_keys_ = reinterpret_cast<const uint8_t *>(pos);
+    pos += (frozen_header_.key_bytes + 7) / 8;
+    frozen_heads_ = pos;
+    pos += frozen_header_.block_count;
+    frozen_key_offsets_ = pos;
+    pos += frozen_header_.block_count;
+    frozen_word_offsets_ = pos;
+    pos += frozen_header_.block_count;
+    frozen_statuses_ = reinterpret_cast<const uint32_t *>(pos);
+    pos += (frozen_header_.key_count + 1) / 2;
+    frozen_words_ = const_cast<uint64_t *>(pos);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ReleaseFrozen() {
+    if (frozen_alloc_size_ != 0)
+        pages_unmap(const_cast<uint64_t *>(frozen_buf_), frozen_alloc_size_);
+    frozen_buf_ = nullptr;
+    frozen_alloc_size_ = 0;
+    frozen_header_ = {};
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline typename Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InfiniteByteString
+Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetFrozenBlockHead(const uint64_t block, const uint8_t *&pos) const {
+    uint32_t length;
+    pos = get_varint(frozen_keys_ + frozen_key_offsets_[block], length);
+    const InfiniteByteString res {pos, length};
+    pos += length;
+    return res;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline typename Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InfiniteByteString
+Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DecodeFrozenKey(const uint8_t *&pos, const InfiniteByteString prev_key, uint8_t *buf) {
+    uint32_t shared, suffix_length;
+    pos = get_varint(pos, shared);
+    pos = get_varint(pos, suffix_length);
+    memcpy(buf, prev_key.str, shared);
+    memcpy(buf + shared, pos, suffix_length);
+    pos += suffix_length;
+    return {buf, shared + suffix_length};
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::FrozenSeekNear(const InfiniteByteString key, InfiniteByteString &prev_key,
+                                                                                            InfiniteByteString &next_key, InfixStore &infix_store,
+                                                                                            uint8_t *key_bufs) const {
+    // Finds the last block starting at or before the key, comparing the full
+    // first keys only when their first eight bytes match, then decodes the
+    // block up to the key. Decoded keys alternate between the two halves of
+    // `key_bufs`, so that the last one decoded never overwrites its predecessor.
+    const uint64_t head = BoundaryKey::GetHead(key.str, key.length);
+    const uint8_t *pos;
+    uint64_t l = 0, r = frozen_header_.block_count;
+    while (l < r) {
+        const uint64_t mid = (l + r) / 2;
+        if (frozen_heads_[mid] < head || (frozen_heads_[mid] == head && GetFrozenBlockHead(mid, pos) <= key))
+            l = mid + 1;
+        else
+            r = mid;
+    }
+    const uint64_t block = l ? l - 1 : 0;
+
+    prev_key = GetFrozenBlockHead(block, pos);
+    next_key = {};
+    uint64_t ind = block * frozen_block_size, word_offset = frozen_word_offsets_[block];
+    const uint64_t block_end = std::min<uint64_t>(ind + frozen_block_size, frozen_header_.key_count);
+    for (; ind + 1 < block_end; ind++) {
+        const InfiniteByteString cur_key = DecodeFrozenKey(pos, prev_key, key_bufs + ((ind + 1) % 2) * frozen_header_.max_key_length);
+        if (key < cur_key) {
+            next_key = cur_key;
+            break;
+        }
+        infix_store.status = frozen_statuses_[ind];
+        word_offset += GetInfixStoreWordCount(infix_store);
+        prev_key = cur_key;
+    }
+    if (next_key.str == nullptr && block + 1 < frozen_header_.block_count)
+        next_key = GetFrozenBlockHead(block + 1, pos);
+    infix_store.status = frozen_statuses_[ind];
+    infix_store.ptr = frozen_words_ + word_offset;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline typename Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeRef *Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetTreeRef() const {
+    if constexpr (!wormhole_index)
+        return index_;
+    else if constexpr (int_optimized)
+        return better_tree_int_;
+    else
+        return better_tree_;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeIterInit(TreeIter &it, TreeRef *ref) {
+    if constexpr (!wormhole_index)
+        it = {ref};
+    else {
+        it.ref = ref;
+        it.map = ref->map;
         it.leaf = nullptr;
         it.is = 0;
+    }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeIterSeek(TreeIter &it, const InfiniteByteString key) {
+    if constexpr (!wormhole_index)
+        it.index->Seek(it, key.str, key.length);
+    else if constexpr (thread_policy == ThreadPolicy::Single) {
+        if constexpr (int_optimized)
+            wh_int_unsafe_iter_seek(&it, key.str, key.length);
+        else
+            wh_unsafe_iter_seek(&it, key.str, key.length);
+    }
+    else if constexpr (int_optimized)
+        wh_int_iter_seek(&it, key.str, key.length);
+    else
         wh_iter_seek(&it, key.str, key.length);
+}
 
-        wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                              reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key == key) {
-            prev_key = next_key;
-            wh_iter_skip1(&it);
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                  reinterpret_cast<void **>(&dummy_infix_store_ptr), &dummy_val);
-        }
-        else {
-            wh_iter_skip1_rev(&it);
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeIterSeekNear(TreeIter &it, const InfiniteByteString key,
+                                                                                    InfiniteByteString &prev_key, InfixStore *&prev_store_ptr,
+                                                                                    InfiniteByteString &next_key, InfixStore *&next_store_ptr) {
+    // Leaves the iterator on the floor of the key, whose successor is the next key
+    if constexpr (!wormhole_index)
+        it.index->SeekNear(it, key.str, key.length, prev_key.str, prev_key.length, prev_store_ptr,
+                           next_key.str, next_key.length, next_store_ptr);
+    else if constexpr (thread_policy == ThreadPolicy::Single) {
+        if constexpr (int_optimized)
+            wh_int_unsafe_iter_seek_near(&it, key.str, key.length,
+                                         reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
+                                         reinterpret_cast<void **>(&prev_store_ptr),
+                                         reinterpret_cast<const void **>(&next_key.str), &next_key.length,
+                                         reinterpret_cast<void **>(&next_store_ptr));
+        else
+            wh_unsafe_iter_seek_near(&it, key.str, key.length,
+                                     reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
+                                     reinterpret_cast<void **>(&prev_store_ptr),
+                                     reinterpret_cast<const void **>(&next_key.str), &next_key.length,
+                                     reinterpret_cast<void **>(&next_store_ptr));
+    }
+    else if constexpr (int_optimized)
+        wh_int_iter_seek_near(&it, key.str, key.length,
+                              reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
+                              reinterpret_cast<void **>(&prev_store_ptr),
+                              reinterpret_cast<const void **>(&next_key.str), &next_key.length,
+                              reinterpret_cast<void **>(&next_store_ptr));
+    else
+        wh_iter_seek_near(&it, key.str, key.length,
+                          reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
+                          reinterpret_cast<void **>(&prev_store_ptr),
+                          reinterpret_cast<const void **>(&next_key.str), &next_key.length,
+                          reinterpret_cast<void **>(&next_store_ptr));
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeIterPeek(TreeIter &it, InfiniteByteString &key, InfixStore *&infix_store_ptr) {
+    uint32_t dummy_val;
+    if constexpr (!wormhole_index)
+        it.index->Peek(it, key.str, key.length, infix_store_ptr);
+    else if constexpr (int_optimized)
+        wh_int_iter_peek_ref(&it, reinterpret_cast<const void **>(&key.str), &key.length,
                                   reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
+    else
+        wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&key.str), &key.length,
+                              reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeIterValid(TreeIter &it) {
+    if constexpr (!wormhole_index)
+        return it.index->Valid(it);
+    else if constexpr (int_optimized)
+        return wh_int_iter_valid(&it);
+    else
+        return wh_iter_valid(&it);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeIterSkip1(TreeIter &it) {
+    if constexpr (!wormhole_index)
+        it.index->Next(it);
+    else if constexpr (thread_policy == ThreadPolicy::Single) {
+        if constexpr (int_optimized)
+            wh_int_unsafe_iter_skip1(&it);
+        else
+            wh_unsafe_iter_skip1(&it);
+    }
+    else if constexpr (int_optimized)
+        wh_int_iter_skip1(&it);
+    else
+        wh_iter_skip1(&it);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeIterSkip1Rev(TreeIter &it) {
+    if constexpr (!wormhole_index)
+        it.index->Prev(it);
+    else if constexpr (thread_policy == ThreadPolicy::Single) {
+        if constexpr (int_optimized)
+            wh_int_unsafe_iter_skip1_rev(&it);
+        else
+            wh_unsafe_iter_skip1_rev(&it);
+    }
+    else if constexpr (int_optimized)
+        wh_int_iter_skip1_rev(&it);
+    else
+        wh_iter_skip1_rev(&it);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeIterUnlock(TreeIter &it) {
+    // Other indexes and unsafe iterators hold no leaf lock
+    if constexpr (wormhole_index) {
+        if (it.leaf) {
+            if constexpr (thread_policy == ThreadPolicy::Concurrent) {
+                if constexpr (int_optimized)
+                    wormleaf_int_unlock_read(it.leaf);
+                else
+                    wormleaf_unlock_read(it.leaf);
+            }
+            it.leaf = nullptr;
         }
-        if (it.leaf)
-            wormleaf_unlock_read(it.leaf);
     }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreePut(TreeRef *ref, const InfiniteByteString key, const InfixStore &infix_store) {
+    if constexpr (!wormhole_index)
+        ref->Insert(key.str, key.length, infix_store);
+    else if constexpr (thread_policy == ThreadPolicy::Single) {
+        if constexpr (int_optimized)
+            wh_int_unsafe_put(ref->map, key.str, key.length, &infix_store, sizeof(InfixStore));
+        else
+            wh_unsafe_put(ref->map, key.str, key.length, &infix_store, sizeof(InfixStore));
+    }
+    else if constexpr (int_optimized)
+        wh_int_put(ref, key.str, key.length, &infix_store, sizeof(InfixStore));
+    else
+        wh_put(ref, key.str, key.length, &infix_store, sizeof(InfixStore));
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreeDel(TreeRef *ref, const InfiniteByteString key) {
+    if constexpr (!wormhole_index)
+        ref->Erase(key.str, key.length);
+    else if constexpr (thread_policy == ThreadPolicy::Single) {
+        if constexpr (int_optimized)
+            wh_int_unsafe_del(ref->map, key.str, key.length);
+        else
+            wh_unsafe_del(ref->map, key.str, key.length);
+    }
+    else if constexpr (int_optimized)
+        wh_int_del(ref, key.str, key.length);
+    else
+        wh_del(ref, key.str, key.length);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TreePark(TreeRef *ref) {
+    // The thread-safe API leaves parking to the iterators, so park directly
+    if constexpr (wormhole_index && thread_policy == ThreadPolicy::Concurrent) {
+        if constexpr (int_optimized)
+            wormhole_int_park(ref);
+        else
+            wormhole_park(ref);
+    }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SetupConcurrency() {
+    if (qsbr_ != nullptr)
+        return;
+    // The instance's own tree reference must not hold back tree updates made
+    // through the sessions
+    TreePark(GetTreeRef());
+    store_locks_ = new StoreLock[store_lock_count]();
+    qsbr_ = qsbr_create();
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline typename Diva<int_optimized, target_size, t_int, thread_policy, t_index>::StoreLock *Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetStoreLock(const InfiniteByteString key) const {
+    // Stores are locked through a striped table keyed by their boundary key,
+    // since the stores themselves are moved around inside the tree's leaves
+    return &store_locks_[kv_crc32c(key.str, key.length) & (store_lock_count - 1)];
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TryLockStore(StoreLock *lock) {
+    uint64_t version = lock->version.load(std::memory_order_relaxed);
+    if ((version & 1) || !lock->version.compare_exchange_strong(version, version + 1, std::memory_order_acquire))
+        return false;
+    // Readers must not see any store update without the odd version
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::UnlockStore(StoreLock *lock) {
+    lock->version.fetch_add(1, std::memory_order_release);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline uint64_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ReadStoreVersion(const StoreLock *lock) {
+    return lock->version.load(std::memory_order_acquire);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ValidateStoreVersion(const StoreLock *lock, const uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return lock->version.load(std::memory_order_relaxed) == version;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetInfixStoreWordCount(const InfixStore &store) const {
+    return InfixStore::GetPtrWordCount(scaled_sizes_[store.GetSizeGrade()], infix_size_);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::FreeInfixStorePtr(uint64_t *ptr, const uint32_t word_count) {
+    if (ptr == nullptr || IsMappedPtr(ptr))
+        return;
+    if (qsbr_ == nullptr) {
+        allocator_.Free(ptr, word_count);
+        return;
+    }
+    // Other sessions may still be reading the buffer
+    std::lock_guard<std::mutex> guard(retire_mutex_);
+    retired_ptrs_.emplace_back(ptr, word_count);
+    retired_count_.store(retired_ptrs_.size(), std::memory_order_relaxed);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ReclaimInfixStorePtrs() {
+    std::lock_guard<std::mutex> reclaim_guard(reclaim_mutex_);
+    std::vector<std::pair<uint64_t *, uint32_t>> ptrs;
+    {
+        std::lock_guard<std::mutex> retire_guard(retire_mutex_);
+        ptrs.swap(retired_ptrs_);
+        retired_count_.store(0, std::memory_order_relaxed);
+    }
+    if (ptrs.empty())
+        return;
+    // Sessions only park between operations, so once all of them have parked
+    // nobody can hold a reference to the retired buffers
+    qsbr_wait(qsbr_, ++reclaim_epoch_);
+    for (auto [ptr, word_count] : ptrs)
+        allocator_.Free(ptr, word_count);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::IsMappedPtr(const uint64_t *ptr) const {
+    const char *byte_ptr = reinterpret_cast<const char *>(ptr);
+    return mapped_buf_ <= byte_ptr && byte_ptr < mapped_buf_ + mapped_size_;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::CopyMappedInfixStore(InfixStore &store) const {
+    if (!IsMappedPtr(store.ptr))
+        return;
+    const uint32_t word_count = GetInfixStoreWordCount(store);
+    uint64_t *ptr = allocator_.Allocate(word_count);
+    memcpy(ptr, store.ptr, word_count * sizeof(uint64_t));
+    store.ptr = ptr;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::AddTreeKey(const uint8_t *key, const uint32_t key_len) {
+    InfixStore infix_store(allocator_, scaled_sizes_[size_scalar_shrink_grow_sep], infix_size_);
+    TreePut(GetTreeRef(), {key, key_len}, infix_store);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InsertSplit(const InfiniteByteString key) {
+    InfixStore *infix_store_ptr;
+    InfiniteByteString next_key {};
+    InfiniteByteString prev_key {};
+    LocateInfixStore(key, prev_key, next_key, infix_store_ptr);
 
 #ifdef DEBUG
     assert(prev_key <= key);
     assert(key < next_key);
 #endif
 
-    InfixStore& infix_store = *infix_store_ptr;
+    if (!InsertSplitInfixStore(key, prev_key, next_key, *infix_store_ptr, GetTreeRef()))
+        InsertSimple(key);
+}
+
 
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InsertSplitInfixStore(const InfiniteByteString key, const InfiniteByteString prev_key,
+                                                                                                   const InfiniteByteString next_key, const InfixStore &infix_store,
+                                                                                                   TreeRef *ref) {
     if (infix_store.IsPartialKey() && prev_key.IsPrefixOf(key, infix_store.GetInvalidBits())) {
         // Previous key was a partial key and a prefix of the new boundary key
         // Inserting using the simple method...
-        InsertSimple(key);
-        return;
+        return false;
     }
 
     auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(prev_key, next_key);
@@ -837,15 +1955,23 @@ inline void Diva<int_optimized>::InsertSplit(const InfiniteByteString key) {
             zero_pos = shared + ignore + implicit_size + infix_size_ - lowbit_pos(infix_list[i]) - 1;
         }
     }
+    // A boundary key cut to its shortest separator splits the store just as
+    // the whole key does, and keeps the key itself as an infix of the new store
+    int32_t cut_pos = zero_pos;
+    if (zero_pos == -1 && shortest_separators_) {
+        const uint32_t separator_len = GetSeparatorLength(prev_key, key, next_key, shared + ignore + implicit_size);
+        if (separator_len > 0)
+            cut_pos = separator_len;
+    }
     uint32_t copied_key_len = key.length;
     uint8_t copied_key_str[copied_key_len];
     memcpy(copied_key_str, key.str, key.length);
-    if (zero_pos != -1 && copied_key_len > (zero_pos - 1) / 8) {
-        copied_key_str[(zero_pos - 1) / 8] &= ~BITMASK(7 - (zero_pos - 1) % 8);
-        copied_key_len = (zero_pos - 1) / 8 + 1;
+    if (cut_pos != -1 && copied_key_len > (cut_pos - 1) / 8) {
+        copied_key_str[(cut_pos - 1) / 8] &= ~BITMASK(7 - (cut_pos - 1) % 8);
+        copied_key_len = (cut_pos - 1) / 8 + 1;
     }
     InfiniteByteString edited_key {copied_key_str, copied_key_len};
-    if (zero_pos != -1)
+    if (cut_pos != -1)
         extraction = ExtractPartialKey(edited_key, shared, ignore, implicit_size, edited_key.GetBit(shared));
 
     const uint32_t shared_word_byte = (shared / 64) * 8;
@@ -875,10 +2001,8 @@ inline void Diva<int_optimized>::InsertSplit(const InfiniteByteString key) {
                                 | (next_key.BitsAt(shared + ignore + implicit_size, shamt_gt) << infix_size_);
     const uint32_t total_implicit_gt = ((next_extraction_gt >> infix_size_) - (extraction_gt >> infix_size_)) + 1;
 
-    if (zero_pos <= std::max(shared_lt, shared_gt)) {
-        InsertSimple(key);
-        return;
-    }
+    if (cut_pos <= std::max(shared_lt, shared_gt))
+        return false;
 
     const auto [left_list_len, left_exp] = GetExpandedInfixListLength(infix_list,
                                                                       split_pos,
@@ -912,37 +2036,28 @@ inline void Diva<int_optimized>::InsertSplit(const InfiniteByteString key) {
                                                      total_implicit_gt);
     
     auto *ptr_to_free = infix_store.ptr;
-    if constexpr (int_optimized)
-        wh_int_put(better_tree_int_, prev_key.str, prev_key.length, &store_lt, sizeof(InfixStore));
-    else 
-        wh_put(better_tree_, prev_key.str, prev_key.length, &store_lt, sizeof(InfixStore));
-    if (zero_pos != -1) {
+    const uint32_t word_count_to_free = GetInfixStoreWordCount(infix_store);
+    TreePut(ref, prev_key, store_lt);
+    if (cut_pos != -1) {
         const uint64_t key_extraction = ExtractPartialKey(key, shared_gt, ignore_gt, implicit_size_gt, 0);
         InsertRawIntoInfixStore(store_gt, key_extraction & BITMASK(infix_size_) | 1, total_implicit_gt);
-        store_gt.SetInvalidBits(7 - (zero_pos - 1) % 8);
-        store_gt.SetPartialKey(true);
-        if constexpr (int_optimized)
-            wh_int_put(better_tree_int_, edited_key.str, edited_key.length, &store_gt, sizeof(InfixStore));
-        else 
-            wh_put(better_tree_, edited_key.str, edited_key.length, &store_gt, sizeof(InfixStore));
-    }
-    else {
-        if constexpr (int_optimized)
-            wh_int_put(better_tree_int_, key.str, key.length, &store_gt, sizeof(InfixStore));
-        else
-            wh_put(better_tree_, key.str, key.length, &store_gt, sizeof(InfixStore));
+        SetPartialBoundary(store_gt, cut_pos);
+        TreePut(ref, edited_key, store_gt);
     }
+    else
+        TreePut(ref, key, store_gt);
 
     // No memory leaks!
-    delete[] ptr_to_free;
+    FreeInfixStorePtr(ptr_to_free, word_count_to_free);
+    return true;
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline std::tuple<uint32_t, bool> Diva<int_optimized>::GetExpandedInfixListLength(const uint64_t *list, const uint32_t list_len,
-                                                                                  const uint32_t implicit_size, const uint32_t shamt,
-                                                                                  const uint64_t lower_lim, const uint64_t upper_lim) {
+inline std::tuple<uint32_t, bool> Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetExpandedInfixListLength(const uint64_t *list, const uint32_t list_len,
+                                                                                                                              const uint32_t implicit_size, const uint32_t shamt,
+                                                                                                                              const uint64_t lower_lim, const uint64_t upper_lim) {
     uint32_t actual_list_len = list_len;
     bool expanded = false;
     const uint64_t lower_implicit_lim = lower_lim >> infix_size_;
@@ -964,11 +2079,11 @@ inline std::tuple<uint32_t, bool> Diva<int_optimized>::GetExpandedInfixListLengt
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline void Diva<int_optimized>::UpdateInfixList(const uint64_t *list, const uint32_t list_len, const uint32_t shamt,
-                                                 const uint64_t lower_lim, const uint64_t upper_lim,
-                                                 uint64_t *res, const uint32_t res_len, const bool expanded) const {
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::UpdateInfixList(const uint64_t *list, const uint32_t list_len, const uint32_t shamt,
+                                                                                             const uint64_t lower_lim, const uint64_t upper_lim,
+                                                                                             uint64_t *res, const uint32_t res_len, const bool expanded) const {
     if (!expanded) {
         for (int32_t i = 0; i < list_len; i++) {
             res[i] = (list[i] << shamt) - lower_lim;
@@ -1018,9 +2133,9 @@ inline void Diva<int_optimized>::UpdateInfixList(const uint64_t *list, const uin
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 inline std::tuple<uint32_t, uint32_t, uint32_t> 
-Diva<int_optimized>::GetSharedIgnoreImplicitLengths(const InfiniteByteString key_1,
+Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetSharedIgnoreImplicitLengths(const InfiniteByteString key_1,
                                                     const InfiniteByteString key_2) const {
     uint32_t share = 0, ignore = 0, implicit = 0;
 
@@ -1028,7 +2143,7 @@ Diva<int_optimized>::GetSharedIgnoreImplicitLengths(const InfiniteByteString key
     do {
         const uint64_t read_1 = key_1.WordAt(ind * sizeof(uint64_t));
         const uint64_t read_2 = key_2.WordAt(ind * sizeof(uint64_t));
-        delta = __builtin_ia32_lzcnt_u64(read_1 ^ read_2);
+        delta = leading_zeros(read_1 ^ read_2);
         share += delta;
         ind++;
     } while (delta == 64);
@@ -1038,7 +2153,7 @@ Diva<int_optimized>::GetSharedIgnoreImplicitLengths(const InfiniteByteString key
         const uint64_t read_1 = key_1.WordAt(ind * sizeof(uint64_t));
         const uint64_t read_2 = key_2.WordAt(ind * sizeof(uint64_t));
         const uint32_t offset = (ind > share / 64 ? 0 : share % 64 + 1);
-        delta = __builtin_ia32_lzcnt_u64(((~read_1) | read_2) & BITMASK(64 - offset));
+        delta = leading_zeros(((~read_1) | read_2) & BITMASK(64 - offset));
         ignore += delta - offset;
         ind++;
     } while (delta == 64);
@@ -1052,93 +2167,176 @@ Diva<int_optimized>::GetSharedIgnoreImplicitLengths(const InfiniteByteString key
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::ShrinkInfixSize(const uint32_t new_infix_size) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetSeparatorLength(const InfiniteByteString prev_key,
+                                                                                                    const InfiniteByteString key,
+                                                                                                    const InfiniteByteString next_key,
+                                                                                                    const uint32_t min_length) const {
+    // Keeps a full infix past the implicit parts against both neighbours, so
+    // the keys that match the cut boundary key also match the infix of `key`.
+    // Returns zero when that takes the whole key
+    auto [shared_prev, ignore_prev, implicit_size_prev] = GetSharedIgnoreImplicitLengths(prev_key, key);
+    auto [shared_next, ignore_next, implicit_size_next] = GetSharedIgnoreImplicitLengths(key, next_key);
+    const uint32_t res = std::max({min_length, shared_prev + ignore_prev + implicit_size_prev,
+                                   shared_next + ignore_next + implicit_size_next}) + infix_size_;
+    return res < 8 * key.length ? res : 0;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline typename Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InfiniteByteString Diva<int_optimized, target_size, t_int, thread_policy, t_index>::TruncateKey(const InfiniteByteString key,
+                                                                                                                                const uint32_t bit_len,
+                                                                                                                                uint8_t *buf) {
+    const uint32_t len = (bit_len + 7) / 8;
+    memcpy(buf, key.str, len);
+    buf[len - 1] &= ~BITMASK(7 - (bit_len - 1) % 8);
+    return {buf, len};
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SetPartialBoundary(InfixStore &store, const uint32_t bit_len) {
+    store.SetInvalidBits(7 - (bit_len - 1) % 8);
+    store.SetPartialKey(true);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ShrinkInfixSize(const uint32_t new_infix_size) {
+    assert(!IsFrozen() && "Thaw a frozen Diva before updating it");
     InfixStore *store_ptr;
-    const uint8_t *key;
-    uint32_t key_len, dummy_val;
+    InfiniteByteString key;
 
-    if constexpr (int_optimized) {
-        wormhole_int_iter it_int;
-        it_int.ref = better_tree_int_;
-        it_int.map = better_tree_int_->map;
-        it_int.leaf = nullptr;
-        it_int.is = 0;
-        wh_int_iter_seek(&it_int, nullptr, 0);
-        do {
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&key), &key_len,
-                                          reinterpret_cast<void **>(&store_ptr), &dummy_val);
-            ShrinkInfixStoreInfixSize(*store_ptr, new_infix_size);
-            wh_int_iter_skip1(&it_int);
-        } while (wh_int_iter_valid(&it_int));
-        if (it_int.leaf)
-            wormleaf_int_unlock_read(it_int.leaf);
+    TreeIter it;
+    TreeIterInit(it, GetTreeRef());
+    TreeIterSeek(it, {});
+    do {
+        TreeIterPeek(it, key, store_ptr);
+        ShrinkInfixStoreInfixSize(*store_ptr, new_infix_size);
+        TreeIterSkip1(it);
+    } while (TreeIterValid(it));
+    TreeIterUnlock(it);
+
+    infix_size_ = new_infix_size;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline Diva<int_optimized, target_size, t_int, thread_policy, t_index> *Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SplitUpperHalf(std::string &split_key, uint64_t &moved_key_count) {
+    // Moves the infix stores from the boundary key closest to the median key
+    // onwards into a new instance. The split key stays here with an empty
+    // store, because the infixes of the store before it are encoded relative to
+    // it. Returns nullptr if there is no boundary key to split at.
+    TreeRef *ref = GetTreeRef();
+    TreeIter it;
+    InfiniteByteString tree_key {};
+    InfixStore *store_ptr;
+
+    uint64_t total_key_count = 0;
+    uint32_t tree_key_count = 0;
+    TreeIterInit(it, ref);
+    for (TreeIterSeek(it, {}); TreeIterValid(it); TreeIterSkip1(it)) {
+        TreeIterPeek(it, tree_key, store_ptr);
+        total_key_count += store_ptr->GetElemCount() + 1;
+        tree_key_count++;
     }
-    else {
-        wormhole_iter it;
-        it.ref = better_tree_;
-        it.map = better_tree_->map;
-        it.leaf = nullptr;
-        it.is = 0;
-        wh_iter_seek(&it, nullptr, 0);
-        do {
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&key), &key_len,
-                                  reinterpret_cast<void **>(&store_ptr), &dummy_val);
-            ShrinkInfixStoreInfixSize(*store_ptr, new_infix_size);
-            wh_iter_skip1(&it);
-        } while (wh_iter_valid(&it));
-        if (it.leaf)
-            wormleaf_unlock_read(it.leaf);
+    TreeIterUnlock(it);
+    if (tree_key_count < 4)
+        return nullptr;
+    TreeIterInit(it, ref);
+
+    // The sentinels are not keys, and the first one is copied into the new instance
+    std::string min_key;
+    std::vector<std::pair<std::string, InfixStore>> moved_stores;
+    uint64_t key_count = 0;
+    uint32_t ind = 0;
+    moved_key_count = 0;
+    for (TreeIterSeek(it, {}); TreeIterValid(it); TreeIterSkip1(it), ind++) {
+        TreeIterPeek(it, tree_key, store_ptr);
+        if (ind == 0)
+            min_key.assign(reinterpret_cast<const char *>(tree_key.str), tree_key.length);
+        const bool can_split = ind > 0 && ind < tree_key_count - 1 && !store_ptr->IsPartialKey();
+        if (moved_stores.empty() && !(can_split && 2 * key_count >= total_key_count)) {
+            key_count += store_ptr->GetElemCount() + 1;
+            continue;
+        }
+        moved_stores.emplace_back(std::string(reinterpret_cast<const char *>(tree_key.str), tree_key.length),
+                                  *store_ptr);
+        moved_key_count += store_ptr->GetElemCount() + 1;
+    }
+    TreeIterUnlock(it);
+    if (moved_stores.size() < 2)
+        return nullptr;
+    moved_key_count--;
+
+    Diva *upper = new Diva(infix_size_, rng_seed_, load_factor_, shortest_separators_);
+    TreeRef *upper_ref = upper->GetTreeRef();
+    upper->AddTreeKey(reinterpret_cast<const uint8_t *>(min_key.data()), min_key.size());
+    for (const auto &[key, store] : moved_stores) {
+        const InfiniteByteString moved_key {reinterpret_cast<const uint8_t *>(key.data()),
+                                            static_cast<uint32_t>(key.size())};
+        // Buffers belong to the allocator of the instance that holds them
+        const uint32_t word_count = GetInfixStoreWordCount(store);
+        InfixStore upper_store = store;
+        upper_store.ptr = upper->allocator_.Allocate(word_count);
+        memcpy(upper_store.ptr, store.ptr, word_count * sizeof(uint64_t));
+        TreePut(upper_ref, moved_key, upper_store);
+        TreeDel(ref, moved_key);
+        FreeInfixStorePtr(store.ptr, word_count);
     }
+    split_key = moved_stores.front().first;
+    const std::string &max_key = moved_stores.back().first;
+    AddTreeKey(reinterpret_cast<const uint8_t *>(split_key.data()), split_key.size());
+    AddTreeKey(reinterpret_cast<const uint8_t *>(max_key.data()), max_key.size());
+    return upper;
+}
 
-    infix_size_ = new_infix_size;
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+constexpr uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SerializedMetadataSize() {
+    const uint32_t res = sizeof(bool) + sizeof(uint8_t) + sizeof(infix_store_target_size) + sizeof(rank_block_size)
+                       + sizeof(base_implicit_size) + sizeof(scale_shift)
+                       + sizeof(scale_implicit_shift) + sizeof(size_scalar_count)
+                       + sizeof(size_scalar_shrink_grow_sep) + sizeof(load_factor_)
+                       + sizeof(load_factor_alt_) + sizeof(infix_size_) 
+                       + sizeof(rng_seed_) + sizeof(shortest_separators_)
+                       + sizeof(InfixStore::size_grade_bit_count)
+                       + sizeof(InfixStore::elem_count_bit_count);
+    return ((res + 7) / 8) * 8;
 }
 
 
-template <bool int_optimized>
-inline uint32_t Diva<int_optimized>::Size() const {
-    uint32_t res = sizeof(bool) + sizeof(infix_store_target_size) 
-                 + sizeof(base_implicit_size) + sizeof(scale_shift)
-                 + sizeof(scale_implicit_shift) + sizeof(size_scalar_count)
-                 + sizeof(size_scalar_shrink_grow_sep) + sizeof(load_factor_)
-                 + sizeof(load_factor_alt_) + sizeof(infix_size_) 
-                 + sizeof(rng_seed_) + sizeof(InfixStore::size_grade_bit_count)
-                 + sizeof(InfixStore::elem_count_bit_count);
-
-    const uint8_t *tree_key, *last_tree_key = nullptr;
-    uint32_t tree_key_len, last_tree_key_len = 0, dummy;
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint64_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Size() const {
+    uint64_t res = SerializedMetadataSize();
+    if (IsFrozen())
+        return res + 2 * sizeof(frozen_marker) + frozen_header_.word_count * sizeof(uint64_t);
+
+    InfiniteByteString tree_key, last_tree_key {};
     InfixStore *store;
 
     if constexpr (int_optimized) {
-        wormhole_int_iter it_int;
-        it_int.ref = better_tree_int_;
-        it_int.map = better_tree_int_->map;
-        it_int.leaf = nullptr;
-        it_int.is = 0;
-        for (wh_int_iter_seek(&it_int, nullptr, 0); wh_int_iter_valid(&it_int); wh_int_iter_skip1(&it_int)) {
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&tree_key), &tree_key_len, 
-                                          reinterpret_cast<void **>(&store), &dummy);
-            res += sizeof(tree_key_len) + tree_key_len;
+        TreeIter it_int;
+        TreeIterInit(it_int, GetTreeRef());
+        for (TreeIterSeek(it_int, {}); TreeIterValid(it_int); TreeIterSkip1(it_int)) {
+            TreeIterPeek(it_int, tree_key, store);
+            const uint32_t rounded_tree_key_len = ((tree_key.length + 7) / 8) * 8;
+            res += sizeof(rounded_tree_key_len) + rounded_tree_key_len;
             const uint32_t word_count = store->GetPtrWordCount(scaled_sizes_[store->GetSizeGrade()], infix_size_);
             res += sizeof(store->status) + word_count * sizeof(uint64_t);
         }
-        if (it_int.leaf)
-            wormleaf_int_unlock_read(it_int.leaf);
+        TreeIterUnlock(it_int);
     }
     else {
-        wormhole_iter it;
-        it.ref = better_tree_;
-        it.map = better_tree_->map;
-        it.leaf = nullptr;
-        it.is = 0;
-        for (wh_iter_seek(&it, nullptr, 0); wh_iter_valid(&it); wh_iter_skip1(&it)) {
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&tree_key), &tree_key_len, 
-                                  reinterpret_cast<void **>(&store), &dummy);
-            const uint32_t rounded_tree_key_len = ((tree_key_len + 7) / 8) * 8;
+        TreeIter it;
+        TreeIterInit(it, GetTreeRef());
+        for (TreeIterSeek(it, {}); TreeIterValid(it); TreeIterSkip1(it)) {
+            TreeIterPeek(it, tree_key, store);
+            const uint32_t rounded_tree_key_len = ((tree_key.length + 7) / 8) * 8;
             res += sizeof(rounded_tree_key_len) + rounded_tree_key_len;
             /*
-            if (last_tree_key != nullptr) {
-                for (uint32_t i = 0; i < std::min(tree_key_len, last_tree_key_len) && last_tree_key[i] == tree_key[i]; i++)
+            if (last_tree_key.str != nullptr) {
+                for (uint32_t i = 0; i < std::min(tree_key.length, last_tree_key.length) && last_tree_key.str[i] == tree_key.str[i]; i++)
                     res--;
             }
             */
@@ -1149,81 +2347,107 @@ inline uint32_t Diva<int_optimized>::Size() const {
                 //res += (store->GetElemCount() * (infix_size_ + 1) + infix_store_target_size + 7) / 8;
             }
             last_tree_key = tree_key;
-            last_tree_key_len = tree_key_len;
         }
-        if (it.leaf)
-            wormleaf_unlock_read(it.leaf);
+        TreeIterUnlock(it);
     }
-    res += sizeof(tree_key_len);
+    res += sizeof(tree_key.length);
     return res;
 }
 
 
-template <bool int_optimized>
-inline uint32_t Diva<int_optimized>::Serialize(char *out) const {
-    uint32_t res = SerializeMetadata(out);
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline SlabAllocator::Stats Diva<int_optimized, target_size, t_int, thread_policy, t_index>::AllocatorStats() const {
+    return allocator_.GetStats();
+}
+
 
-    const uint8_t *tree_key;
-    uint32_t tree_key_len, dummy;
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint64_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Serialize(char *out) const {
+    BufferSink sink(out);
+    SerializeToSink(sink);
+    return sink.size;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint64_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SerializeTo(const int fd) const {
+    return SerializeTo([fd](const char *data, size_t len) {
+        while (len > 0) {
+            const ssize_t written = ::write(fd, data, len);
+            assert(written > 0 && "Could not write the serialized Diva");
+            data += written;
+            len -= written;
+        }
+    });
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint64_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SerializeTo(std::ostream &out) const {
+    return SerializeTo([&out](const char *data, size_t len) {
+        out.write(data, len);
+    });
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint64_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SerializeTo(const std::function<void(const char *, size_t)> &write) const {
+    StreamSink sink(write);
+    SerializeToSink(sink);
+    sink.Flush();
+    return sink.size;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_sink>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SerializeToSink(t_sink &sink) const {
+    static constexpr char zeros[8] = {};
+    char metadata[SerializedMetadataSize()];
+    SerializeMetadata(metadata);
+    sink.Write(metadata, sizeof(metadata));
+
+    if (IsFrozen()) {
+        // Padded so that the frozen buffer can be used in place once mapped
+        const uint32_t marker[2] = {frozen_marker, 0};
+        sink.Write(marker, sizeof(marker));
+        sink.Write(frozen_buf_, frozen_header_.word_count * sizeof(uint64_t));
+        return;
+    }
+
+    InfiniteByteString tree_key;
     InfixStore *store;
 
-    if constexpr (int_optimized) {
-        wormhole_int_iter it_int;
-        it_int.ref = better_tree_int_;
-        it_int.map = better_tree_int_->map;
-        it_int.leaf = nullptr;
-        it_int.is = 0;
-        for (wh_int_iter_seek(&it_int, nullptr, 0); wh_int_iter_valid(&it_int); wh_int_iter_skip1(&it_int)) {
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&tree_key), &tree_key_len, 
-                                          reinterpret_cast<void **>(&store), &dummy);
-            memcpy(out + res, &tree_key_len, sizeof(tree_key_len));
-            res += sizeof(tree_key_len);
-            const uint32_t rounded_tree_key_len = ((tree_key_len + 7) / 8) * 8;
-            memcpy(out + res, tree_key, tree_key_len);
-            memset(out + res + tree_key_len, 0, rounded_tree_key_len - tree_key_len);
-            res += rounded_tree_key_len;
-            res += SerializeInfixStore(out + res, *store);
-        }
-        if (it_int.leaf)
-            wormleaf_int_unlock_read(it_int.leaf);
+    TreeIter it;
+    TreeIterInit(it, GetTreeRef());
+    for (TreeIterSeek(it, {}); TreeIterValid(it); TreeIterSkip1(it)) {
+        TreeIterPeek(it, tree_key, store);
+        sink.Write(&tree_key.length, sizeof(tree_key.length));
+        const uint32_t rounded_tree_key_len = ((tree_key.length + 7) / 8) * 8;
+        sink.Write(tree_key.str, tree_key.length);
+        sink.Write(zeros, rounded_tree_key_len - tree_key.length);
+        SerializeInfixStore(sink, *store);
     }
-    else {
-        wormhole_iter it;
-        it.ref = better_tree_;
-        it.map = better_tree_->map;
-        it.leaf = nullptr;
-        it.is = 0;
-        for (wh_iter_seek(&it, nullptr, 0); wh_iter_valid(&it); wh_iter_skip1(&it)) {
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&tree_key), &tree_key_len, 
-                                  reinterpret_cast<void **>(&store), &dummy);
-            memcpy(out + res, &tree_key_len, sizeof(tree_key_len));
-            res += sizeof(tree_key_len);
-            const uint32_t rounded_tree_key_len = ((tree_key_len + 7) / 8) * 8;
-            memcpy(out + res, tree_key, tree_key_len);
-            memset(out + res + tree_key_len, 0, rounded_tree_key_len - tree_key_len);
-            res += rounded_tree_key_len;
-            res += SerializeInfixStore(out + res, *store);
-        }
-        if (it.leaf)
-            wormleaf_unlock_read(it.leaf);
-    }
-    tree_key_len = std::numeric_limits<uint32_t>::max();
-    memcpy(out + res, &tree_key_len, sizeof(tree_key_len));
-    res += sizeof(tree_key_len);
-    return res;
+    TreeIterUnlock(it);
+    const uint32_t end_marker = std::numeric_limits<uint32_t>::max();
+    sink.Write(&end_marker, sizeof(end_marker));
 }
 
 
-template <bool int_optimized>
-inline uint32_t Diva<int_optimized>::SerializeMetadata(char *out) const {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SerializeMetadata(char *out) const {
     uint32_t res = 0;
     // Diva Version
     out[res++] = static_cast<char>(int_optimized);
+    out[res++] = static_cast<char>(sizeof(t_int));
 
     // Global Metadata
     memcpy(out + res, &infix_store_target_size, sizeof(infix_store_target_size));
     res += sizeof(infix_store_target_size);
 
+    memcpy(out + res, &rank_block_size, sizeof(rank_block_size));
+    res += sizeof(rank_block_size);
+
     memcpy(out + res, &base_implicit_size, sizeof(base_implicit_size));
     res += sizeof(base_implicit_size);
 
@@ -1252,6 +2476,9 @@ inline uint32_t Diva<int_optimized>::SerializeMetadata(char *out) const {
     memcpy(out + res, &rng_seed_, sizeof(rng_seed_));
     res += sizeof(rng_seed_);
 
+    memcpy(out + res, &shortest_separators_, sizeof(shortest_separators_));
+    res += sizeof(shortest_separators_);
+
     // Infix Store Metadata
     memcpy(out + res, &InfixStore::size_grade_bit_count, sizeof(InfixStore::size_grade_bit_count));
     res += sizeof(InfixStore::size_grade_bit_count);
@@ -1259,31 +2486,76 @@ inline uint32_t Diva<int_optimized>::SerializeMetadata(char *out) const {
     memcpy(out + res, &InfixStore::elem_count_bit_count, sizeof(InfixStore::elem_count_bit_count));
     res += sizeof(InfixStore::elem_count_bit_count);
 
-    return res;
+    // Pad so that every infix store payload lands on an 8-byte boundary
+    const uint32_t padded_res = ((res + 7) / 8) * 8;
+    memset(out + res, 0, padded_res - res);
+    return padded_res;
 }
 
 
-template <bool int_optimized>
-inline uint32_t Diva<int_optimized>::SerializeInfixStore(char *out, const Diva<int_optimized>::InfixStore& store) const {
-    memcpy(out, &store.status, sizeof(store.status));
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_sink>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SerializeInfixStore(t_sink &sink, const Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InfixStore& store) const {
+    sink.Write(&store.status, sizeof(store.status));
     const uint32_t word_count = store.GetPtrWordCount(scaled_sizes_[store.GetSizeGrade()], infix_size_);
-    memcpy(out + sizeof(store.status), store.ptr, word_count * sizeof(uint64_t));
-    return sizeof(store.status) + word_count * sizeof(uint64_t);
+    sink.Write(store.ptr, word_count * sizeof(uint64_t));
 }
 
 
-template <bool int_optimized>
-inline Diva<int_optimized>::Diva(char *deser_buf):
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Diva(char *deser_buf):
         bulk_load_streaming_ind_(0) {
-    uint32_t ind = DeserializeMetadata(deser_buf);
-    if constexpr (int_optimized) {
-        wh_int_ = wh_int_create();
-        better_tree_int_ = wh_int_ref(wh_int_);
-    }
-    else {
-        wh_ = wh_create();
-        better_tree_ = wh_ref(wh_);
+    BufferSource source(deser_buf);
+    Deserialize(source, false);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Diva(const int fd, const bool map):
+        bulk_load_streaming_ind_(0) {
+    if (!map) {
+        const std::function<size_t(char *, size_t)> read_fd = [fd](char *data, size_t len) -> size_t {
+            const ssize_t read_len = ::read(fd, data, len);
+            return read_len > 0 ? read_len : 0;
+        };
+        StreamSource source(read_fd, true);
+        Deserialize(source, false);
+        // Hand back whatever was read past the end, if the file allows it
+        lseek(fd, -static_cast<off_t>(source.end - source.begin), SEEK_CUR);
+        return;
     }
+    struct stat file_stat;
+    [[maybe_unused]] const int stat_res = fstat(fd, &file_stat);
+    assert(stat_res == 0 && "Could not stat the serialized Diva");
+    mapped_size_ = file_stat.st_size;
+    void *buf = mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, fd, 0);
+    assert(buf != MAP_FAILED && "Could not map the serialized Diva");
+    mapped_buf_ = static_cast<const char *>(buf);
+    BufferSource source(mapped_buf_);
+    Deserialize(source, true);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Diva(std::istream &in):
+        Diva([&in](char *data, size_t len) -> size_t {
+            in.read(data, len);
+            return in.gcount();
+        }) {}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Diva(const std::function<size_t(char *, size_t)> &read):
+        bulk_load_streaming_ind_(0) {
+    StreamSource source(read, false);
+    Deserialize(source, false);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_source>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Deserialize(t_source &source, const bool in_place) {
+    DeserializeMetadata(source.Take(SerializedMetadataSize()));
     SetupScaleFactors();
 
     const uint32_t max_key_length = 20000;
@@ -1291,73 +2563,485 @@ inline Diva<int_optimized>::Diva(char *deser_buf):
     uint32_t key_length;
     InfixStore store;
 
-    memcpy(&key_length, deser_buf + ind, sizeof(key_length));
-    ind += sizeof(key_length);
+    memcpy(&key_length, source.Take(sizeof(key_length)), sizeof(key_length));
+    if (key_length == frozen_marker) {
+        DeserializeFrozen(source, in_place);
+        return;
+    }
+    CreateTree();
     while (key_length != std::numeric_limits<uint32_t>::max()) {
 #ifdef DEBUG
         assert(key_length < max_key_length);
 #endif
-        memcpy(key, deser_buf + ind, key_length);
         const uint32_t rounded_key_len = ((key_length + 7) / 8) * 8;
-        ind += rounded_key_len;
-        ind += DeserializeInfixStore(deser_buf + ind, store);
+        memcpy(key, source.Take(rounded_key_len), key_length);
+        DeserializeInfixStore(source, store, in_place);
 
-        if constexpr (int_optimized) {
 #ifdef DEBUG
-            assert(key_length == sizeof(uint64_t));
+        if constexpr (int_optimized)
+            assert(key_length <= sizeof(t_int));
+#endif
+        TreePut(GetTreeRef(), {reinterpret_cast<const uint8_t *>(key), key_length}, store);
+
+        memcpy(&key_length, source.Take(sizeof(key_length)), sizeof(key_length));
+    }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_source>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DeserializeFrozen(t_source &source, const bool in_place) {
+    source.Take(sizeof(frozen_marker));
+    const char *header_buf = source.Take(sizeof(FrozenHeader));
+    FrozenHeader header;
+    memcpy(&header, header_buf, sizeof(header));
+    const uint64_t rest_len = header.word_count * sizeof(uint64_t) - sizeof(header);
+    if (in_place) {
+        source.Take(rest_len);
+        SetFrozenViews(reinterpret_cast<const uint64_t *>(header_buf));
+        return;
+    }
+    u64 alloc_size;
+    uint64_t *buf = static_cast<uint64_t *>(pages_alloc_best(header.word_count * sizeof(uint64_t), false, &alloc_size));
+    assert(buf != nullptr && "Could not allocate the frozen Diva");
+    memcpy(buf, &header, sizeof(header));
+    memcpy(buf + sizeof(header) / sizeof(uint64_t), source.Take(rest_len), rest_len);
+    frozen_alloc_size_ = alloc_size;
+    SetFrozenViews(buf);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline Diva<int_optimized, target_size, t_int, thread_policy, t_index>::~Diva() {
+    // Infix store buffers go away with the allocator's chunks
+    DestroyTree();
+    ReleaseFrozen();
+
+    if (qsbr_ != nullptr) {
+        qsbr_destroy(qsbr_);
+        delete[] store_locks_;
+    }
+    if (mapped_buf_ != nullptr)
+        munmap(const_cast<char *>(mapped_buf_), mapped_size_);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Session(Diva &diva): diva_(diva) {
+    static_assert(thread_policy == ThreadPolicy::Concurrent, "Sessions share the tree, which needs ThreadPolicy::Concurrent");
+    static_assert(wormhole_index, "Sessions lock the leaves of the wormholes, which other boundary indexes lack");
+    assert(!diva.IsFrozen() && "Sessions need a thawed Diva");
+    std::lock_guard<std::mutex> guard(diva_.session_mutex_);
+    diva_.SetupConcurrency();
+    if constexpr (int_optimized)
+        ref_ = wh_int_ref(diva_.wh_int_);
+    else
+        ref_ = wh_ref(diva_.wh_);
+    qsbr_register(diva_.qsbr_, &qref_);
+    qsbr_park(&qref_);
+    rng_.seed(diva_.rng_seed_ + ++diva_.session_count_);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::~Session() {
+    std::lock_guard<std::mutex> guard(diva_.session_mutex_);
+    qsbr_unregister(diva_.qsbr_, &qref_);
+    if constexpr (int_optimized)
+        wh_int_unref(ref_);
+    else
+        wh_unref(ref_);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Enter() {
+    qsbr_resume(&qref_);
+    // The resumed state has to be visible before any store buffer is read
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Exit() {
+    TreePark(ref_);
+    qsbr_park(&qref_);
+    if (diva_.retired_count_.load(std::memory_order_relaxed) >= reclaim_threshold)
+        diva_.ReclaimInfixStorePtrs();
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Backoff() {
+    // The store is held by another session, which may need the tree to move on
+    TreePark(ref_);
+    std::this_thread::yield();
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline typename Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InfiniteByteString Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::CopyKey(const InfiniteByteString key,
+                                                                                                                std::string &buf) {
+    buf.assign(reinterpret_cast<const char *>(key.str), key.length);
+    return {reinterpret_cast<const uint8_t *>(buf.data()), key.length};
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::TryLockInfixStore(StoreLock *lock, const bool write, uint64_t &version) {
+    if (write)
+        return TryLockStore(lock);
+    // Readers only snapshot the version and never write to the lock
+    version = ReadStoreVersion(lock);
+    return !(version & 1);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::LockInfixStore(TreeIter &it, const InfiniteByteString key, const bool write,
+                                                                                                     InfiniteByteString &prev_key, InfiniteByteString &next_key,
+                                                                                                     InfixStore *&infix_store_ptr, StoreLock *&lock,
+                                                                                                     uint64_t &version) {
+    // Expects `it` to be freshly seeked to `key`, with `next_key` and
+    // `infix_store_ptr` peeked from it. On success, the store covering `key` is
+    // write-locked, or for readers its version is read into `version`, and the
+    // iterator's leaf is left read-locked. On failure, nothing is held and the
+    // caller has to retry from the seek.
+    InfixStore *dummy_infix_store_ptr;
+    InfiniteByteString succ_key {};
+
+    if (next_key == key) {
+        // The store is locked before its successor is read, so that no split
+        // can slip a new boundary key in between
+        prev_key = next_key;
+        lock = diva_.GetStoreLock(prev_key);
+        if (!TryLockInfixStore(lock, write, version)) {
+            TreeIterUnlock(it);
+            return false;
+        }
+        TreeIterSkip1(it);
+        TreeIterPeek(it, next_key, dummy_infix_store_ptr);
+        next_key = CopyKey(next_key, next_key_buf_);
+        TreeIterSkip1Rev(it);
+        TreeIterPeek(it, prev_key, infix_store_ptr);
+#ifdef DEBUG
+        assert(prev_key == key);
 #endif
-            wh_int_put(better_tree_int_, key, key_length, &store, sizeof(store));
+        return true;
+    }
+
+    next_key = CopyKey(next_key, next_key_buf_);
+    const auto *next_leaf = it.leaf;
+    TreeIterSkip1Rev(it);
+    TreeIterPeek(it, prev_key, infix_store_ptr);
+    lock = diva_.GetStoreLock(prev_key);
+    if (!TryLockInfixStore(lock, write, version)) {
+        TreeIterUnlock(it);
+        return false;
+    }
+    if (it.leaf != next_leaf) {
+        // The next key's leaf was released on the way back, so the store may
+        // have been split before it got locked
+        TreeIterSkip1(it);
+        TreeIterPeek(it, succ_key, dummy_infix_store_ptr);
+        const bool valid = succ_key == next_key;
+        TreeIterSkip1Rev(it);
+        TreeIterPeek(it, prev_key, infix_store_ptr);
+        if (!valid) {
+            if (write)
+                UnlockStore(lock);
+            TreeIterUnlock(it);
+            return false;
         }
-        else
-            wh_put(better_tree_, key, key_length, &store, sizeof(store));
+    }
+    return true;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::MergeInfixStores(TreeIter &it, StoreLock *middle_lock) {
+    // Merges the store of the boundary key under `it` into its left neighbor.
+    // Both stores stay write-locked until the tree points to the merged store.
+    InfiniteByteString middle_key {};
+    InfiniteByteString left_key {};
+    InfiniteByteString right_key {};
+    InfiniteByteString succ_key {};
+    InfixStore *infix_store_ptr;
+
+    TreeIterPeek(it, middle_key, infix_store_ptr);
+    if (middle_lock == nullptr) {
+        middle_lock = diva_.GetStoreLock(middle_key);
+        if (!TryLockStore(middle_lock)) {
+            TreeIterUnlock(it);
+            return false;
+        }
+    }
+    const InfixStore store_r = *infix_store_ptr;
+    middle_key = CopyKey(middle_key, prev_key_buf_);
+    TreeIterSkip1(it);
+    TreeIterPeek(it, right_key, infix_store_ptr);
+    right_key = CopyKey(right_key, next_key_buf_);
+    TreeIterSkip1Rev(it);
+    TreeIterSkip1Rev(it);
+    TreeIterPeek(it, left_key, infix_store_ptr);
+
+    StoreLock *const left_lock = diva_.GetStoreLock(left_key);
+    if (left_lock != middle_lock && !TryLockStore(left_lock)) {
+        TreeIterUnlock(it);
+        UnlockStore(middle_lock);
+        return false;
+    }
+    const InfixStore store_l = *infix_store_ptr;
+    left_key = CopyKey(left_key, left_key_buf_);
+    TreeIterSkip1(it);
+    TreeIterPeek(it, succ_key, infix_store_ptr);
+    const bool valid = succ_key == middle_key;
+    TreeIterUnlock(it);
+    if (valid)
+        diva_.DeleteMergeInfixStores(left_key, middle_key, right_key, store_l, store_r, ref_);
+
+    if (left_lock != middle_lock)
+        UnlockStore(left_lock);
+    UnlockStore(middle_lock);
+    return valid;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Insert(t_int key) {
+    key = to_big_endian_order(key);
+    Insert(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Insert(std::string_view key) {
+    Insert(reinterpret_cast<const uint8_t *>(key.data()), key.size());
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Insert(const uint8_t *input_key, const uint32_t key_len) {
+    const InfiniteByteString key {input_key, key_len};
+    const bool split = rng_() % infix_store_target_size == 0;
+    InfixStore *infix_store_ptr;
+    StoreLock *lock;
+    uint64_t version;
+    TreeIter it;
+
+    Enter();
+    while (true) {
+        InfiniteByteString next_key {};
+        InfiniteByteString prev_key {};
+        TreeIterInit(it, ref_);
+        TreeIterSeek(it, key);
+        TreeIterPeek(it, next_key, infix_store_ptr);
+        if (!LockInfixStore(it, key, true, prev_key, next_key, infix_store_ptr, lock, version)) {
+            Backoff();
+            continue;
+        }
+
+        if (split) {
+            // The old store stays write-locked until both halves are in the
+            // tree, so its readers wait out the split
+            const InfixStore infix_store = *infix_store_ptr;
+            prev_key = CopyKey(prev_key, prev_key_buf_);
+            TreeIterUnlock(it);
+            if (!diva_.InsertSplitInfixStore(key, prev_key, next_key, infix_store, ref_)) {
+                InfixStore updated_store = infix_store;
+                diva_.InsertWithBoundaries(key, prev_key, next_key, updated_store);
+                TreePut(ref_, prev_key, updated_store);
+            }
+        }
+        else {
+            diva_.InsertWithBoundaries(key, prev_key, next_key, *infix_store_ptr);
+            TreeIterUnlock(it);
+        }
+        UnlockStore(lock);
+        break;
+    }
+    Exit();
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Delete(t_int key) {
+    key = to_big_endian_order(key);
+    Delete(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Delete(std::string_view input_key) {
+    Delete(reinterpret_cast<const uint8_t *>(input_key.data()), input_key.size());
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::Delete(const uint8_t *input_key, const uint32_t input_key_len) {
+    const InfiniteByteString key {input_key, input_key_len};
+    InfixStore *infix_store_ptr;
+    StoreLock *lock;
+    uint64_t version;
+    TreeIter it;
+
+    Enter();
+    while (true) {
+        InfiniteByteString next_key {};
+        InfiniteByteString prev_key {};
+        TreeIterInit(it, ref_);
+        TreeIterSeek(it, key);
+        TreeIterPeek(it, next_key, infix_store_ptr);
+        if (next_key == key && !infix_store_ptr->IsPartialKey()) {
+            if (!MergeInfixStores(it, nullptr)) {
+                Backoff();
+                continue;
+            }
+            break;
+        }
+        if (!LockInfixStore(it, key, true, prev_key, next_key, infix_store_ptr, lock, version)) {
+            Backoff();
+            continue;
+        }
+        if (!diva_.DeleteWithBoundaries(key, prev_key, next_key, *infix_store_ptr)) {
+            if (!MergeInfixStores(it, lock)) {
+                Backoff();
+                continue;
+            }
+            break;
+        }
+        TreeIterUnlock(it);
+        UnlockStore(lock);
+        break;
+    }
+    Exit();
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::RangeQuery(t_int l, t_int r) {
+    l = to_big_endian_order(l);
+    r = to_big_endian_order(r);
+    return RangeQuery(reinterpret_cast<const uint8_t *>(&l), sizeof(l),
+                      reinterpret_cast<const uint8_t *>(&r), sizeof(r));
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::RangeQuery(std::string_view input_l, std::string_view input_r) {
+    return RangeQuery(reinterpret_cast<const uint8_t *>(input_l.data()), input_l.size(),
+                      reinterpret_cast<const uint8_t *>(input_r.data()), input_r.size());
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::RangeQuery(const uint8_t *input_l, const uint32_t input_l_len,
+                                                                                                 const uint8_t *input_r, const uint32_t input_r_len) {
+    const InfiniteByteString l_key {input_l, input_l_len};
+    const InfiniteByteString r_key {input_r, input_r_len};
+    InfixStore *infix_store_ptr;
+    StoreLock *lock;
+    uint64_t version;
+    TreeIter it;
+    bool res;
+
+    Enter();
+    while (true) {
+        InfiniteByteString next_key {};
+        InfiniteByteString prev_key {};
+        TreeIterInit(it, ref_);
+        TreeIterSeek(it, l_key);
+        TreeIterPeek(it, next_key, infix_store_ptr);
+        if (next_key <= r_key) {
+            TreeIterUnlock(it);
+            res = true;
+            break;
+        }
+        if (!LockInfixStore(it, l_key, false, prev_key, next_key, infix_store_ptr, lock, version)) {
+            Backoff();
+            continue;
+        }
+        // The store is probed without holding anything, and the answer only
+        // counts if no writer touched the store in the meantime. Validating
+        // the snapshot first keeps its buffer pointer and size grade in sync.
+        InfixStore infix_store = *infix_store_ptr;
+        prev_key = CopyKey(prev_key, prev_key_buf_);
+        TreeIterUnlock(it);
+        if (!diva_.ValidateStoreVersion(lock, version)) {
+            Backoff();
+            continue;
+        }
+        res = diva_.RangeQueryWithBoundaries(l_key, r_key, prev_key, next_key, infix_store);
+        if (diva_.ValidateStoreVersion(lock, version))
+            break;
+        Backoff();
+    }
+    Exit();
+    return res;
+}
 
-        memcpy(&key_length, deser_buf + ind, sizeof(key_length));
-        ind += sizeof(key_length);
-    }
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::PointQuery(t_int key) {
+    key = to_big_endian_order(key);
+    return PointQuery(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
 }
 
 
-template <bool int_optimized>
-inline Diva<int_optimized>::~Diva() {
-    const uint8_t *tree_key;
-    uint32_t tree_key_len, dummy;
-    InfixStore *store;
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::PointQuery(std::string_view key) {
+    return PointQuery(reinterpret_cast<const uint8_t *>(key.data()), key.size());
+}
 
-    if constexpr (int_optimized) {
-        wormhole_int_iter it_int;
-        it_int.ref = better_tree_int_;
-        it_int.map = better_tree_int_->map;
-        it_int.leaf = nullptr;
-        it_int.is = 0;
-        for (wh_int_iter_seek(&it_int, nullptr, 0); wh_int_iter_valid(&it_int); wh_int_iter_skip1(&it_int)) {
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&tree_key), &tree_key_len, 
-                                          reinterpret_cast<void **>(&store), &dummy);
-            delete[] store->ptr;
-        }
-        if (it_int.leaf)
-            wormleaf_int_unlock_read(it_int.leaf);
-        wh_int_destroy(wh_int_);
-    }
-    else {
-        wormhole_iter it;
-        it.ref = better_tree_;
-        it.map = better_tree_->map;
-        it.leaf = nullptr;
-        it.is = 0;
-        for (wh_iter_seek(&it, nullptr, 0); wh_iter_valid(&it); wh_iter_skip1(&it)) {
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&tree_key), &tree_key_len, 
-                                  reinterpret_cast<void **>(&store), &dummy);
-            delete[] store->ptr;
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Session::PointQuery(const uint8_t *input_key, const uint32_t key_len) {
+    const InfiniteByteString key {input_key, key_len};
+    InfixStore *infix_store_ptr;
+    StoreLock *lock;
+    uint64_t version;
+    TreeIter it;
+    bool res;
+
+    Enter();
+    while (true) {
+        InfiniteByteString next_key {};
+        InfiniteByteString prev_key {};
+        TreeIterInit(it, ref_);
+        TreeIterSeek(it, key);
+        TreeIterPeek(it, next_key, infix_store_ptr);
+        if (next_key == key) {
+            TreeIterUnlock(it);
+            res = true;
+            break;
         }
-        if (it.leaf)
-            wormleaf_unlock_read(it.leaf);
-        wh_destroy(wh_);
+        if (!LockInfixStore(it, key, false, prev_key, next_key, infix_store_ptr, lock, version)) {
+            Backoff();
+            continue;
+        }
+        InfixStore infix_store = *infix_store_ptr;
+        prev_key = CopyKey(prev_key, prev_key_buf_);
+        TreeIterUnlock(it);
+        if (!diva_.ValidateStoreVersion(lock, version)) {
+            Backoff();
+            continue;
+        }
+        res = diva_.PointQueryWithBoundaries(key, prev_key, next_key, infix_store);
+        if (diva_.ValidateStoreVersion(lock, version))
+            break;
+        Backoff();
     }
+    Exit();
+    return res;
 }
 
 
-template <bool int_optimized>
-inline uint32_t Diva<int_optimized>::DeserializeMetadata(char *deser_buf) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DeserializeMetadata(const char *deser_buf) {
     uint32_t res = 0;
     uint32_t buf32;
     float buf_float;
@@ -1365,12 +3049,18 @@ inline uint32_t Diva<int_optimized>::DeserializeMetadata(char *deser_buf) {
     // Diva Version
     assert(static_cast<bool>(deser_buf[res]) == int_optimized && "Mismatched Diva version");
     res++;
+    assert(static_cast<uint8_t>(deser_buf[res]) == sizeof(t_int) && "Mismatched Diva version");
+    res++;
 
     // Global Metadata
     memcpy(&buf32, deser_buf + res, sizeof(infix_store_target_size));
     assert(buf32 == infix_store_target_size && "Mismatched Diva version");
     res += sizeof(infix_store_target_size);
 
+    memcpy(&buf32, deser_buf + res, sizeof(rank_block_size));
+    assert(buf32 == rank_block_size && "Mismatched Diva version");
+    res += sizeof(rank_block_size);
+
     memcpy(&buf32, deser_buf + res, sizeof(base_implicit_size));
     assert(buf32 == base_implicit_size && "Mismatched Diva version");
     res += sizeof(base_implicit_size);
@@ -1407,6 +3097,9 @@ inline uint32_t Diva<int_optimized>::DeserializeMetadata(char *deser_buf) {
     res += sizeof(rng_seed_);
     rng_.seed(rng_seed_);
 
+    memcpy(&shortest_separators_, deser_buf + res, sizeof(shortest_separators_));
+    res += sizeof(shortest_separators_);
+
     // Infix Store Metadata
     memcpy(&buf32, deser_buf + res, sizeof(InfixStore::size_grade_bit_count));
     assert(buf32 == InfixStore::size_grade_bit_count && "Mismatched Diva version");
@@ -1416,26 +3109,35 @@ inline uint32_t Diva<int_optimized>::DeserializeMetadata(char *deser_buf) {
     assert(buf32 == InfixStore::elem_count_bit_count && "Mismatched Diva version");
     res += sizeof(InfixStore::elem_count_bit_count);
 
-    return res;
+    return ((res + 7) / 8) * 8;
 }
 
 
-template <bool int_optimized>
-inline uint32_t Diva<int_optimized>::DeserializeInfixStore(char *deser_buf, Diva<int_optimized>::InfixStore& store) const {
-    memcpy(&store.status, deser_buf, sizeof(store.status));
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_source>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DeserializeInfixStore(t_source &source, Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InfixStore& store,
+                                                                                         const bool in_place) const {
+    memcpy(&store.status, source.Take(sizeof(store.status)), sizeof(store.status));
     const uint32_t word_count = store.GetPtrWordCount(scaled_sizes_[store.GetSizeGrade()], infix_size_);
-    store.ptr = reinterpret_cast<uint64_t *>(deser_buf + sizeof(store.status));
-    //store.ptr = new uint64_t[word_count];
-    //memcpy(store.ptr, deser_buf + sizeof(store.status), word_count * sizeof(uint64_t));
-    return sizeof(store.status) + word_count * sizeof(uint64_t);
+    const char *payload = source.Take(word_count * sizeof(uint64_t));
+    if (in_place) {
+        store.ptr = reinterpret_cast<uint64_t *>(const_cast<char *>(payload));
+#ifdef DEBUG
+        assert(reinterpret_cast<uintptr_t>(store.ptr) % alignof(uint64_t) == 0);
+#endif
+    }
+    else {
+        store.ptr = allocator_.Allocate(word_count);
+        memcpy(store.ptr, payload, word_count * sizeof(uint64_t));
+    }
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline uint64_t Diva<int_optimized>::ExtractPartialKey(const InfiniteByteString key,
-                                                       const uint32_t shared, const uint32_t ignore,
-                                                       const uint32_t implicit_size, const uint64_t msb) const {
+inline uint64_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ExtractPartialKey(const InfiniteByteString key,
+                                                                                                   const uint32_t shared, const uint32_t ignore,
+                                                                                                   const uint32_t implicit_size, const uint64_t msb) const {
     const uint32_t real_diff_pos = shared + ignore;
     uint64_t res = key.WordAt(real_diff_pos / 8);
     res >>= (63 - (implicit_size - 1) - infix_size_ - real_diff_pos % 8);
@@ -1445,82 +3147,35 @@ inline uint64_t Diva<int_optimized>::ExtractPartialKey(const InfiniteByteString
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::Delete(uint64_t key) {
-    key = __builtin_bswap64(key);
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Delete(t_int key) {
+    key = to_big_endian_order(key);
     Delete(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::Delete(std::string_view input_key) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Delete(std::string_view input_key) {
     Delete(reinterpret_cast<const uint8_t *>(input_key.data()), input_key.size());
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::Delete(const uint8_t *input_key, const uint32_t input_key_len) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::Delete(const uint8_t *input_key, const uint32_t input_key_len) {
+    assert(!IsFrozen() && "Thaw a frozen Diva before updating it");
     InfiniteByteString key {input_key, input_key_len};
 
     InfixStore *infix_store_ptr, *dummy_infix_store_ptr;
-    uint32_t dummy_val;
 
     InfiniteByteString next_key {};
     InfiniteByteString prev_key {};
 
-    wormhole_int_iter it_int;
-    wormhole_iter it;
-    if constexpr (int_optimized) {
-        it_int.ref = better_tree_int_;
-        it_int.map = better_tree_int_->map;
-        it_int.leaf = nullptr;
-        it_int.is = 0;
-        wh_int_iter_seek(&it_int, key.str, key.length);
-
-        wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                      reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key == key) {
-            if (!infix_store_ptr->IsPartialKey()) {
-                DeleteMerge(&it_int);
-                return;
-            }
-            prev_key = next_key;
-            wh_int_iter_skip1(&it_int);
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                          reinterpret_cast<void **>(&dummy_infix_store_ptr), &dummy_val);
-            wh_int_iter_skip1_rev(&it_int);
-        }
-        else {
-            wh_int_iter_skip1_rev(&it_int);
-            wh_int_iter_peek_ref(&it_int, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
-                                          reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        }
-    }
-    else {
-        it.ref = better_tree_;
-        it.map = better_tree_->map;
-        it.leaf = nullptr;
-        it.is = 0;
-        wh_iter_seek(&it, key.str, key.length);
-
-        wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                              reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        if (next_key == key) {
-            if (!infix_store_ptr->IsPartialKey()) {
-                DeleteMerge(&it);
-                return;
-            }
-            prev_key = next_key;
-            wh_iter_skip1(&it);
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&next_key.str), &next_key.length,
-                                  reinterpret_cast<void **>(&dummy_infix_store_ptr), &dummy_val);
-            wh_iter_skip1_rev(&it);
-        }
-        else {
-            wh_iter_skip1_rev(&it);
-            wh_iter_peek_ref(&it, reinterpret_cast<const void **>(&prev_key.str), &prev_key.length,
-                                  reinterpret_cast<void **>(&infix_store_ptr), &dummy_val);
-        }
+    TreeIter it;
+    TreeIterInit(it, GetTreeRef());
+    TreeIterSeekNear(it, key, prev_key, infix_store_ptr, next_key, dummy_infix_store_ptr);
+    if (prev_key == key && !infix_store_ptr->IsPartialKey()) {
+        DeleteMerge(&it);
+        return;
     }
 
 #ifdef DEBUG
@@ -1528,7 +3183,18 @@ inline void Diva<int_optimized>::Delete(const uint8_t *input_key, const uint32_t
     assert(key < next_key);
 #endif
 
-    InfixStore& infix_store = *infix_store_ptr;
+    if (!DeleteWithBoundaries(key, prev_key, next_key, *infix_store_ptr)) {
+        DeleteMerge(&it);
+        return;
+    }
+    TreeIterUnlock(it);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DeleteWithBoundaries(const InfiniteByteString key, const InfiniteByteString prev_key,
+                                                                                                  const InfiniteByteString next_key, InfixStore &infix_store) {
     auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(prev_key, next_key);
 
     const uint64_t extraction = ExtractPartialKey(key, shared, ignore, implicit_size, key.GetBit(shared));
@@ -1539,77 +3205,158 @@ inline void Diva<int_optimized>::Delete(const uint8_t *input_key, const uint32_t
 
     if (infix_store.IsPartialKey()) {
         const uint32_t longest_match_len = GetLongestMatchingInfixSize(infix_store, deletee);
-        if (longest_match_len == 0 || 8 * prev_key.length - infix_store.GetInvalidBits() 
-                                        > shared + ignore + implicit_size + longest_match_len - 1) {
-            if constexpr (int_optimized)
-                DeleteMerge(&it_int);
-            else
-                DeleteMerge(&it);
-            return;
+        // Only keys under the partial boundary key can be the one it stands for
+        if (longest_match_len == 0 || (prev_key.IsPrefixOf(key, infix_store.GetInvalidBits())
+                                       && 8 * prev_key.length - infix_store.GetInvalidBits() 
+                                            > shared + ignore + implicit_size + longest_match_len - 1)) {
+            // The partial boundary key itself has to go
+            return false;
         }
     }
 
-    if constexpr (int_optimized) {
-        if (it_int.leaf)
-            wormleaf_int_unlock_read(it_int.leaf);
-    }
-    else {
-        if (it.leaf)
-            wormleaf_unlock_read(it.leaf);
+    DeleteRawFromInfixStore(infix_store, deletee, total_implicit);
+    return true;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_itr>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DeleteBatch(const t_itr begin, const t_itr end) {
+    assert(!IsFrozen() && "Thaw a frozen Diva before updating it");
+    t_int int_buf;
+    auto get_key = [&int_buf](const t_itr key_it) {
+        return ToByteString(*key_it, int_buf);
+    };
+
+    // Deletions that remove a boundary key, and thus merge two infix stores,
+    // are deferred until every touched store has had its plain deletions
+    // applied through a single rebuild
+    const uint32_t key_count = std::distance(begin, end);
+    bool is_deferred[key_count];
+    t_itr key_it = begin;
+    uint32_t ind = 0;
+    while (key_it != end) {
+        InfixStore *infix_store_ptr;
+        InfiniteByteString next_key {};
+        InfiniteByteString prev_key {};
+        LocateInfixStore(get_key(key_it), prev_key, next_key, infix_store_ptr);
+        InfixStore& infix_store = *infix_store_ptr;
+
+        auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(prev_key, next_key);
+        const uint64_t next_implicit = ExtractPartialKey(next_key, shared, ignore, implicit_size, 1) >> infix_size_;
+        const uint64_t prev_implicit = ExtractPartialKey(prev_key, shared, ignore, implicit_size, 0) >> infix_size_;
+        const uint32_t total_implicit = next_implicit - prev_implicit + 1;
+
+        const uint32_t infix_count = infix_store.GetElemCount();
+        uint64_t infix_list[infix_count + 1];
+        bool is_deleted[infix_count + 1];
+        GetInfixList(infix_store, infix_list);
+        memset(is_deleted, 0, sizeof(is_deleted));
+
+        uint32_t deleted_count = 0;
+        for (; key_it != end; ++key_it, ind++) {
+            const InfiniteByteString key = get_key(key_it);
+            if (!(key < next_key))
+                break;
+#ifdef DEBUG
+            assert(prev_key <= key);
+#endif
+            is_deferred[ind] = key == prev_key && !infix_store.IsPartialKey();
+            if (is_deferred[ind])
+                continue;
+
+            const uint64_t extraction = ExtractPartialKey(key, shared, ignore, implicit_size, key.GetBit(shared));
+            const uint64_t deletee = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+            if (infix_store.IsPartialKey()) {
+                const uint32_t longest_match_len = GetLongestMatchingInfixSize(infix_store, deletee);
+                is_deferred[ind] = longest_match_len == 0 || (prev_key.IsPrefixOf(key, infix_store.GetInvalidBits())
+                                                              && 8 * prev_key.length - infix_store.GetInvalidBits() 
+                                                                   > shared + ignore + implicit_size + longest_match_len - 1);
+                if (is_deferred[ind])
+                    continue;
+            }
+
+            int32_t l = -1, r = infix_count, mid;
+            while (r - l > 1) {
+                mid = (l + r) / 2;
+                const uint64_t value = infix_list[mid] - (infix_list[mid] & -infix_list[mid]);
+                if (value <= deletee - 1)
+                    l = mid;
+                else
+                    r = mid;
+            }
+            for (int32_t match_pos = l; match_pos >= 0 && (infix_list[match_pos] >> infix_size_) == (deletee >> infix_size_);
+                    match_pos--) {
+                const uint64_t mask = ((infix_list[match_pos] & -infix_list[match_pos]) << 1) - 1;
+                if (!is_deleted[match_pos] && (infix_list[match_pos] | mask) == (deletee | mask)) {
+                    is_deleted[match_pos] = true;
+                    deleted_count++;
+                    break;
+                }
+            }
+        }
+
+        if (deleted_count == 0)
+            continue;
+        uint32_t write_head = 0;
+        for (int32_t i = 0; i < infix_count; i++) {
+            if (!is_deleted[i])
+                infix_list[write_head++] = infix_list[i];
+        }
+        InfixStore new_store = AllocateInfixStoreWithList(infix_list, write_head, total_implicit);
+        new_store.SetInvalidBits(infix_store.GetInvalidBits());
+        new_store.SetPartialKey(infix_store.IsPartialKey());
+        FreeInfixStorePtr(infix_store.ptr, GetInfixStoreWordCount(infix_store));
+        infix_store = new_store;
     }
 
-    DeleteRawFromInfixStore(infix_store, deletee, total_implicit);
+    ind = 0;
+    for (key_it = begin; key_it != end; ++key_it, ind++) {
+        if (is_deferred[ind]) {
+            const InfiniteByteString key = get_key(key_it);
+            Delete(key.str, key.length);
+        }
+    }
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::DeleteMerge(void *const it_inp) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DeleteMerge(void *const it_inp) {
     InfiniteByteString middle_key {};
     InfiniteByteString left_key {};
     InfiniteByteString right_key {};
     InfixStore *store_l, *store_r;
-    uint32_t dummy;
 
-    if constexpr (int_optimized) {
-        wormhole_int_iter *const it_int = reinterpret_cast<wormhole_int_iter *const>(it_inp);
-        wh_int_iter_peek_ref(it_int, reinterpret_cast<const void **>(&middle_key.str), &middle_key.length, 
-                                     reinterpret_cast<void **>(&store_r), &dummy);
-        wh_int_iter_skip1(it_int);
-        wh_int_iter_peek_ref(it_int, reinterpret_cast<const void **>(&right_key.str), &right_key.length, 
-                                     reinterpret_cast<void **>(&store_l), &dummy);
-        wh_int_iter_skip1_rev(it_int);
-        wh_int_iter_skip1_rev(it_int);
-        wh_int_iter_peek_ref(it_int, reinterpret_cast<const void **>(&left_key.str), &left_key.length, 
-                                     reinterpret_cast<void **>(&store_l), &dummy);
-        if (it_int->leaf)
-            wormleaf_int_unlock_read(it_int->leaf);
-    }
-    else {
-        wormhole_iter *const it = reinterpret_cast<wormhole_iter *const>(it_inp);
-        wh_iter_peek_ref(it, reinterpret_cast<const void **>(&middle_key.str), &middle_key.length, 
-                             reinterpret_cast<void **>(&store_r), &dummy);
-        wh_iter_skip1(it);
-        wh_iter_peek_ref(it, reinterpret_cast<const void **>(&right_key.str), &right_key.length, 
-                             reinterpret_cast<void **>(&store_l), &dummy);
-        wh_iter_skip1_rev(it);
-        wh_iter_skip1_rev(it);
-        wh_iter_peek_ref(it, reinterpret_cast<const void **>(&left_key.str), &left_key.length, 
-                             reinterpret_cast<void **>(&store_l), &dummy);
-        if (it->leaf)
-            wormleaf_unlock_read(it->leaf);
-    }
+    TreeIter &it = *reinterpret_cast<TreeIter *>(it_inp);
+    TreeIterPeek(it, middle_key, store_r);
+    TreeIterSkip1(it);
+    TreeIterPeek(it, right_key, store_l);
+    TreeIterSkip1Rev(it);
+    TreeIterSkip1Rev(it);
+    TreeIterPeek(it, left_key, store_l);
+    TreeIterUnlock(it);
+
+    DeleteMergeInfixStores(left_key, middle_key, right_key, *store_l, *store_r, GetTreeRef());
+}
+
 
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DeleteMergeInfixStores(const InfiniteByteString left_key,
+                                                                                                    const InfiniteByteString middle_key,
+                                                                                                    const InfiniteByteString right_key,
+                                                                                                    const InfixStore store_l, const InfixStore store_r,
+                                                                                                    TreeRef *ref) {
     auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(left_key, right_key);
 
-    uint32_t total_elem_count = store_l->GetElemCount() + store_r->GetElemCount();
+    uint32_t total_elem_count = store_l.GetElemCount() + store_r.GetElemCount();
     uint64_t infix_list[total_elem_count];
-    GetInfixList(*store_l, infix_list);
-    GetInfixList(*store_r, infix_list + store_l->GetElemCount());
+    GetInfixList(store_l, infix_list);
+    GetInfixList(store_r, infix_list + store_l.GetElemCount());
 
     UpdateInfixListDelete(shared, ignore, implicit_size, left_key, middle_key,
-                          infix_list, store_l->GetElemCount());
+                          infix_list, store_l.GetElemCount());
     UpdateInfixListDelete(shared, ignore, implicit_size, middle_key, right_key,
-                          infix_list + store_l->GetElemCount(), store_r->GetElemCount());
+                          infix_list + store_l.GetElemCount(), store_r.GetElemCount());
     const uint64_t implicit = ExtractPartialKey(left_key, shared, ignore, implicit_size, 0) >> infix_size_;
     for (int32_t i = 0; i < total_elem_count; i++)
         infix_list[i] -= implicit << infix_size_;
@@ -1622,30 +3369,25 @@ inline void Diva<int_optimized>::DeleteMerge(void *const it_inp) {
     }
 #endif
 
-    delete[] store_l->ptr;
-    delete[] store_r->ptr;
-    if constexpr (int_optimized)
-        wh_int_del(better_tree_int_, middle_key.str, middle_key.length);
-    else
-        wh_del(better_tree_, middle_key.str, middle_key.length);
-
     const uint64_t left_extraction = ExtractPartialKey(left_key, shared, ignore, implicit_size, 0);
     const uint64_t right_extraction = ExtractPartialKey(right_key, shared, ignore, implicit_size, 1);
     const uint32_t total_implicit = ((right_extraction >> infix_size_) - (left_extraction >> infix_size_)) + 1;
 
     InfixStore store = AllocateInfixStoreWithList(infix_list, total_elem_count, total_implicit);
-    store.SetPartialKey(store_l->IsPartialKey());
-    store.SetInvalidBits(store_l->GetInvalidBits());
-    if constexpr (int_optimized)
-        wh_int_put(better_tree_int_, left_key.str, left_key.length, reinterpret_cast<const void *>(&store), sizeof(InfixStore));
-    else
-        wh_put(better_tree_, left_key.str, left_key.length, reinterpret_cast<const void *>(&store), sizeof(InfixStore));
+    store.SetPartialKey(store_l.IsPartialKey());
+    store.SetInvalidBits(store_l.GetInvalidBits());
+
+    FreeInfixStorePtr(store_l.ptr, GetInfixStoreWordCount(store_l));
+    FreeInfixStorePtr(store_r.ptr, GetInfixStoreWordCount(store_r));
+    // Overwriting the left key first keeps both keys in place until the delete
+    TreePut(ref, left_key, store);
+    TreeDel(ref, middle_key);
 }
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::UpdateInfixListDelete(const uint32_t shared, const uint32_t ignore, const uint32_t implicit_size,
-                                                           const InfiniteByteString left_key, const InfiniteByteString right_key,
-                                                           uint64_t *infix_list, const uint32_t infix_list_len) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::UpdateInfixListDelete(const uint32_t shared, const uint32_t ignore, const uint32_t implicit_size,
+                                                                               const InfiniteByteString left_key, const InfiniteByteString right_key,
+                                                                               uint64_t *infix_list, const uint32_t infix_list_len) {
     const uint32_t shared_word_byte = (shared / 64) * 8;
 
     auto [old_shared, old_ignore, old_implicit_size] = GetSharedIgnoreImplicitLengths(
@@ -1723,23 +3465,40 @@ inline void Diva<int_optimized>::UpdateInfixListDelete(const uint32_t shared, co
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 template <class t_itr>
-inline void Diva<int_optimized>::BulkLoadFixedLength(const t_itr begin, const t_itr end, const uint32_t key_len) {
-    uint64_t infix_list[infix_store_target_size], int_opt_buf[3];
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::BulkLoadFixedLength(const t_itr begin, const t_itr end, const uint32_t key_len,
+                                                                                                 const uint32_t thread_count) {
+    uint64_t infix_list[infix_store_target_size];
+    t_int int_opt_buf[3];
     t_itr last_key_it = begin, key_it = begin;
     InfiniteByteString left_key {}, right_key {};
+    uint64_t cnt = 1;
+    if (thread_count > 1) {
+        auto get_key = [key_len](const t_itr key_it, t_int &int_buf) -> InfiniteByteString {
+            if constexpr (int_optimized) {
+                int_buf = to_big_endian_order(static_cast<t_int>(*key_it));
+                return {reinterpret_cast<const uint8_t *>(&int_buf), key_len};
+            }
+            else
+                return {reinterpret_cast<const uint8_t *>(&(*key_it)), key_len};
+        };
+        const uint64_t store_count = (std::distance(begin, end) - 1) / infix_store_target_size;
+        BulkLoadFullStores(begin, store_count, thread_count, get_key);
+        std::advance(key_it, store_count * infix_store_target_size);
+        last_key_it = key_it;
+        cnt += store_count * infix_store_target_size;
+    }
     if constexpr (int_optimized) {
-        int_opt_buf[0] = __builtin_bswap64(*key_it);
+        int_opt_buf[0] = to_big_endian_order(static_cast<t_int>(*key_it));
         left_key = {reinterpret_cast<const uint8_t *>(int_opt_buf + 0), key_len};
     }
     else
         left_key = {reinterpret_cast<const uint8_t *>(&(*key_it)), key_len};
-    int32_t cnt = 1;
     for (++key_it; key_it != end; ++key_it) {
         if (cnt % infix_store_target_size == 0) {   // New boundary key
             if constexpr (int_optimized) {
-                int_opt_buf[1] = __builtin_bswap64(*key_it);
+                int_opt_buf[1] = to_big_endian_order(static_cast<t_int>(*key_it));
                 right_key = {reinterpret_cast<const uint8_t *>(int_opt_buf + 1), key_len};
             }
             else
@@ -1753,7 +3512,7 @@ inline void Diva<int_optimized>::BulkLoadFixedLength(const t_itr begin, const t_
             for (int32_t i = 0; i < infix_store_target_size - 1; i++) {
                 InfiniteByteString key;
                 if constexpr (int_optimized) {
-                    int_opt_buf[2] = __builtin_bswap64(*last_key_it);
+                    int_opt_buf[2] = to_big_endian_order(static_cast<t_int>(*last_key_it));
                     key = {reinterpret_cast<const uint8_t *>(int_opt_buf + 2), key_len};
                 }
                 else 
@@ -1763,12 +3522,9 @@ inline void Diva<int_optimized>::BulkLoadFixedLength(const t_itr begin, const t_
                 ++last_key_it;
             }
 
-            InfixStore store(scaled_sizes_[size_scalar_shrink_grow_sep], infix_size_);
+            InfixStore store(allocator_, scaled_sizes_[size_scalar_shrink_grow_sep], infix_size_);
             LoadListToInfixStore(store, infix_list, infix_store_target_size - 1, total_implicit);
-            if constexpr (int_optimized)
-                wh_int_put(better_tree_int_, left_key.str, left_key.length, &store, sizeof(store));
-            else
-                wh_put(better_tree_, left_key.str, left_key.length, &store, sizeof(store));
+            TreePut(GetTreeRef(), left_key, store);
 
             if constexpr (int_optimized)
                 int_opt_buf[0] = int_opt_buf[1];
@@ -1781,7 +3537,7 @@ inline void Diva<int_optimized>::BulkLoadFixedLength(const t_itr begin, const t_
     // Add what was left from the loop
     key_it--;
     if constexpr (int_optimized) {
-        int_opt_buf[1] = __builtin_bswap64(*key_it);
+        int_opt_buf[1] = to_big_endian_order(static_cast<t_int>(*key_it));
         right_key = {reinterpret_cast<const uint8_t *>(int_opt_buf + 1), key_len};
     }
     else
@@ -1797,7 +3553,7 @@ inline void Diva<int_optimized>::BulkLoadFixedLength(const t_itr begin, const t_
     while (last_key_it != key_it) {
         InfiniteByteString key;
         if constexpr (int_optimized) {
-            int_opt_buf[2] = __builtin_bswap64(*last_key_it);
+            int_opt_buf[2] = to_big_endian_order(static_cast<t_int>(*last_key_it));
             key = {reinterpret_cast<const uint8_t *>(int_opt_buf + 2), key_len};
         }
         else 
@@ -1808,12 +3564,9 @@ inline void Diva<int_optimized>::BulkLoadFixedLength(const t_itr begin, const t_
     }
 
     const uint32_t size_scalar = std::lower_bound(scaled_sizes_, scaled_sizes_ + size_scalar_count, i) - scaled_sizes_;
-    InfixStore store(scaled_sizes_[size_scalar], infix_size_, size_scalar);
+    InfixStore store(allocator_, scaled_sizes_[size_scalar], infix_size_, size_scalar);
     LoadListToInfixStore(store, infix_list, i, total_implicit);
-    if constexpr (int_optimized)
-        wh_int_put(better_tree_int_, left_key.str, left_key.length, &store, sizeof(store));
-    else
-        wh_put(better_tree_, left_key.str, left_key.length, &store, sizeof(store));
+    TreePut(GetTreeRef(), left_key, store);
 
     if (add_last_key)
         AddTreeKey(right_key.str, right_key.length);
@@ -1824,45 +3577,96 @@ inline void Diva<int_optimized>::BulkLoadFixedLength(const t_itr begin, const t_
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 template <class t_itr>
-inline void Diva<int_optimized>::BulkLoad(const t_itr begin, const t_itr end) {
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::BulkLoad(const t_itr begin, const t_itr end, const uint32_t thread_count) {
     uint64_t infix_list[infix_store_target_size];
     t_itr last_key_it = begin, key_it = begin;
-    std::string_view sv {*key_it};
+    uint64_t cnt = 1;
+    uint32_t max_len = 0;
+    std::string_view sv;
+    if (thread_count > 1) {
+        auto get_key = [](const t_itr key_it, t_int &int_buf) -> InfiniteByteString {
+            const std::string_view sv {*key_it};
+            return {reinterpret_cast<const uint8_t *>(sv.data()), static_cast<uint32_t>(sv.size())};
+        };
+        // Cutting a boundary key looks at the key after it, which has to exist
+        const uint64_t store_count = (std::distance(begin, end) - 1 - shortest_separators_) / infix_store_target_size;
+        max_len = BulkLoadFullStores(begin, store_count, thread_count, get_key);
+        if (store_count > 0) {
+            std::advance(key_it, store_count * infix_store_target_size - 1);
+            sv = *key_it;
+            ++key_it;
+        }
+        last_key_it = key_it;
+        cnt += store_count * infix_store_target_size;
+    }
+    std::vector<uint8_t> left_buf, right_buf;
+    const std::string_view prev_sv = sv;
+    sv = *key_it;
     InfiniteByteString left_key {reinterpret_cast<const uint8_t *>(sv.data()), 
                                  static_cast<uint32_t>(sv.size())};
-    InfiniteByteString right_key {};
-    int32_t cnt = 1;
-    uint32_t max_len = sv.size();
+    InfiniteByteString left_first = left_key, right_key {};
+    uint32_t left_cut = 0, right_cut = 0;
+    if (shortest_separators_ && key_it != begin && std::next(key_it) != end) {
+        const std::string_view next_sv = *std::next(key_it);
+        left_cut = GetSeparatorLength({reinterpret_cast<const uint8_t *>(prev_sv.data()), static_cast<uint32_t>(prev_sv.size())},
+                                      left_key,
+                                      {reinterpret_cast<const uint8_t *>(next_sv.data()), static_cast<uint32_t>(next_sv.size())});
+        if (left_cut > 0) {
+            left_buf.resize((left_cut + 7) / 8);
+            left_key = TruncateKey(left_key, left_cut, left_buf.data());
+        }
+    }
+    max_len = std::max<uint32_t>(max_len, sv.size());
     for (++key_it; key_it != end; ++key_it) {
         if (cnt % infix_store_target_size == 0) {   // New boundary key
+            const InfiniteByteString prev_key {reinterpret_cast<const uint8_t *>(sv.data()), 
+                                               static_cast<uint32_t>(sv.size())};
             std::string_view sv = *key_it;
             right_key = {reinterpret_cast<const uint8_t *>(sv.data()), 
                          static_cast<uint32_t>(sv.size())};
+            const InfiniteByteString right_first = right_key;
+            right_cut = 0;
+            if (shortest_separators_ && std::next(key_it) != end) {
+                sv = *std::next(key_it);
+                right_cut = GetSeparatorLength(prev_key, right_key,
+                                               {reinterpret_cast<const uint8_t *>(sv.data()), static_cast<uint32_t>(sv.size())});
+                if (right_cut > 0) {
+                    right_buf.resize((right_cut + 7) / 8);
+                    right_key = TruncateKey(right_key, right_cut, right_buf.data());
+                }
+            }
 
             auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(left_key, right_key);
             const uint64_t prev_implicit = ExtractPartialKey(left_key, shared, ignore, implicit_size, 0) >> infix_size_;
             const uint64_t next_implicit = ExtractPartialKey(right_key, shared, ignore, implicit_size, 1) >> infix_size_;
             const uint32_t total_implicit = next_implicit - prev_implicit + 1;
+            int32_t i = 0;
+            if (left_cut > 0) {
+                const uint64_t extraction = ExtractPartialKey(left_first, shared, ignore, implicit_size, left_first.GetBit(shared));
+                infix_list[i++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+            }
             ++last_key_it;
-            for (int32_t i = 0; i < infix_store_target_size - 1; i++) {
+            for (int32_t k = 0; k < infix_store_target_size - 1; k++) {
                 sv = *last_key_it;
                 const InfiniteByteString key {reinterpret_cast<const uint8_t *>(sv.data()), 
                                               static_cast<uint32_t>(sv.size())};
                 const uint64_t extraction = ExtractPartialKey(key, shared, ignore, implicit_size, key.GetBit(shared));
-                infix_list[i] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+                infix_list[i++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
                 ++last_key_it;
             }
 
-            InfixStore store(scaled_sizes_[size_scalar_shrink_grow_sep], infix_size_);
-            LoadListToInfixStore(store, infix_list, infix_store_target_size - 1, total_implicit);
-            if constexpr (int_optimized)
-                wh_int_put(better_tree_int_, left_key.str, left_key.length, &store, sizeof(store));
-            else
-                wh_put(better_tree_, left_key.str, left_key.length, &store, sizeof(store));
+            InfixStore store(allocator_, scaled_sizes_[size_scalar_shrink_grow_sep], infix_size_);
+            LoadListToInfixStore(store, infix_list, i, total_implicit);
+            if (left_cut > 0)
+                SetPartialBoundary(store, left_cut);
+            TreePut(GetTreeRef(), left_key, store);
 
             left_key = right_key;
+            left_first = right_first;
+            left_cut = right_cut;
+            std::swap(left_buf, right_buf);
         }
         sv = *key_it;
         max_len = std::max<uint32_t>(max_len, sv.size());
@@ -1881,6 +3685,10 @@ inline void Diva<int_optimized>::BulkLoad(const t_itr begin, const t_itr end) {
     const uint64_t next_implicit = ExtractPartialKey(right_key, shared, ignore, implicit_size, 1) >> infix_size_;
     const uint32_t total_implicit = next_implicit - prev_implicit + 1;
     int32_t i = 0;
+    if (left_cut > 0) {
+        const uint64_t extraction = ExtractPartialKey(left_first, shared, ignore, implicit_size, left_first.GetBit(shared));
+        infix_list[i++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+    }
     ++last_key_it;
     while (last_key_it != key_it) {
         sv = *last_key_it;
@@ -1892,12 +3700,11 @@ inline void Diva<int_optimized>::BulkLoad(const t_itr begin, const t_itr end) {
     }
 
     const uint32_t size_scalar = std::lower_bound(scaled_sizes_, scaled_sizes_ + size_scalar_count, i) - scaled_sizes_;
-    InfixStore store(scaled_sizes_[size_scalar], infix_size_, size_scalar);
+    InfixStore store(allocator_, scaled_sizes_[size_scalar], infix_size_, size_scalar);
     LoadListToInfixStore(store, infix_list, i, total_implicit);
-    if constexpr (int_optimized)
-        wh_int_put(better_tree_int_, left_key.str, left_key.length, &store, sizeof(store));
-    else
-        wh_put(better_tree_, left_key.str, left_key.length, &store, sizeof(store));
+    if (left_cut > 0)
+        SetPartialBoundary(store, left_cut);
+    TreePut(GetTreeRef(), left_key, store);
 
     if (add_last_key)
         AddTreeKey(right_key.str, right_key.length);
@@ -1908,31 +3715,133 @@ inline void Diva<int_optimized>::BulkLoad(const t_itr begin, const t_itr end) {
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::BulkLoadStreaming(uint64_t key) {
-    key = __builtin_bswap64(key);
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <class t_itr, class t_key_fn>
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::BulkLoadFullStores(const t_itr begin, const uint64_t store_count,
+                                                                                                    const uint32_t thread_count, t_key_fn get_key) {
+    // Builds the first `store_count` full infix stores of a bulk load, each
+    // thread taking a contiguous run of them, and then puts them into the tree
+    // in order. Returns the length of the longest left boundary or infix key.
+    // Boundary keys are cut as in the sequential part, so with shortest
+    // separators the key after the last right boundary has to exist
+    if (store_count == 0)
+        return 0;
+    std::vector<InfixStore> stores(store_count);
+    std::vector<std::vector<uint8_t>> cut_keys(shortest_separators_ ? store_count : 0);
+    std::vector<uint32_t> max_lens(thread_count, 0);
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < thread_count; i++) {
+        threads.emplace_back([&, i]() {
+            uint64_t infix_list[infix_store_target_size];
+            t_int int_opt_buf[5];
+            std::vector<uint8_t> right_buf;
+            const uint64_t store_begin = store_count * i / thread_count;
+            const uint64_t store_end = store_count * (i + 1) / thread_count;
+            t_itr key_it = std::next(begin, store_begin * infix_store_target_size);
+            InfiniteByteString left_key;
+            uint32_t left_cut = 0;
+            if (shortest_separators_ && store_begin > 0) {
+                left_key = get_key(key_it, int_opt_buf[0]);
+                left_cut = GetSeparatorLength(get_key(std::next(begin, store_begin * infix_store_target_size - 1), int_opt_buf[3]),
+                                              left_key, get_key(std::next(key_it), int_opt_buf[4]));
+                if (left_cut > 0) {
+                    cut_keys[store_begin].resize((left_cut + 7) / 8);
+                    left_key = TruncateKey(left_key, left_cut, cut_keys[store_begin].data());
+                }
+            }
+            for (uint64_t j = store_begin; j < store_end; j++) {
+                const InfiniteByteString left_first = get_key(key_it, int_opt_buf[0]);
+                if (left_cut == 0)
+                    left_key = left_first;
+                const t_itr right_it = std::next(key_it, infix_store_target_size);
+                InfiniteByteString right_key = get_key(right_it, int_opt_buf[1]);
+                uint32_t right_cut = 0;
+                if (shortest_separators_) {
+                    right_cut = GetSeparatorLength(get_key(std::next(key_it, infix_store_target_size - 1), int_opt_buf[3]),
+                                                   right_key, get_key(std::next(right_it), int_opt_buf[4]));
+                    if (right_cut > 0) {
+                        right_buf.resize((right_cut + 7) / 8);
+                        right_key = TruncateKey(right_key, right_cut, right_buf.data());
+                    }
+                }
+                max_lens[i] = std::max(max_lens[i], left_first.length);
+
+                auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(left_key, right_key);
+                const uint64_t prev_implicit = ExtractPartialKey(left_key, shared, ignore, implicit_size, 0) >> infix_size_;
+                const uint64_t next_implicit = ExtractPartialKey(right_key, shared, ignore, implicit_size, 1) >> infix_size_;
+                const uint32_t total_implicit = next_implicit - prev_implicit + 1;
+                int32_t list_len = 0;
+                if (left_cut > 0) {
+                    const uint64_t extraction = ExtractPartialKey(left_first, shared, ignore, implicit_size, left_first.GetBit(shared));
+                    infix_list[list_len++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+                }
+                ++key_it;
+                for (int32_t k = 0; k < infix_store_target_size - 1; k++) {
+                    const InfiniteByteString key = get_key(key_it, int_opt_buf[2]);
+                    max_lens[i] = std::max(max_lens[i], key.length);
+                    const uint64_t extraction = ExtractPartialKey(key, shared, ignore, implicit_size, key.GetBit(shared));
+                    infix_list[list_len++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+                    ++key_it;
+                }
+
+                stores[j] = InfixStore(allocator_, scaled_sizes_[size_scalar_shrink_grow_sep], infix_size_);
+                LoadListToInfixStore(stores[j], infix_list, list_len, total_implicit);
+                if (left_cut > 0)
+                    SetPartialBoundary(stores[j], left_cut);
+
+                left_cut = j + 1 < store_end ? right_cut : 0;
+                if (left_cut > 0) {
+                    cut_keys[j + 1] = right_buf;
+                    left_key = {cut_keys[j + 1].data(), right_key.length};
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    TreeRef *ref = GetTreeRef();
+    t_itr key_it = begin;
+    t_int int_buf;
+    for (uint64_t j = 0; j < store_count; j++) {
+        if (stores[j].IsPartialKey())
+            TreePut(ref, {cut_keys[j].data(), static_cast<uint32_t>(cut_keys[j].size())}, stores[j]);
+        else
+            TreePut(ref, get_key(key_it, int_buf), stores[j]);
+        std::advance(key_it, infix_store_target_size);
+    }
+    return *std::max_element(max_lens.begin(), max_lens.end());
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::BulkLoadStreaming(t_int key) {
+    key = to_big_endian_order(key);
     BulkLoadStreaming(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::BulkLoadStreaming(std::string_view key) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::BulkLoadStreaming(std::string_view key) {
     BulkLoadStreaming(reinterpret_cast<const uint8_t *>(key.data()), key.size());
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::BulkLoadStreaming(const uint8_t *key, const uint32_t key_len) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::BulkLoadStreaming(const uint8_t *key, const uint32_t key_len) {
+    assert(!IsFrozen() && "Thaw a frozen Diva before updating it");
     uint8_t *key_copy = new uint8_t[key_len];
     memcpy(key_copy, key, key_len);
 
     if (bulk_load_left_key_.str == nullptr) {
         bulk_load_left_key_ = {key_copy, key_len};
+        bulk_load_left_cut_ = 0;
         bulk_load_streaming_max_len_ = key_len;
         return;
     }
     bulk_load_streaming_max_len_ = std::max(bulk_load_streaming_max_len_, key_len);
-    if (bulk_load_streaming_ind_ < infix_store_target_size - 1) {
+    // A boundary key is only cut once the key after it comes in
+    if (bulk_load_streaming_ind_ < infix_store_target_size - 1 + shortest_separators_) {
         delete[] bulk_load_key_list_[bulk_load_streaming_ind_].str;
         bulk_load_key_list_[bulk_load_streaming_ind_] = {key_copy, key_len};
         bulk_load_streaming_ind_++;
@@ -1940,31 +3849,54 @@ inline void Diva<int_optimized>::BulkLoadStreaming(const uint8_t *key, const uin
     }
 
     InfiniteByteString bulk_load_right_key {key_copy, key_len};
+    uint32_t right_cut = 0;
+    if (shortest_separators_) {
+        const InfiniteByteString next_key = bulk_load_right_key;
+        bulk_load_streaming_ind_--;
+        bulk_load_right_key = bulk_load_key_list_[bulk_load_streaming_ind_];
+        right_cut = GetSeparatorLength(bulk_load_key_list_[bulk_load_streaming_ind_ - 1], bulk_load_right_key, next_key);
+        bulk_load_key_list_[bulk_load_streaming_ind_] = next_key;
+    }
+    uint8_t left_buf[bulk_load_left_key_.length], right_buf[bulk_load_right_key.length];
+    const InfiniteByteString left_key = bulk_load_left_cut_ > 0 ? TruncateKey(bulk_load_left_key_, bulk_load_left_cut_, left_buf)
+                                                                : bulk_load_left_key_;
+    const InfiniteByteString right_key = right_cut > 0 ? TruncateKey(bulk_load_right_key, right_cut, right_buf)
+                                                       : bulk_load_right_key;
 
     uint64_t infix_list[infix_store_target_size];
-    auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(bulk_load_left_key_, bulk_load_right_key);
-    const uint64_t prev_implicit = ExtractPartialKey(bulk_load_left_key_, shared, ignore, implicit_size, 0) >> infix_size_;
-    const uint64_t next_implicit = ExtractPartialKey(bulk_load_right_key, shared, ignore, implicit_size, 1) >> infix_size_;
+    auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(left_key, right_key);
+    const uint64_t prev_implicit = ExtractPartialKey(left_key, shared, ignore, implicit_size, 0) >> infix_size_;
+    const uint64_t next_implicit = ExtractPartialKey(right_key, shared, ignore, implicit_size, 1) >> infix_size_;
     const uint32_t total_implicit = next_implicit - prev_implicit + 1;
+    int32_t list_len = 0;
+    if (bulk_load_left_cut_ > 0) {
+        const uint64_t extraction = ExtractPartialKey(bulk_load_left_key_, shared, ignore, implicit_size, bulk_load_left_key_.GetBit(shared));
+        infix_list[list_len++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+    }
     for (int32_t i = 0; i < bulk_load_streaming_ind_; i++) {
         const uint64_t extraction = ExtractPartialKey(bulk_load_key_list_[i], shared, ignore, implicit_size, bulk_load_key_list_[i].GetBit(shared));
-        infix_list[i] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+        infix_list[list_len++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
     }
-    InfixStore store(scaled_sizes_[size_scalar_shrink_grow_sep], infix_size_);
-    LoadListToInfixStore(store, infix_list, bulk_load_streaming_ind_, total_implicit);
-    if constexpr (int_optimized)
-        wh_int_put(better_tree_int_, bulk_load_left_key_.str, bulk_load_left_key_.length, &store, sizeof(store));
-    else
-        wh_put(better_tree_, bulk_load_left_key_.str, bulk_load_left_key_.length, &store, sizeof(store));
+    InfixStore store(allocator_, scaled_sizes_[size_scalar_shrink_grow_sep], infix_size_);
+    LoadListToInfixStore(store, infix_list, list_len, total_implicit);
+    if (bulk_load_left_cut_ > 0)
+        SetPartialBoundary(store, bulk_load_left_cut_);
+    TreePut(GetTreeRef(), left_key, store);
 
     delete[] bulk_load_left_key_.str;
     bulk_load_left_key_ = bulk_load_right_key;
+    bulk_load_left_cut_ = right_cut;
     bulk_load_streaming_ind_ = 0;
+    if (shortest_separators_) {
+        // The key after the boundary is the first one of the next store
+        std::swap(bulk_load_key_list_[0], bulk_load_key_list_[infix_store_target_size - 1]);
+        bulk_load_streaming_ind_ = 1;
+    }
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::BulkLoadStreamingFinish() {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::BulkLoadStreamingFinish() {
     uint8_t *key_copy = new uint8_t[bulk_load_streaming_max_len_];
     memset(key_copy, 0x00, bulk_load_streaming_max_len_);
     AddTreeKey(key_copy, bulk_load_streaming_max_len_);
@@ -1977,22 +3909,29 @@ inline void Diva<int_optimized>::BulkLoadStreamingFinish() {
         bulk_load_key_list_[bulk_load_streaming_ind_ - 1] = {};
         bulk_load_streaming_ind_--;
 
+        uint8_t left_buf[bulk_load_left_key_.length];
+        const InfiniteByteString left_key = bulk_load_left_cut_ > 0 ? TruncateKey(bulk_load_left_key_, bulk_load_left_cut_, left_buf)
+                                                                    : bulk_load_left_key_;
         uint64_t infix_list[infix_store_target_size];
-        auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(bulk_load_left_key_, bulk_load_right_key);
-        const uint64_t prev_implicit = ExtractPartialKey(bulk_load_left_key_, shared, ignore, implicit_size, 0) >> infix_size_;
+        auto [shared, ignore, implicit_size] = GetSharedIgnoreImplicitLengths(left_key, bulk_load_right_key);
+        const uint64_t prev_implicit = ExtractPartialKey(left_key, shared, ignore, implicit_size, 0) >> infix_size_;
         const uint64_t next_implicit = ExtractPartialKey(bulk_load_right_key, shared, ignore, implicit_size, 1) >> infix_size_;
         const uint32_t total_implicit = next_implicit - prev_implicit + 1;
+        int32_t list_len = 0;
+        if (bulk_load_left_cut_ > 0) {
+            const uint64_t extraction = ExtractPartialKey(bulk_load_left_key_, shared, ignore, implicit_size, bulk_load_left_key_.GetBit(shared));
+            infix_list[list_len++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+        }
         for (int32_t i = 0; i < bulk_load_streaming_ind_; i++) {
             const uint64_t extraction = ExtractPartialKey(bulk_load_key_list_[i], shared, ignore, implicit_size, bulk_load_key_list_[i].GetBit(shared));
-            infix_list[i] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
+            infix_list[list_len++] = ((extraction | 1ULL) - (prev_implicit << infix_size_));
         }
-        const uint32_t size_scalar = std::lower_bound(scaled_sizes_, scaled_sizes_ + size_scalar_count, bulk_load_streaming_ind_) - scaled_sizes_;
-        InfixStore store(scaled_sizes_[size_scalar], infix_size_, size_scalar);
-        LoadListToInfixStore(store, infix_list, bulk_load_streaming_ind_, total_implicit);
-        if constexpr (int_optimized)
-            wh_int_put(better_tree_int_, bulk_load_left_key_.str, bulk_load_left_key_.length, &store, sizeof(store));
-        else
-            wh_put(better_tree_, bulk_load_left_key_.str, bulk_load_left_key_.length, &store, sizeof(store));
+        const uint32_t size_scalar = std::lower_bound(scaled_sizes_, scaled_sizes_ + size_scalar_count, list_len) - scaled_sizes_;
+        InfixStore store(allocator_, scaled_sizes_[size_scalar], infix_size_, size_scalar);
+        LoadListToInfixStore(store, infix_list, list_len, total_implicit);
+        if (bulk_load_left_cut_ > 0)
+            SetPartialBoundary(store, bulk_load_left_cut_);
+        TreePut(GetTreeRef(), left_key, store);
         AddTreeKey(bulk_load_right_key.str, bulk_load_right_key.length);
         delete[] bulk_load_right_key.str;
     }
@@ -2000,6 +3939,7 @@ inline void Diva<int_optimized>::BulkLoadStreamingFinish() {
     delete[] bulk_load_left_key_.str;
     bulk_load_streaming_ind_ = 0;
     bulk_load_left_key_ = {};
+    bulk_load_left_cut_ = 0;
     for (int32_t i = 0; i < infix_store_target_size; i++) {
         delete[] bulk_load_key_list_[i].str;
         bulk_load_key_list_[i] = {};
@@ -2007,42 +3947,111 @@ inline void Diva<int_optimized>::BulkLoadStreamingFinish() {
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline uint16_t *Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetOccupiedsDirectory(const InfixStore &store) {
+    return reinterpret_cast<uint16_t *>(store.ptr);
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline uint16_t *Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetRunendsDirectory(const InfixStore &store) {
+    return reinterpret_cast<uint16_t *>(store.ptr) + 2 * header_word_count;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::UpdateRankDirectory(uint16_t *directory, const int32_t pos, const int32_t delta) {
+    for (int32_t i = 0; i < rank_directory_size; i++)
+        directory[i] += (pos < static_cast<int32_t>((i + 1) * rank_block_size)) ? delta : 0;
+}
+
+
+// Call after shifting the runends between `l` and `r` one position to the right
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ShiftRankDirectoryRight(uint16_t *directory, const uint64_t *runends,
+                                                                                                     const int32_t l, const int32_t r) {
+    for (int32_t i = 0; i < rank_directory_size; i++) {
+        const int32_t boundary = (i + 1) * rank_block_size;
+        if (l < boundary && boundary <= r)
+            directory[i] -= get_bitmap_bit(runends, boundary);
+    }
+}
+
+
+// Call before shifting the runends between `l` and `r` one position to the left
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ShiftRankDirectoryLeft(uint16_t *directory, const uint64_t *runends,
+                                                                                                    const int32_t l, const int32_t r) {
+    for (int32_t i = 0; i < rank_directory_size; i++) {
+        const int32_t boundary = (i + 1) * rank_block_size;
+        if (l <= boundary && boundary < r)
+            directory[i] += get_bitmap_bit(runends, boundary);
+    }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ComputeRankDirectory(const InfixStore &store, uint16_t *occupieds_directory,
+                                                                                                  uint16_t *runends_directory) const {
+    const uint64_t *occupieds = store.ptr + header_word_count;
+    const uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
+    const int32_t runends_size = scaled_sizes_[store.GetSizeGrade()];
+    uint32_t occupied_count = 0, runend_count = 0;
+    for (int32_t i = 0; i < rank_directory_size * rank_block_size / 64; i++) {
+        occupied_count += __builtin_popcountll(occupieds[i]);
+        if (runends_size - i * 64 > 0)
+            runend_count += __builtin_popcountll(runends[i] & BITMASK(std::min(64, runends_size - i * 64)));
+        if ((i + 1) % (rank_block_size / 64) == 0) {
+            occupieds_directory[i / (rank_block_size / 64)] = occupied_count;
+            runends_directory[i / (rank_block_size / 64)] = runend_count;
+        }
+    }
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline uint32_t Diva<int_optimized>::RankOccupieds(const InfixStore &store, const uint32_t pos) const {
-    const uint32_t *popcnts = reinterpret_cast<const uint32_t *>(store.ptr);
-    const uint64_t *occupieds = store.ptr + 1;
-
-    const bool cond = infix_store_target_size / 2 <= pos;
-    uint32_t res = cond ? popcnts[0] : 0;
-    for (int32_t i = cond ? infix_store_target_size / 128 : 0; i < pos / 64; i++)
-        res += __builtin_popcountll(occupieds[i]);
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::RankOccupieds(const InfixStore &store, const uint32_t pos) const {
+    const uint16_t *directory = GetOccupiedsDirectory(store);
+    const uint64_t *occupieds = store.ptr + header_word_count;
+
+    const uint32_t block = pos / rank_block_size;
+    const uint32_t start = block * (rank_block_size / 64);
+    const uint32_t res = (block ? directory[block - 1] : 0) + popcount_words(occupieds + start, pos / 64 - start);
     return res + bit_rank(occupieds[pos / 64], pos % 64);
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline uint32_t Diva<int_optimized>::SelectRunends(const InfixStore &store, const uint32_t rank) const {
-    const uint32_t *popcnts = reinterpret_cast<const uint32_t *>(store.ptr);
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SelectRunends(const InfixStore &store, const uint32_t rank) const {
+    const uint16_t *directory = GetRunendsDirectory(store);
     const uint32_t size_grade = store.GetSizeGrade();
     const uint32_t total_words = (scaled_sizes_[size_grade] + 63) / 64;
-    const uint64_t *runends = store.ptr + 1 + infix_store_target_size / 64;
-
-    const bool cond = popcnts[1] <= rank;
-    uint32_t i, old_total_set_bits = cond ? popcnts[1] : 0, total_set_bits = cond ? popcnts[1] : 0;
-    for (i = cond ? infix_store_target_size / 128 : 0; total_set_bits <= rank && i < total_words; i++) {
-        old_total_set_bits = total_set_bits;
-        total_set_bits += __builtin_popcountll(runends[i]);
-    }
-    i--;
-    return i * 64 + bit_select(runends[i], rank - old_total_set_bits);
+    const uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
+
+    uint32_t block = 0;
+    for (int32_t i = 0; i < rank_directory_size; i++)
+        block += directory[i] <= rank;
+    const uint32_t start = block * (rank_block_size / 64);
+    const uint32_t local_rank = rank - (block ? directory[block - 1] : 0);
+    uint32_t rank_before;
+    const uint32_t i = start + select_word(runends + start, total_words > start ? total_words - start : 0,
+                                           local_rank, rank_before);
+    // Clamped so that sessions probing a store mid-update stay in its buffer
+    return std::min<uint32_t>(i * 64 + bit_select(runends[i], local_rank - rank_before),
+                              scaled_sizes_[size_grade] - 1);
 }
 
 
-template <bool int_optimized>
-inline int32_t Diva<int_optimized>::NextOccupied(const InfixStore &store, const uint32_t pos) const {
-    const uint64_t *occupieds = store.ptr + 1;
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline int32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::NextOccupied(const InfixStore &store, const uint32_t pos) const {
+    const uint64_t *occupieds = store.ptr + header_word_count;
     int32_t res = pos + 1, lb_pos;
     do {
         lb_pos = lowbit_pos(occupieds[res / 64] & (~BITMASK(res % 64)));
@@ -2052,10 +4061,10 @@ inline int32_t Diva<int_optimized>::NextOccupied(const InfixStore &store, const
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline int32_t Diva<int_optimized>::PreviousOccupied(const InfixStore &store, const uint32_t pos) const {
-    const uint64_t *occupieds = store.ptr + 1;
+inline int32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::PreviousOccupied(const InfixStore &store, const uint32_t pos) const {
+    const uint64_t *occupieds = store.ptr + header_word_count;
     int32_t res = pos - 1, hb_pos;
     do {
         const int32_t offset = res % 64;
@@ -2069,10 +4078,10 @@ inline int32_t Diva<int_optimized>::PreviousOccupied(const InfixStore &store, co
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline int32_t Diva<int_optimized>::NextRunend(const InfixStore &store, const uint32_t pos) const {
-    const uint64_t *runends = store.ptr + 1 + infix_store_target_size / 64;
+inline int32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::NextRunend(const InfixStore &store, const uint32_t pos) const {
+    const uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
     const uint32_t size_grade = store.GetSizeGrade();
     const uint32_t runends_size = scaled_sizes_[size_grade];
     int32_t res = pos + 1, lb_pos;
@@ -2084,10 +4093,10 @@ inline int32_t Diva<int_optimized>::NextRunend(const InfixStore &store, const ui
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline int32_t Diva<int_optimized>::PreviousRunend(const InfixStore &store, const uint32_t pos) const {
-    const uint64_t *runends = store.ptr + 1 + infix_store_target_size / 64;
+inline int32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::PreviousRunend(const InfixStore &store, const uint32_t pos) const {
+    const uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
     int32_t res = pos - 1, hb_pos;
     do {
         const int32_t offset = res % 64;
@@ -2101,50 +4110,81 @@ inline int32_t Diva<int_optimized>::PreviousRunend(const InfixStore &store, cons
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline int32_t Diva<int_optimized>::GetMappedPos(const uint32_t implicit_part, const uint32_t size_grade,
-                                                 const uint64_t implicit_scalar) const {
+inline int32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetMappedPos(const uint32_t implicit_part, const uint32_t size_grade,
+                                                                                             const uint64_t implicit_scalar) const {
     uint32_t res = (implicit_part * size_scalars_[size_grade] * implicit_scalar)
                         >> (scale_shift + scale_implicit_shift);
     return std::min<uint32_t>(scaled_sizes_[size_grade] - 1, res);
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+__attribute__((always_inline))
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::PrefetchInfixStore(const InfixStore &store, const uint32_t implicit_part,
+                                                                                                const uint64_t implicit_scalar) const {
+    // The popcounts, the occupieds word, and the runends and slots around the
+    // mapped position are all addressed from `ptr` alone, so a probe can have
+    // them in flight together instead of missing on each one after the other
+    const uint32_t size_grade = store.GetSizeGrade();
+    const uint32_t mapped_pos = GetMappedPos(implicit_part, size_grade, implicit_scalar);
+    const uint8_t *ptr = reinterpret_cast<const uint8_t *>(store.ptr);
+    __builtin_prefetch(ptr);
+    __builtin_prefetch(ptr + (64 * header_word_count + implicit_part) / 8);
+    __builtin_prefetch(ptr + (64 * header_word_count + infix_store_target_size + mapped_pos) / 8);
+    __builtin_prefetch(ptr + (64 * header_word_count + infix_store_target_size + scaled_sizes_[size_grade] + mapped_pos * infix_size_) / 8);
+}
+
+
+// Slot widths other than 0 are known at compile time, so the slot arithmetic
+// of the routines instantiated for them folds into constants
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
 __attribute__((always_inline))
-inline uint64_t Diva<int_optimized>::GetSlot(const InfixStore &store, const uint32_t pos) const {
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetSlotWidth() const {
+    return width ? width : infix_size_;
+}
+
+
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
+__attribute__((always_inline))
+inline uint64_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetSlot(const InfixStore &store, const uint32_t pos) const {
+    const uint32_t infix_size = GetSlotWidth<width>();
     const uint32_t size_grade = store.GetSizeGrade();
-    const uint32_t bit_pos = 64 + infix_store_target_size + scaled_sizes_[size_grade] + pos * infix_size_;
+    const uint32_t bit_pos = 64 * header_word_count + infix_store_target_size + scaled_sizes_[size_grade] + pos * infix_size;
     const uint8_t *ptr = ((uint8_t *) store.ptr) + bit_pos / 8;
     uint64_t value;
     memcpy(&value, ptr, sizeof(value));
-    return (value >> bit_pos % 8) & BITMASK(infix_size_);
+    return (value >> bit_pos % 8) & BITMASK(infix_size);
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
 __attribute__((always_inline))
-inline void Diva<int_optimized>::SetSlot(InfixStore &store, const uint32_t pos, const uint64_t value) {
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SetSlot(InfixStore &store, const uint32_t pos, const uint64_t value) {
+    const uint32_t infix_size = GetSlotWidth<width>();
     const uint32_t size_grade = store.GetSizeGrade();
-    const uint32_t bit_pos = 64 + infix_store_target_size + scaled_sizes_[size_grade] + pos * infix_size_;
+    const uint32_t bit_pos = 64 * header_word_count + infix_store_target_size + scaled_sizes_[size_grade] + pos * infix_size;
     uint8_t *ptr = ((uint8_t *) store.ptr) + bit_pos / 8;
     uint64_t stamp;
     memcpy(&stamp, ptr, sizeof(stamp));
-    stamp &= ~(BITMASK(infix_size_) << (bit_pos % 8));
+    stamp &= ~(BITMASK(infix_size) << (bit_pos % 8));
     stamp |= value << (bit_pos % 8);
     memcpy(ptr, &stamp, sizeof(stamp));
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline void Diva<int_optimized>::SetSlot(InfixStore &store, const uint32_t pos, const uint64_t value, const uint32_t width) {
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::SetSlot(InfixStore &store, const uint32_t pos, const uint64_t value, const uint32_t width) {
 #ifdef DEBUG
     assert(value > 0);
 #endif
     const uint32_t size_grade = store.GetSizeGrade();
-    const uint32_t bit_pos = 64 + infix_store_target_size + scaled_sizes_[size_grade] + pos * width;
+    const uint32_t bit_pos = 64 * header_word_count + infix_store_target_size + scaled_sizes_[size_grade] + pos * width;
     uint8_t *ptr = ((uint8_t *) store.ptr) + bit_pos / 8;
     uint64_t stamp;
     memcpy(&stamp, ptr, sizeof(stamp));
@@ -2154,87 +4194,93 @@ inline void Diva<int_optimized>::SetSlot(InfixStore &store, const uint32_t pos,
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
 __attribute__((always_inline))
-inline void Diva<int_optimized>::ShiftSlotsRight(const InfixStore &store, const uint32_t l, const uint32_t r,
-                                                 const uint32_t shamt) {
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ShiftSlotsRight(const InfixStore &store, const uint32_t l, const uint32_t r,
+                                                                                             const uint32_t shamt) {
 #ifdef NAIVE_SLOT_SHIFT
     for (int32_t i = r - 1; i >= l; i--)
-        SetSlot(store, i + shamt, GetSlot(store, i));
+        SetSlot<width>(store, i + shamt, GetSlot<width>(store, i));
     for (int32_t i = l; i < l + shamt; i++)
-        SetSlot(store, i, 0ULL);
+        SetSlot<width>(store, i, 0ULL);
 #else
+    const uint32_t infix_size = GetSlotWidth<width>();
     const uint32_t size_grade = store.GetSizeGrade();
-    const uint32_t l_bit_pos = 64 + infix_store_target_size + scaled_sizes_[size_grade] + l * infix_size_;
-    const uint32_t r_bit_pos = 64 + infix_store_target_size + scaled_sizes_[size_grade] + r * infix_size_ - 1;
-    shift_bitmap_right(store.ptr, l_bit_pos, r_bit_pos, shamt * infix_size_);
+    const uint32_t l_bit_pos = 64 * header_word_count + infix_store_target_size + scaled_sizes_[size_grade] + l * infix_size;
+    const uint32_t r_bit_pos = 64 * header_word_count + infix_store_target_size + scaled_sizes_[size_grade] + r * infix_size - 1;
+    shift_bitmap_right(store.ptr, l_bit_pos, r_bit_pos, shamt * infix_size);
 #endif
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
 __attribute__((always_inline))
-inline void Diva<int_optimized>::ShiftSlotsLeft(const InfixStore &store, const uint32_t l, const uint32_t r,
-                                                const uint32_t shamt) {
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ShiftSlotsLeft(const InfixStore &store, const uint32_t l, const uint32_t r,
+                                                                                            const uint32_t shamt) {
 #ifdef NAIVE_SLOT_SHIFT
     for (int32_t i = l; i < r; i--)
-        SetSlot(store, i - shamt, GetSlot(store, i));
+        SetSlot<width>(store, i - shamt, GetSlot<width>(store, i));
 #else
+    const uint32_t infix_size = GetSlotWidth<width>();
     const uint32_t size_grade = store.GetSizeGrade();
-    const uint32_t l_bit_pos = 64 + infix_store_target_size + scaled_sizes_[size_grade] + l * infix_size_;
-    const uint32_t r_bit_pos = 64 + infix_store_target_size + scaled_sizes_[size_grade] + r * infix_size_ - 1;
-    shift_bitmap_left(store.ptr, l_bit_pos, r_bit_pos, shamt * infix_size_);
+    const uint32_t l_bit_pos = 64 * header_word_count + infix_store_target_size + scaled_sizes_[size_grade] + l * infix_size;
+    const uint32_t r_bit_pos = 64 * header_word_count + infix_store_target_size + scaled_sizes_[size_grade] + r * infix_size - 1;
+    shift_bitmap_left(store.ptr, l_bit_pos, r_bit_pos, shamt * infix_size);
 #endif
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline void Diva<int_optimized>::ShiftRunendsRight(const InfixStore &store, const uint32_t l, const uint32_t r, 
-                                                   const uint32_t shamt) {
-    shift_bitmap_right(store.ptr + 1 + infix_store_target_size / 64, l, r - 1, shamt);
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ShiftRunendsRight(const InfixStore &store, const uint32_t l, const uint32_t r, 
+                                                                                               const uint32_t shamt) {
+    shift_bitmap_right(store.ptr + header_word_count + infix_store_target_size / 64, l, r - 1, shamt);
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
 __attribute__((always_inline))
-inline void Diva<int_optimized>::ShiftRunendsLeft(const InfixStore &store, const uint32_t l, const uint32_t r,
-                                                  const uint32_t shamt) {
-    shift_bitmap_left(store.ptr + 1 + infix_store_target_size / 64, l, r - 1, shamt);
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ShiftRunendsLeft(const InfixStore &store, const uint32_t l, const uint32_t r,
+                                                                                              const uint32_t shamt) {
+    shift_bitmap_left(store.ptr + header_word_count + infix_store_target_size / 64, l, r - 1, shamt);
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
 __attribute__((always_inline))
-inline int32_t Diva<int_optimized>::FindEmptySlotAfter(const InfixStore &store, const uint32_t runend_pos) const {
+inline int32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::FindEmptySlotAfter(const InfixStore &store, const uint32_t runend_pos) const {
     const uint32_t size_grade = store.GetSizeGrade();
     int32_t current_pos = runend_pos;
-    while (current_pos < scaled_sizes_[size_grade] && GetSlot(store, current_pos + 1)) {
+    while (current_pos < scaled_sizes_[size_grade] && GetSlot<width>(store, current_pos + 1)) {
         current_pos = NextRunend(store, current_pos);
     }
     return current_pos + 1;
 }
 
 
-template <bool int_optimized>
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
 __attribute__((always_inline))
-inline int32_t Diva<int_optimized>::FindEmptySlotBefore(const InfixStore &store, const uint32_t runend_pos) const {
+inline int32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::FindEmptySlotBefore(const InfixStore &store, const uint32_t runend_pos) const {
     int32_t current_pos = runend_pos, previous_pos;
     do {
         previous_pos = current_pos;
         current_pos = PreviousRunend(store, current_pos);
-    } while (current_pos >= 0 && GetSlot(store, current_pos + 1));
+    } while (current_pos >= 0 && GetSlot<width>(store, current_pos + 1));
 
     do {
         previous_pos--;
-    } while (current_pos < previous_pos && GetSlot(store, previous_pos));
+    } while (current_pos < previous_pos && GetSlot<width>(store, previous_pos));
     return previous_pos;
 
     // Maybe binary searching would be better?
     int32_t l = current_pos, r = previous_pos, mid;
     while (r - l > 1) {
         mid = (l + r) / 2;
-        const bool cond = GetSlot(store, mid) == 0;
+        const bool cond = GetSlot<width>(store, mid) == 0;
         l = cond ? mid : l;
         r = cond ? r : mid;
     }
@@ -2242,8 +4288,20 @@ inline int32_t Diva<int_optimized>::FindEmptySlotBefore(const InfixStore &store,
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::InsertRawIntoInfixStore(InfixStore &store, const uint64_t key, const uint32_t total_implicit) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
+DIVA_MULTIVERSION
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InsertRawIntoInfixStore(InfixStore &store, const uint64_t key, const uint32_t total_implicit) {
+    if constexpr (width == 0) {
+        switch (infix_size_) {
+            case 6: return InsertRawIntoInfixStore<6>(store, key, total_implicit);
+            case 8: return InsertRawIntoInfixStore<8>(store, key, total_implicit);
+            case 10: return InsertRawIntoInfixStore<10>(store, key, total_implicit);
+            case 12: return InsertRawIntoInfixStore<12>(store, key, total_implicit);
+            case 16: return InsertRawIntoInfixStore<16>(store, key, total_implicit);
+        }
+    }
+    const uint32_t infix_size = GetSlotWidth<width>();
     uint32_t size_grade = store.GetSizeGrade();
     const uint32_t elem_count = store.GetElemCount();
     if (elem_count >= (size_grade ? scaled_sizes_[size_grade - 1] : exception_scaled_size_)) {
@@ -2253,90 +4311,84 @@ inline void Diva<int_optimized>::InsertRawIntoInfixStore(InfixStore &store, cons
         ResizeInfixStore(store, true, total_implicit);
         size_grade++;
     }
+    CopyMappedInfixStore(store);
 
-    const uint64_t implicit_part = key >> infix_size_;
-    const uint64_t explicit_part = key & BITMASK(infix_size_);
+    const uint64_t implicit_part = key >> infix_size;
+    const uint64_t explicit_part = key & BITMASK(infix_size);
     const uint64_t implicit_scalar = implicit_scalars_[total_implicit - infix_store_target_size / 2];
 
 #ifdef DEBUG
     assert(implicit_part < total_implicit);
 #endif
 
-    uint32_t *popcnts = reinterpret_cast<uint32_t *>(store.ptr);
-    uint64_t *occupieds = store.ptr + 1;
-    uint64_t *runends = store.ptr + 1 + infix_store_target_size / 64;
-    
+    uint16_t *occupieds_directory = GetOccupiedsDirectory(store);
+    uint16_t *runends_directory = GetRunendsDirectory(store);
+    uint64_t *occupieds = store.ptr + header_word_count;
+    uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
+
     const int32_t mapped_pos = GetMappedPos(implicit_part, size_grade, implicit_scalar);
     const uint32_t key_rank = RankOccupieds(store, implicit_part);
     const bool is_occupied = get_bitmap_bit(occupieds, implicit_part);
-    if (!is_occupied && GetSlot(store, mapped_pos) == 0) {
-        SetSlot(store, mapped_pos, explicit_part);
+    if (!is_occupied && GetSlot<width>(store, mapped_pos) == 0) {
+        SetSlot<width>(store, mapped_pos, explicit_part);
         set_bitmap_bit(runends, mapped_pos);
-        popcnts[0] += implicit_part < infix_store_target_size / 2;
-        popcnts[1] += mapped_pos < infix_store_target_size / 2;
+        UpdateRankDirectory(occupieds_directory, implicit_part, 1);
+        UpdateRankDirectory(runends_directory, mapped_pos, 1);
     }
     else if (is_occupied) {
         const int32_t runend_pos = SelectRunends(store, key_rank);
-        const int32_t next_empty = FindEmptySlotAfter(store, mapped_pos);
+        const int32_t next_empty = FindEmptySlotAfter<width>(store, mapped_pos);
 #ifdef DEBUG
         assert(next_empty >= scaled_sizes_[size_grade] || mapped_pos <= runend_pos);
 #endif
-        const int32_t previous_empty = FindEmptySlotBefore(store, mapped_pos);
+        const int32_t previous_empty = FindEmptySlotBefore<width>(store, mapped_pos);
 
         int32_t l = std::max(PreviousRunend(store, runend_pos), previous_empty);
         int32_t r = runend_pos + 1;
         int32_t mid;
         while (r - l > 1) {
             mid = (l + r) / 2;
-            const uint64_t range_l = GetSlot(store, mid);
+            const uint64_t range_l = GetSlot<width>(store, mid);
             const bool cond = (range_l - (range_l & -range_l)) <= explicit_part - 1;
             l = cond ? mid : l;
             r = cond ? r : mid;
         }
         if (next_empty < scaled_sizes_[size_grade]) {
-            ShiftSlotsRight(store, r, next_empty, 1);
+            ShiftSlotsRight<width>(store, r, next_empty, 1);
             ShiftRunendsRight(store, runend_pos, next_empty, 1);
-            if (runend_pos < infix_store_target_size / 2 
-                    && infix_store_target_size / 2 <= next_empty)
-                popcnts[1] -= get_bitmap_bit(runends, infix_store_target_size / 2);
-            SetSlot(store, r, explicit_part);
+            ShiftRankDirectoryRight(runends_directory, runends, runend_pos, next_empty);
+            SetSlot<width>(store, r, explicit_part);
         }
         else {
-            ShiftSlotsLeft(store, previous_empty + 1, r, 1);
-            if (previous_empty + 1 <= infix_store_target_size / 2
-                    && infix_store_target_size / 2 < std::min(runend_pos, r))
-                popcnts[1] += get_bitmap_bit(runends, infix_store_target_size / 2);
+            ShiftSlotsLeft<width>(store, previous_empty + 1, r, 1);
+            ShiftRankDirectoryLeft(runends_directory, runends, previous_empty + 1, std::min(runend_pos, r));
             ShiftRunendsLeft(store, previous_empty + 1, std::min(runend_pos, r), 1);
-            SetSlot(store, r - 1, explicit_part);
+            SetSlot<width>(store, r - 1, explicit_part);
         }
     }
     else {
         const int32_t runend_pos = key_rank == 0 ? -1 : SelectRunends(store, key_rank - 1);
-        const int32_t next_empty = FindEmptySlotAfter(store, mapped_pos);
+        const int32_t next_empty = FindEmptySlotAfter<width>(store, mapped_pos);
         if (next_empty < scaled_sizes_[size_grade]) {
             const int32_t shift_start = std::max(runend_pos + 1, mapped_pos);
-            ShiftSlotsRight(store, shift_start, next_empty, 1);
+            ShiftSlotsRight<width>(store, shift_start, next_empty, 1);
             ShiftRunendsRight(store, shift_start, next_empty, 1);
-            if (shift_start < infix_store_target_size / 2 
-                    && infix_store_target_size / 2 <= next_empty)
-                popcnts[1] -= get_bitmap_bit(runends, infix_store_target_size / 2);
-            SetSlot(store, shift_start, explicit_part);
+            ShiftRankDirectoryRight(runends_directory, runends, shift_start, next_empty);
+            SetSlot<width>(store, shift_start, explicit_part);
             set_bitmap_bit(runends, shift_start);
-            popcnts[1] += shift_start < infix_store_target_size / 2;
+            UpdateRankDirectory(runends_directory, shift_start, 1);
         }
         else {
-            const int32_t previous_empty = FindEmptySlotBefore(store, mapped_pos);
+            const int32_t previous_empty = FindEmptySlotBefore<width>(store, mapped_pos);
             const int32_t target_pos = std::max(runend_pos, previous_empty);
-            ShiftSlotsLeft(store, previous_empty + 1, target_pos + 1, 1);
-            if (previous_empty + 1 <= infix_store_target_size / 2 
-                    && infix_store_target_size / 2 < target_pos + 1)
-                popcnts[1] += get_bitmap_bit(runends, infix_store_target_size / 2);
+            ShiftSlotsLeft<width>(store, previous_empty + 1, target_pos + 1, 1);
+            ShiftRankDirectoryLeft(runends_directory, runends, previous_empty + 1, target_pos + 1);
             ShiftRunendsLeft(store, previous_empty + 1, target_pos + 1, 1);
-            SetSlot(store, target_pos, explicit_part);
+            SetSlot<width>(store, target_pos, explicit_part);
             set_bitmap_bit(runends, target_pos);
-            popcnts[1] += target_pos < infix_store_target_size / 2;
+            UpdateRankDirectory(runends_directory, target_pos, 1);
         }
-        popcnts[0] += implicit_part < infix_store_target_size / 2;
+        UpdateRankDirectory(occupieds_directory, implicit_part, 1);
     }
     set_bitmap_bit(occupieds, implicit_part);
     store.UpdateElemCount(1);
@@ -2350,16 +4402,12 @@ inline void Diva<int_optimized>::InsertRawIntoInfixStore(InfixStore &store, cons
             runend_count += get_bitmap_bit(runends, i);
         assert(occupied_count == runend_count);
 
-        uint32_t check_popcnts[2] = {};
-        for (int32_t i = 0; i < Diva<int_optimized>::infix_store_target_size / 128; i++) {
-            check_popcnts[0] += __builtin_popcountll(occupieds[i]);
-            if (static_cast<int32_t>(scaled_sizes_[size_grade]) - i * 64 > 0) {
-                const uint64_t mask = BITMASK(std::min(64UL, scaled_sizes_[size_grade] - i * 64));
-                check_popcnts[1] += __builtin_popcountll(runends[i] & mask);
-            }
+        uint16_t check_directories[2][rank_directory_size];
+        ComputeRankDirectory(store, check_directories[0], check_directories[1]);
+        for (int32_t i = 0; i < rank_directory_size; i++) {
+            assert(GetOccupiedsDirectory(store)[i] == check_directories[0][i]);
+            assert(GetRunendsDirectory(store)[i] == check_directories[1][i]);
         }
-        assert(popcnts[0] == check_popcnts[0]);
-        assert(popcnts[1] == check_popcnts[1]);
         
         if (elem_count < infix_store_target_size) {
             uint64_t infix_list[infix_store_target_size];
@@ -2370,22 +4418,36 @@ inline void Diva<int_optimized>::InsertRawIntoInfixStore(InfixStore &store, cons
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::DeleteRawFromInfixStore(InfixStore &store, const uint64_t key, const uint32_t total_implicit) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
+DIVA_MULTIVERSION
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::DeleteRawFromInfixStore(InfixStore &store, const uint64_t key, const uint32_t total_implicit) {
+    if constexpr (width == 0) {
+        switch (infix_size_) {
+            case 6: return DeleteRawFromInfixStore<6>(store, key, total_implicit);
+            case 8: return DeleteRawFromInfixStore<8>(store, key, total_implicit);
+            case 10: return DeleteRawFromInfixStore<10>(store, key, total_implicit);
+            case 12: return DeleteRawFromInfixStore<12>(store, key, total_implicit);
+            case 16: return DeleteRawFromInfixStore<16>(store, key, total_implicit);
+        }
+    }
+    const uint32_t infix_size = GetSlotWidth<width>();
     uint32_t size_grade = store.GetSizeGrade();
     const uint32_t elem_count = store.GetElemCount();
     if (size_grade > 0 && elem_count <= (size_grade > 1 ? scaled_sizes_[size_grade - 2] : exception_scaled_size_)) {
         ResizeInfixStore(store, false, total_implicit);
         size_grade--;
     }
+    CopyMappedInfixStore(store);
 
-    const uint64_t implicit_part = key >> infix_size_;
-    const uint64_t explicit_part = key & BITMASK(infix_size_);
+    const uint64_t implicit_part = key >> infix_size;
+    const uint64_t explicit_part = key & BITMASK(infix_size);
     const uint64_t implicit_scalar = implicit_scalars_[total_implicit - infix_store_target_size / 2];
 
-    uint32_t *popcnts = reinterpret_cast<uint32_t *>(store.ptr);
-    uint64_t *occupieds = store.ptr + 1;
-    uint64_t *runends = store.ptr + 1 + infix_store_target_size / 64;
+    uint16_t *occupieds_directory = GetOccupiedsDirectory(store);
+    uint16_t *runends_directory = GetRunendsDirectory(store);
+    uint64_t *occupieds = store.ptr + header_word_count;
+    uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
     const bool is_occupied = get_bitmap_bit(occupieds, implicit_part);
 #ifdef DEBUG
     assert(is_occupied);
@@ -2394,13 +4456,13 @@ inline void Diva<int_optimized>::DeleteRawFromInfixStore(InfixStore &store, cons
     const uint32_t key_rank = RankOccupieds(store, implicit_part);
     const int32_t runend_pos = SelectRunends(store, key_rank);
     const int32_t runstart_pos = std::max(key_rank ? static_cast<int32_t>(SelectRunends(store, key_rank - 1)) : -1,
-                                          static_cast<int32_t>(FindEmptySlotBefore(store, runend_pos))) + 1;
+                                          static_cast<int32_t>(FindEmptySlotBefore<width>(store, runend_pos))) + 1;
     const bool run_destroyed = runstart_pos == runend_pos;
 
     int32_t l = runstart_pos - 1, r = runend_pos + 1, mid;
     while (r - l > 1) {
         mid = (l + r) / 2;
-        uint64_t value = GetSlot(store, mid);
+        uint64_t value = GetSlot<width>(store, mid);
         value -= value & -value;
         if (value <= key - 1)
             l = mid;
@@ -2409,7 +4471,7 @@ inline void Diva<int_optimized>::DeleteRawFromInfixStore(InfixStore &store, cons
     }
     int32_t match_pos;
     for (match_pos = l; match_pos >= runstart_pos; match_pos--) {
-        const uint64_t value = GetSlot(store, match_pos);
+        const uint64_t value = GetSlot<width>(store, match_pos);
         const uint64_t mask = ((value & -value) << 1) - 1;
         if ((value | mask) == (explicit_part | mask))
             break;
@@ -2428,7 +4490,7 @@ inline void Diva<int_optimized>::DeleteRawFromInfixStore(InfixStore &store, cons
     while (cur_runend < scaled_sizes_[size_grade]) {
         // Find last run that starts in its canonical slot.
         prev_runend = cur_runend;
-        if (prev_runend + 1 < scaled_sizes_[size_grade] && GetSlot(store, prev_runend + 1) == 0) {
+        if (prev_runend + 1 < scaled_sizes_[size_grade] && GetSlot<width>(store, prev_runend + 1) == 0) {
             found_empty_right = true;
             break;
         }
@@ -2444,8 +4506,8 @@ inline void Diva<int_optimized>::DeleteRawFromInfixStore(InfixStore &store, cons
         int32_t cur_occupied = implicit_part;
         int32_t cur_runend = PreviousRunend(store, runend_pos), prev_runend = runend_pos;
         while (cur_runend >= 0) {
-            if (GetSlot(store, cur_runend + 1) == 0) {
-                const int32_t runstart = FindEmptySlotBefore(store, prev_runend) + 1;
+            if (GetSlot<width>(store, cur_runend + 1) == 0) {
+                const int32_t runstart = FindEmptySlotBefore<width>(store, prev_runend) + 1;
                 const uint32_t mapped_pos = GetMappedPos(cur_occupied, size_grade, implicit_scalar);
                 shift_start = (mapped_pos > runstart ? runstart : shift_start);
                 break;
@@ -2458,7 +4520,7 @@ inline void Diva<int_optimized>::DeleteRawFromInfixStore(InfixStore &store, cons
         }
         if (cur_runend < 0) {
             const uint32_t mapped_pos = GetMappedPos(cur_occupied, size_grade, implicit_scalar);
-            const int32_t first_empty_slot_before = FindEmptySlotBefore(store, runend_pos);
+            const int32_t first_empty_slot_before = FindEmptySlotBefore<width>(store, runend_pos);
             shift_start = (first_empty_slot_before < mapped_pos ? first_empty_slot_before : shift_start);
         }
     }
@@ -2470,40 +4532,36 @@ inline void Diva<int_optimized>::DeleteRawFromInfixStore(InfixStore &store, cons
     }
 
     if (shift_start == -1) {    // Shift to the left
-        if (match_pos <= infix_store_target_size / 2 
-                && infix_store_target_size / 2 < shift_end + 1)
-            popcnts[1] += get_bitmap_bit(runends, infix_store_target_size / 2);
-        ShiftSlotsLeft(store, match_pos + 1, shift_end + 1, 1);
+        ShiftRankDirectoryLeft(runends_directory, runends, match_pos, shift_end + 1);
+        ShiftSlotsLeft<width>(store, match_pos + 1, shift_end + 1, 1);
         ShiftRunendsLeft(store, match_pos + 1, shift_end + 1, 1);
         if (match_pos == shift_end) {
-            SetSlot(store, match_pos, 0);
+            SetSlot<width>(store, match_pos, 0);
             reset_bitmap_bit(runends, match_pos);
         }
         if (!run_destroyed)
             set_bitmap_bit(runends, runend_pos - 1);
         else
-            popcnts[1] -= runend_pos <= infix_store_target_size / 2;
+            UpdateRankDirectory(runends_directory, runend_pos - 1, -1);
     }
     else {  // Shift to the right
-        ShiftSlotsRight(store, shift_start, match_pos, 1);
+        ShiftSlotsRight<width>(store, shift_start, match_pos, 1);
         ShiftRunendsRight(store, shift_start, match_pos, 1);
         if (match_pos == shift_start) {
-            SetSlot(store, match_pos, 0);
+            SetSlot<width>(store, match_pos, 0);
             if (run_destroyed)
                 reset_bitmap_bit(runends, runend_pos);
         }
-        if (shift_start < infix_store_target_size / 2 
-                && infix_store_target_size / 2 <= match_pos)
-            popcnts[1] -= get_bitmap_bit(runends, infix_store_target_size / 2);
+        ShiftRankDirectoryRight(runends_directory, runends, shift_start, match_pos);
         if (!run_destroyed)
             set_bitmap_bit(runends, runend_pos);
         else
-            popcnts[1] -= runend_pos < infix_store_target_size / 2;
+            UpdateRankDirectory(runends_directory, runend_pos, -1);
     }
     
     if (run_destroyed) {
         reset_bitmap_bit(occupieds, implicit_part);
-        popcnts[0] -= implicit_part < infix_store_target_size / 2;
+        UpdateRankDirectory(occupieds_directory, implicit_part, -1);
     }
     store.UpdateElemCount(-1);
 
@@ -2516,42 +4574,49 @@ inline void Diva<int_optimized>::DeleteRawFromInfixStore(InfixStore &store, cons
             runend_count += get_bitmap_bit(runends, i);
         assert(occupied_count == runend_count);
 
-        uint32_t check_popcnts[2] = {};
-        for (int32_t i = 0; i < Diva<int_optimized>::infix_store_target_size / 128; i++) {
-            check_popcnts[0] += __builtin_popcountll(occupieds[i]);
-            if (static_cast<int32_t>(scaled_sizes_[size_grade]) - i * 64 > 0) {
-                const uint64_t mask = BITMASK(std::min(64UL, scaled_sizes_[size_grade] - i * 64));
-                check_popcnts[1] += __builtin_popcountll(runends[i] & mask);
-            }
+        uint16_t check_directories[2][rank_directory_size];
+        ComputeRankDirectory(store, check_directories[0], check_directories[1]);
+        for (int32_t i = 0; i < rank_directory_size; i++) {
+            assert(GetOccupiedsDirectory(store)[i] == check_directories[0][i]);
+            assert(GetRunendsDirectory(store)[i] == check_directories[1][i]);
         }
-        assert(popcnts[0] == check_popcnts[0]);
-        assert(popcnts[1] == check_popcnts[1]);
     }
 #endif
 }
 
 
-template <bool int_optimized>
-inline uint32_t Diva<int_optimized>::GetLongestMatchingInfixSize(const InfixStore &store, const uint64_t key,
-                                                                 const uint32_t total_implicit) const {
-    const uint64_t implicit_part = key >> infix_size_;
-    const uint64_t explicit_part = key & BITMASK(infix_size_);
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetLongestMatchingInfixSize(const InfixStore &store, const uint64_t key,
+                                                                                                             const uint32_t total_implicit) const {
+    if constexpr (width == 0) {
+        switch (infix_size_) {
+            case 6: return GetLongestMatchingInfixSize<6>(store, key, total_implicit);
+            case 8: return GetLongestMatchingInfixSize<8>(store, key, total_implicit);
+            case 10: return GetLongestMatchingInfixSize<10>(store, key, total_implicit);
+            case 12: return GetLongestMatchingInfixSize<12>(store, key, total_implicit);
+            case 16: return GetLongestMatchingInfixSize<16>(store, key, total_implicit);
+        }
+    }
+    const uint32_t infix_size = GetSlotWidth<width>();
+    const uint64_t implicit_part = key >> infix_size;
+    const uint64_t explicit_part = key & BITMASK(infix_size);
     const uint64_t implicit_scalar = implicit_scalars_[total_implicit - infix_store_target_size / 2];
 
-    uint64_t *occupieds = store.ptr + 1;
+    uint64_t *occupieds = store.ptr + header_word_count;
     if (!get_bitmap_bit(occupieds, implicit_part))
         return 0;   // No matching infix found
 
     const uint32_t key_rank = RankOccupieds(store, implicit_part);
     const int32_t runend_pos = SelectRunends(store, key_rank);
     const int32_t runstart_pos = std::max(key_rank ? static_cast<int32_t>(SelectRunends(store, key_rank - 1)) : -1,
-                                          static_cast<int32_t>(FindEmptySlotBefore(store, runend_pos))) + 1;
+                                          static_cast<int32_t>(FindEmptySlotBefore<width>(store, runend_pos))) + 1;
     const bool run_destroyed = runstart_pos == runend_pos;
 
     int32_t l = runstart_pos - 1, r = runend_pos + 1, mid;
     while (r - l > 1) {
         mid = (l + r) / 2;
-        uint64_t value = GetSlot(store, mid);
+        uint64_t value = GetSlot<width>(store, mid);
         value -= value & -value;
         if (value <= key - 1)
             l = mid;
@@ -2560,24 +4625,40 @@ inline uint32_t Diva<int_optimized>::GetLongestMatchingInfixSize(const InfixStor
     }
     int32_t match_pos;
     for (match_pos = l; match_pos >= runstart_pos; match_pos--) {
-        const uint64_t value = GetSlot(store, match_pos);
+        const uint64_t value = GetSlot<width>(store, match_pos);
         const uint64_t mask = ((value & -value) << 1) - 1;
         if ((value | mask) == (explicit_part | mask))
-            return infix_size_ - lowbit_pos(value);
+            return infix_size - lowbit_pos(value);
     }
     return 0;   // No matching infix found
 }
 
 
-template <bool int_optimized>
-inline bool Diva<int_optimized>::RangeQueryInfixStore(InfixStore &store, const uint64_t l_key, const uint64_t r_key,
-                                                      const uint32_t total_implicit) const {
-    const uint64_t l_implicit_part = l_key >> infix_size_;
-    const uint64_t l_explicit_part = l_key & BITMASK(infix_size_);
-    const uint64_t r_implicit_part = r_key >> infix_size_;
-    const uint64_t r_explicit_part = r_key & BITMASK(infix_size_);
-    const uint64_t *occupieds = store.ptr + 1;
-    const uint64_t *runends = store.ptr + 1 + infix_store_target_size / 64;
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
+DIVA_MULTIVERSION
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::RangeQueryInfixStore(InfixStore &store, const uint64_t l_key, const uint64_t r_key,
+                                                                                                  const uint32_t total_implicit) const {
+    if constexpr (width == 0) {
+        switch (infix_size_) {
+            case 6: return RangeQueryInfixStore<6>(store, l_key, r_key, total_implicit);
+            case 8: return RangeQueryInfixStore<8>(store, l_key, r_key, total_implicit);
+            case 10: return RangeQueryInfixStore<10>(store, l_key, r_key, total_implicit);
+            case 12: return RangeQueryInfixStore<12>(store, l_key, r_key, total_implicit);
+            case 16: return RangeQueryInfixStore<16>(store, l_key, r_key, total_implicit);
+        }
+    }
+    const uint32_t infix_size = GetSlotWidth<width>();
+    const uint64_t l_implicit_part = l_key >> infix_size;
+    const uint64_t l_explicit_part = l_key & BITMASK(infix_size);
+    const uint64_t r_implicit_part = r_key >> infix_size;
+    const uint64_t r_explicit_part = r_key & BITMASK(infix_size);
+    const uint64_t implicit_scalar = implicit_scalars_[total_implicit - infix_store_target_size / 2];
+    PrefetchInfixStore(store, l_implicit_part, implicit_scalar);
+    if (l_implicit_part < r_implicit_part)
+        PrefetchInfixStore(store, r_implicit_part, implicit_scalar);
+    const uint64_t *occupieds = store.ptr + header_word_count;
+    const uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
 
     if (l_implicit_part < r_implicit_part) {
         if (NextOccupied(store, l_implicit_part) < r_implicit_part)
@@ -2587,8 +4668,8 @@ inline bool Diva<int_optimized>::RangeQueryInfixStore(InfixStore &store, const u
             const uint32_t r_rank = RankOccupieds(store, r_implicit_part);
             const uint32_t runend_pos = SelectRunends(store, r_rank);
             const uint32_t runstart_pos = std::max(r_rank ? static_cast<int32_t>(SelectRunends(store, r_rank - 1)) : -1,
-                                                   static_cast<int32_t>(FindEmptySlotBefore(store, runend_pos))) + 1;
-            const uint64_t slot_value = GetSlot(store, runstart_pos);
+                                                   static_cast<int32_t>(FindEmptySlotBefore<width>(store, runend_pos))) + 1;
+            const uint64_t slot_value = GetSlot<width>(store, runstart_pos);
             if (slot_value - (slot_value & -slot_value) <= r_explicit_part)
                 return true;
         }
@@ -2596,13 +4677,13 @@ inline bool Diva<int_optimized>::RangeQueryInfixStore(InfixStore &store, const u
             const uint32_t l_rank = RankOccupieds(store, l_implicit_part);
             const uint32_t runend_pos = SelectRunends(store, l_rank);
             uint32_t pos = runend_pos;
-            uint64_t slot_value = GetSlot(store, pos);
+            uint64_t slot_value = GetSlot<width>(store, pos);
             do {
                 if (l_explicit_part <= (slot_value | (slot_value - 1)))
                     return true;
                 if (pos == 0)
                     break;
-                slot_value = GetSlot(store, --pos);
+                slot_value = GetSlot<width>(store, --pos);
             } while (slot_value && !get_bitmap_bit(runends, pos));
         }
         return false;
@@ -2617,7 +4698,7 @@ inline bool Diva<int_optimized>::RangeQueryInfixStore(InfixStore &store, const u
     const uint32_t rank = RankOccupieds(store, l_implicit_part);
     const uint32_t runend_pos = SelectRunends(store, rank);
     uint32_t pos = runend_pos;
-    uint64_t slot_value = GetSlot(store, pos);
+    uint64_t slot_value = GetSlot<width>(store, pos);
 
     // TODO: Faster implementation via broadword operations?
     do {
@@ -2626,20 +4707,33 @@ inline bool Diva<int_optimized>::RangeQueryInfixStore(InfixStore &store, const u
             return true;
         if (pos == 0)
             break;
-        slot_value = GetSlot(store, --pos);
+        slot_value = GetSlot<width>(store, --pos);
     } while (slot_value && !get_bitmap_bit(runends, pos));
     return false;
 }
 
 
-template <bool int_optimized>
-inline bool Diva<int_optimized>::PointQueryInfixStore(InfixStore &store, const uint64_t key, const uint32_t total_implicit) const {
-    const uint64_t implicit_part = key >> infix_size_;
-    const uint64_t explicit_part = key & BITMASK(infix_size_);
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+template <uint32_t width>
+DIVA_MULTIVERSION
+inline bool Diva<int_optimized, target_size, t_int, thread_policy, t_index>::PointQueryInfixStore(InfixStore &store, const uint64_t key, const uint32_t total_implicit) const {
+    if constexpr (width == 0) {
+        switch (infix_size_) {
+            case 6: return PointQueryInfixStore<6>(store, key, total_implicit);
+            case 8: return PointQueryInfixStore<8>(store, key, total_implicit);
+            case 10: return PointQueryInfixStore<10>(store, key, total_implicit);
+            case 12: return PointQueryInfixStore<12>(store, key, total_implicit);
+            case 16: return PointQueryInfixStore<16>(store, key, total_implicit);
+        }
+    }
+    const uint32_t infix_size = GetSlotWidth<width>();
+    const uint64_t implicit_part = key >> infix_size;
+    const uint64_t explicit_part = key & BITMASK(infix_size);
     const uint64_t implicit_scalar = implicit_scalars_[total_implicit - infix_store_target_size / 2];
+    PrefetchInfixStore(store, implicit_part, implicit_scalar);
 
-    const uint64_t *occupieds = store.ptr + 1;
-    const uint64_t *runends = store.ptr + 1 + infix_store_target_size / 64;
+    const uint64_t *occupieds = store.ptr + header_word_count;
+    const uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
 
     if (!get_bitmap_bit(occupieds, implicit_part))
         return false;
@@ -2647,7 +4741,7 @@ inline bool Diva<int_optimized>::PointQueryInfixStore(InfixStore &store, const u
     const uint32_t rank = RankOccupieds(store, implicit_part);
     const uint32_t runend_pos = SelectRunends(store, rank);
     uint32_t pos = runend_pos;
-    uint64_t slot_value = GetSlot(store, pos);
+    uint64_t slot_value = GetSlot<width>(store, pos);
     // TODO: Faster implementation via broadword operations?
     do {
         const uint64_t mask = ((slot_value & (-slot_value)) << 1) - 1;
@@ -2655,14 +4749,14 @@ inline bool Diva<int_optimized>::PointQueryInfixStore(InfixStore &store, const u
             return true;
         if (pos == 0)
             break;
-        slot_value = GetSlot(store, --pos);
+        slot_value = GetSlot<width>(store, --pos);
     } while (slot_value && !get_bitmap_bit(runends, pos));
     return false;
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::ResizeInfixStore(InfixStore &store, const bool expand, const uint32_t total_implicit) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ResizeInfixStore(InfixStore &store, const bool expand, const uint32_t total_implicit) {
     // TODO: Optimize further?
     uint32_t size_grade = store.GetSizeGrade();
     const uint32_t infix_count = store.GetElemCount();
@@ -2670,27 +4764,27 @@ inline void Diva<int_optimized>::ResizeInfixStore(InfixStore &store, const bool
 
     uint64_t infix_list[infix_count];
     GetInfixList(store, infix_list);
-    delete[] store.ptr;
+    FreeInfixStorePtr(store.ptr, GetInfixStoreWordCount(store));
 
     size_grade += expand ? 1 : -1;
     store.SetSizeGrade(size_grade);
     const uint32_t next_size = scaled_sizes_[size_grade];
     const uint32_t word_count = InfixStore::GetPtrWordCount(next_size, infix_size_);
-    store.ptr = new uint64_t[word_count];
+    store.ptr = allocator_.Allocate(word_count);
     LoadListToInfixStore(store, infix_list, infix_count, total_implicit, true);
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::ShrinkInfixStoreInfixSize(InfixStore &store, const uint32_t new_infix_size) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::ShrinkInfixStoreInfixSize(InfixStore &store, const uint32_t new_infix_size) {
     const uint32_t size_grade = store.GetSizeGrade();
     const uint32_t infix_count = store.GetElemCount();
     const uint32_t slot_count = scaled_sizes_[size_grade];
 
-    InfixStore new_store(slot_count, new_infix_size);
+    InfixStore new_store(allocator_, slot_count, new_infix_size, size_grade);
 
     // Copy the occupieds and runends bitmaps
-    const uint32_t total_bitmap_size = 64 + infix_store_target_size + scaled_sizes_[size_grade];
+    const uint32_t total_bitmap_size = 64 * header_word_count + infix_store_target_size + scaled_sizes_[size_grade];
     memcpy(new_store.ptr, store.ptr, (total_bitmap_size + 7) / 8);
     uint8_t *new_store_byte_ptr = reinterpret_cast<uint8_t *>(new_store.ptr);
     new_store_byte_ptr[(total_bitmap_size + 7) / 8 - 1] &= BITMASK(total_bitmap_size % 8);
@@ -2703,14 +4797,14 @@ inline void Diva<int_optimized>::ShrinkInfixStoreInfixSize(InfixStore &store, co
             SetSlot(new_store, i, new_slot, new_infix_size);
         }
     }
-    delete[] store.ptr;
+    FreeInfixStorePtr(store.ptr, GetInfixStoreWordCount(store));
     store.ptr = new_store.ptr;
 }
 
 
-template <bool int_optimized>
-inline void Diva<int_optimized>::LoadListToInfixStore(InfixStore &store, const uint64_t *list, const uint32_t list_len,
-                                                      const uint32_t total_implicit, const bool zero_out) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline void Diva<int_optimized, target_size, t_int, thread_policy, t_index>::LoadListToInfixStore(InfixStore &store, const uint64_t *list, const uint32_t list_len,
+                                                                                                  const uint32_t total_implicit, const bool zero_out) {
     const uint32_t size_grade = store.GetSizeGrade();
     const uint32_t total_size = scaled_sizes_[size_grade];
 #ifdef DEBUG
@@ -2739,8 +4833,8 @@ inline void Diva<int_optimized>::LoadListToInfixStore(InfixStore &store, const u
     }
 #endif
 
-    uint64_t *occupieds = store.ptr + 1;
-    uint64_t *runends = store.ptr + 1 + infix_store_target_size / 64;
+    uint64_t *occupieds = store.ptr + header_word_count;
+    uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
     uint64_t old_implicit_part = list[0] >> infix_size_;
     l[0] = GetMappedPos(old_implicit_part, size_grade, implicit_scalar);
     r[0] = l[0];
@@ -2790,14 +4884,7 @@ inline void Diva<int_optimized>::LoadListToInfixStore(InfixStore &store, const u
     }
 #endif
 
-    uint32_t *popcnts = reinterpret_cast<uint32_t *>(store.ptr);
-    for (int32_t i = 0; i < infix_store_target_size / 128; i++) {
-        popcnts[0] += __builtin_popcountll(occupieds[i]);
-        if (static_cast<int32_t>(scaled_sizes_[size_grade]) - i * 64 > 0) {
-            const uint64_t mask = BITMASK(std::min(64UL, scaled_sizes_[size_grade] - i * 64));
-            popcnts[1] += __builtin_popcountll(runends[i] & mask);
-        }
-    }
+    ComputeRankDirectory(store, GetOccupiedsDirectory(store), GetRunendsDirectory(store));
 
 #ifdef DEBUG
     {
@@ -2815,25 +4902,25 @@ inline void Diva<int_optimized>::LoadListToInfixStore(InfixStore &store, const u
 }
 
 
-template <bool int_optimized>
-inline typename Diva<int_optimized>::InfixStore Diva<int_optimized>::AllocateInfixStoreWithList(const uint64_t *list,
-                                                                                                const uint32_t list_len,
-                                                                                                const uint32_t total_implicit) {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline typename Diva<int_optimized, target_size, t_int, thread_policy, t_index>::InfixStore Diva<int_optimized, target_size, t_int, thread_policy, t_index>::AllocateInfixStoreWithList(const uint64_t *list,
+                                                                                                                    const uint32_t list_len,
+                                                                                                                    const uint32_t total_implicit) {
     const uint32_t scaled_len = (size_scalars_[size_scalar_shrink_grow_sep] * list_len) >> scale_shift;
     uint32_t size_grade;
     for (size_grade = 0; size_grade < size_scalar_count && scaled_sizes_[size_grade] < scaled_len; size_grade++);
-    InfixStore res(scaled_sizes_[size_grade], infix_size_, size_grade);
+    InfixStore res(allocator_, scaled_sizes_[size_grade], infix_size_, size_grade);
     LoadListToInfixStore(res, list, list_len, total_implicit);
     return res;
 }
 
 
-template <bool int_optimized>
-inline uint32_t Diva<int_optimized>::GetInfixList(const InfixStore &store, uint64_t *res) const {
+template <bool int_optimized, uint32_t target_size, class t_int, ThreadPolicy thread_policy, template <class> class t_index>
+inline uint32_t Diva<int_optimized, target_size, t_int, thread_policy, t_index>::GetInfixList(const InfixStore &store, uint64_t *res) const {
     const uint32_t size_grade = store.GetSizeGrade();
     const uint32_t store_size = scaled_sizes_[size_grade];
-    const uint64_t *occupieds = store.ptr + 1;
-    const uint64_t *runends = store.ptr + 1 + infix_store_target_size / 64;
+    const uint64_t *occupieds = store.ptr + header_word_count;
+    const uint64_t *runends = store.ptr + header_word_count + infix_store_target_size / 64;
     uint64_t implicit_part = occupieds[0] & 1ULL ? 0 : NextOccupied(store, 0);
     uint32_t ind = 0;
     for (int32_t i = 0; i < store_size; i++) {
@@ -2863,17 +4950,12 @@ inline uint32_t Diva<int_optimized>::GetInfixList(const InfixStore &store, uint6
             runend_count += get_bitmap_bit(runends, i);
         assert(occupied_count == runend_count);
 
-        uint32_t *popcnts = reinterpret_cast<uint32_t *>(store.ptr);
-        uint32_t check_popcnts[2] = {};
-        for (int32_t i = 0; i < Diva<int_optimized>::infix_store_target_size / 128; i++) {
-            check_popcnts[0] += __builtin_popcountll(occupieds[i]);
-            if (static_cast<int32_t>(scaled_sizes_[size_grade]) - i * 64 > 0) {
-                const uint64_t mask = BITMASK(std::min(64UL, scaled_sizes_[size_grade] - i * 64));
-                check_popcnts[1] += __builtin_popcountll(runends[i] & mask);
-            }
+        uint16_t check_directories[2][rank_directory_size];
+        ComputeRankDirectory(store, check_directories[0], check_directories[1]);
+        for (int32_t i = 0; i < rank_directory_size; i++) {
+            assert(GetOccupiedsDirectory(store)[i] == check_directories[0][i]);
+            assert(GetRunendsDirectory(store)[i] == check_directories[1][i]);
         }
-        assert(popcnts[0] == check_popcnts[0]);
-        assert(popcnts[1] == check_popcnts[1]);
     }
 #endif
 
@@ -0,0 +1,417 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "diva.hpp"
+
+/**
+ * Diva front-end that partitions the key space into disjoint key ranges, each
+ * served by its own Diva instance. Operations on different shards proceed in
+ * parallel, and shards that grow hot are split online.
+ */
+template <bool int_optimized>
+class ShardedDiva {
+    friend class ShardedDivaTests;
+
+public:
+    template <class t_itr>
+    ShardedDiva(const uint32_t shard_count, const uint32_t infix_size, const t_itr begin, const t_itr end,
+                const uint32_t key_len, const uint32_t rng_seed, const float load_factor);
+
+    template <class t_itr>
+    ShardedDiva(const uint32_t shard_count, const uint32_t infix_size, const t_itr begin, const t_itr end,
+                const uint32_t rng_seed, const float load_factor);
+
+    ShardedDiva(char *deser_buf);
+
+    ~ShardedDiva();
+
+    void Insert(uint64_t key);
+    void Insert(std::string_view key);
+    void Insert(const uint8_t *key, const uint32_t key_len);
+    void Delete(uint64_t key);
+    void Delete(std::string_view input_key);
+    void Delete(const uint8_t *input_key, const uint32_t input_key_len);
+    bool RangeQuery(uint64_t l, uint64_t r) const;
+    bool RangeQuery(std::string_view input_l, std::string_view input_r) const;
+    bool RangeQuery(const uint8_t *input_l, const uint32_t input_l_len,
+                    const uint8_t *input_r, const uint32_t input_r_len) const;
+    bool PointQuery(uint64_t key) const;
+    bool PointQuery(std::string_view key) const;
+    bool PointQuery(const uint8_t *key, const uint32_t key_len) const;
+    void Rebalance();
+    uint32_t ShardCount() const;
+    uint64_t Size() const;
+    uint64_t Serialize(char *out) const;
+
+private:
+    static constexpr uint32_t hot_shard_factor = 2;
+    static constexpr uint64_t min_split_key_count = 4 * Diva<int_optimized>::infix_store_target_size;
+
+    struct alignas(64) Shard {
+        Diva<int_optimized> *diva;
+        std::string lower_key;      // Smallest key covered, empty for the first shard
+        uint64_t key_count;
+        uint64_t split_key_count;
+        std::mutex mutex;
+    };
+
+    std::vector<Shard *> shards_;
+    mutable std::shared_mutex shards_mutex_;
+
+    template <class t_itr>
+    void BulkLoadShards(const uint32_t shard_count, const uint32_t infix_size, const t_itr begin, const t_itr end,
+                        const uint32_t key_len, const uint32_t rng_seed, const float load_factor);
+    uint32_t FindShard(const uint8_t *key, const uint32_t key_len) const;
+    bool SplitShard(const uint32_t shard_ind);
+    uint64_t GetHotKeyCount() const;
+    void UpdateSplitKeyCounts();
+};
+
+
+template <bool int_optimized>
+template <class t_itr>
+inline ShardedDiva<int_optimized>::ShardedDiva(const uint32_t shard_count, const uint32_t infix_size,
+                                               const t_itr begin, const t_itr end, const uint32_t key_len,
+                                               const uint32_t rng_seed, const float load_factor) {
+    BulkLoadShards(shard_count, infix_size, begin, end, key_len, rng_seed, load_factor);
+}
+
+
+template <bool int_optimized>
+template <class t_itr>
+inline ShardedDiva<int_optimized>::ShardedDiva(const uint32_t shard_count, const uint32_t infix_size,
+                                               const t_itr begin, const t_itr end,
+                                               const uint32_t rng_seed, const float load_factor) {
+    BulkLoadShards(shard_count, infix_size, begin, end, 0, rng_seed, load_factor);
+}
+
+
+template <bool int_optimized>
+template <class t_itr>
+inline void ShardedDiva<int_optimized>::BulkLoadShards(const uint32_t shard_count, const uint32_t infix_size,
+                                                       const t_itr begin, const t_itr end, const uint32_t key_len,
+                                                       const uint32_t rng_seed, const float load_factor) {
+    // Shards split the sorted input at its quantiles. Integer keys go through
+    // the fixed-length bulk load, anything else is taken as a byte string.
+    using t_key = typename std::iterator_traits<t_itr>::value_type;
+    const uint64_t n_keys = std::distance(begin, end);
+    assert(n_keys > 0);
+    const uint32_t real_shard_count = std::max<uint64_t>(1, std::min<uint64_t>(shard_count, n_keys));
+    std::vector<t_itr> shard_begins;
+    for (int32_t i = 0; i <= real_shard_count; i++) {
+        shard_begins.push_back(std::next(begin, n_keys * i / real_shard_count));
+        if (i == real_shard_count)
+            break;
+        Shard *shard = new Shard;
+        shard->key_count = n_keys * (i + 1) / real_shard_count - n_keys * i / real_shard_count;
+        if (i > 0) {
+            if constexpr (!std::is_integral_v<t_key>) {
+                const std::string_view sv {*shard_begins[i]};
+                shard->lower_key.assign(sv.data(), sv.size());
+            }
+            else if constexpr (int_optimized) {
+                const uint64_t key = __builtin_bswap64(*shard_begins[i]);
+                shard->lower_key.assign(reinterpret_cast<const char *>(&key), key_len);
+            }
+            else
+                shard->lower_key.assign(reinterpret_cast<const char *>(&(*shard_begins[i])), key_len);
+        }
+        shards_.push_back(shard);
+    }
+
+    // Shards are bulk loaded in parallel, each thread taking every
+    // `thread_count`-th shard
+    const uint32_t thread_count = std::max<uint32_t>(1, std::min<uint32_t>(real_shard_count,
+                                                                           std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < thread_count; i++) {
+        threads.emplace_back([&, i]() {
+            for (int32_t j = i; j < real_shard_count; j += thread_count) {
+                if constexpr (!std::is_integral_v<t_key>)
+                    shards_[j]->diva = new Diva<int_optimized>(infix_size, shard_begins[j], shard_begins[j + 1],
+                                                               rng_seed + j, load_factor);
+                else
+                    shards_[j]->diva = new Diva<int_optimized>(infix_size, shard_begins[j], shard_begins[j + 1],
+                                                               key_len, rng_seed + j, load_factor);
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    UpdateSplitKeyCounts();
+}
+
+
+template <bool int_optimized>
+inline ShardedDiva<int_optimized>::~ShardedDiva() {
+    for (Shard *shard : shards_) {
+        delete shard->diva;
+        delete shard;
+    }
+}
+
+
+template <bool int_optimized>
+inline void ShardedDiva<int_optimized>::Insert(uint64_t key) {
+    key = __builtin_bswap64(key);
+    Insert(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
+}
+
+
+template <bool int_optimized>
+inline void ShardedDiva<int_optimized>::Insert(std::string_view key) {
+    Insert(reinterpret_cast<const uint8_t *>(key.data()), key.size());
+}
+
+
+template <bool int_optimized>
+inline void ShardedDiva<int_optimized>::Insert(const uint8_t *key, const uint32_t key_len) {
+    bool hot;
+    {
+        std::shared_lock<std::shared_mutex> shards_guard(shards_mutex_);
+        Shard *shard = shards_[FindShard(key, key_len)];
+        std::lock_guard<std::mutex> guard(shard->mutex);
+        shard->diva->Insert(key, key_len);
+        hot = ++shard->key_count > shard->split_key_count;
+    }
+    if (hot)
+        Rebalance();
+}
+
+
+template <bool int_optimized>
+inline void ShardedDiva<int_optimized>::Delete(uint64_t key) {
+    key = __builtin_bswap64(key);
+    Delete(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
+}
+
+
+template <bool int_optimized>
+inline void ShardedDiva<int_optimized>::Delete(std::string_view input_key) {
+    Delete(reinterpret_cast<const uint8_t *>(input_key.data()), input_key.size());
+}
+
+
+template <bool int_optimized>
+inline void ShardedDiva<int_optimized>::Delete(const uint8_t *input_key, const uint32_t input_key_len) {
+    std::shared_lock<std::shared_mutex> shards_guard(shards_mutex_);
+    Shard *shard = shards_[FindShard(input_key, input_key_len)];
+    std::lock_guard<std::mutex> guard(shard->mutex);
+    shard->diva->Delete(input_key, input_key_len);
+    shard->key_count -= shard->key_count > 0;
+}
+
+
+template <bool int_optimized>
+inline bool ShardedDiva<int_optimized>::RangeQuery(uint64_t l, uint64_t r) const {
+    l = __builtin_bswap64(l);
+    r = __builtin_bswap64(r);
+    return RangeQuery(reinterpret_cast<const uint8_t *>(&l), sizeof(l),
+                      reinterpret_cast<const uint8_t *>(&r), sizeof(r));
+}
+
+
+template <bool int_optimized>
+inline bool ShardedDiva<int_optimized>::RangeQuery(std::string_view input_l, std::string_view input_r) const {
+    return RangeQuery(reinterpret_cast<const uint8_t *>(input_l.data()), input_l.size(),
+                      reinterpret_cast<const uint8_t *>(input_r.data()), input_r.size());
+}
+
+
+template <bool int_optimized>
+inline bool ShardedDiva<int_optimized>::RangeQuery(const uint8_t *input_l, const uint32_t input_l_len,
+                                                   const uint8_t *input_r, const uint32_t input_r_len) const {
+    std::shared_lock<std::shared_mutex> shards_guard(shards_mutex_);
+    const uint32_t l_shard_ind = FindShard(input_l, input_l_len);
+    const uint32_t r_shard_ind = FindShard(input_r, input_r_len);
+    // Every shard covers its whole key range, so overlapping shards can be
+    // asked about the full query range
+    for (int32_t i = l_shard_ind; i <= r_shard_ind; i++) {
+        Shard *shard = shards_[i];
+        std::lock_guard<std::mutex> guard(shard->mutex);
+        if (shard->diva->RangeQuery(input_l, input_l_len, input_r, input_r_len))
+            return true;
+    }
+    return false;
+}
+
+
+template <bool int_optimized>
+inline bool ShardedDiva<int_optimized>::PointQuery(uint64_t key) const {
+    key = __builtin_bswap64(key);
+    return PointQuery(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
+}
+
+
+template <bool int_optimized>
+inline bool ShardedDiva<int_optimized>::PointQuery(std::string_view key) const {
+    return PointQuery(reinterpret_cast<const uint8_t *>(key.data()), key.size());
+}
+
+
+template <bool int_optimized>
+inline bool ShardedDiva<int_optimized>::PointQuery(const uint8_t *key, const uint32_t key_len) const {
+    std::shared_lock<std::shared_mutex> shards_guard(shards_mutex_);
+    Shard *shard = shards_[FindShard(key, key_len)];
+    std::lock_guard<std::mutex> guard(shard->mutex);
+    return shard->diva->PointQuery(key, key_len);
+}
+
+
+template <bool int_optimized>
+inline void ShardedDiva<int_optimized>::Rebalance() {
+    std::unique_lock<std::shared_mutex> shards_guard(shards_mutex_);
+    const uint64_t hot_key_count = GetHotKeyCount();
+    std::vector<bool> deferred(shards_.size(), false);
+    for (int32_t i = 0; i < shards_.size(); i++) {
+        if (shards_[i]->key_count <= hot_key_count)
+            continue;
+        if (SplitShard(i)) {
+            // Both halves are checked again
+            deferred.insert(deferred.begin() + i, false);
+            i--;
+        }
+        else
+            deferred[i] = true;
+    }
+
+    UpdateSplitKeyCounts();
+    for (int32_t i = 0; i < shards_.size(); i++) {
+        // Shards that could not be split are retried once they double in size
+        if (deferred[i])
+            shards_[i]->split_key_count = 2 * shards_[i]->key_count;
+    }
+}
+
+
+template <bool int_optimized>
+inline uint32_t ShardedDiva<int_optimized>::ShardCount() const {
+    std::shared_lock<std::shared_mutex> shards_guard(shards_mutex_);
+    return shards_.size();
+}
+
+
+template <bool int_optimized>
+inline uint32_t ShardedDiva<int_optimized>::FindShard(const uint8_t *key, const uint32_t key_len) const {
+    const std::string_view sv {reinterpret_cast<const char *>(key), key_len};
+    auto it = std::upper_bound(shards_.begin() + 1, shards_.end(), sv,
+                               [](const std::string_view key, const Shard *shard) {
+                                   return key < shard->lower_key;
+                               });
+    return it - shards_.begin() - 1;
+}
+
+
+template <bool int_optimized>
+inline bool ShardedDiva<int_optimized>::SplitShard(const uint32_t shard_ind) {
+    Shard *shard = shards_[shard_ind];
+    Shard *new_shard = new Shard;
+    uint64_t moved_key_count;
+    new_shard->diva = shard->diva->SplitUpperHalf(new_shard->lower_key, moved_key_count);
+    if (new_shard->diva == nullptr) {
+        delete new_shard;
+        return false;
+    }
+    new_shard->key_count = std::min(moved_key_count, shard->key_count);
+    shard->key_count -= new_shard->key_count;
+    shards_.insert(shards_.begin() + shard_ind + 1, new_shard);
+    return true;
+}
+
+
+template <bool int_optimized>
+inline uint64_t ShardedDiva<int_optimized>::GetHotKeyCount() const {
+    uint64_t total_key_count = 0;
+    for (Shard *shard : shards_)
+        total_key_count += shard->key_count;
+    return std::max<uint64_t>(hot_shard_factor * total_key_count / shards_.size(), min_split_key_count);
+}
+
+
+template <bool int_optimized>
+inline void ShardedDiva<int_optimized>::UpdateSplitKeyCounts() {
+    const uint64_t hot_key_count = GetHotKeyCount();
+    for (Shard *shard : shards_)
+        shard->split_key_count = hot_key_count;
+}
+
+
+template <bool int_optimized>
+inline uint64_t ShardedDiva<int_optimized>::Size() const {
+    std::shared_lock<std::shared_mutex> shards_guard(shards_mutex_);
+    uint64_t res = sizeof(uint32_t);
+    for (Shard *shard : shards_) {
+        std::lock_guard<std::mutex> guard(shard->mutex);
+        res += sizeof(uint32_t) + shard->lower_key.size() + sizeof(shard->key_count)
+             + sizeof(uint64_t) + shard->diva->Size();
+    }
+    return res;
+}
+
+
+template <bool int_optimized>
+inline uint64_t ShardedDiva<int_optimized>::Serialize(char *out) const {
+    std::shared_lock<std::shared_mutex> shards_guard(shards_mutex_);
+    uint64_t res = 0;
+    const uint32_t shard_count = shards_.size();
+    memcpy(out + res, &shard_count, sizeof(shard_count));
+    res += sizeof(shard_count);
+
+    for (Shard *shard : shards_) {
+        std::lock_guard<std::mutex> guard(shard->mutex);
+        const uint32_t lower_key_len = shard->lower_key.size();
+        memcpy(out + res, &lower_key_len, sizeof(lower_key_len));
+        res += sizeof(lower_key_len);
+        memcpy(out + res, shard->lower_key.data(), lower_key_len);
+        res += lower_key_len;
+        memcpy(out + res, &shard->key_count, sizeof(shard->key_count));
+        res += sizeof(shard->key_count);
+
+        // Each shard is prefixed with its serialized size, so that the
+        // deserializer can skip over it
+        const uint64_t diva_size = shard->diva->Serialize(out + res + sizeof(diva_size));
+        memcpy(out + res, &diva_size, sizeof(diva_size));
+        res += sizeof(diva_size) + diva_size;
+    }
+    return res;
+}
+
+
+template <bool int_optimized>
+inline ShardedDiva<int_optimized>::ShardedDiva(char *deser_buf) {
+    uint64_t ind = 0;
+    uint32_t shard_count;
+    memcpy(&shard_count, deser_buf + ind, sizeof(shard_count));
+    ind += sizeof(shard_count);
+
+    for (int32_t i = 0; i < shard_count; i++) {
+        Shard *shard = new Shard;
+        uint32_t lower_key_len;
+        memcpy(&lower_key_len, deser_buf + ind, sizeof(lower_key_len));
+        ind += sizeof(lower_key_len);
+        shard->lower_key.assign(deser_buf + ind, lower_key_len);
+        ind += lower_key_len;
+        memcpy(&shard->key_count, deser_buf + ind, sizeof(shard->key_count));
+        ind += sizeof(shard->key_count);
+
+        uint64_t diva_size;
+        memcpy(&diva_size, deser_buf + ind, sizeof(diva_size));
+        ind += sizeof(diva_size);
+        shard->diva = new Diva<int_optimized>(deser_buf + ind);
+        ind += diva_size;
+        shards_.push_back(shard);
+    }
+    UpdateSplitKeyCounts();
+}
+
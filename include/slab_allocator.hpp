@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "wormhole/lib.h"
+
+/**
+ * Fixed-size buffer allocator with one size class per word count. Buffers are
+ * carved out of large page-backed chunks and freed buffers are recycled
+ * within their class, so churn between neighbouring sizes does not fragment
+ * the heap. Each buffer can be followed by a few spare words that no other
+ * buffer overlaps, for callers that access memory in whole words past the end.
+ * Chunks follow the huge page policy set with `pages_set_huge`.
+ */
+class SlabAllocator {
+public:
+    struct Stats {
+        uint64_t class_count;
+        uint64_t chunk_count;
+        uint64_t reserved_bytes;    // mapped for chunks
+        uint64_t allocated_bytes;   // handed out and not freed yet
+        uint64_t free_bytes;        // on free lists, ready for reuse
+    };
+
+    static constexpr uint64_t min_chunk_size = 1ULL << 16;
+    static constexpr uint64_t max_chunk_size = 1ULL << 21;
+
+    SlabAllocator(const uint32_t spare_words=0): spare_words_(spare_words) {};
+    SlabAllocator(const SlabAllocator &other) = delete;
+    SlabAllocator &operator=(const SlabAllocator &other) = delete;
+    ~SlabAllocator();
+
+    uint64_t *Allocate(const uint32_t word_count);
+    void Free(uint64_t *ptr, const uint32_t word_count);
+    // Unmaps every chunk at once, invalidating all buffers still handed out
+    void Release();
+    Stats GetStats() const;
+
+private:
+    struct SizeClass {
+        uint64_t *free_head = nullptr;  // freed buffers keep the next pointer in their first word
+        uint64_t free_count = 0;
+        uint64_t allocated_count = 0;
+    };
+
+    const uint32_t spare_words_;
+    std::unordered_map<uint32_t, SizeClass> classes_;
+    std::vector<std::pair<void *, uint64_t>> chunks_;
+    uint64_t *chunk_ptr_ = nullptr, *chunk_end_ = nullptr;
+    uint64_t next_chunk_size_ = min_chunk_size;
+    uint64_t reserved_bytes_ = 0;
+    mutable std::mutex mutex_;
+};
+
+
+inline SlabAllocator::~SlabAllocator() {
+    for (auto [chunk, size] : chunks_)
+        pages_unmap(chunk, size);
+}
+
+
+inline uint64_t *SlabAllocator::Allocate(const uint32_t word_count) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    SizeClass &size_class = classes_[word_count];
+    size_class.allocated_count++;
+    if (size_class.free_head != nullptr) {
+        uint64_t *res = size_class.free_head;
+        size_class.free_head = reinterpret_cast<uint64_t *>(res[0]);
+        size_class.free_count--;
+        return res;
+    }
+
+    const uint32_t stride = word_count + spare_words_;
+    if (chunk_ptr_ + stride > chunk_end_) {
+        // Chunks grow geometrically, so small filters stay small, unless huge
+        // pages are requested, in which case every chunk spans whole huge pages
+        const uint64_t requested_size = std::max<uint64_t>(pages_huge_block(next_chunk_size_), stride * sizeof(uint64_t));
+        next_chunk_size_ = std::min(next_chunk_size_ * 2, max_chunk_size);
+        u64 chunk_size;
+        void *chunk = pages_alloc_best(requested_size, false, &chunk_size);
+        assert(chunk != nullptr && "Could not allocate a slab chunk");
+        chunks_.emplace_back(chunk, chunk_size);
+        reserved_bytes_ += chunk_size;
+        chunk_ptr_ = static_cast<uint64_t *>(chunk);
+        chunk_end_ = chunk_ptr_ + chunk_size / sizeof(uint64_t);
+    }
+    uint64_t *res = chunk_ptr_;
+    chunk_ptr_ += stride;
+    return res;
+}
+
+
+inline void SlabAllocator::Free(uint64_t *ptr, const uint32_t word_count) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    SizeClass &size_class = classes_[word_count];
+#ifdef DEBUG
+    assert(size_class.allocated_count > 0);
+#endif
+    ptr[0] = reinterpret_cast<uint64_t>(size_class.free_head);
+    size_class.free_head = ptr;
+    size_class.free_count++;
+    size_class.allocated_count--;
+}
+
+
+inline void SlabAllocator::Release() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto [chunk, size] : chunks_)
+        pages_unmap(chunk, size);
+    chunks_.clear();
+    classes_.clear();
+    chunk_ptr_ = chunk_end_ = nullptr;
+    next_chunk_size_ = min_chunk_size;
+    reserved_bytes_ = 0;
+}
+
+
+inline SlabAllocator::Stats SlabAllocator::GetStats() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Stats res = {classes_.size(), chunks_.size(), reserved_bytes_, 0, 0};
+    for (const auto &[word_count, size_class] : classes_) {
+        res.allocated_bytes += size_class.allocated_count * word_count * sizeof(uint64_t);
+        res.free_bytes += size_class.free_count * word_count * sizeof(uint64_t);
+    }
+    return res;
+}
@@ -4,6 +4,16 @@
 #include <cstdint>
 #include <immintrin.h>
 
+// Portable builds (-DDIVA_PORTABLE) target a baseline ISA and clone the hot
+// bitmap routines for newer ones; an ifunc resolver picks one per host
+#if defined(DIVA_PORTABLE) && defined(__x86_64__) && defined(__linux__)
+#define DIVA_MULTIVERSION __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#define DIVA_MULTIVERSION_INLINE DIVA_MULTIVERSION
+#else
+#define DIVA_MULTIVERSION
+#define DIVA_MULTIVERSION_INLINE __attribute__((always_inline))
+#endif
+
 #define MAX_VALUE(nbits) ((1ULL << (nbits)) - 1)
 #define BITMASK(nbits)                                    \
   ((nbits) == 64 ? 0xffffffffffffffff : MAX_VALUE(nbits))
@@ -136,16 +146,62 @@ static inline uint64_t _select64(uint64_t x, int k)
 	return place + kSelectInByte[((x >> place) & 0xFF) | (byteRank << 8)];
 }
 
+struct CpuFeatures {
+    bool avx2;
+    bool avx512_popcnt;
+    bool fast_pdep;     // BMI2, except on Zen 1 and 2 where PDEP is microcoded
+};
+
+inline CpuFeatures detect_cpu_features() {
+    __builtin_cpu_init();
+    const bool slow_pdep = __builtin_cpu_is("znver1") || __builtin_cpu_is("znver2");
+    return {static_cast<bool>(__builtin_cpu_supports("avx2")),
+            static_cast<bool>(__builtin_cpu_supports("avx512vpopcntdq")),
+            __builtin_cpu_supports("bmi2") && !slow_pdep};
+}
+
+inline const CpuFeatures cpu_features = detect_cpu_features();
+
+
+__attribute__((always_inline))
+static inline int32_t trailing_zeros(uint64_t val) {
+#ifdef __BMI__
+    return __builtin_ia32_tzcnt_u64(val);
+#else
+    return val ? __builtin_ctzll(val) : 64;
+#endif
+}
+
+
+__attribute__((always_inline))
+static inline int32_t leading_zeros(uint64_t val) {
+#ifdef __LZCNT__
+    return __builtin_ia32_lzcnt_u64(val);
+#else
+    return val ? __builtin_clzll(val) : 64;
+#endif
+}
+
+
+__attribute__((target("bmi,bmi2")))
+static inline uint32_t bit_select_bmi2(uint64_t val, uint32_t i) {
+    uint64_t tmp = 1ULL << i;
+    tmp = _pdep_u64(tmp, val);
+    return _tzcnt_u64(tmp);
+}
+
+
 // Returns the position of the rank'th 1.  (rank = 0 returns the first 1)
 // Returns 64 if there are fewer than rank+1 1s.
 __attribute__((always_inline))
 static inline uint32_t bit_select(uint64_t val, uint32_t i) {
 #ifdef __BMI2__
-    uint64_t tmp = 1ULL << i;
-    tmp = _pdep_u64(tmp, val);
-    return __builtin_ia32_tzcnt_u64(tmp);
-#endif
+    return bit_select_bmi2(val, i);
+#else
+    if (cpu_features.fast_pdep)
+        return bit_select_bmi2(val, i);
     return _select64(val, i);
+#endif
 }
 
 
@@ -155,15 +211,144 @@ static inline uint32_t bit_rank(uint64_t val, uint32_t i) {
 }
 
 
+static inline uint32_t popcount_words_scalar(const uint64_t *words, const uint32_t word_count) {
+    uint32_t res = 0;
+    for (uint32_t i = 0; i < word_count; i++)
+        res += __builtin_popcountll(words[i]);
+    return res;
+}
+
+
+// Nibble lookups with pshufb, for hosts without VPOPCNTQ
+__attribute__((target("avx2")))
+static inline __m256i popcount_epi64_avx2(const __m256i words) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    const __m256i low = _mm256_and_si256(words, low_mask);
+    const __m256i high = _mm256_and_si256(_mm256_srli_epi16(words, 4), low_mask);
+    const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+
+__attribute__((target("avx2")))
+static inline uint32_t popcount_words_avx2(const uint64_t *words, const uint32_t word_count) {
+    const __m256i lane = _mm256_setr_epi64x(0, 1, 2, 3);
+    __m256i sum = _mm256_setzero_si256();
+    for (uint32_t i = 0; i < word_count; i += 4) {
+        const __m256i valid = _mm256_cmpgt_epi64(_mm256_set1_epi64x(word_count - i), lane);
+        const __m256i words_vec = _mm256_maskload_epi64(reinterpret_cast<const long long *>(words + i), valid);
+        sum = _mm256_add_epi64(sum, popcount_epi64_avx2(words_vec));
+    }
+    const __m128i half_sum = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    return _mm_cvtsi128_si64(half_sum) + _mm_extract_epi64(half_sum, 1);
+}
+
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static inline uint32_t popcount_words_avx512(const uint64_t *words, const uint32_t word_count) {
+    uint32_t res = 0, i = 0;
+    for (; i + 8 <= word_count; i += 8)
+        res += _mm512_reduce_add_epi64(_mm512_popcnt_epi64(_mm512_loadu_si512(words + i)));
+    if (i < word_count) {
+        const __mmask8 valid = (1U << (word_count - i)) - 1;
+        res += _mm512_reduce_add_epi64(_mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(valid, words + i)));
+    }
+    return res;
+}
+
+
+// Returns the number of 1s in the first `word_count` words of the bitmap
+__attribute__((always_inline))
+static inline uint32_t popcount_words(const uint64_t *words, const uint32_t word_count) {
+#if defined(__AVX512VPOPCNTDQ__)
+    return popcount_words_avx512(words, word_count);
+#elif defined(__AVX2__)
+    return popcount_words_avx2(words, word_count);
+#else
+    if (cpu_features.avx512_popcnt)
+        return popcount_words_avx512(words, word_count);
+    if (cpu_features.avx2)
+        return popcount_words_avx2(words, word_count);
+    return popcount_words_scalar(words, word_count);
+#endif
+}
+
+
+static inline uint32_t select_word_scalar(const uint64_t *words, const uint32_t word_count, const uint32_t rank,
+                                          uint32_t &rank_before) {
+    uint32_t i, old_total_set_bits = 0, total_set_bits = 0;
+    for (i = 0; total_set_bits <= rank && i < word_count; i++) {
+        old_total_set_bits = total_set_bits;
+        total_set_bits += __builtin_popcountll(words[i]);
+    }
+    rank_before = old_total_set_bits;
+    return i - 1;
+}
+
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static inline uint32_t select_word_avx512(const uint64_t *words, const uint32_t word_count, const uint32_t rank,
+                                          uint32_t &rank_before) {
+    if (word_count == 0)
+        return select_word_scalar(words, word_count, rank, rank_before);
+
+    // Inclusive prefix sums of the word popcounts, eight words at a time; the
+    // words whose prefix sum does not exceed `rank` all come before the answer
+    const __m512i shift_1 = _mm512_setr_epi64(0, 0, 1, 2, 3, 4, 5, 6);
+    const __m512i shift_2 = _mm512_setr_epi64(0, 0, 0, 1, 2, 3, 4, 5);
+    const __m512i shift_4 = _mm512_setr_epi64(0, 0, 0, 0, 0, 1, 2, 3);
+    const __m512i target = _mm512_set1_epi64(rank);
+    __m512i carry = _mm512_setzero_si512(), before;
+    uint32_t res = 0;
+    for (uint32_t i = 0; i < word_count; i += 8) {
+        const __mmask8 valid = word_count - i >= 8 ? 0xFF : (1U << (word_count - i)) - 1;
+        const __m512i counts = _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(valid, words + i));
+        __m512i prefix = _mm512_add_epi64(counts, _mm512_maskz_permutexvar_epi64(0xFE, shift_1, counts));
+        prefix = _mm512_add_epi64(prefix, _mm512_maskz_permutexvar_epi64(0xFC, shift_2, prefix));
+        prefix = _mm512_add_epi64(prefix, _mm512_maskz_permutexvar_epi64(0xF0, shift_4, prefix));
+        prefix = _mm512_add_epi64(prefix, carry);
+        before = _mm512_sub_epi64(prefix, counts);
+        const uint32_t below = __builtin_popcount(_mm512_mask_cmple_epu64_mask(valid, prefix, target));
+        res += below;
+        if (below < 8)
+            break;
+        carry = _mm512_permutexvar_epi64(_mm512_set1_epi64(7), prefix);
+    }
+    res = std::min(res, word_count - 1);
+    rank_before = _mm_cvtsi128_si64(_mm512_castsi512_si128(_mm512_permutexvar_epi64(_mm512_set1_epi64(res % 8), before)));
+    return res;
+}
+
+
+// Returns the index of the word holding the rank'th 1 of the bitmap, or the
+// last word if there are fewer than rank+1 1s, and sets `rank_before` to the
+// number of 1s in the words before it
+__attribute__((always_inline))
+static inline uint32_t select_word(const uint64_t *words, const uint32_t word_count, const uint32_t rank,
+                                   uint32_t &rank_before) {
+    // Without VPOPCNTQ, vector popcounts lose to POPCNT once the prefix sums
+    // are added, so select stays scalar
+#ifdef __AVX512VPOPCNTDQ__
+    return select_word_avx512(words, word_count, rank, rank_before);
+#else
+    if (cpu_features.avx512_popcnt)
+        return select_word_avx512(words, word_count, rank, rank_before);
+    return select_word_scalar(words, word_count, rank, rank_before);
+#endif
+}
+
+
 __attribute__((always_inline))
 static inline int32_t lowbit_pos(uint64_t val) {
-    return __builtin_ia32_tzcnt_u64(val);
+    return trailing_zeros(val);
 }
 
 
 __attribute__((always_inline))
 static inline int32_t highbit_pos(uint64_t val) {
-    return 8 * sizeof(val) - __builtin_ia32_lzcnt_u64(val) - 1;
+    return 8 * sizeof(val) - leading_zeros(val) - 1;
 }
 
 
@@ -185,6 +370,32 @@ static inline uint64_t get_bitmap_bit(const uint64_t *bitmap, const uint32_t pos
 }
 
 
+// LEB128 varints, seven bits per byte with the high bit set on all but the last
+static inline uint8_t *put_varint(uint8_t *out, uint32_t val) {
+    while (val >= 0x80) {
+        *out++ = static_cast<uint8_t>(val) | 0x80;
+        val >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(val);
+    return out;
+}
+
+
+__attribute__((always_inline))
+static inline const uint8_t *get_varint(const uint8_t *in, uint32_t &val) {
+    val = *in & 0x7F;
+    for (uint32_t shift = 7; *in++ & 0x80; shift += 7)
+        val |= static_cast<uint32_t>(*in & 0x7F) << shift;
+    return in;
+}
+
+
+__attribute__((always_inline))
+inline auto to_big_endian_order(unsigned __int128 const &key) {
+	return (static_cast<unsigned __int128>(__builtin_bswap64(static_cast<uint64_t>(key))) << 64)
+	     | __builtin_bswap64(static_cast<uint64_t>(key >> 64));
+};
+
 __attribute__((always_inline))
 inline auto to_big_endian_order(uint64_t const &key) {
 	return __builtin_bswap64(key);
@@ -202,7 +413,7 @@ inline auto to_big_endian_order(uint16_t const &key) {
 };
 
 
-__attribute__((always_inline))
+DIVA_MULTIVERSION_INLINE
 inline void shift_bitmap_right(uint64_t *ptr, const uint32_t l, const uint32_t r, const uint32_t shamt) {
     const int32_t l_src_bit_pos = l;
     int32_t r_src_bit_pos = r;
@@ -233,7 +444,7 @@ inline void shift_bitmap_right(uint64_t *ptr, const uint32_t l, const uint32_t r
 }
 
 
-__attribute__((always_inline))
+DIVA_MULTIVERSION_INLINE
 inline void shift_bitmap_left(uint64_t *ptr, const uint32_t l, const uint32_t r, const uint32_t shamt) {
     int32_t l_src_bit_pos = l;
     const int32_t r_src_bit_pos = r;
@@ -378,6 +378,12 @@ struct kvmap_api {
   void *      (* iter_create)   (void * const ref);
   // move the cursor to the first key >= search-key;
   void        (* iter_seek)     (void * const iter, const struct kref * const key);
+  // move the cursor to the last key <= search-key; the cursor is invalid if there is none
+  void        (* iter_seek_le)  (void * const iter, const struct kref * const key);
+  // iter_seek_le that also returns the key under the cursor and the one after it (the first key > search-key)
+  // the out kvrefs have a NULL kptr if there is no such key
+  void        (* iter_seek_near)  (void * const iter, const struct kref * const key,
+                                   struct kvref * const le, struct kvref * const gt);
   // check if the cursor points to a valid key
   bool        (* iter_valid)    (void * const iter);
   // return the current key; copy to out if (out != NULL)
@@ -750,6 +750,57 @@ pages_alloc_4kb(const size_t nr_4kb)
     memset(p, 0, sz);
   return p;
 #endif
+}
+
+static enum pages_huge pages_huge_policy = PAGES_HUGE_AUTO;
+
+  void
+pages_set_huge(const enum pages_huge huge)
+{
+  pages_huge_policy = huge;
+}
+
+  enum pages_huge
+pages_get_huge(void)
+{
+  return pages_huge_policy;
+}
+
+  size_t
+pages_huge_block(const size_t size)
+{
+  switch (pages_huge_policy) {
+  case PAGES_HUGE_2MB:
+    return size < (1lu << 21) ? (1lu << 21) : size;
+  case PAGES_HUGE_1GB:
+    return size < (1lu << 30) ? (1lu << 30) : size;
+  default:
+    return size;
+  }
+}
+
+// 2mb-aligned 4kb pages that the kernel may promote to huge pages
+  static void *
+pages_alloc_thp(const size_t nr_2mb)
+{
+  const size_t sz = nr_2mb << 21;
+#ifndef HEAPCHECKING
+  u8 * const p = mmap(NULL, sz + (1lu << 21), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+    return NULL;
+
+  u8 * const a = (u8 *)bits_round_up((u64)p, 21);
+  if (a > p)
+    munmap(p, (size_t)(a - p));
+  munmap(a + sz, (size_t)(p + (1lu << 21) - a));
+#if defined(MADV_HUGEPAGE)
+  madvise(a, sz, MADV_HUGEPAGE);
+#endif
+  pages_lock(a, sz);
+  return a;
+#else
+  return pages_alloc_2mb(nr_2mb);
+#endif
 }
 
   void *
@@ -759,8 +810,12 @@ pages_alloc_best(const size_t size, const bool try_1gb, u64 * const size_out)
   if (alloc_fail())
     return NULL;
 #endif
+  const enum pages_huge huge = pages_huge_policy;
+  if (huge == PAGES_HUGE_NONE)
+    goto small;
+
   // 1gb huge page: at least 0.25GB
-  if (try_1gb) {
+  if ((try_1gb && huge == PAGES_HUGE_AUTO) || huge == PAGES_HUGE_1GB) {
     if (size >= (1lu << 28)) {
       const size_t nr_1gb = bits_round_up(size, 30) >> 30;
       void * const p1 = pages_alloc_1gb(nr_1gb);
@@ -779,8 +834,16 @@ pages_alloc_best(const size_t size, const bool try_1gb, u64 * const size_out)
       *size_out = nr_2mb << 21;
       return p2;
     }
+    if (huge != PAGES_HUGE_AUTO) {
+      void * const pt = pages_alloc_thp(nr_2mb);
+      if (pt) {
+        *size_out = nr_2mb << 21;
+        return pt;
+      }
+    }
   }
 
+small:;
   const size_t nr_4kb = bits_round_up(size, 12) >> 12;
   void * const p3 = pages_alloc_4kb(nr_4kb);
   if (p3)
@@ -264,6 +264,24 @@ pages_alloc_1gb(const size_t nr_1gb);
 
   extern void *
 pages_alloc_best(const size_t size, const bool try_1gb, u64 * const size_out);
+
+// policy of pages_alloc_best; process-wide, applies to later allocations
+enum pages_huge {
+  PAGES_HUGE_AUTO = 0, // hugetlb when available, else 4kb (default)
+  PAGES_HUGE_NONE, // 4kb only
+  PAGES_HUGE_2MB, // 2mb hugetlb, else transparent huge pages
+  PAGES_HUGE_1GB, // 1gb hugetlb, else as PAGES_HUGE_2MB
+};
+
+  extern void
+pages_set_huge(const enum pages_huge huge);
+
+  extern enum pages_huge
+pages_get_huge(void);
+
+// block size for pools of blocks (e.g., slabs) under the current policy
+  extern size_t
+pages_huge_block(const size_t size);
 // }}} mm
 
 // process/thread {{{
@@ -62,7 +62,8 @@ struct wormleaf {
 
   struct entry13 hs[WH_KPN]; // sorted by hashes
   u8 ss[WH_KPN]; // sorted by keys
-};
+} __attribute__((aligned(64))); // wormmeta keeps leaf pointers in the upper bits of entry13
+static_assert((sizeof(struct wormleaf) % 64) == 0, "sizeof(wormleaf) % 64 != 0");
 
 struct wormslot { u16 t[WH_BKT_NR]; };
 static_assert(sizeof(struct wormslot) == 16, "sizeof(wormslot) != 16");
@@ -1118,17 +1119,17 @@ wormhole_create_internal(const struct kvmap_mm * const mm, const u32 nh)
     if (!wormhmap_init(hmap, map->pbuf))
       goto fail;
 
-    hmap->slab1 = slab_create(sizeof(struct wormmeta), WH_SLABMETA_SIZE);
+    hmap->slab1 = slab_create(sizeof(struct wormmeta), pages_huge_block(WH_SLABMETA_SIZE));
     if (hmap->slab1 == NULL)
       goto fail;
 
-    hmap->slab2 = slab_create(sizeof(struct wormmeta) + (sizeof(u64) * WH_BMNR), WH_SLABMETA_SIZE);
+    hmap->slab2 = slab_create(sizeof(struct wormmeta) + (sizeof(u64) * WH_BMNR), pages_huge_block(WH_SLABMETA_SIZE));
     if (hmap->slab2 == NULL)
       goto fail;
   }
 
   // leaf slab
-  map->slab_leaf = slab_create(sizeof(struct wormleaf), WH_SLABLEAF_SIZE);
+  map->slab_leaf = slab_create(sizeof(struct wormleaf), pages_huge_block(WH_SLABLEAF_SIZE));
   if (map->slab_leaf == NULL)
     goto fail;
 
@@ -1565,6 +1566,20 @@ wormleaf_seek(const struct wormleaf * const leaf, const struct kref * const key)
   }
 }
 
+// search the last key that is <= the given key
+// return -1 .. nr_sorted-1
+  static int
+wormleaf_seek_le(const struct wormleaf * const leaf, const struct kref * const key)
+{
+  debug_assert(leaf->nr_sorted == leaf->nr_keys);
+  const u32 ih = wormleaf_match_hs(leaf, key);
+  if (ih < WH_KPN) { // hit
+    return (int)wormleaf_search_is(leaf, (u8)ih);
+  } else { // miss, the one before the first gt
+    return (int)wormleaf_search_ss(leaf, key) - 1;
+  }
+}
+
 // same to search_sorted but the target is very likely beyond the end
   static u32
 wormleaf_seek_end(const struct wormleaf * const leaf, const struct kref * const key)
@@ -3126,6 +3141,83 @@ whsafe_iter_seek(struct wormhole_iter * const iter, const struct kref * const ke
   wormhole_iter_seek(iter, key);
 }
 
+  void
+wormhole_iter_seek_le(struct wormhole_iter * const iter, const struct kref * const key)
+{
+  debug_assert(key);
+  if (iter->leaf)
+    wormleaf_unlock_read(iter->leaf);
+
+  struct wormleaf * const leaf = wormhole_jump_leaf_read(iter->ref, key);
+  wormhole_iter_leaf_sync_sorted(leaf);
+
+  iter->leaf = leaf;
+  iter->is = wormleaf_seek_le(leaf, key);
+  wormhole_iter_fix_rev(iter);
+}
+
+  void
+whsafe_iter_seek_le(struct wormhole_iter * const iter, const struct kref * const key)
+{
+  wormhole_resume(iter->ref);
+  wormhole_iter_seek_le(iter, key);
+}
+
+// the first key of the leaves after leaf; the iter keeps its lock on leaf
+  static void
+wormhole_iter_first_after(struct wormref * const ref, const struct wormleaf * const leaf,
+    struct kvref * const kvref)
+{
+  struct wormleaf * next = leaf->next;
+  while (next) {
+    wormleaf_lock_read(next, ref);
+    wormhole_iter_leaf_sync_sorted(next);
+    struct wormleaf * const next1 = next->next;
+    if (next->nr_sorted) {
+      kvref_ref_kv(kvref, wormleaf_kv_at_is(next, 0));
+      wormleaf_unlock_read(next);
+      return;
+    }
+    wormleaf_unlock_read(next);
+    next = next1;
+  }
+  memset(kvref, 0, sizeof(*kvref));
+}
+
+// both neighbours come from the leaf the search lands in, unless one of them
+// is across a leaf boundary
+  void
+wormhole_iter_seek_near(struct wormhole_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt)
+{
+  debug_assert(key);
+  if (iter->leaf)
+    wormleaf_unlock_read(iter->leaf);
+
+  struct wormleaf * const leaf = wormhole_jump_leaf_read(iter->ref, key);
+  wormhole_iter_leaf_sync_sorted(leaf);
+
+  iter->leaf = leaf;
+  iter->is = wormleaf_seek_le(leaf, key);
+  const u32 i1 = (u32)(iter->is + 1);
+  if (likely(i1 < leaf->nr_sorted))
+    kvref_ref_kv(gt, wormleaf_kv_at_is(leaf, i1));
+  else
+    wormhole_iter_first_after(iter->ref, leaf, gt);
+
+  wormhole_iter_fix_rev(iter);
+  if (!wormhole_iter_kvref(iter, le))
+    memset(le, 0, sizeof(*le));
+}
+
+  void
+whsafe_iter_seek_near(struct wormhole_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt)
+{
+  wormhole_resume(iter->ref);
+  wormhole_iter_seek_near(iter, key, le, gt);
+}
+
   bool
 wormhole_iter_valid(struct wormhole_iter * const iter)
 {
@@ -3296,6 +3388,23 @@ whunsafe_iter_fix(struct wormhole_iter * const iter)
   }
 }
 
+  static void
+whunsafe_iter_fix_rev(struct wormhole_iter * const iter)
+{
+  if (!wormhole_iter_valid(iter))
+    return;
+
+  while (unlikely(iter->is < 0)) {
+    struct wormleaf * const prev = iter->leaf->prev;
+    if (likely(prev != NULL))
+      wormhole_iter_leaf_sync_sorted(prev);
+    iter->leaf = prev;
+    if (!wormhole_iter_valid(iter))
+      return;
+    iter->is = prev->nr_keys - 1;
+  }
+}
+
   void
 whunsafe_iter_seek(struct wormhole_iter * const iter, const struct kref * const key)
 {
@@ -3307,6 +3416,50 @@ whunsafe_iter_seek(struct wormhole_iter * const iter, const struct kref * const
   whunsafe_iter_fix(iter);
 }
 
+  void
+whunsafe_iter_seek_le(struct wormhole_iter * const iter, const struct kref * const key)
+{
+  struct wormleaf * const leaf = wormhole_jump_leaf(iter->map->hmap, key);
+  wormhole_iter_leaf_sync_sorted(leaf);
+
+  iter->leaf = leaf;
+  iter->is = wormleaf_seek_le(leaf, key);
+  whunsafe_iter_fix_rev(iter);
+}
+
+  static void
+whunsafe_iter_first_after(const struct wormleaf * const leaf, struct kvref * const kvref)
+{
+  for (struct wormleaf * next = leaf->next; next; next = next->next) {
+    wormhole_iter_leaf_sync_sorted(next);
+    if (next->nr_sorted) {
+      kvref_ref_kv(kvref, wormleaf_kv_at_is(next, 0));
+      return;
+    }
+  }
+  memset(kvref, 0, sizeof(*kvref));
+}
+
+  void
+whunsafe_iter_seek_near(struct wormhole_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt)
+{
+  struct wormleaf * const leaf = wormhole_jump_leaf(iter->map->hmap, key);
+  wormhole_iter_leaf_sync_sorted(leaf);
+
+  iter->leaf = leaf;
+  iter->is = wormleaf_seek_le(leaf, key);
+  const u32 i1 = (u32)(iter->is + 1);
+  if (likely(i1 < leaf->nr_sorted))
+    kvref_ref_kv(gt, wormleaf_kv_at_is(leaf, i1));
+  else
+    whunsafe_iter_first_after(leaf, gt);
+
+  whunsafe_iter_fix_rev(iter);
+  if (!wormhole_iter_kvref(iter, le))
+    memset(le, 0, sizeof(*le));
+}
+
   void
 whunsafe_iter_skip1(struct wormhole_iter * const iter)
 {
@@ -3337,6 +3490,15 @@ whunsafe_iter_next(struct wormhole_iter * const iter, struct kv * const out)
   return ret;
 }
 
+  void
+whunsafe_iter_skip1_rev(struct wormhole_iter * const iter)
+{
+  if (wormhole_iter_valid(iter)) {
+    iter->is--;
+    whunsafe_iter_fix_rev(iter);
+  }
+}
+
   void
 whunsafe_iter_destroy(struct wormhole_iter * const iter)
 {
@@ -3496,6 +3658,8 @@ const struct kvmap_api kvmap_api_wormhole = {
   .delr = (void *)wormhole_delr,
   .iter_create = (void *)wormhole_iter_create,
   .iter_seek = (void *)wormhole_iter_seek,
+  .iter_seek_le = (void *)wormhole_iter_seek_le,
+  .iter_seek_near = (void *)wormhole_iter_seek_near,
   .iter_valid = (void *)wormhole_iter_valid,
   .iter_peek = (void *)wormhole_iter_peek,
   .iter_kref = (void *)wormhole_iter_kref,
@@ -3531,6 +3695,8 @@ const struct kvmap_api kvmap_api_whsafe = {
   .delr = (void *)whsafe_delr,
   .iter_create = (void *)wormhole_iter_create,
   .iter_seek = (void *)whsafe_iter_seek,
+  .iter_seek_le = (void *)whsafe_iter_seek_le,
+  .iter_seek_near = (void *)whsafe_iter_seek_near,
   .iter_valid = (void *)wormhole_iter_valid,
   .iter_peek = (void *)wormhole_iter_peek,
   .iter_kref = (void *)wormhole_iter_kref,
@@ -3563,12 +3729,15 @@ const struct kvmap_api kvmap_api_whunsafe = {
   .delr = (void *)whunsafe_delr,
   .iter_create = (void *)whunsafe_iter_create,
   .iter_seek = (void *)whunsafe_iter_seek,
+  .iter_seek_le = (void *)whunsafe_iter_seek_le,
+  .iter_seek_near = (void *)whunsafe_iter_seek_near,
   .iter_valid = (void *)wormhole_iter_valid,
   .iter_peek = (void *)wormhole_iter_peek,
   .iter_kref = (void *)wormhole_iter_kref,
   .iter_kvref = (void *)wormhole_iter_kvref,
   .iter_skip1 = (void *)whunsafe_iter_skip1,
   .iter_skip = (void *)whunsafe_iter_skip,
+  .iter_skip1_rev = (void *)whunsafe_iter_skip1_rev,
   .iter_next = (void *)whunsafe_iter_next,
   .iter_inp = (void *)wormhole_iter_inp,
   .iter_destroy = (void *)whunsafe_iter_destroy,
@@ -3776,6 +3945,33 @@ wh_iter_seek(struct wormhole_iter * const iter, const void * const kbuf, const u
   wh_api->iter_seek(iter, &kref);
 }
 
+  void
+wh_iter_seek_le(struct wormhole_iter * const iter, const void * const kbuf, const u32 klen)
+{
+  struct kref kref;
+  kref_ref_hash32(&kref, kbuf, klen);
+  wh_api->iter_seek_le(iter, &kref);
+}
+
+// seek_le + peek_ref of the key under the cursor and of the key after it
+// an out kbuf is NULL if there is no such key
+  void
+wh_iter_seek_near(struct wormhole_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out)
+{
+  struct kref kref;
+  struct kvref le, gt;
+  kref_ref_hash32(&kref, kbuf, klen);
+  wh_api->iter_seek_near(iter, &kref, &le, &gt);
+  *le_kbuf_out = le.kptr;
+  *le_klen_out = le.hdr.klen;
+  *le_vbuf_out = (void *)le.vptr;
+  *gt_kbuf_out = gt.kptr;
+  *gt_klen_out = gt.hdr.klen;
+  *gt_vbuf_out = (void *)gt.vptr;
+}
+
   bool
 wh_iter_valid(struct wormhole_iter * const iter)
 {
@@ -3872,6 +4068,63 @@ wh_iter_destroy(struct wormhole_iter * const iter)
 {
   wh_api->iter_destroy(iter);
 }
+
+// The same operations without locks or qsbr, for a map that only one thread
+// uses at a time. The iterators only need their map set and hold no locks.
+  bool
+wh_unsafe_put(struct wormhole * const map, const void * const kbuf, const u32 klen,
+    const void * const vbuf, const u32 vlen)
+{
+  struct kv * const newkv = kv_create(kbuf, klen, vbuf, vlen);
+  if (newkv == NULL)
+    return false;
+  return whunsafe_put(map, newkv);
+}
+
+  bool
+wh_unsafe_del(struct wormhole * const map, const void * const kbuf, const u32 klen)
+{
+  struct kref kref;
+  kref_ref_hash32(&kref, kbuf, klen);
+  return whunsafe_del(map, &kref);
+}
+
+  void
+wh_unsafe_iter_seek(struct wormhole_iter * const iter, const void * const kbuf, const u32 klen)
+{
+  struct kref kref;
+  kref_ref_hash32(&kref, kbuf, klen);
+  whunsafe_iter_seek(iter, &kref);
+}
+
+  void
+wh_unsafe_iter_seek_near(struct wormhole_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out)
+{
+  struct kref kref;
+  struct kvref le, gt;
+  kref_ref_hash32(&kref, kbuf, klen);
+  whunsafe_iter_seek_near(iter, &kref, &le, &gt);
+  *le_kbuf_out = le.kptr;
+  *le_klen_out = le.hdr.klen;
+  *le_vbuf_out = (void *)le.vptr;
+  *gt_kbuf_out = gt.kptr;
+  *gt_klen_out = gt.hdr.klen;
+  *gt_vbuf_out = (void *)gt.vptr;
+}
+
+  void
+wh_unsafe_iter_skip1(struct wormhole_iter * const iter)
+{
+  whunsafe_iter_skip1(iter);
+}
+
+  void
+wh_unsafe_iter_skip1_rev(struct wormhole_iter * const iter)
+{
+  whunsafe_iter_skip1_rev(iter);
+}
 // }}} wh
 
 // vim:fdm=marker
@@ -74,6 +74,13 @@ wormhole_iter_create(struct wormref * const ref);
   extern void
 wormhole_iter_seek(struct wormhole_iter * const iter, const struct kref * const key);
 
+  extern void
+wormhole_iter_seek_le(struct wormhole_iter * const iter, const struct kref * const key);
+
+  extern void
+wormhole_iter_seek_near(struct wormhole_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt);
+
   extern bool
 wormhole_iter_valid(struct wormhole_iter * const iter);
 
@@ -170,6 +177,13 @@ whsafe_delr(struct wormref * const ref, const struct kref * const start,
   extern void
 whsafe_iter_seek(struct wormhole_iter * const iter, const struct kref * const key);
 
+  extern void
+whsafe_iter_seek_le(struct wormhole_iter * const iter, const struct kref * const key);
+
+  extern void
+whsafe_iter_seek_near(struct wormhole_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt);
+
   extern struct kv *
 whsafe_iter_peek(struct wormhole_iter * const iter, struct kv * const out);
 
@@ -225,6 +239,13 @@ whunsafe_iter_create(struct wormhole * const map);
   extern void
 whunsafe_iter_seek(struct wormhole_iter * const iter, const struct kref * const key);
 
+  extern void
+whunsafe_iter_seek_le(struct wormhole_iter * const iter, const struct kref * const key);
+
+  extern void
+whunsafe_iter_seek_near(struct wormhole_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt);
+
 // unsafe iter_valid: use wormhole_iter_valid
 // unsafe iter_peek: use wormhole_iter_peek
 // unsafe iter_kref: use wormhole_iter_kref
@@ -238,6 +259,9 @@ whunsafe_iter_skip(struct wormhole_iter * const iter, const u32 nr);
   extern struct kv *
 whunsafe_iter_next(struct wormhole_iter * const iter, struct kv * const out);
 
+  extern void
+whunsafe_iter_skip1_rev(struct wormhole_iter * const iter);
+
 // unsafe iter_inp: use wormhole_iter_inp
 
   extern void
@@ -309,6 +333,14 @@ wh_iter_create(struct wormref * const ref);
   extern void
 wh_iter_seek(struct wormhole_iter * const iter, const void * const kbuf, const u32 klen);
 
+  extern void
+wh_iter_seek_le(struct wormhole_iter * const iter, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_iter_seek_near(struct wormhole_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out);
+
   extern bool
 wh_iter_valid(struct wormhole_iter * const iter);
 
@@ -339,6 +371,28 @@ wh_iter_park(struct wormhole_iter * const iter);
 
   extern void
 wh_iter_destroy(struct wormhole_iter * const iter);
+
+// single-threaded variants: no locks, no qsbr
+  extern bool
+wh_unsafe_put(struct wormhole * const map, const void * const kbuf, const u32 klen,
+    const void * const vbuf, const u32 vlen);
+
+  extern bool
+wh_unsafe_del(struct wormhole * const map, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_unsafe_iter_seek(struct wormhole_iter * const iter, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_unsafe_iter_seek_near(struct wormhole_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out);
+
+  extern void
+wh_unsafe_iter_skip1(struct wormhole_iter * const iter);
+
+  extern void
+wh_unsafe_iter_skip1_rev(struct wormhole_iter * const iter);
 // }}} wh
 
 #ifdef __cplusplus
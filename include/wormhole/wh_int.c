@@ -77,6 +77,7 @@ struct wormleaf_int {
       u8 store[sizeof(struct store_sim_hack)];
   } kvs[WH_KPN]; 
 };
+static_assert((sizeof(struct wormleaf_int) % 64) == 0, "sizeof(wormleaf_int) % 64 != 0");
 
 struct wormslot { u16 t[WH_BKT_NR]; };
 static_assert(sizeof(struct wormslot) == 16, "sizeof(wormslot) != 16");
@@ -1151,17 +1152,17 @@ wormhole_create_internal(const struct kvmap_mm * const mm, const u32 nh)
     if (!wormhmap_init(hmap, map->pbuf))
       goto fail;
 
-    hmap->slab1 = slab_create(sizeof(struct wormmeta), WH_SLABMETA_SIZE);
+    hmap->slab1 = slab_create(sizeof(struct wormmeta), pages_huge_block(WH_SLABMETA_SIZE));
     if (hmap->slab1 == NULL)
       goto fail;
 
-    hmap->slab2 = slab_create(sizeof(struct wormmeta) + (sizeof(u64) * WH_BMNR), WH_SLABMETA_SIZE);
+    hmap->slab2 = slab_create(sizeof(struct wormmeta) + (sizeof(u64) * WH_BMNR), pages_huge_block(WH_SLABMETA_SIZE));
     if (hmap->slab2 == NULL)
       goto fail;
   }
 
   // leaf slab
-  map->slab_leaf = slab_create(sizeof(struct wormleaf_int), WH_SLABLEAF_SIZE);
+  map->slab_leaf = slab_create(sizeof(struct wormleaf_int), pages_huge_block(WH_SLABLEAF_SIZE));
   if (map->slab_leaf == NULL)
     goto fail;
 
@@ -1436,8 +1437,13 @@ wormleaf_int_search_eq(const struct wormleaf_int * const leaf, const struct kref
     lo = cmp <= 0 ? lo : i;
     hi = cmp <= 0 ? i : hi;
   }
-  u32 res = (hi < leaf->nr_keys && compare_int_isp(search_key, key->len, leaf->kvs + hi) == 0) ? hi : WH_KPN;
-  return res;
+  if (hi < leaf->nr_sorted && compare_int_isp(search_key, key->len, leaf->kvs + hi) == 0)
+    return hi;
+  // inserts and removals leave an unsorted tail until the next sync
+  for (u32 i = leaf->nr_sorted; i < leaf->nr_keys; i++)
+    if (compare_int_isp(search_key, key->len, leaf->kvs + i) == 0)
+      return i;
+  return WH_KPN;
 }
 
 
@@ -1468,6 +1474,25 @@ wormleaf_int_seek(const struct wormleaf_int * const leaf, const struct kref * co
   return wormleaf_int_search(leaf, key);
 }
 
+// search the last key that is <= the given key
+// return -1 .. nr_sorted-1
+  static int
+wormleaf_int_seek_le(const struct wormleaf_int * const leaf, const struct kref * const key)
+{
+  debug_assert(leaf->nr_sorted == leaf->nr_keys);
+  const u64 search_key = key->ptr ? _bswap64((*((u64 *) key->ptr)) & BITMASK(key->len * 8)) : 0;
+  int lo = -1;
+  int hi = leaf->nr_sorted;
+  while (hi - lo > 1) {
+    const int i = (lo + hi) >> 1;
+    const struct int_store_pair * const curr = leaf->kvs + i;
+    const int cmp = compare_int_isp(search_key, key->len, curr);
+    lo = cmp < 0 ? lo : i;
+    hi = cmp < 0 ? i : hi;
+  }
+  return lo;
+}
+
 // same to search_sorted but the target is very likely beyond the end
   static u32
 wormleaf_int_seek_end(const struct wormleaf_int * const leaf, const struct kref * const key)
@@ -1861,12 +1886,10 @@ wormhole_split_leaf(struct wormhole_int * const map, struct wormleaf_int * const
 wormleaf_merge(struct wormleaf_int * const leaf1, struct wormleaf_int * const leaf2)
 {
   debug_assert((leaf1->nr_keys + leaf2->nr_keys) <= WH_KPN);
-  const bool leaf1_sorted = leaf1->nr_keys == leaf1->nr_sorted;
 
+  // wormleaf_int_insert_isp keeps nr_sorted up to date
   for (u32 i = 0; i < leaf2->nr_keys; i++)
     wormleaf_int_insert_isp(leaf1, leaf2->kvs + i);
-  if (leaf1_sorted)
-    leaf1->nr_sorted += leaf2->nr_sorted;
   return true;
 }
 
@@ -2727,6 +2750,94 @@ whsafe_int_iter_seek(struct wormhole_int_iter * const iter, const struct kref *
   wormhole_int_iter_seek(iter, key);
 }
 
+  void
+wormhole_int_iter_seek_le(struct wormhole_int_iter * const iter, const struct kref * const key)
+{
+  debug_assert(key);
+  if (iter->leaf)
+    wormleaf_int_unlock_read(iter->leaf);
+
+  struct wormleaf_int * const leaf = wormhole_jump_leaf_read(iter->ref, key);
+  wormhole_int_iter_leaf_sync_sorted(leaf);
+
+  iter->leaf = leaf;
+  iter->is = wormleaf_int_seek_le(leaf, key);
+  wormhole_int_iter_fix_rev(iter);
+}
+
+  void
+whsafe_int_iter_seek_le(struct wormhole_int_iter * const iter, const struct kref * const key)
+{
+  wormhole_int_resume(iter->ref);
+  wormhole_int_iter_seek_le(iter, key);
+}
+
+  static void
+int_isp_kvref(struct kvref * const kvref, const struct int_store_pair * const isp)
+{
+  kvref->kptr = (const u8 *) &(isp->key);
+  kvref->vptr = isp->store;
+  kvref->hdr.klen = isp->key_size;
+  kvref->hdr.vlen = sizeof(isp->store);
+}
+
+// the first key of the leaves after leaf; the iter keeps its lock on leaf
+  static void
+wormhole_int_iter_first_after(struct wormref_int * const ref, const struct wormleaf_int * const leaf,
+    struct kvref * const kvref)
+{
+  struct wormleaf_int * next = leaf->next;
+  while (next) {
+    wormleaf_int_lock_read(next, ref);
+    wormhole_int_iter_leaf_sync_sorted(next);
+    struct wormleaf_int * const next1 = next->next;
+    if (next->nr_sorted) {
+      int_isp_kvref(kvref, next->kvs);
+      wormleaf_int_unlock_read(next);
+      return;
+    }
+    wormleaf_int_unlock_read(next);
+    next = next1;
+  }
+  memset(kvref, 0, sizeof(*kvref));
+}
+
+// both neighbours come from the leaf the search lands in, unless one of them
+// is across a leaf boundary
+  void
+wormhole_int_iter_seek_near(struct wormhole_int_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt)
+{
+  debug_assert(key);
+  if (iter->leaf)
+    wormleaf_int_unlock_read(iter->leaf);
+
+  struct wormleaf_int * const leaf = wormhole_jump_leaf_read(iter->ref, key);
+  wormhole_int_iter_leaf_sync_sorted(leaf);
+
+  iter->leaf = leaf;
+  iter->is = wormleaf_int_seek_le(leaf, key);
+  const u32 i1 = (u32)(iter->is + 1);
+  if (likely(i1 < leaf->nr_sorted))
+    int_isp_kvref(gt, leaf->kvs + i1);
+  else
+    wormhole_int_iter_first_after(iter->ref, leaf, gt);
+
+  wormhole_int_iter_fix_rev(iter);
+  if (iter->leaf)
+    int_isp_kvref(le, iter->leaf->kvs + iter->is);
+  else
+    memset(le, 0, sizeof(*le));
+}
+
+  void
+whsafe_int_iter_seek_near(struct wormhole_int_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt)
+{
+  wormhole_int_resume(iter->ref);
+  wormhole_int_iter_seek_near(iter, key, le, gt);
+}
+
   bool
 wormhole_int_iter_valid(struct wormhole_int_iter * const iter)
 {
@@ -2865,6 +2976,118 @@ whsafe_int_iter_destroy(struct wormhole_int_iter * const iter)
 }
 // }}} iter
 
+// unsafe iter {{{
+// no locks: the iterator only needs its map set
+  static void
+whunsafe_int_iter_fix(struct wormhole_int_iter * const iter)
+{
+  if (!wormhole_int_iter_valid(iter))
+    return;
+
+  while (unlikely(iter->is >= iter->leaf->nr_sorted)) {
+    struct wormleaf_int * const next = iter->leaf->next;
+    if (likely(next != NULL))
+      wormhole_int_iter_leaf_sync_sorted(next);
+    iter->leaf = next;
+    iter->is = 0;
+    if (!wormhole_int_iter_valid(iter))
+      return;
+  }
+}
+
+  static void
+whunsafe_int_iter_fix_rev(struct wormhole_int_iter * const iter)
+{
+  if (!wormhole_int_iter_valid(iter))
+    return;
+
+  while (unlikely(iter->is < 0)) {
+    struct wormleaf_int * const prev = iter->leaf->prev;
+    if (likely(prev != NULL))
+      wormhole_int_iter_leaf_sync_sorted(prev);
+    iter->leaf = prev;
+    if (!wormhole_int_iter_valid(iter))
+      return;
+    iter->is = prev->nr_keys - 1;
+  }
+}
+
+  void
+whunsafe_int_iter_seek(struct wormhole_int_iter * const iter, const struct kref * const key)
+{
+  struct wormleaf_int * const leaf = wormhole_jump_leaf(iter->map->hmap, key);
+  wormhole_int_iter_leaf_sync_sorted(leaf);
+
+  iter->leaf = leaf;
+  iter->is = wormleaf_int_seek(leaf, key);
+  whunsafe_int_iter_fix(iter);
+}
+
+  void
+whunsafe_int_iter_seek_le(struct wormhole_int_iter * const iter, const struct kref * const key)
+{
+  struct wormleaf_int * const leaf = wormhole_jump_leaf(iter->map->hmap, key);
+  wormhole_int_iter_leaf_sync_sorted(leaf);
+
+  iter->leaf = leaf;
+  iter->is = wormleaf_int_seek_le(leaf, key);
+  whunsafe_int_iter_fix_rev(iter);
+}
+
+  static void
+whunsafe_int_iter_first_after(const struct wormleaf_int * const leaf, struct kvref * const kvref)
+{
+  for (struct wormleaf_int * next = leaf->next; next; next = next->next) {
+    wormhole_int_iter_leaf_sync_sorted(next);
+    if (next->nr_sorted) {
+      int_isp_kvref(kvref, next->kvs);
+      return;
+    }
+  }
+  memset(kvref, 0, sizeof(*kvref));
+}
+
+  void
+whunsafe_int_iter_seek_near(struct wormhole_int_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt)
+{
+  struct wormleaf_int * const leaf = wormhole_jump_leaf(iter->map->hmap, key);
+  wormhole_int_iter_leaf_sync_sorted(leaf);
+
+  iter->leaf = leaf;
+  iter->is = wormleaf_int_seek_le(leaf, key);
+  const u32 i1 = (u32)(iter->is + 1);
+  if (likely(i1 < leaf->nr_sorted))
+    int_isp_kvref(gt, leaf->kvs + i1);
+  else
+    whunsafe_int_iter_first_after(leaf, gt);
+
+  whunsafe_int_iter_fix_rev(iter);
+  if (iter->leaf)
+    int_isp_kvref(le, iter->leaf->kvs + iter->is);
+  else
+    memset(le, 0, sizeof(*le));
+}
+
+  void
+whunsafe_int_iter_skip1(struct wormhole_int_iter * const iter)
+{
+  if (wormhole_int_iter_valid(iter)) {
+    iter->is++;
+    whunsafe_int_iter_fix(iter);
+  }
+}
+
+  void
+whunsafe_int_iter_skip1_rev(struct wormhole_int_iter * const iter)
+{
+  if (wormhole_int_iter_valid(iter)) {
+    iter->is--;
+    whunsafe_int_iter_fix_rev(iter);
+  }
+}
+// }}} unsafe iter
+
 // misc {{{
   struct wormref_int *
 wormhole_int_ref(struct wormhole_int * const map)
@@ -3011,6 +3234,8 @@ const struct kvmap_api kvmap_api_wormhole_int = {
   .delr = (void *)wormhole_int_delr,
   .iter_create = (void *)wormhole_int_iter_create,
   .iter_seek = (void *)wormhole_int_iter_seek,
+  .iter_seek_le = (void *)wormhole_int_iter_seek_le,
+  .iter_seek_near = (void *)wormhole_int_iter_seek_near,
   .iter_valid = (void *)wormhole_int_iter_valid,
   .iter_peek = (void *)wormhole_int_iter_peek,
   .iter_kref = (void *)wormhole_int_iter_kref,
@@ -3046,6 +3271,8 @@ const struct kvmap_api kvmap_api_whsafe_int = {
   .delr = (void *)whsafe_int_delr,
   .iter_create = (void *)wormhole_int_iter_create,
   .iter_seek = (void *)whsafe_int_iter_seek,
+  .iter_seek_le = (void *)whsafe_int_iter_seek_le,
+  .iter_seek_near = (void *)whsafe_int_iter_seek_near,
   .iter_valid = (void *)wormhole_int_iter_valid,
   .iter_peek = (void *)wormhole_int_iter_peek,
   .iter_kref = (void *)wormhole_int_iter_kref,
@@ -3265,6 +3492,33 @@ wh_int_iter_seek(struct wormhole_int_iter * const iter, const void * const kbuf,
   wh_api->iter_seek(iter, &kref);
 }
 
+  void
+wh_int_iter_seek_le(struct wormhole_int_iter * const iter, const void * const kbuf, const u32 klen)
+{
+  struct kref kref;
+  kref_ref_hash32(&kref, kbuf, klen);
+  wh_api->iter_seek_le(iter, &kref);
+}
+
+// seek_le + peek_ref of the key under the cursor and of the key after it
+// an out kbuf is NULL if there is no such key
+  void
+wh_int_iter_seek_near(struct wormhole_int_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out)
+{
+  struct kref kref;
+  struct kvref le, gt;
+  kref_ref_hash32(&kref, kbuf, klen);
+  wh_api->iter_seek_near(iter, &kref, &le, &gt);
+  *le_kbuf_out = le.kptr;
+  *le_klen_out = le.hdr.klen;
+  *le_vbuf_out = (void *)le.vptr;
+  *gt_kbuf_out = gt.kptr;
+  *gt_klen_out = gt.hdr.klen;
+  *gt_vbuf_out = (void *)gt.vptr;
+}
+
   bool
 wh_int_iter_valid(struct wormhole_int_iter * const iter)
 {
@@ -3359,6 +3613,65 @@ wh_int_iter_destroy(struct wormhole_int_iter * const iter)
 {
   wh_api->iter_destroy(iter);
 }
+
+// The same operations without locks or qsbr, for a map that only one thread
+// uses at a time. The iterators only need their map set and hold no locks.
+  bool
+wh_int_unsafe_put(struct wormhole_int * const map, const void * const kbuf, const u32 klen,
+    const void * const vbuf, const u32 vlen)
+{
+  struct kv * const newkv = kv_create(kbuf, klen, vbuf, vlen);
+  if (newkv == NULL)
+    return false;
+  const bool res = whunsafe_int_put(map, newkv);
+  free(newkv);
+  return res;
+}
+
+  bool
+wh_int_unsafe_del(struct wormhole_int * const map, const void * const kbuf, const u32 klen)
+{
+  struct kref kref;
+  kref_ref_hash32(&kref, kbuf, klen);
+  return whunsafe_int_del(map, &kref);
+}
+
+  void
+wh_int_unsafe_iter_seek(struct wormhole_int_iter * const iter, const void * const kbuf, const u32 klen)
+{
+  struct kref kref;
+  kref_ref_hash32(&kref, kbuf, klen);
+  whunsafe_int_iter_seek(iter, &kref);
+}
+
+  void
+wh_int_unsafe_iter_seek_near(struct wormhole_int_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out)
+{
+  struct kref kref;
+  struct kvref le, gt;
+  kref_ref_hash32(&kref, kbuf, klen);
+  whunsafe_int_iter_seek_near(iter, &kref, &le, &gt);
+  *le_kbuf_out = le.kptr;
+  *le_klen_out = le.hdr.klen;
+  *le_vbuf_out = (void *)le.vptr;
+  *gt_kbuf_out = gt.kptr;
+  *gt_klen_out = gt.hdr.klen;
+  *gt_vbuf_out = (void *)gt.vptr;
+}
+
+  void
+wh_int_unsafe_iter_skip1(struct wormhole_int_iter * const iter)
+{
+  whunsafe_int_iter_skip1(iter);
+}
+
+  void
+wh_int_unsafe_iter_skip1_rev(struct wormhole_int_iter * const iter)
+{
+  whunsafe_int_iter_skip1_rev(iter);
+}
 // }}} wh
 
 #undef BITMASK
@@ -66,6 +66,13 @@ wormhole_int_iter_create(struct wormref_int * const ref);
   extern void
 wormhole_int_iter_seek(struct wormhole_int_iter * const iter, const struct kref * const key);
 
+  extern void
+wormhole_int_iter_seek_le(struct wormhole_int_iter * const iter, const struct kref * const key);
+
+  extern void
+wormhole_int_iter_seek_near(struct wormhole_int_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt);
+
   extern bool
 wormhole_int_iter_valid(struct wormhole_int_iter * const iter);
 
@@ -154,6 +161,13 @@ whsafe_int_delr(struct wormref_int * const ref, const struct kref * const start,
   extern void
 whsafe_int_iter_seek(struct wormhole_int_iter * const iter, const struct kref * const key);
 
+  extern void
+whsafe_int_iter_seek_le(struct wormhole_int_iter * const iter, const struct kref * const key);
+
+  extern void
+whsafe_int_iter_seek_near(struct wormhole_int_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt);
+
   extern struct kv *
 whsafe_int_iter_peek(struct wormhole_int_iter * const iter, struct kv * const out);
 
@@ -174,6 +188,23 @@ whsafe_int_iter_destroy(struct wormhole_int_iter * const iter);
   extern struct wormref_int *
 whsafe_int_ref(struct wormhole_int * const map);
 
+// unsafe iterators: no locks, the iterator only needs its map set
+  extern void
+whunsafe_int_iter_seek(struct wormhole_int_iter * const iter, const struct kref * const key);
+
+  extern void
+whunsafe_int_iter_seek_le(struct wormhole_int_iter * const iter, const struct kref * const key);
+
+  extern void
+whunsafe_int_iter_seek_near(struct wormhole_int_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt);
+
+  extern void
+whunsafe_int_iter_skip1(struct wormhole_int_iter * const iter);
+
+  extern void
+whunsafe_int_iter_skip1_rev(struct wormhole_int_iter * const iter);
+
 // use wormhole_unref
 
   extern void
@@ -234,6 +265,14 @@ wh_int_iter_create(struct wormref_int * const ref);
   extern void
 wh_int_iter_seek(struct wormhole_int_iter * const iter, const void * const kbuf, const u32 klen);
 
+  extern void
+wh_int_iter_seek_le(struct wormhole_int_iter * const iter, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_int_iter_seek_near(struct wormhole_int_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out);
+
   extern bool
 wh_int_iter_valid(struct wormhole_int_iter * const iter);
 
@@ -264,6 +303,28 @@ wh_int_iter_park(struct wormhole_int_iter * const iter);
 
   extern void
 wh_int_iter_destroy(struct wormhole_int_iter * const iter);
+
+// single-threaded variants: no locks, no qsbr
+  extern bool
+wh_int_unsafe_put(struct wormhole_int * const map, const void * const kbuf, const u32 klen,
+    const void * const vbuf, const u32 vlen);
+
+  extern bool
+wh_int_unsafe_del(struct wormhole_int * const map, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_int_unsafe_iter_seek(struct wormhole_int_iter * const iter, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_int_unsafe_iter_seek_near(struct wormhole_int_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out);
+
+  extern void
+wh_int_unsafe_iter_skip1(struct wormhole_int_iter * const iter);
+
+  extern void
+wh_int_unsafe_iter_skip1_rev(struct wormhole_int_iter * const iter);
 // }}} wh
 
 #ifdef __cplusplus
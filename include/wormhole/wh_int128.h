@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2016--2021  Wu, Xingbo <wuxb45@gmail.com>
+ *
+ * All rights reserved. No warranty, explicit or implicit, provided.
+ */
+#pragma once
+
+#include "kv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct wormhole_int128;
+struct wormref_int128;
+
+struct wormref_int128 {
+  struct wormhole_int128 * map;
+  struct qsbr_ref qref;
+};
+
+struct wormhole_int128_iter {
+  struct wormref_int128 * ref; // safe-iter only
+  struct wormhole_int128 * map;
+  struct wormleaf_int128 * leaf;
+  int is;
+};
+
+
+// wormhole_int128 {{{
+// the wh created by wormhole_create() can work with all of safe/unsafe operations.
+  extern struct wormhole_int128 *
+wormhole_int128_create(const struct kvmap_mm * const mm);
+
+// the wh created by whunsafe_create() can only work with the unsafe operations.
+  extern struct wormhole_int128 *
+whunsafe_int128_create(const struct kvmap_mm * const mm);
+
+  extern struct kv *
+wormhole_int128_get(struct wormref_int128 * const ref, const struct kref * const key, struct kv * const out);
+
+  extern bool
+wormhole_int128_probe(struct wormref_int128 * const ref, const struct kref * const key);
+
+  extern bool
+wormhole_int128_put(struct wormref_int128 * const ref, struct kv * const kv);
+
+  extern bool
+wormhole_int128_merge(struct wormref_int128 * const ref, const struct kref * const kref,
+    kv_merge_func uf, void * const priv);
+
+  extern bool
+wormhole_int128_del(struct wormref_int128 * const ref, const struct kref * const key);
+
+  extern u64
+wormhole_int128_delr(struct wormref_int128 * const ref, const struct kref * const start,
+    const struct kref * const end);
+
+// HAAAAAAAAAAAAAAACK
+  void
+wormleaf_int128_unlock_read(struct wormleaf_int128 * const leaf);
+
+  extern struct wormhole_int128_iter *
+wormhole_int128_iter_create(struct wormref_int128 * const ref);
+
+  extern void
+wormhole_int128_iter_seek(struct wormhole_int128_iter * const iter, const struct kref * const key);
+
+  extern void
+wormhole_int128_iter_seek_le(struct wormhole_int128_iter * const iter, const struct kref * const key);
+
+  extern void
+wormhole_int128_iter_seek_near(struct wormhole_int128_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt);
+
+  extern bool
+wormhole_int128_iter_valid(struct wormhole_int128_iter * const iter);
+
+  extern struct kv *
+wormhole_int128_iter_peek(struct wormhole_int128_iter * const iter, struct kv * const out);
+
+  extern bool
+wormhole_int128_iter_kref(struct wormhole_int128_iter * const iter, struct kref * const kref);
+
+  extern bool
+wormhole_int128_iter_kvref(struct wormhole_int128_iter * const iter, struct kvref * const kvref);
+
+  extern void
+wormhole_int128_iter_skip1(struct wormhole_int128_iter * const iter);
+
+  extern void
+wormhole_int128_iter_skip(struct wormhole_int128_iter * const iter, const u32 nr);
+
+  extern struct kv *
+wormhole_int128_iter_next(struct wormhole_int128_iter * const iter, struct kv * const out);
+
+  extern void
+wormhole_int128_iter_skip1_rev(struct wormhole_int128_iter * const iter);
+
+  extern struct kv *
+wormhole_int128_iter_prev(struct wormhole_int128_iter * const iter, struct kv * const out);
+
+
+  extern bool
+wormhole_int128_iter_inp(struct wormhole_int128_iter * const iter, kv_inp_func uf, void * const priv);
+
+  extern void
+wormhole_int128_iter_park(struct wormhole_int128_iter * const iter);
+
+  extern void
+wormhole_int128_iter_destroy(struct wormhole_int128_iter * const iter);
+
+  extern struct wormref_int128 *
+wormhole_int128_ref(struct wormhole_int128 * const map);
+
+  extern struct wormhole_int128 *
+wormhole_int128_unref(struct wormref_int128 * const ref);
+
+  extern void
+wormhole_int128_park(struct wormref_int128 * const ref);
+
+  extern void
+wormhole_int128_resume(struct wormref_int128 * const ref);
+
+  extern void
+wormhole_int128_refresh_qstate(struct wormref_int128 * const ref);
+
+// clean with more threads
+  extern void
+wormhole_int128_clean_th(struct wormhole_int128 * const map, const u32 nr_threads);
+
+  extern void
+wormhole_int128_clean(struct wormhole_int128 * const map);
+
+  extern void
+wormhole_int128_destroy(struct wormhole_int128 * const map);
+
+// safe API (no need to refresh qstate)
+
+  extern struct kv *
+whsafe_int128_get(struct wormref_int128 * const ref, const struct kref * const key, struct kv * const out);
+
+  extern bool
+whsafe_int128_probe(struct wormref_int128 * const ref, const struct kref * const key);
+
+  extern bool
+whsafe_int128_put(struct wormref_int128 * const ref, struct kv * const kv);
+
+  extern bool
+whsafe_int128_merge(struct wormref_int128 * const ref, const struct kref * const kref,
+    kv_merge_func uf, void * const priv);
+
+  extern bool
+whsafe_int128_del(struct wormref_int128 * const ref, const struct kref * const key);
+
+  extern u64
+whsafe_int128_delr(struct wormref_int128 * const ref, const struct kref * const start,
+    const struct kref * const end);
+
+// use wormhole_int128_iter_create
+  extern void
+whsafe_int128_iter_seek(struct wormhole_int128_iter * const iter, const struct kref * const key);
+
+  extern void
+whsafe_int128_iter_seek_le(struct wormhole_int128_iter * const iter, const struct kref * const key);
+
+  extern void
+whsafe_int128_iter_seek_near(struct wormhole_int128_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt);
+
+  extern struct kv *
+whsafe_int128_iter_peek(struct wormhole_int128_iter * const iter, struct kv * const out);
+
+// use wormhole_int128_iter_valid
+// use wormhole_int128_iter_peek
+// use wormhole_int128_iter_kref
+// use wormhole_int128_iter_kvref
+// use wormhole_int128_iter_skip1
+// use wormhole_int128_iter_skip
+// use wormhole_int128_iter_next
+
+  extern void
+whsafe_int128_iter_park(struct wormhole_int128_iter * const iter);
+
+  extern void
+whsafe_int128_iter_destroy(struct wormhole_int128_iter * const iter);
+
+  extern struct wormref_int128 *
+whsafe_int128_ref(struct wormhole_int128 * const map);
+
+// unsafe iterators: no locks, the iterator only needs its map set
+  extern void
+whunsafe_int128_iter_seek(struct wormhole_int128_iter * const iter, const struct kref * const key);
+
+  extern void
+whunsafe_int128_iter_seek_le(struct wormhole_int128_iter * const iter, const struct kref * const key);
+
+  extern void
+whunsafe_int128_iter_seek_near(struct wormhole_int128_iter * const iter, const struct kref * const key,
+    struct kvref * const le, struct kvref * const gt);
+
+  extern void
+whunsafe_int128_iter_skip1(struct wormhole_int128_iter * const iter);
+
+  extern void
+whunsafe_int128_iter_skip1_rev(struct wormhole_int128_iter * const iter);
+
+// use wormhole_unref
+
+  extern void
+wormhole_int128_fprint(struct wormhole_int128 * const map, FILE * const out);
+
+extern const struct kvmap_api kvmap_api_wormhole;
+extern const struct kvmap_api kvmap_api_whsafe;
+extern const struct kvmap_api kvmap_api_whunsafe;
+// }}} wormhole_int128
+
+// wh {{{
+  extern struct wormhole_int128 *
+wh_int128_create(void);
+
+  extern struct wormref_int128 *
+wh_int128_ref(struct wormhole_int128 * const wh);
+
+  extern void
+wh_int128_unref(struct wormref_int128 * const ref);
+
+  extern void
+wh_int128_park(struct wormref_int128 * const ref);
+
+  extern void
+wh_int128_resume(struct wormref_int128 * const ref);
+
+  extern void
+wh_int128_clean(struct wormhole_int128 * const map);
+
+  extern void
+wh_int128_destroy(struct wormhole_int128 * const map);
+
+  extern bool
+wh_int128_put(struct wormref_int128 * const ref, const void * const kbuf, const u32 klen,
+    const void * const vbuf, const u32 vlen);
+
+  extern bool
+wh_int128_del(struct wormref_int128 * const ref, const void * const kbuf, const u32 klen);
+
+  extern bool
+wh_int128_probe(struct wormref_int128 * const ref, const void * const kbuf, const u32 klen);
+
+  extern bool
+wh_int128_get(struct wormref_int128 * const ref, const void * const kbuf, const u32 klen,
+    void * const vbuf_out, const u32 vbuf_size, u32 * const vlen_out);
+
+  extern bool
+wh_int128_merge(struct wormref_int128 * const ref, const void * const kbuf, const u32 klen,
+    kv_merge_func uf, void * const priv);
+
+  extern u64
+wh_int128_delr(struct wormref_int128 * const ref, const void * const kbuf_start, const u32 klen_start,
+    const void * const kbuf_end, const u32 klen_end);
+
+  extern struct wormhole_int128_iter *
+wh_int128_iter_create(struct wormref_int128 * const ref);
+
+  extern void
+wh_int128_iter_seek(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_int128_iter_seek_le(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_int128_iter_seek_near(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out);
+
+  extern bool
+wh_int128_iter_valid(struct wormhole_int128_iter * const iter);
+
+  extern bool
+wh_int128_iter_peek(struct wormhole_int128_iter * const iter,
+    void * const kbuf_out, const u32 kbuf_size, u32 * const klen_out,
+    void * const vbuf_out, const u32 vbuf_size, u32 * const vlen_out);
+
+  void
+wh_int128_iter_peek_ref(struct wormhole_int128_iter * const iter,
+    const void ** kbuf_out, u32 * const klen_out,
+    void ** vbuf_out, u32 * const vlen_out);
+
+  extern void
+wh_int128_iter_skip1(struct wormhole_int128_iter * const iter);
+
+  extern void
+wh_int128_iter_skip(struct wormhole_int128_iter * const iter, const u32 nr);
+
+  extern void
+wh_int128_iter_skip1_rev(struct wormhole_int128_iter * const iter);
+
+  extern bool
+wh_int128_iter_inp(struct wormhole_int128_iter * const iter, kv_inp_func uf, void * const priv);
+
+  extern void
+wh_int128_iter_park(struct wormhole_int128_iter * const iter);
+
+  extern void
+wh_int128_iter_destroy(struct wormhole_int128_iter * const iter);
+
+// single-threaded variants: no locks, no qsbr
+  extern bool
+wh_int128_unsafe_put(struct wormhole_int128 * const map, const void * const kbuf, const u32 klen,
+    const void * const vbuf, const u32 vlen);
+
+  extern bool
+wh_int128_unsafe_del(struct wormhole_int128 * const map, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_int128_unsafe_iter_seek(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen);
+
+  extern void
+wh_int128_unsafe_iter_seek_near(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out);
+
+  extern void
+wh_int128_unsafe_iter_skip1(struct wormhole_int128_iter * const iter);
+
+  extern void
+wh_int128_unsafe_iter_skip1_rev(struct wormhole_int128_iter * const iter);
+// }}} wh
+
+#ifdef __cplusplus
+}
+
+// Overloads under the wh_int names, so that C++ code can drive either integer
+// tree without spelling out the key width at each call
+  inline struct wormref_int128 *
+wh_int_ref(struct wormhole_int128 * const wh) { return wh_int128_ref(wh); }
+
+  inline void
+wh_int_unref(struct wormref_int128 * const ref) { wh_int128_unref(ref); }
+
+  inline void
+wh_int_destroy(struct wormhole_int128 * const map) { wh_int128_destroy(map); }
+
+  inline bool
+wh_int_put(struct wormref_int128 * const ref, const void * const kbuf, const u32 klen,
+    const void * const vbuf, const u32 vlen) { return wh_int128_put(ref, kbuf, klen, vbuf, vlen); }
+
+  inline bool
+wh_int_del(struct wormref_int128 * const ref, const void * const kbuf, const u32 klen)
+{ return wh_int128_del(ref, kbuf, klen); }
+
+  inline void
+wh_int_iter_seek(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen)
+{ wh_int128_iter_seek(iter, kbuf, klen); }
+
+  inline void
+wh_int_iter_seek_le(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen)
+{ wh_int128_iter_seek_le(iter, kbuf, klen); }
+
+  inline void
+wh_int_iter_seek_near(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out)
+{ wh_int128_iter_seek_near(iter, kbuf, klen, le_kbuf_out, le_klen_out, le_vbuf_out, gt_kbuf_out, gt_klen_out, gt_vbuf_out); }
+
+  inline bool
+wh_int_iter_valid(struct wormhole_int128_iter * const iter) { return wh_int128_iter_valid(iter); }
+
+  inline void
+wh_int_iter_peek_ref(struct wormhole_int128_iter * const iter,
+    const void ** kbuf_out, u32 * const klen_out,
+    void ** vbuf_out, u32 * const vlen_out) { wh_int128_iter_peek_ref(iter, kbuf_out, klen_out, vbuf_out, vlen_out); }
+
+  inline void
+wh_int_iter_skip1(struct wormhole_int128_iter * const iter) { wh_int128_iter_skip1(iter); }
+
+  inline void
+wh_int_iter_skip1_rev(struct wormhole_int128_iter * const iter) { wh_int128_iter_skip1_rev(iter); }
+
+  inline bool
+wh_int_unsafe_put(struct wormhole_int128 * const map, const void * const kbuf, const u32 klen,
+    const void * const vbuf, const u32 vlen) { return wh_int128_unsafe_put(map, kbuf, klen, vbuf, vlen); }
+
+  inline bool
+wh_int_unsafe_del(struct wormhole_int128 * const map, const void * const kbuf, const u32 klen)
+{ return wh_int128_unsafe_del(map, kbuf, klen); }
+
+  inline void
+wh_int_unsafe_iter_seek(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen)
+{ wh_int128_unsafe_iter_seek(iter, kbuf, klen); }
+
+  inline void
+wh_int_unsafe_iter_seek_near(struct wormhole_int128_iter * const iter, const void * const kbuf, const u32 klen,
+    const void ** le_kbuf_out, u32 * const le_klen_out, void ** le_vbuf_out,
+    const void ** gt_kbuf_out, u32 * const gt_klen_out, void ** gt_vbuf_out)
+{ wh_int128_unsafe_iter_seek_near(iter, kbuf, klen, le_kbuf_out, le_klen_out, le_vbuf_out, gt_kbuf_out, gt_klen_out, gt_vbuf_out); }
+
+  inline void
+wh_int_unsafe_iter_skip1(struct wormhole_int128_iter * const iter) { wh_int128_unsafe_iter_skip1(iter); }
+
+  inline void
+wh_int_unsafe_iter_skip1_rev(struct wormhole_int128_iter * const iter) { wh_int128_unsafe_iter_skip1_rev(iter); }
+
+  inline void
+wormhole_int_park(struct wormref_int128 * const ref) { wormhole_int128_park(ref); }
+
+  inline void
+wormleaf_int_unlock_read(struct wormleaf_int128 * const leaf) { wormleaf_int128_unlock_read(leaf); }
+#endif
+// vim:fdm=marker
+
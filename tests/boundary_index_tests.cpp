@@ -0,0 +1,170 @@
+/**
+ * @file boundary index tests
+ * @author ---
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "boundary_index.hpp"
+
+template <class t_index>
+static std::string PeekKey(t_index &index, const typename t_index::Iter &it, uint64_t *&value) {
+    const uint8_t *key;
+    uint32_t key_len;
+    index.Peek(it, key, key_len, value);
+    return std::string(reinterpret_cast<const char *>(key), key_len);
+}
+
+
+template <class t_index>
+static void CheckOrder(t_index &index, const std::map<std::string, uint64_t> &expected) {
+    typename t_index::Iter it {&index};
+    uint64_t *value;
+    auto expected_it = expected.begin();
+    for (index.Seek(it, nullptr, 0); index.Valid(it); index.Next(it), ++expected_it) {
+        REQUIRE_NE(expected_it, expected.end());
+        REQUIRE_EQ(PeekKey(index, it, value), expected_it->first);
+        REQUIRE_EQ(*value, expected_it->second);
+    }
+    REQUIRE_EQ(expected_it, expected.end());
+    REQUIRE_EQ(index.Count(), expected.size());
+
+    if (expected.empty())
+        return;
+    const std::string &last = expected.rbegin()->first;
+    auto expected_rit = expected.rbegin();
+    for (index.Seek(it, reinterpret_cast<const uint8_t *>(last.data()), last.size()); index.Valid(it);
+            index.Prev(it), ++expected_rit) {
+        REQUIRE_NE(expected_rit, expected.rend());
+        REQUIRE_EQ(PeekKey(index, it, value), expected_rit->first);
+    }
+    REQUIRE_EQ(expected_rit, expected.rend());
+}
+
+
+template <class t_index>
+static void CheckSeeks(t_index &index, const std::map<std::string, uint64_t> &expected, const std::string &query) {
+    const uint8_t *query_str = reinterpret_cast<const uint8_t *>(query.data());
+    typename t_index::Iter it {&index};
+    uint64_t *value;
+
+    auto lower = expected.lower_bound(query);
+    index.Seek(it, query_str, query.size());
+    REQUIRE_EQ(index.Valid(it), lower != expected.end());
+    if (lower != expected.end())
+        REQUIRE_EQ(PeekKey(index, it, value), lower->first);
+
+    auto upper = expected.upper_bound(query);
+    const uint8_t *prev_key, *next_key;
+    uint32_t prev_key_len, next_key_len;
+    uint64_t *prev_value, *next_value;
+    index.SeekNear(it, query_str, query.size(), prev_key, prev_key_len, prev_value,
+                   next_key, next_key_len, next_value);
+    if (upper == expected.begin()) {
+        REQUIRE_FALSE(index.Valid(it));
+        REQUIRE_EQ(prev_value, nullptr);
+    }
+    else {
+        auto floor = std::prev(upper);
+        REQUIRE(index.Valid(it));
+        REQUIRE_EQ(std::string(reinterpret_cast<const char *>(prev_key), prev_key_len), floor->first);
+        REQUIRE_EQ(*prev_value, floor->second);
+        REQUIRE_EQ(PeekKey(index, it, value), floor->first);
+    }
+    if (upper == expected.end())
+        REQUIRE_EQ(next_value, nullptr);
+    else {
+        REQUIRE_EQ(std::string(reinterpret_cast<const char *>(next_key), next_key_len), upper->first);
+        REQUIRE_EQ(*next_value, upper->second);
+    }
+}
+
+
+template <class t_index>
+static void AgainstMap() {
+    const uint32_t n_ops = 60000;
+    const uint32_t n_queries = 20000;
+    std::mt19937_64 rng(1);
+
+    // Short keys, and long ones sharing prefixes well past their first eight bytes
+    auto random_key = [&]() {
+        std::string res;
+        const uint32_t len = rng() % 4 == 0 ? rng() % 9 : 8 + rng() % 16;
+        for (uint32_t i = 0; i < len; i++)
+            res.push_back(i < 10 ? "ab\0\xff"[rng() % 4] : static_cast<char>(rng()));
+        return res;
+    };
+
+    t_index index;
+    std::map<std::string, uint64_t> expected;
+    CheckOrder(index, expected);
+    CheckSeeks(index, expected, "a");
+
+    std::vector<std::string> keys;
+    for (uint32_t i = 0; i < n_ops; i++) {
+        const uint32_t op = rng() % 10;
+        if (op < 6 || keys.empty()) {
+            keys.push_back(random_key());
+            const uint64_t value = rng();
+            index.Insert(reinterpret_cast<const uint8_t *>(keys.back().data()), keys.back().size(), value);
+            expected[keys.back()] = value;
+        }
+        else if (op < 8) {
+            // Overwrites through a key that points into the index
+            typename t_index::Iter it {&index};
+            const std::string &key = keys[rng() % keys.size()];
+            index.Seek(it, reinterpret_cast<const uint8_t *>(key.data()), key.size());
+            if (!index.Valid(it))
+                continue;
+            const uint8_t *found_key;
+            uint32_t found_key_len;
+            uint64_t *value;
+            index.Peek(it, found_key, found_key_len, value);
+            const uint64_t new_value = rng();
+            expected[std::string(reinterpret_cast<const char *>(found_key), found_key_len)] = new_value;
+            index.Insert(found_key, found_key_len, new_value);
+        }
+        else {
+            const std::string &key = keys[rng() % keys.size()];
+            index.Erase(reinterpret_cast<const uint8_t *>(key.data()), key.size());
+            expected.erase(key);
+        }
+        if (i % 10000 == 0)
+            CheckOrder(index, expected);
+    }
+    CheckOrder(index, expected);
+    for (uint32_t i = 0; i < n_queries; i++)
+        CheckSeeks(index, expected, i % 2 ? random_key() : keys[rng() % keys.size()]);
+
+    // Emptying the index and filling it again
+    for (const std::string &key : keys)
+        index.Erase(reinterpret_cast<const uint8_t *>(key.data()), key.size());
+    expected.clear();
+    CheckOrder(index, expected);
+    CheckSeeks(index, expected, "a");
+    for (uint32_t i = 0; i < 1000; i++) {
+        const std::string key = random_key();
+        index.Insert(reinterpret_cast<const uint8_t *>(key.data()), key.size(), i);
+        expected[key] = i;
+    }
+    CheckOrder(index, expected);
+}
+
+
+TEST_SUITE("boundary_index") {
+    TEST_CASE("sorted array") {
+        AgainstMap<SortedArrayIndex<uint64_t>>();
+    }
+
+    TEST_CASE("b+-tree") {
+        AgainstMap<BTreeIndex<uint64_t>>();
+    }
+}
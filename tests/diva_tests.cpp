@@ -14,11 +14,15 @@
 
 #include <doctest/doctest.h>
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <unistd.h>
 #include <vector>
 
 #include "diva.hpp"
@@ -479,6 +483,57 @@ public:
     }
 
 
+    template <bool O>
+    static void InsertBatch() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t init_n = 20000;
+        const uint32_t extra_n = 300000;
+
+        const uint32_t rng_seed = 11;
+        std::mt19937_64 rng(rng_seed);
+
+        std::vector<uint64_t> init_keys;
+        for (int32_t i = 0; i < init_n; i++)
+            init_keys.push_back(rng());
+        std::sort(init_keys.begin(), init_keys.end());
+        std::vector<uint64_t> conv_init_keys(init_keys);
+        if constexpr (!O) {
+            for (int32_t i = 0; i < init_n; i++)
+                conv_init_keys[i] = to_big_endian_order(conv_init_keys[i]);
+        }
+        Diva<O> s(infix_size, conv_init_keys.begin(), conv_init_keys.end(), sizeof(uint64_t), seed, load_factor);
+
+        std::vector<uint64_t> inserted_keys(init_keys);
+        const uint32_t batch_size = 30000;
+        for (int32_t i = 0; i < extra_n / batch_size; i++) {
+            std::vector<uint64_t> batch;
+            if (i % 2) {
+                for (int32_t j = 0; j < batch_size; j++)
+                    batch.push_back(rng());
+            }
+            else {
+                // Dense batch hitting only a few infix stores
+                const uint64_t base = rng();
+                for (int32_t j = 0; j < batch_size; j++)
+                    batch.push_back(base + rng() % (1ULL << 40));
+            }
+            std::sort(batch.begin(), batch.end());
+            s.InsertBatch(batch.begin(), batch.end());
+            inserted_keys.insert(inserted_keys.end(), batch.begin(), batch.end());
+        }
+        for (uint64_t key : inserted_keys)
+            REQUIRE(s.PointQuery(key));
+
+        const uint32_t n_queries = 100000;
+        uint32_t false_positives = 0;
+        for (int32_t i = 0; i < n_queries; i++)
+            false_positives += s.PointQuery(rng());
+        REQUIRE_LT(false_positives, n_queries / 2);
+    }
+
+
     template <bool O>
     static void PointQuery() {
         const uint32_t infix_size = 5;
@@ -622,6 +677,70 @@ public:
     }
 
 
+    template <bool O>
+    static void PointQuerySorted() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_queries = 200000;
+
+        const uint32_t rng_seed = 3;
+        std::mt19937_64 rng(rng_seed);
+
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::vector<uint64_t> queries;
+        for (int32_t i = 0; i < n_queries / 2; i++) {
+            queries.push_back(keys[rng() % keys.size()]);
+            queries.push_back(rng() % 4 ? rng() : keys[rng() % keys.size()] + rng() % 1024);
+        }
+        queries.push_back(0);
+        queries.push_back(std::numeric_limits<uint64_t>::max());
+        std::sort(queries.begin(), queries.end());
+
+        SUBCASE("integer keys") {
+            std::vector<uint64_t> conv_keys(keys);
+            if constexpr (!O) {
+                for (int32_t i = 0; i < conv_keys.size(); i++)
+                    conv_keys[i] = to_big_endian_order(conv_keys[i]);
+            }
+            Diva<O> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+            bool *res = new bool[queries.size()];
+            s.PointQuerySorted(queries.data(), queries.data() + queries.size(), res);
+            for (int32_t i = 0; i < queries.size(); i++)
+                REQUIRE_EQ(res[i], s.PointQuery(queries[i]));
+            delete[] res;
+        }
+
+        SUBCASE("string keys") {
+            std::vector<std::string> string_keys;
+            for (int32_t i = 0; i < keys.size(); i++) {
+                const uint64_t value = to_big_endian_order(keys[i]);
+                string_keys.emplace_back(reinterpret_cast<const char *>(&value), sizeof(value));
+            }
+            Diva<O> s(infix_size, string_keys.begin(), string_keys.end(), seed, load_factor);
+            std::vector<std::string> string_queries;
+            for (uint64_t query : queries) {
+                const uint64_t value = to_big_endian_order(query);
+                string_queries.emplace_back(reinterpret_cast<const char *>(&value), sizeof(value));
+            }
+            bool *res = new bool[string_queries.size()];
+            s.PointQuerySorted(string_queries.begin(), string_queries.end(), res);
+            for (int32_t i = 0; i < string_queries.size(); i++) {
+                REQUIRE_EQ(res[i], s.PointQuery(string_queries[i]));
+                if (std::binary_search(keys.begin(), keys.end(), queries[i]))
+                    REQUIRE(res[i]);
+            }
+            delete[] res;
+        }
+    }
+
+
     template <bool O>
     static void RangeQuery() {
         const uint32_t infix_size = 5;
@@ -830,6 +949,68 @@ public:
     }
 
 
+    template <bool O>
+    static void RangeQueryBatch() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_queries = 100000;
+
+        const uint32_t rng_seed = 2;
+        std::mt19937_64 rng(rng_seed);
+
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        SUBCASE("integer keys") {
+            std::vector<uint64_t> conv_keys(keys);
+            if constexpr (!O) {
+                for (int32_t i = 0; i < conv_keys.size(); i++)
+                    conv_keys[i] = to_big_endian_order(conv_keys[i]);
+            }
+            Diva<O> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+            std::vector<std::pair<uint64_t, uint64_t>> queries;
+            for (int32_t i = 0; i < n_queries; i++) {
+                const uint64_t l = rng();
+                const uint64_t r = l + std::min<uint64_t>(rng() % (1ULL << (i % 48)), ~l);
+                queries.emplace_back(l, r);
+            }
+            bool *res = new bool[n_queries];
+            s.RangeQueryBatch(queries.begin(), queries.end(), res);
+            for (int32_t i = 0; i < n_queries; i++)
+                REQUIRE_EQ(res[i], s.RangeQuery(queries[i].first, queries[i].second));
+            delete[] res;
+        }
+
+        SUBCASE("string keys") {
+            std::vector<std::string> string_keys;
+            for (int32_t i = 0; i < keys.size(); i++) {
+                const uint64_t value = to_big_endian_order(keys[i]);
+                string_keys.emplace_back(reinterpret_cast<const char *>(&value), sizeof(value));
+            }
+            Diva<O> s(infix_size, string_keys.begin(), string_keys.end(), seed, load_factor);
+            std::vector<std::pair<std::string, std::string>> queries;
+            for (int32_t i = 0; i < n_queries; i++) {
+                const uint64_t l = rng();
+                const uint64_t r = l + std::min<uint64_t>(rng() % (1ULL << (i % 48)), ~l);
+                const uint64_t conv_l = to_big_endian_order(l);
+                const uint64_t conv_r = to_big_endian_order(r);
+                queries.emplace_back(std::string(reinterpret_cast<const char *>(&conv_l), sizeof(conv_l)),
+                                     std::string(reinterpret_cast<const char *>(&conv_r), sizeof(conv_r)));
+            }
+            bool *res = new bool[n_queries];
+            s.RangeQueryBatch(queries.begin(), queries.end(), res);
+            for (int32_t i = 0; i < n_queries; i++)
+                REQUIRE_EQ(res[i], s.RangeQuery(queries[i].first, queries[i].second));
+            delete[] res;
+        }
+    }
+
+
     template <bool O>
     static void Delete() {
         const uint32_t infix_size = 5;
@@ -1302,6 +1483,279 @@ public:
     }
 
 
+    template <bool O>
+    static void DeleteBatch() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 200000;
+
+        const uint32_t rng_seed = 12;
+        std::mt19937_64 rng(rng_seed);
+
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<uint64_t> conv_keys(keys);
+        if constexpr (!O) {
+            for (int32_t i = 0; i < conv_keys.size(); i++)
+                conv_keys[i] = to_big_endian_order(conv_keys[i]);
+        }
+        Diva<O> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+        Diva<O> seq_s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+
+        std::vector<uint64_t> remaining_keys, deleted_keys;
+        for (int32_t i = 0; i < keys.size(); i++) {
+            // Deletes whole runs of keys, including boundary keys, as well as sparse ones
+            if ((i / 5000) % 3 == 0 || rng() % 3 == 0)
+                deleted_keys.push_back(keys[i]);
+            else
+                remaining_keys.push_back(keys[i]);
+        }
+        s.DeleteBatch(deleted_keys.begin(), deleted_keys.end());
+        for (uint64_t key : deleted_keys)
+            seq_s.Delete(key);
+
+        for (uint64_t key : remaining_keys)
+            REQUIRE(s.PointQuery(key));
+        uint32_t batch_positives = 0, seq_positives = 0;
+        for (uint64_t key : deleted_keys) {
+            batch_positives += s.PointQuery(key);
+            seq_positives += seq_s.PointQuery(key);
+        }
+        REQUIRE_LE(batch_positives, seq_positives + deleted_keys.size() / 100);
+        REQUIRE_LE(s.Size(), seq_s.Size() + seq_s.Size() / 20);
+    }
+
+
+
+    template <bool O>
+    static void AllocatorStats() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 20000;
+        const uint32_t n_updates = 200000;
+
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        if constexpr (!O) {
+            for (int32_t i = 0; i < n_keys; i++)
+                keys[i] = to_big_endian_order(keys[i]);
+        }
+        Diva<O> s(infix_size, keys.begin(), keys.end(), sizeof(uint64_t), seed, load_factor);
+
+        // Churn the stores through several size grades and splits
+        for (int32_t i = 0; i < n_updates; i++) {
+            const uint64_t key = to_big_endian_order(rng());
+            s.Insert(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
+        }
+
+        uint64_t live_bytes = 0;
+        typename Diva<O>::TreeIter it;
+        typename Diva<O>::InfiniteByteString tree_key;
+        typename Diva<O>::InfixStore *store;
+        if constexpr (O)
+            Diva<O>::TreeIterInit(it, s.better_tree_int_);
+        else
+            Diva<O>::TreeIterInit(it, s.better_tree_);
+        for (Diva<O>::TreeIterSeek(it, {}); Diva<O>::TreeIterValid(it); Diva<O>::TreeIterSkip1(it)) {
+            Diva<O>::TreeIterPeek(it, tree_key, store);
+            live_bytes += s.GetInfixStoreWordCount(*store) * sizeof(uint64_t);
+        }
+        Diva<O>::TreeIterUnlock(it);
+
+        const SlabAllocator::Stats stats = s.AllocatorStats();
+        REQUIRE_EQ(stats.allocated_bytes, live_bytes);
+        REQUIRE_GT(stats.free_bytes, 0);
+        REQUIRE_GE(stats.reserved_bytes, stats.allocated_bytes + stats.free_bytes);
+
+        // Freed buffers are handed out again before the class grows
+        const uint32_t word_count = s.GetInfixStoreWordCount(*store);
+        uint64_t *ptr = s.allocator_.Allocate(word_count);
+        s.allocator_.Free(ptr, word_count);
+        REQUIRE_EQ(s.allocator_.Allocate(word_count), ptr);
+        REQUIRE_EQ(s.AllocatorStats().reserved_bytes, stats.reserved_bytes);
+        s.allocator_.Free(ptr, word_count);
+    }
+
+
+    template <bool O>
+    static void HugePages() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 20000;
+        const uint32_t n_inserts = 20000;
+
+        for (const enum pages_huge huge : {PAGES_HUGE_NONE, PAGES_HUGE_2MB}) {
+            pages_set_huge(huge);
+            std::mt19937_64 rng(seed);
+            std::vector<uint64_t> keys;
+            for (int32_t i = 0; i < n_keys; i++)
+                keys.push_back(rng());
+            std::sort(keys.begin(), keys.end());
+            std::vector<uint64_t> conv_keys(keys);
+            if constexpr (!O) {
+                for (int32_t i = 0; i < n_keys; i++)
+                    conv_keys[i] = to_big_endian_order(conv_keys[i]);
+            }
+            Diva<O> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+            for (int32_t i = 0; i < n_inserts; i++) {
+                keys.push_back(rng());
+                s.Insert(keys.back());
+            }
+            for (const uint64_t key : keys)
+                REQUIRE(s.PointQuery(key));
+
+            // Falls back to transparent huge pages without reserved hugetlb pages
+            const SlabAllocator::Stats stats = s.AllocatorStats();
+            if (huge == PAGES_HUGE_2MB)
+                REQUIRE_EQ(stats.reserved_bytes % (1ULL << 21), 0);
+            REQUIRE_GE(stats.reserved_bytes, stats.allocated_bytes + stats.free_bytes);
+        }
+        pages_set_huge(PAGES_HUGE_AUTO);
+    }
+
+
+    template <bool O>
+    static void ConcurrentSessions() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_threads = 4;
+        const uint32_t n_inserts_per_thread = 25000;
+
+        const uint32_t rng_seed = 13;
+        std::mt19937_64 rng(rng_seed);
+
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<uint64_t> conv_keys(keys);
+        if constexpr (!O) {
+            for (int32_t i = 0; i < conv_keys.size(); i++)
+                conv_keys[i] = to_big_endian_order(conv_keys[i]);
+        }
+        Diva<O> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+
+        // Every thread inserts its own keys, deletes its own share of the initial
+        // keys and keeps querying the initial keys that nobody deletes
+        std::vector<uint64_t> inserted_keys[n_threads], deleted_keys[n_threads], kept_keys[n_threads];
+        for (int32_t i = 0; i < keys.size(); i++) {
+            if ((i / 2000) % 4 == 0 || rng() % 4 == 0)
+                deleted_keys[i % n_threads].push_back(keys[i]);
+            else
+                kept_keys[i % n_threads].push_back(keys[i]);
+        }
+        for (int32_t i = 0; i < n_threads; i++) {
+            for (int32_t j = 0; j < n_inserts_per_thread; j++)
+                inserted_keys[i].push_back(rng());
+        }
+
+        uint32_t false_negatives[n_threads] = {};
+        std::vector<std::thread> threads;
+        for (int32_t i = 0; i < n_threads; i++) {
+            threads.emplace_back([&, i]() {
+                typename Diva<O>::Session session(s);
+                for (int32_t j = 0; j < n_inserts_per_thread; j++) {
+                    session.Insert(inserted_keys[i][j]);
+                    if (j < deleted_keys[i].size())
+                        session.Delete(deleted_keys[i][j]);
+                    const uint64_t kept_key = kept_keys[i][j % kept_keys[i].size()];
+                    false_negatives[i] += !session.PointQuery(kept_key);
+                    false_negatives[i] += !session.RangeQuery(kept_key, kept_key);
+                }
+                for (int32_t j = n_inserts_per_thread; j < deleted_keys[i].size(); j++)
+                    session.Delete(deleted_keys[i][j]);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        for (int32_t i = 0; i < n_threads; i++) {
+            REQUIRE_EQ(false_negatives[i], 0);
+            for (uint64_t key : inserted_keys[i])
+                REQUIRE(s.PointQuery(key));
+            for (uint64_t key : kept_keys[i])
+                REQUIRE(s.PointQuery(key));
+        }
+    }
+
+
+    template <bool O>
+    static void ConcurrentReaders() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_readers = 3;
+        const uint32_t n_inserts = 50000;
+
+        const uint32_t rng_seed = 17;
+        std::mt19937_64 rng(rng_seed);
+
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<uint64_t> conv_keys(keys);
+        if constexpr (!O) {
+            for (int32_t i = 0; i < conv_keys.size(); i++)
+                conv_keys[i] = to_big_endian_order(conv_keys[i]);
+        }
+        Diva<O> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+
+        // A single writer keeps splitting, resizing and merging stores while the
+        // readers query the keys it never deletes
+        std::vector<uint64_t> inserted_keys, deleted_keys, kept_keys;
+        for (int32_t i = 0; i < keys.size(); i++)
+            (i % 2 ? deleted_keys : kept_keys).push_back(keys[i]);
+        for (int32_t i = 0; i < n_inserts; i++)
+            inserted_keys.push_back(rng());
+
+        std::atomic<bool> done {false};
+        uint32_t false_negatives[n_readers] = {};
+        std::vector<std::thread> threads;
+        threads.emplace_back([&]() {
+            typename Diva<O>::Session session(s);
+            for (int32_t i = 0; i < n_inserts; i++) {
+                session.Insert(inserted_keys[i]);
+                if (i < deleted_keys.size())
+                    session.Delete(deleted_keys[i]);
+            }
+            done = true;
+        });
+        for (int32_t i = 0; i < n_readers; i++) {
+            threads.emplace_back([&, i]() {
+                typename Diva<O>::Session session(s);
+                for (int32_t j = i; !done; j = (j + n_readers) % kept_keys.size()) {
+                    false_negatives[i] += !session.PointQuery(kept_keys[j]);
+                    false_negatives[i] += !session.RangeQuery(kept_keys[j], kept_keys[j]);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        for (int32_t i = 0; i < n_readers; i++)
+            REQUIRE_EQ(false_negatives[i], 0);
+        for (uint64_t key : inserted_keys)
+            REQUIRE(s.PointQuery(key));
+        for (uint64_t key : kept_keys)
+            REQUIRE(s.PointQuery(key));
+    }
+
+
     template <bool O>
     static void ShrinkInfixSize() {
         const uint32_t infix_size = 5;
@@ -1531,76 +1985,655 @@ public:
 
 
     template <bool O>
-    static void BulkLoad() {
-        const uint32_t infix_size = 5;
+    static void InfixSizes() {
         const uint32_t seed = 1;
         const float load_factor = 0.95;
-        const uint32_t n_keys = 2600;
+        const uint32_t n_keys = 50000;
+        const uint32_t n_inserts = 50000;
+        const uint32_t n_queries = 100000;
 
-        const uint32_t rng_seed = 2;
-        std::mt19937_64 rng(rng_seed);
-        SUBCASE("fixed length") {
+        // Covers the sizes with constant-width slot routines and one without
+        for (const uint32_t infix_size : {6, 7, 8, 10, 12, 16}) {
+            std::mt19937_64 rng(seed);
             std::vector<uint64_t> keys;
             for (int32_t i = 0; i < n_keys; i++)
                 keys.push_back(rng());
             std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            std::vector<uint64_t> conv_keys(keys);
             if constexpr (!O) {
-                for (int32_t i = 0; i < n_keys; i++)
-                    keys[i] = to_big_endian_order(keys[i]);
+                for (int32_t i = 0; i < conv_keys.size(); i++)
+                    conv_keys[i] = to_big_endian_order(conv_keys[i]);
+            }
+            Diva<O> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+            for (int32_t i = 0; i < n_inserts; i++) {
+                keys.push_back(rng());
+                s.Insert(keys.back());
             }
 
-            Diva<O> s(infix_size, keys.begin(), keys.end(), sizeof(uint64_t), seed, load_factor);
-
-            if constexpr (O) {
-                wormhole_int_iter *it = wh_int_iter_create(s.better_tree_int_);
-                wh_int_iter_seek(it, nullptr, 0);
-                {
-                    const uint8_t expected_boundary[] = {0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000};
-                    const std::vector<uint32_t> occupieds_pos = {};
-                    const std::vector<std::tuple<uint32_t, bool, uint64_t>> checks = {};
+            std::vector<uint64_t> remaining_keys;
+            for (int32_t i = 0; i < keys.size(); i++) {
+                if (i % 3 == 0)
+                    s.Delete(keys[i]);
+                else
+                    remaining_keys.push_back(keys[i]);
+            }
+            for (const uint64_t key : remaining_keys) {
+                REQUIRE(s.PointQuery(key));
+                REQUIRE(s.RangeQuery(key, key + 1));
+            }
 
-                    const uint8_t *res_key;
-                    uint32_t res_size, dummy;
-                    typename Diva<O>::InfixStore *store;
-                    wh_int_iter_peek_ref(it, reinterpret_cast<const void **>(&res_key), &res_size,
-                                         reinterpret_cast<void **>(&store), &dummy);
+            uint32_t false_positives = 0;
+            for (int32_t i = 0; i < n_queries; i++)
+                false_positives += s.PointQuery(rng());
+            REQUIRE_LE(false_positives, n_queries >> (infix_size - 4));
+        }
+    }
 
-                    REQUIRE_EQ(memcmp(expected_boundary, res_key, sizeof(keys[0])), 0);
-                    REQUIRE_FALSE(store->IsPartialKey());
-                    REQUIRE_EQ(store->GetInvalidBits(), 0);
-                    AssertStoreContents(s, *store, occupieds_pos, checks);
-                }
 
-                wh_int_iter_skip1(it);
-                {
-                    const uint8_t expected_boundary[] = {0b00000000, 0b00010000, 0b00001100, 0b00111101, 0b11110111, 0b11101011, 0b00011100, 0b10100010};
-                    const std::vector<uint32_t> occupieds_pos = {1, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 14, 15, 16, 17, 20, 22, 23, 25, 27, 28, 29, 32, 34, 35, 36, 37, 38, 39, 40, 41, 42, 44, 45, 46, 47, 49, 51, 52, 54, 55, 56, 57, 59, 60, 61, 63, 64, 70, 71, 72, 73, 74, 75, 78, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 92, 94, 95, 98, 99, 100, 101, 102, 103, 104, 107, 108, 111, 113, 114, 115, 116, 117, 118, 120, 121, 122, 123, 125, 126, 127, 131, 132, 133, 134, 135, 137, 138, 139, 141, 144, 145, 146, 147, 148, 149, 151, 152, 153, 154, 155, 157, 159, 160, 162, 164, 165, 167, 168, 170, 174, 175, 176, 177, 179, 180, 181, 182, 184, 185, 186, 187, 189, 190, 192, 196, 197, 199, 201, 202, 203, 204, 205, 206, 207, 208, 210, 212, 213, 214, 216, 218, 220, 221, 222, 223, 225, 226, 228, 229, 230, 231, 234, 235, 237, 238, 239, 241, 242, 243, 244, 246, 248, 249, 250, 251, 253, 254, 255, 256, 257, 259, 261, 262, 263, 264, 265, 267, 268, 270, 271, 272, 274, 276, 277, 278, 280, 281, 282, 283, 285, 287, 288, 289, 291, 292, 293, 294, 296, 297, 298, 301, 302, 303, 304, 305, 308, 309, 310, 311, 313, 314, 315, 320, 321, 322, 323, 325, 326, 327, 328, 331, 332, 334, 335, 336, 338, 339, 340, 341, 342, 344, 345, 346, 348, 349, 351, 354, 355, 356, 357, 358, 359, 360, 363, 364, 365, 366, 367, 369, 371, 372, 373, 374, 375, 376, 378, 379, 381, 382, 383, 384, 385, 386, 388, 389, 390, 391, 394, 395, 396, 397, 398, 399, 400, 402, 403, 404, 406, 408, 409, 410, 411, 414, 415, 416, 417, 419, 420, 421, 422, 424, 428, 429, 430, 432, 433, 435, 437, 438, 439, 440, 441, 443, 444, 445, 447, 448, 449, 450, 451, 452, 453, 454, 455, 456, 457, 459, 460, 461, 462, 463, 464, 466, 467, 468, 469, 470, 471, 472, 473, 474, 476, 477, 479, 480, 481, 482, 483, 484, 485, 486, 487, 488, 489, 492, 494, 495, 496, 498, 499, 500, 501, 502, 503, 504, 506, 508, 509, 510, 511, 512, 513, 514, 516, 517, 519, 520, 521, 522, 523, 524, 525, 526, 527, 528, 529, 531, 532, 535, 537, 538, 540, 541, 542, 546, 548, 549, 550, 551, 552, 553, 554, 555, 557, 558, 559, 561, 562, 564, 565, 566, 568, 570, 572, 573, 574, 575, 578, 579, 580, 584, 585, 586, 587, 588, 589, 590, 591, 594, 595, 596, 597, 598, 599, 601, 602, 603, 604, 607, 608, 612, 613, 614, 616, 617, 618, 619, 620, 621, 623, 624, 625, 628, 629, 631, 632, 633, 634, 635, 636, 637, 638, 639, 640, 641, 642, 643, 644, 645, 646, 647, 648, 649, 650, 651, 653, 655, 657, 658, 659, 660, 662, 664, 665, 666, 668, 669, 670, 672, 673, 674, 676, 677, 678, 679, 680, 681, 682, 683, 684, 685, 686, 687, 689, 690, 691, 692, 693, 694, 697, 698, 700, 701, 702, 703, 705, 706, 707, 708, 709, 710, 711, 713, 714, 715, 718, 720, 721, 722, 724, 725, 727, 728, 730, 731, 732, 733, 736, 737, 738, 744, 745, 746, 747, 748, 750, 753, 754, 755, 756, 758, 759, 761, 762, 763, 765, 767, 768, 769, 770, 771, 772, 773, 774, 775, 777, 778, 779, 780, 781, 783, 784};
-                    const std::vector<std::tuple<uint32_t, bool, uint64_t>> checks = {{  1,0,0b00001},   {  2,0,0b01101},   {  3,0,0b10011},   {  4,0,0b10101},   {  5,1,0b11111},   {  6,1,0b11011},   {  7,0,0b10101},   {  8,1,0b10111},   {  9,1,0b01101},   { 10,0,0b00011},   { 11,0,0b10101},   { 12,1,0b11101},   { 13,1,0b00011},   { 14,0,0b00001},   { 15,0,0b00001},   { 16,1,0b01101},   { 17,1,0b10011},   { 18,0,0b10101},   { 19,1,0b11011},   { 20,1,0b00011},   { 21,1,0b01011},   { 22,0,0b00111},   { 23,0,0b01011},   { 24,0,0b11011},   { 25,1,0b11111},   { 26,0,0b00101},   { 27,1,0b11101},   { 28,1,0b01001},   { 29,1,0b10001},   { 30,1,0b10011},   { 31,1,0b11011},   { 32,0,0b00001},   { 33,0,0b00111},   { 34,0,0b11011},   { 35,0,0b11011},   { 36,1,0b11101},   { 37,1,0b00101},   { 38,1,0b11111},   { 39,0,0b01001},   { 40,0,0b10011},   { 41,0,0b10011},   { 42,1,0b11111},   { 43,1,0b11101},   { 44,0,0b01101},   { 45,0,0b01101},   { 46,1,0b11101},   { 47,1,0b01101},   { 48,0,0b00011},   { 49,0,0b11001},   { 50,1,0b11011},   { 51,1,0b01001},   { 52,1,0b00111},   { 53,0,0b00011},   { 54,1,0b00111},   { 55,1,0b10011},   { 56,0,0b00001},   { 57,1,0b11001},   { 58,0,0b00001},   { 59,0,0b00001},   { 60,1,0b01001},   { 61,0,0b00101},   { 62,0,0b10011},   { 63,1,0b10111},   { 64,1,0b00011},   { 65,1,0b00111},   { 66,0,0b10001},   { 67,1,0b10001},   { 68,1,0b01101},   { 69,0,0b00001},   { 70,0,0b01101},   { 71,1,0b11011},   { 72,0,0b01101},   { 73,0,0b10111},   { 74,0,0b11001},   { 75,1,0b11101},   { 76,0,0b00111},   { 77,0,0b00111},   { 78,0,0b01011},   { 79,1,0b11011},   { 80,0,0b01001},   { 81,0,0b01101},   { 82,0,0b01101},   { 83,1,0b11111},   { 84,1,0b11111},   { 85,0,0b10011},   { 86,0,0b11001},   { 87,1,0b11001},   { 88,1,0b00101},   { 89,0,0b00001},   { 90,1,0b00111},   { 91,1,0b01011},   { 92,0,0b01011},   { 93,0,0b11011},   { 94,1,0b11011},   { 95,1,0b10111},   { 96,0,0b01001},   { 97,1,0b10111},   { 98,0,0b10011},   { 99,1,0b11011},   {100,1,0b11001},   {101,1,0b00101},   {102,1,0b11001},   {103,1,0b01101},   {104,0,0b10111},   {105,1,0b11111},   {106,1,0b11001},   {109,0,0b00101},   {110,1,0b01111},   {111,1,0b01001},   {112,0,0b11101},   {113,1,0b11101},   {114,0,0b01111},   {115,0,0b10001},   {116,1,0b11101},   {117,0,0b00101},   {118,1,0b11001},   {119,1,0b11011},   {120,1,0b00111},   {121,0,0b01011},   {122,0,0b01011},   {123,0,0b01101},   {124,1,0b11111},   {125,1,0b10101},   {126,0,0b10011},   {127,1,0b10101},   {128,1,0b11001},   {129,0,0b00011},   {130,1,0b10111},   {131,1,0b01111},   {134,1,0b01011},   {135,1,0b00111},   {137,1,0b10111},   {138,0,0b01001},   {139,1,0b01111},   {140,1,0b00101},   {141,0,0b01001},   {142,1,0b01011},   {143,0,0b01111},   {144,1,0b10011},   {146,1,0b01011},   {148,0,0b00001},   {149,0,0b10011},   {150,1,0b11001},   {152,1,0b01011},   {154,0,0b10001},   {155,0,0b10101},   {156,1,0b10101},   {157,1,0b10011},   {158,1,0b11001},   {159,0,0b10001},   {160,0,0b10101},   {161,1,0b11111},   {162,0,0b00001},   {163,0,0b00111},   {164,1,0b01011},   {165,1,0b01011},   {166,1,0b11101},   {167,0,0b00111},   {168,1,0b01011},   {169,0,0b00101},   {170,1,0b10101},   {171,1,0b11101},   {172,0,0b00101},   {173,1,0b11001},   {174,0,0b00111},   {175,1,0b11101},   {176,0,0b00111},   {177,1,0b11001},   {179,0,0b01001},   {180,1,0b11011},   {181,0,0b00011},   {182,1,0b11111},   {183,1,0b11111},   {184,0,0b10111},   {185,1,0b10111},   {186,0,0b00101},   {187,1,0b11101},   {188,0,0b10001},   {189,0,0b10101},   {190,1,0b11111},   {191,0,0b01111},   {192,0,0b10111},   {193,1,0b11111},   {194,1,0b10111},   {195,1,0b01011},   {197,0,0b01011},   {198,1,0b10101},   {199,1,0b10111},   {200,0,0b10101},   {201,1,0b11001},   {202,1,0b00101},   {203,1,0b11011},   {204,1,0b01011},   {207,0,0b00001},   {208,0,0b01011},   {209,0,0b01011},   {210,1,0b01111},   {211,1,0b11111},   {212,1,0b10111},   {213,1,0b01111},   {214,1,0b11011},   {215,0,0b01011},   {216,1,0b01101},   {218,1,0b01001},   {219,0,0b11011},   {220,0,0b11011},   {221,1,0b11111},   {222,1,0b10101},   {224,1,0b01011},   {226,1,0b11111},   {229,1,0b11001},   {230,1,0b01011},   {233,0,0b01011},   {234,1,0b10111},   {238,1,0b01111},   {239,0,0b11101},   {240,0,0b11101},   {241,0,0b11111},   {242,1,0b11111},   {243,0,0b00001},   {244,0,0b01001},   {245,1,0b10101},   {246,1,0b01111},   {247,0,0b00011},   {248,1,0b11001},   {249,0,0b00011},   {250,0,0b00101},   {251,1,0b11011},   {252,0,0b00101},   {253,1,0b01111},   {254,0,0b00001},   {255,0,0b11001},   {256,1,0b11111},   {257,0,0b00001},   {258,0,0b01011},   {259,1,0b11101},   {260,1,0b01011},   {261,0,0b01101},   {262,1,0b01111},   {263,0,0b11011},   {264,1,0b11101},   {265,1,0b00011},   {266,0,0b00011},   {267,1,0b11011},   {268,0,0b00101},   {269,1,0b10001},   {270,1,0b11101},   {271,1,0b11001},   {272,0,0b01101},   {273,1,0b11001},   {275,1,0b10101},   {277,0,0b11001},   {278,1,0b11001},   {279,1,0b10101},   {280,0,0b00011},   {281,1,0b00101},   {282,1,0b00101},   {283,0,0b10001},   {284,1,0b11111},   {285,1,0b10101},   {286,1,0b10111},   {287,0,0b00101},   {288,1,0b01101},   {290,1,0b01011},   {292,1,0b01111},   {293,1,0b00111},   {296,0,0b01011},   {297,1,0b01101},   {298,1,0b11001},   {301,0,0b00001},   {302,1,0b10101},   {303,0,0b00001},   {304,1,0b01011},   {305,1,0b11001},   {306,1,0b01011},   {308,0,0b01001},   {309,1,0b10001},   {310,1,0b01001},   {312,0,0b01011},   {313,1,0b01011},   {314,0,0b01011},   {315,0,0b01011},   {316,1,0b01111},   {317,0,0b00011},   {318,1,0b11011},   {319,1,0b10011},   {320,0,0b10001},   {321,1,0b11001},   {322,1,0b00001},   {325,0,0b01101},   {326,0,0b01101},   {327,1,0b11001},   {328,0,0b01101},   {329,1,0b10111},   {330,0,0b00001},   {331,1,0b10011},   {332,0,0b00011},   {333,1,0b10111},   {334,1,0b11101},   {335,0,0b01111},   {336,0,0b10111},   {337,1,0b11001},   {338,1,0b10011},   {339,1,0b01101},   {340,1,0b01011},   {341,1,0b11111},   {342,0,0b01001},   {343,1,0b11001},   {344,1,0b00001},   {346,0,0b10001},   {347,0,0b10111},   {348,1,0b11101},   {349,0,0b00111},   {350,1,0b10001},   {351,1,0b10001},   {352,0,0b01011},   {353,1,0b11001},   {354,1,0b00011},   {355,1,0b00111},   {357,0,0b10011},   {358,1,0b11101},   {359,1,0b00011},   {360,0,0b01111},   {361,1,0b10001},   {362,1,0b01111},   {363,1,0b10101},   {366,1,0b11111},   {367,1,0b00111},   {370,1,0b11001},   {371,1,0b11101},   {373,1,0b00011},   {375,1,0b00101},   {378,1,0b00111},   {379,1,0b11111},   {381,0,0b01001},   {382,0,0b10011},   {383,0,0b11001},   {384,1,0b11011},   {385,0,0b00111},   {386,1,0b01101},   {387,0,0b00011},   {388,0,0b00101},   {389,0,0b01101},   {390,0,0b10111},   {391,0,0b11001},   {392,1,0b11111},   {393,1,0b10111},   {394,1,0b00001},   {395,0,0b01101},   {396,1,0b01101},   {397,0,0b00001},   {398,0,0b01011},   {399,1,0b10111},   {400,1,0b11111},   {401,0,0b00101},   {402,1,0b01001},   {403,1,0b01101},   {404,0,0b10001},   {405,0,0b10011},   {406,1,0b10101},   {407,1,0b01011},   {408,1,0b10001},   {409,0,0b01011},   {410,1,0b01111},   {411,1,0b11011},   {412,0,0b00101},   {413,1,0b10001},   {414,0,0b00111},   {415,0,0b11001},   {416,0,0b11001},   {417,1,0b11101},   {418,1,0b01001},   {419,0,0b00111},   {420,1,0b11011},   {421,1,0b11101},   {422,1,0b01111},   {423,1,0b11001},   {424,0,0b00011},   {425,1,0b10111},   {426,0,0b00101},   {427,1,0b11001},   {428,0,0b10011},   {429,1,0b10111},   {430,1,0b10011},   {431,1,0b01011},   {432,0,0b01111},   {433,1,0b11111},   {438,1,0b10111},   {440,1,0b00011},   {441,1,0b10011},   {442,1,0b01111},   {445,1,0b11111},   {446,1,0b01001},   {447,0,0b00001},   {448,0,0b00001},   {449,0,0b01101},   {450,0,0b01111},   {451,0,0b10101},   {452,0,0b11101},   {453,1,0b11111},   {454,0,0b10001},   {455,1,0b11111},   {456,0,0b10001},   {457,1,0b11101},   {458,0,0b00101},   {459,1,0b01001},   {460,0,0b00101},   {461,0,0b10011},   {462,0,0b11001},   {463,0,0b11101},   {464,1,0b11101},   {465,1,0b01111},   {466,0,0b00011},   {467,1,0b10111},   {468,1,0b00001},   {469,1,0b01111},   {470,1,0b00111},   {471,1,0b10011},   {472,0,0b11001},   {473,0,0b11001},   {474,1,0b11101},   {475,1,0b10111},   {476,1,0b11111},   {477,0,0b00011},   {478,1,0b01001},   {479,0,0b00001},   {480,0,0b10101},   {481,1,0b11101},   {482,0,0b10001},   {483,1,0b10011},   {484,1,0b00001},   {485,1,0b00001},   {486,0,0b01111},   {487,1,0b01111},   {488,1,0b00111},   {489,0,0b00011},   {490,0,0b00101},   {491,0,0b01101},   {492,1,0b10001},   {493,0,0b00011},   {494,1,0b10111},   {495,0,0b01001},   {496,1,0b10101},   {497,0,0b00111},   {498,1,0b01011},   {499,0,0b00001},   {500,1,0b10001},   {501,0,0b01011},   {502,0,0b10011},   {503,1,0b11111},   {504,1,0b11011},   {505,1,0b10011},   {506,1,0b10001},   {507,0,0b00111},   {508,1,0b10001},   {509,1,0b01101},   {510,0,0b10111},   {511,1,0b11101},   {512,1,0b11101},   {513,0,0b00111},   {514,0,0b11001},   {515,1,0b11101},   {516,1,0b01011},   {517,0,0b10001},   {518,1,0b10111},   {519,0,0b00011},   {520,1,0b00111},   {521,1,0b00101},   {522,0,0b10101},   {523,1,0b11001},   {524,0,0b00101},   {525,1,0b10101},   {526,1,0b10001},   {527,0,0b01001},   {528,1,0b11111},   {529,0,0b01101},   {530,1,0b01111},   {531,1,0b11001},   {532,0,0b00101},   {533,1,0b00111},   {534,1,0b01011},   {535,0,0b00111},   {536,0,0b10001},   {537,0,0b10101},   {538,1,0b10111},   {539,0,0b00011},   {540,0,0b01001},   {541,1,0b10011},   {542,1,0b11101},   {543,0,0b01001},   {544,0,0b01001},   {545,0,0b01011},   {546,1,0b11011},   {547,0,0b01101},   {548,0,0b10101},   {549,1,0b10101},   {550,0,0b00001},   {551,0,0b00101},   {552,1,0b01111},   {553,1,0b01011},   {554,0,0b10101},   {555,1,0b11101},   {556,1,0b10011},   {557,0,0b01001},   {558,0,0b10001},   {559,1,0b10101},   {560,0,0b00101},   {561,0,0b01111},   {562,0,0b10101},   {563,0,0b10111},   {564,1,0b11101},   {565,1,0b01111},   {566,1,0b00101},   {567,0,0b00101},   {568,0,0b00111},   {569,1,0b01001},   {570,1,0b01011},   {571,1,0b01111},   {572,1,0b00101},   {573,1,0b00111},   {574,1,0b11011},   {575,0,0b00111},   {576,1,0b10101},   {577,1,0b01111},   {578,1,0b11001},   {579,1,0b00001},   {580,1,0b00001},   {581,1,0b00001},   {582,0,0b01011},   {583,1,0b11011},   {584,0,0b00011},   {585,0,0b01001},   {586,0,0b10011},   {587,1,0b11011},   {588,0,0b10001},   {589,1,0b11001},   {590,1,0b00101},   {591,1,0b10111},   {592,0,0b10011},   {593,0,0b10101},   {594,1,0b11001},   {595,0,0b10011},   {596,1,0b10101},   {597,1,0b10011},   {598,1,0b11001},   {599,0,0b00111},   {600,0,0b10101},   {601,0,0b10101},   {602,1,0b11101},   {603,0,0b10011},   {604,1,0b10011},   {605,1,0b01001},   {606,1,0b01011},   {607,1,0b00111},   {608,0,0b00001},   {609,0,0b00011},   {610,0,0b10001},   {611,1,0b11001},   {612,0,0b00001},   {613,0,0b01011},   {614,1,0b11001},   {615,1,0b00111},   {616,1,0b11001},   {617,0,0b00111},   {618,0,0b01101},   {619,0,0b10001},   {620,1,0b10001},   {621,1,0b11011},   {622,0,0b01101},   {623,1,0b11101},   {624,0,0b00011},   {625,1,0b01111},   {626,1,0b11101},   {627,0,0b00111},   {628,1,0b01001},   {629,0,0b00001},   {630,1,0b11011},   {631,0,0b00101},   {632,1,0b10111},   {633,0,0b00111},   {634,1,0b11011},   {635,1,0b11101},   {636,1,0b00011},   {637,1,0b01111},   {638,0,0b00011},   {639,0,0b01101},   {640,1,0b11011},   {641,1,0b00011},   {642,0,0b00111},   {643,0,0b01001},   {644,0,0b01011},   {645,0,0b10111},   {646,0,0b11001},   {647,1,0b11101},   {648,1,0b01011},   {649,1,0b10111},   {650,1,0b00011},   {651,0,0b00101},   {652,0,0b10111},   {653,0,0b10111},   {654,1,0b11011},   {655,0,0b01011},   {656,1,0b11011},   {657,0,0b00111},   {658,0,0b01101},   {659,0,0b10011},   {660,1,0b11111},   {661,1,0b01011},   {662,0,0b10101},   {663,1,0b11011},   {664,0,0b01011},   {665,0,0b01111},   {666,1,0b11001},   {667,1,0b11011},   {668,1,0b00111},   {669,1,0b00101},   {670,1,0b01001},   {671,1,0b01011},   {672,1,0b11101},   {673,1,0b10011},   {674,0,0b01001},   {675,1,0b11001},   {676,0,0b00101},   {677,1,0b01111},   {678,0,0b00001},   {679,1,0b10001},   {680,0,0b00101},   {681,1,0b11011},   {682,1,0b10101},   {683,0,0b01111},   {684,0,0b10111},   {685,1,0b11111},   {686,0,0b00101},   {687,0,0b01011},   {688,0,0b10011},   {689,1,0b11011},   {690,1,0b01001},   {691,0,0b00101},   {692,1,0b11001},   {693,0,0b10011},   {694,1,0b10101},   {695,1,0b10001},   {696,1,0b10111},   {697,1,0b00111},   {698,1,0b11001},   {699,1,0b00001},   {700,1,0b01101},   {701,1,0b11111},   {702,1,0b00001},   {703,0,0b00111},   {704,1,0b11001},   {705,1,0b10001},   {706,0,0b11101},   {707,1,0b11101},   {708,0,0b10111},   {709,1,0b11111},   {710,0,0b00001},   {711,0,0b00101},   {712,1,0b01011},   {713,0,0b00011},   {714,1,0b10111},   {715,0,0b00011},   {716,1,0b00101},   {717,0,0b01001},   {718,0,0b10101},   {719,1,0b11111},   {720,0,0b01011},   {721,1,0b10111},   {722,1,0b01111},   {723,0,0b01011},   {724,1,0b10101},   {725,0,0b01111},   {726,1,0b11011},   {727,0,0b00111},   {728,0,0b10011},   {729,1,0b10111},   {730,0,0b00111},   {731,0,0b10001},   {732,1,0b10011},   {733,1,0b00001},   {734,0,0b01111},   {735,0,0b01111},   {736,1,0b10001},   {737,1,0b01001},   {738,0,0b00001},   {739,1,0b00111},   {740,1,0b11011},   {741,0,0b10001},   {742,0,0b10001},   {743,0,0b10001},   {744,1,0b10111},   {745,1,0b10001},   {746,1,0b10001},   {747,0,0b01001},   {748,0,0b01101},   {749,0,0b11001},   {750,1,0b11011},   {751,1,0b10001},   {752,0,0b00001},   {753,0,0b00011},   {754,1,0b00101},   {755,1,0b00111},   {756,0,0b00011},   {757,1,0b01001},   {758,1,0b00111},   {759,0,0b00001},   {760,1,0b11101},   {761,1,0b01111},   {762,1,0b00111},   {763,0,0b01001},   {764,1,0b10001},   {765,1,0b00111},   {766,1,0b01011},   {767,1,0b10011},   {768,0,0b01101},   {769,1,0b10001},   {770,1,0b10001},   {771,0,0b00011},   {772,0,0b00101},   {773,1,0b11101},   {774,1,0b10111},   {775,1,0b10101},   {776,1,0b10001},   {777,1,0b11101},   {778,0,0b11001},   {779,1,0b11101},   {780,0,0b01011},   {781,1,0b11001},   {782,0,0b10001},   {783,1,0b10101},   {784,1,0b00001},   {785,0,0b10001},   {786,1,0b11101},   {787,1,0b11111},   {788,0,0b00011},   {789,1,0b10001},   {790,1,0b01011},   {791,1,0b10101},   {792,0,0b11001},   {793,1,0b11101},   {794,0,0b10001},   {795,1,0b10101},   {796,1,0b01001},   {797,1,0b11011},   {798,0,0b00111},   {799,0,0b01001},   {800,0,0b10111},   {801,1,0b11111},   {802,1,0b11101},   {803,1,0b10101},   {804,0,0b00011},   {805,1,0b10001},   {806,1,0b11111},   {807,1,0b10111},   {808,1,0b01111},   {809,0,0b01011},   {810,1,0b11011},   {811,1,0b10101},   {812,0,0b00011},   {813,1,0b01101},   {814,0,0b00101},   {815,0,0b01001},   {816,1,0b10001},   {817,0,0b01101},   {818,1,0b11111},   {819,1,0b01001},   {820,0,0b10101},   {821,0,0b10111},   {822,1,0b11111},   {823,0,0b00001},   {824,1,0b10011},   {825,1,0b00011},   {826,1,0b01101},   {827,1,0b11011},   {828,1,0b00001},   {829,1,0b11011},   {830,1,0b10011},   {831,0,0b01101},   {832,1,0b10001},   {833,0,0b00011},   {834,1,0b10011},   {835,0,0b00101},   {836,1,0b01001},   {837,0,0b01111},   {838,1,0b10011},   {839,0,0b10011},   {840,1,0b11111},   {841,1,0b01001},   {842,1,0b01101},   {843,0,0b01111},   {844,1,0b10101},   {845,0,0b00011},   {846,1,0b11111},   {847,1,0b00111},   {848,0,0b00001},   {849,0,0b00111},   {850,0,0b10101},   {851,0,0b10111},   {852,1,0b11101},   {853,0,0b01111},   {854,1,0b11001},   {855,1,0b10001},   {856,1,0b01111},   {857,0,0b10111},   {858,0,0b11001},   {859,1,0b11001},   {860,0,0b10101},   {861,1,0b11111},   {862,1,0b10011},   {863,0,0b01011},   {864,1,0b11011},   {865,1,0b11011},   {866,0,0b10011},   {867,1,0b10101},   {868,0,0b00101},   {869,1,0b00101},   {870,0,0b00011},   {871,0,0b10111},   {872,1,0b11011},   {873,0,0b01001},   {874,0,0b01001},   {875,1,0b11101},   {876,0,0b01001},   {877,0,0b10101},   {878,1,0b11101},   {879,0,0b11001},   {880,0,0b11111},   {881,1,0b11111},   {882,0,0b01011},   {883,1,0b11101},   {884,0,0b00111},   {885,1,0b10111},   {886,0,0b00101},   {887,1,0b01011},   {888,0,0b00001},   {889,1,0b00011},   {890,0,0b00111},   {891,0,0b01001},   {892,1,0b01101},   {893,0,0b00011},   {894,1,0b10011},   {895,1,0b01111},   {896,1,0b10111},   {897,0,0b01001},   {898,0,0b01111},   {899,0,0b10011},   {900,1,0b11111},   {901,1,0b11001},   {902,0,0b00011},   {903,1,0b10001},   {904,1,0b01011},   {905,0,0b00101},   {906,1,0b01001},   {907,0,0b10011},   {908,0,0b10111},   {909,0,0b11011},   {910,1,0b11111},   {911,1,0b11111},   {912,1,0b00111},   {913,1,0b01101},   {914,1,0b11101},   {915,0,0b10101},   {916,0,0b11011},   {917,1,0b11011},   {918,0,0b01111},   {919,0,0b10001},   {920,1,0b11101},   {921,0,0b01011},   {922,1,0b10111},   {923,0,0b00001},   {924,0,0b01011},   {925,1,0b10001},   {926,0,0b00011},   {927,1,0b01101},   {928,1,0b11001},   {929,0,0b00111},   {930,0,0b01101},   {931,0,0b11011},   {932,1,0b11111},   {933,1,0b11011},   {934,1,0b11011},   {935,0,0b10101},   {936,1,0b11001},   {937,1,0b00111},   {938,1,0b01011},   {939,0,0b00101},   {940,1,0b00111},   {941,1,0b01001},   {942,1,0b11111},   {943,0,0b01101},   {944,1,0b11101},   {945,0,0b00001},   {946,1,0b11001},   {947,0,0b01001},   {948,1,0b01111},   {949,1,0b00001},   {950,0,0b00101},   {951,0,0b01111},   {952,0,0b11001},   {953,1,0b11001},   {954,0,0b10001},   {955,1,0b11011},   {956,0,0b01101},   {957,1,0b01101},   {958,1,0b01101},   {959,0,0b00111},   {960,0,0b01011},   {961,1,0b10011},   {962,0,0b00111},   {963,0,0b10001},   {964,0,0b10101},   {965,1,0b11001},   {966,1,0b11011},   {967,1,0b11101},   {968,1,0b01001},   {969,0,0b00101},   {970,0,0b00111},   {971,1,0b10111},   {972,1,0b00001},   {973,0,0b01101},   {974,1,0b10101},   {975,1,0b11111},   {976,1,0b01111},   {977,0,0b00101},   {978,0,0b10001},   {979,1,0b11111},   {980,1,0b10111},   {981,0,0b01011},   {982,0,0b01101},   {983,1,0b10101},   {984,1,0b11101},   {985,1,0b10011},   {986,0,0b10101},   {987,1,0b11111},   {988,0,0b10011},   {989,1,0b11111},   {990,0,0b00111},   {991,1,0b10111},   {992,0,0b10101},   {993,0,0b10101},   {994,1,0b11011},   {995,0,0b01001},   {996,1,0b10101},   {997,1,0b01011},   {998,1,0b10101},   {999,1,0b11001},   {1000,1,0b01111},   {1001,1,0b00011},   {1002,0,0b00001},   {1003,0,0b00011},   {1004,0,0b00101},   {1005,1,0b01011},   {1006,1,0b00101},   {1007,1,0b00101},   {1008,0,0b00111},   {1009,1,0b01011},   {1010,0,0b11001},   {1011,1,0b11111},   {1012,0,0b10101},   {1013,0,0b11101},   {1014,1,0b11111},   {1015,1,0b10101},   {1016,0,0b01011},   {1017,0,0b10111},   {1018,1,0b11111},   {1019,1,0b11011},   {1020,1,0b10101},   {1021,0,0b01001},   {1022,0,0b10001},   {1023,1,0b11111},   {1024,1,0b11001},   {1025,0,0b00101},   {1026,0,0b10001},   {1027,1,0b11001},   {1028,0,0b10111},   {1029,1,0b10111},   {1030,0,0b11011},   {1031,1,0b11111},   {1032,1,0b11111},   {1033,0,0b01011},   {1034,0,0b01011},   {1035,1,0b10011},   {1036,0,0b01101},   {1037,1,0b10011},   {1038,0,0b00001},   {1039,1,0b01111},   {1040,1,0b00011},   {1041,0,0b10101},   {1042,1,0b11101},   {1043,0,0b11001},   {1044,1,0b11011},   {1045,1,0b01101},   {1046,0,0b00101},   {1047,0,0b01011},   {1048,0,0b10101},   {1049,0,0b11101},   {1050,1,0b11101},   {1051,0,0b00001},   {1052,0,0b01101},   {1053,1,0b10001},   {1054,0,0b00101},   {1055,0,0b00111},   {1056,1,0b01001},   {1057,0,0b11101},   {1058,1,0b11101},   {1059,1,0b10001},   {1060,1,0b10101},   {1061,0,0b00101},   {1062,1,0b10101},   {1063,0,0b00011},   {1064,0,0b00101},   {1065,1,0b10111},   {1066,0,0b01011},   {1067,1,0b01011},   {1068,0,0b00101},   {1069,1,0b01011},   {1070,1,0b01001},   {1071,0,0b00011},   {1072,1,0b00101},   {1073,0,0b10001},   {1074,1,0b11101},   {1075,1,0b01011},   {1076,1,0b11001}};
-                    const uint8_t *res_key;
-                    uint32_t res_size, dummy;
-                    typename Diva<O>::InfixStore *store;
-                    wh_int_iter_peek_ref(it, reinterpret_cast<const void **>(&res_key), &res_size,
-                                         reinterpret_cast<void **>(&store), &dummy);
+    template <bool O, uint32_t T>
+    static void StoreTargetSize() {
+        const uint32_t infix_size = 8;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 20 * T;
+        const uint32_t n_inserts = 20 * T;
+        const uint32_t n_queries = 100000;
 
-                    REQUIRE_EQ(memcmp(expected_boundary, res_key, sizeof(keys[0])), 0);
-                    REQUIRE_FALSE(store->IsPartialKey());
-                    REQUIRE_EQ(store->GetInvalidBits(), 0);
-                    AssertStoreContents(s, *store, occupieds_pos, checks);
-                }
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<uint64_t> conv_keys(keys);
+        if constexpr (!O) {
+            for (int32_t i = 0; i < conv_keys.size(); i++)
+                conv_keys[i] = to_big_endian_order(conv_keys[i]);
+        }
+        Diva<O, T> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+        REQUIRE_EQ(s.infix_store_target_size, T);
+        REQUIRE_EQ(s.base_implicit_size, __builtin_ctz(T));
 
-                wh_int_iter_skip1(it);
-                {
-                    const uint8_t expected_boundary[] = {0b01100010, 0b00101001, 0b11111000, 0b10110111, 0b10010000, 0b00101011, 0b01101111, 0b10111011};
-                    const std::vector<uint32_t> occupieds_pos = {0, 2, 4, 6, 7, 8, 9, 10, 12, 13, 14, 15, 17, 18, 20, 21, 23, 26, 27, 28, 29, 30, 31, 32, 33, 34, 36, 37, 39, 40, 41, 42, 43, 44, 47, 49, 50, 52, 53, 54, 55, 56, 57, 58, 60, 63, 64, 65, 66, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 95, 96, 97, 98, 100, 101, 102, 104, 105, 107, 108, 109, 110, 111, 112, 113, 115, 116, 118, 119, 120, 121, 122, 123, 125, 126, 127, 128, 131, 134, 135, 136, 138, 139, 140, 141, 142, 143, 145, 146, 147, 148, 150, 152, 154, 155, 156, 157, 158, 159, 160, 163, 164, 165, 166, 170, 171, 172, 173, 175, 176, 177, 179, 180, 181, 185, 186, 187, 188, 189, 190, 193, 195, 196, 198, 199, 200, 201, 202, 203, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215, 216, 219, 220, 222, 223, 224, 225, 226, 227, 229, 230, 231, 232, 233, 234, 235, 236, 237, 239, 240, 241, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 254, 255, 256, 257, 258, 260, 261, 262, 264, 265, 266, 268, 269, 271, 273, 274, 275, 276, 277, 279, 280, 281, 282, 283, 284, 285, 286, 287, 288, 289, 291, 292, 297, 298, 300, 301, 302, 303, 304, 305, 308, 309, 310, 311, 312, 313, 314, 316, 317, 318, 321, 322, 323, 324, 326, 327, 328, 329, 331, 332, 335, 338, 340, 341, 343, 345, 346, 347, 348, 349, 350, 351, 352, 353, 354, 355, 356, 358, 361, 362, 364, 365, 367, 368, 369, 370, 371, 372, 373, 374, 377, 378, 380, 382, 383, 384, 387, 388, 389, 391, 392, 393, 394, 395, 396, 398, 399, 400, 401, 403, 404, 406, 409, 410, 411, 413, 415, 417, 418, 420, 421, 424, 425, 429, 430, 431, 432, 433, 434, 435, 437, 438, 439, 440, 442, 443, 444, 445, 446, 447, 448, 450, 451, 452, 453, 454, 455, 456, 457, 458, 459, 461, 462, 463, 464, 466, 468, 471, 472, 474, 475, 477, 478, 479, 480, 481, 482, 484, 485, 486, 487, 489, 490, 491, 492, 493, 494, 497, 498, 499, 502, 503, 505, 506, 507, 508, 509, 511, 512, 513, 516, 517, 521, 523, 525, 526, 527, 528, 530, 532, 537, 538, 539, 541, 542, 543, 544, 545, 549, 551, 552, 553, 554, 556, 557, 558, 559, 560, 562, 564, 567, 568, 570, 573, 574, 575, 576, 577, 578, 579, 580, 581, 582, 583, 584, 585, 589, 590, 591, 592, 593, 594, 595, 596, 597, 598, 601, 602, 603, 604, 606, 607, 608, 609, 610, 612, 613, 616, 617, 618, 619, 620, 621, 622, 623, 624, 625, 626, 627, 629, 630, 631, 632, 634, 636, 637, 638, 639, 640, 641, 642, 643, 644, 645, 647, 649, 650, 651, 654, 655, 656, 657, 658, 659, 661, 662, 664, 668, 669, 670, 671, 673, 675, 676, 677, 678, 680, 681, 682, 683, 684, 686, 687, 688, 689, 691, 692, 693, 694, 698, 700, 702, 703, 704, 705, 706, 708, 709, 710, 714, 715, 717, 718, 719, 720, 721, 722, 724, 725, 730, 731, 732, 733, 734, 735, 736, 737, 740, 741, 742, 743, 744, 745, 746, 747, 748, 749, 750, 751, 752, 753, 756, 757, 758, 762, 763, 765, 767, 768, 770, 771, 772, 774, 776, 777, 778, 779, 781, 783, 784, 786, 787, 789, 790, 792, 793, 796, 797, 800, 801, 802, 803, 805, 809, 811};
-                    const std::vector<std::tuple<uint32_t, bool, uint64_t>> checks = {{  0,0,0b11101},   {  1,1,0b11111},   {  2,0,0b10101},   {  3,1,0b11011},   {  5,0,0b01001},   {  6,0,0b01011},   {  7,1,0b10011},   {  8,0,0b00101},   {  9,1,0b10001},   { 10,0,0b01101},   { 11,1,0b11001},   { 12,0,0b00001},   { 13,1,0b11111},   { 14,1,0b10001},   { 15,1,0b00001},   { 16,0,0b01001},   { 17,1,0b11111},   { 18,0,0b01101},   { 19,1,0b01111},   { 20,0,0b01111},   { 21,0,0b10111},   { 22,1,0b11111},   { 23,1,0b01111},   { 24,0,0b00001},   { 25,0,0b01001},   { 26,1,0b11001},   { 27,1,0b10001},   { 28,1,0b10111},   { 29,1,0b01011},   { 30,0,0b00011},   { 31,1,0b11001},   { 34,0,0b01001},   { 35,0,0b01111},   { 36,0,0b10101},   { 37,1,0b11001},   { 38,0,0b00011},   { 39,0,0b00101},   { 40,0,0b01101},   { 41,0,0b10011},   { 42,1,0b11011},   { 43,1,0b11001},   { 44,1,0b00011},   { 45,1,0b01111},   { 46,1,0b11011},   { 47,1,0b11111},   { 48,1,0b10011},   { 49,1,0b11111},   { 50,1,0b00001},   { 51,1,0b10001},   { 52,0,0b01101},   { 53,0,0b01111},   { 54,1,0b10101},   { 55,1,0b10101},   { 56,0,0b10111},   { 57,1,0b11101},   { 58,1,0b10101},   { 59,0,0b00001},   { 60,1,0b10001},   { 61,1,0b01111},   { 62,0,0b01101},   { 63,0,0b10111},   { 64,1,0b11001},   { 65,0,0b01001},   { 66,0,0b01011},   { 67,1,0b01111},   { 68,1,0b00111},   { 69,1,0b00111},   { 70,0,0b00111},   { 71,1,0b01101},   { 72,1,0b11101},   { 73,1,0b10101},   { 74,0,0b10001},   { 75,1,0b11111},   { 76,1,0b11111},   { 77,0,0b01001},   { 78,0,0b10111},   { 79,1,0b11001},   { 80,0,0b00111},   { 81,1,0b11111},   { 83,0,0b01011},   { 84,1,0b10101},   { 85,0,0b00001},   { 86,0,0b01101},   { 87,0,0b10011},   { 88,1,0b10101},   { 89,1,0b01011},   { 90,0,0b01101},   { 91,1,0b01111},   { 92,1,0b00101},   { 93,1,0b11101},   { 94,0,0b00111},   { 95,1,0b01001},   { 96,0,0b00101},   { 97,1,0b10001},   { 98,0,0b10001},   { 99,0,0b10001},   {100,1,0b11001},   {101,1,0b01101},   {102,1,0b01001},   {103,0,0b00101},   {104,0,0b00111},   {105,0,0b00111},   {106,1,0b10011},   {107,1,0b00001},   {108,0,0b01101},   {109,1,0b10101},   {110,0,0b10101},   {111,1,0b11001},   {112,0,0b01111},   {113,1,0b01111},   {114,1,0b00101},   {115,0,0b10001},   {116,0,0b10101},   {117,0,0b10111},   {118,1,0b11011},   {119,1,0b10111},   {120,1,0b10101},   {121,0,0b01111},   {122,0,0b01111},   {123,0,0b10101},   {124,1,0b10101},   {125,0,0b00111},   {126,0,0b01011},   {127,1,0b10001},   {128,0,0b01011},   {129,1,0b11101},   {130,0,0b01001},   {131,1,0b10111},   {132,0,0b10111},   {133,1,0b11001},   {134,0,0b01111},   {135,1,0b11001},   {136,0,0b00101},   {137,1,0b11101},   {138,1,0b00011},   {139,1,0b11011},   {140,1,0b00011},   {141,0,0b10001},   {142,1,0b10111},   {143,0,0b00001},   {144,0,0b01101},   {145,0,0b10001},   {146,1,0b11011},   {147,0,0b00101},   {148,0,0b10111},   {149,1,0b11011},   {150,0,0b01111},   {151,1,0b11001},   {152,0,0b10011},   {153,1,0b10101},   {154,1,0b10111},   {155,0,0b01011},   {156,1,0b01111},   {157,0,0b00111},   {158,0,0b10001},   {159,1,0b11011},   {160,1,0b00001},   {161,0,0b11111},   {162,1,0b11111},   {163,0,0b01001},   {164,0,0b10001},   {165,1,0b10011},   {166,1,0b01111},   {167,0,0b00111},   {168,0,0b01111},   {169,1,0b10101},   {170,0,0b01101},   {171,1,0b11001},   {172,1,0b11011},   {173,1,0b01011},   {174,1,0b10101},   {175,1,0b01101},   {176,1,0b01101},   {177,0,0b00111},   {178,1,0b11001},   {179,0,0b01011},   {180,1,0b11011},   {181,0,0b00011},   {182,1,0b01001},   {183,0,0b01101},   {184,0,0b11001},   {185,1,0b11101},   {186,1,0b10011},   {187,0,0b00011},   {188,1,0b00011},   {189,0,0b00011},   {190,0,0b00101},   {191,1,0b10101},   {192,1,0b00001},   {193,1,0b10001},   {194,1,0b11011},   {195,0,0b10001},   {196,0,0b10111},   {197,0,0b11101},   {198,1,0b11101},   {199,1,0b00101},   {200,0,0b01101},   {201,1,0b11111},   {202,1,0b01101},   {203,1,0b00101},   {204,1,0b01001},   {205,1,0b10001},   {206,0,0b01001},   {207,1,0b01011},   {208,0,0b10111},   {209,1,0b10111},   {210,1,0b01101},   {211,0,0b01011},   {212,1,0b10101},   {213,0,0b01011},   {214,1,0b10001},   {215,0,0b00001},   {216,0,0b11011},   {217,0,0b11011},   {218,1,0b11011},   {219,1,0b11101},   {220,0,0b00001},   {221,1,0b00101},   {222,0,0b00011},   {223,1,0b01001},   {224,1,0b10101},   {225,1,0b11001},   {226,1,0b11101},   {227,1,0b00001},   {228,1,0b01001},   {229,0,0b00111},   {230,0,0b01001},   {231,1,0b11011},   {232,1,0b01111},   {233,0,0b01001},   {234,0,0b01011},   {235,1,0b01111},   {236,0,0b00111},   {237,0,0b00111},   {238,1,0b11011},   {239,1,0b10101},   {240,0,0b00001},   {241,0,0b10001},   {242,1,0b11011},   {243,0,0b00101},   {244,1,0b10011},   {245,0,0b00111},   {246,1,0b10001},   {247,1,0b11001},   {248,1,0b11001},   {249,1,0b00111},   {250,1,0b10111},   {251,0,0b00001},   {252,1,0b10101},   {253,1,0b10011},   {254,1,0b00101},   {255,1,0b10101},   {256,1,0b01111},   {257,0,0b01001},   {258,1,0b10001},   {259,0,0b00011},   {260,0,0b10001},   {261,1,0b11111},   {262,0,0b00011},   {263,0,0b01011},   {264,1,0b10011},   {265,1,0b00011},   {266,0,0b01101},   {267,1,0b11001},   {268,0,0b00101},   {269,0,0b10111},   {270,1,0b11011},   {271,1,0b11101},   {272,1,0b10001},   {273,0,0b00001},   {274,1,0b11101},   {275,0,0b10111},   {276,1,0b11111},   {277,0,0b01101},   {278,0,0b10111},   {279,1,0b11111},   {280,0,0b00111},   {281,1,0b11101},   {282,0,0b01011},   {283,1,0b10101},   {284,0,0b01101},   {285,1,0b10001},   {286,0,0b00101},   {287,0,0b10001},   {288,0,0b11001},   {289,1,0b11101},   {290,1,0b00111},   {291,0,0b01011},   {292,1,0b11001},   {293,0,0b01011},   {294,1,0b11001},   {295,0,0b00001},   {296,0,0b00011},   {297,0,0b00101},   {298,1,0b11011},   {299,0,0b00011},   {300,0,0b00111},   {301,1,0b10001},   {302,1,0b11011},   {303,0,0b11001},   {304,1,0b11111},   {305,1,0b11101},   {306,0,0b11001},   {307,1,0b11111},   {308,0,0b01001},   {309,1,0b01101},   {310,1,0b11011},   {311,1,0b10101},   {312,0,0b00101},   {313,0,0b01101},   {314,1,0b10111},   {315,0,0b00111},   {316,0,0b11011},   {317,1,0b11011},   {318,1,0b00011},   {319,0,0b01111},   {320,0,0b11001},   {321,1,0b11111},   {322,1,0b10011},   {323,1,0b01101},   {324,1,0b11101},   {325,1,0b00001},   {326,1,0b01101},   {327,0,0b01001},   {328,1,0b11011},   {329,0,0b00111},   {330,1,0b10001},   {331,1,0b10011},   {332,0,0b01111},   {333,0,0b10101},   {334,1,0b11101},   {335,1,0b11001},   {336,0,0b01101},   {337,1,0b10111},   {338,1,0b00001},   {339,1,0b00011},   {340,1,0b01111},   {341,1,0b11011},   {342,0,0b10101},   {343,1,0b10111},   {344,1,0b10101},   {345,1,0b11011},   {346,0,0b01011},   {347,1,0b11001},   {348,1,0b01001},   {349,1,0b01101},   {350,0,0b11001},   {351,1,0b11111},   {352,1,0b01001},   {353,1,0b11011},   {354,1,0b00101},   {355,1,0b00111},   {356,0,0b01111},   {357,1,0b11001},   {358,0,0b10011},   {359,1,0b11011},   {360,0,0b01001},   {361,1,0b10001},   {362,1,0b10101},   {363,0,0b01101},   {364,1,0b11101},   {365,1,0b01111},   {366,1,0b01101},   {367,0,0b00111},   {368,0,0b01101},   {369,1,0b11001},   {370,0,0b10011},   {371,1,0b11101},   {372,0,0b01001},   {373,0,0b01011},   {374,1,0b01111},   {375,0,0b10101},   {376,1,0b11101},   {377,0,0b00101},   {378,0,0b01011},   {379,1,0b11001},   {380,1,0b10001},   {381,0,0b00101},   {382,1,0b11101},   {383,0,0b01111},   {384,1,0b11111},   {385,0,0b10111},   {386,1,0b11111},   {387,1,0b01101},   {388,0,0b10011},   {389,1,0b10101},   {390,0,0b00001},   {391,0,0b00011},   {392,1,0b10011},   {393,0,0b01001},   {394,0,0b10011},   {395,1,0b11001},   {396,0,0b01011},   {397,1,0b01111},   {398,0,0b00111},   {399,1,0b11011},   {400,1,0b10111},   {401,0,0b01111},   {402,1,0b01111},   {403,1,0b00101},   {404,1,0b11111},   {405,1,0b11101},   {406,1,0b10101},   {407,1,0b01101},   {408,0,0b01111},   {409,0,0b10001},   {410,1,0b10001},   {411,0,0b10101},   {412,1,0b11111},   {413,0,0b01111},   {414,1,0b11101},   {415,0,0b00111},   {416,0,0b01001},   {417,1,0b10001},   {418,0,0b10011},   {419,1,0b11101},   {420,0,0b00001},   {421,1,0b01111},   {422,0,0b11001},   {423,1,0b11101},   {424,1,0b01101},   {425,1,0b11111},   {426,1,0b01101},   {427,0,0b00011},   {428,0,0b00101},   {429,0,0b11101},   {430,1,0b11111},   {431,0,0b00011},   {432,0,0b01001},   {433,1,0b11011},   {434,0,0b01101},   {435,1,0b11111},   {436,1,0b11001},   {437,0,0b01111},   {438,1,0b11101},   {439,1,0b11101},   {440,1,0b00101},   {441,0,0b01011},   {442,1,0b11011},   {443,0,0b00011},   {444,1,0b00101},   {445,1,0b11011},   {446,0,0b11111},   {447,1,0b11111},   {448,1,0b10101},   {449,0,0b00011},   {450,0,0b01111},   {451,0,0b10001},   {452,1,0b11011},   {453,0,0b01101},   {454,0,0b10101},   {455,1,0b11111},   {456,1,0b10111},   {457,1,0b01111},   {458,0,0b01101},   {459,1,0b10101},   {460,0,0b10101},   {461,1,0b11101},   {462,1,0b00111},   {463,1,0b11101},   {464,1,0b01101},   {465,0,0b00001},   {466,0,0b10001},   {467,1,0b10101},   {468,1,0b10001},   {469,0,0b00011},   {470,1,0b01101},   {471,1,0b00001},   {472,0,0b00001},   {473,1,0b01101},   {474,1,0b10011},   {475,1,0b11101},   {476,0,0b00001},   {477,1,0b11011},   {478,1,0b00001},   {479,1,0b01101},   {480,1,0b10011},   {481,1,0b00111},   {482,1,0b01111},   {483,1,0b01001},   {484,0,0b00111},   {485,1,0b11101},   {486,0,0b01011},   {487,1,0b10101},   {488,1,0b00111},   {489,0,0b00111},   {490,1,0b01001},   {491,1,0b11101},   {492,0,0b10001},   {493,1,0b11101},   {494,1,0b01001},   {495,1,0b10001},   {496,1,0b10101},   {497,0,0b00011},   {498,1,0b00111},   {500,0,0b00011},   {501,1,0b01101},   {502,1,0b10001},   {504,0,0b01111},   {505,1,0b10111},   {507,1,0b00011},   {508,1,0b10001},   {509,1,0b10101},   {513,0,0b01101},   {514,1,0b10001},   {515,0,0b00101},   {516,0,0b00111},   {517,1,0b11101},   {518,1,0b11111},   {519,0,0b00011},   {520,1,0b00011},   {521,0,0b00101},   {522,1,0b01111},   {523,0,0b00001},   {524,1,0b10111},   {525,0,0b00001},   {526,1,0b00101},   {527,1,0b01001},   {528,0,0b00101},   {529,1,0b01111},   {530,1,0b10111},   {531,1,0b00011},   {532,0,0b10001},   {533,1,0b11101},   {534,1,0b01001},   {535,0,0b00111},   {536,0,0b10111},   {537,1,0b11111},   {538,1,0b11001},   {539,0,0b00001},   {540,1,0b01101},   {542,1,0b11001},   {544,1,0b00011},   {545,0,0b00111},   {546,1,0b10111},   {548,0,0b00101},   {549,0,0b10101},   {550,1,0b11011},   {551,1,0b01101},   {553,0,0b01011},   {554,0,0b10001},   {555,1,0b11011},   {556,0,0b01111},   {557,1,0b11111},   {558,0,0b00011},   {559,0,0b01101},   {560,0,0b10011},   {561,1,0b10011},   {562,0,0b00001},   {563,1,0b11111},   {564,1,0b11001},   {565,1,0b01001},   {569,1,0b10101},   {570,0,0b10011},   {571,1,0b11001},   {572,1,0b10011},   {573,1,0b01011},   {574,1,0b01111},   {576,0,0b00011},   {577,0,0b01101},   {578,1,0b11111},   {579,0,0b00111},   {580,1,0b01001},   {581,1,0b01001},   {582,1,0b11001},   {583,1,0b10001},   {584,1,0b10011},   {586,0,0b01001},   {587,1,0b10101},   {588,0,0b10111},   {589,1,0b11111},   {590,1,0b10111},   {591,0,0b00001},   {592,0,0b00001},   {593,1,0b01011},   {594,1,0b01001},   {595,0,0b00011},   {596,1,0b10001},   {597,0,0b11101},   {598,1,0b11111},   {599,1,0b11111},   {600,1,0b11101},   {601,1,0b10111},   {602,1,0b01011},   {603,0,0b11101},   {604,1,0b11111},   {605,1,0b01011},   {606,1,0b11011},   {607,1,0b01011},   {608,0,0b10111},   {609,1,0b11011},   {610,0,0b01101},   {611,1,0b01111},   {612,1,0b01001},   {613,0,0b01111},   {614,1,0b10111},   {615,0,0b10011},   {616,0,0b10111},   {617,1,0b11001},   {618,1,0b01111},   {619,0,0b10011},   {620,1,0b10011},   {621,0,0b00101},   {622,1,0b01111},   {625,1,0b00011},   {626,0,0b00001},   {627,1,0b11011},   {629,1,0b11111},   {630,1,0b00101},   {633,0,0b01011},   {634,1,0b01101},   {635,0,0b01111},   {636,1,0b10101},   {637,1,0b10111},   {638,0,0b10101},   {639,0,0b11011},   {640,1,0b11011},   {641,1,0b00111},   {642,0,0b01111},   {643,1,0b01111},   {644,0,0b00011},   {645,0,0b00011},   {646,0,0b01111},   {647,0,0b10011},   {648,1,0b11011},   {649,1,0b01111},   {650,1,0b01111},   {651,1,0b00111},   {652,0,0b00001},   {653,1,0b00011},   {654,1,0b10011},   {655,0,0b11011},   {656,1,0b11101},   {657,0,0b00001},   {658,1,0b00011},   {659,1,0b00101},   {660,1,0b01011},   {661,1,0b00101},   {662,0,0b00011},   {663,1,0b01001},   {664,0,0b01101},   {665,1,0b11011},   {666,0,0b10001},   {667,1,0b10011},   {668,1,0b11101},   {670,1,0b11111},   {671,1,0b11001},   {673,0,0b10001},   {674,1,0b11011},   {675,0,0b00111},   {676,1,0b11001},   {677,0,0b00101},   {678,0,0b00101},   {679,1,0b01101},   {680,1,0b00011},   {681,1,0b10001},   {682,0,0b01111},   {683,1,0b01111},   {684,1,0b00001},   {686,1,0b10001},   {691,0,0b10001},   {692,1,0b11001},   {694,1,0b11001},   {696,0,0b10001},   {697,0,0b10001},   {698,1,0b10111},   {699,1,0b11011},   {700,1,0b11111},   {701,1,0b11111},   {703,1,0b00001},   {706,0,0b00111},   {707,0,0b01111},   {708,1,0b10111},   {712,0,0b00101},   {713,1,0b01101},   {714,1,0b01101},   {715,1,0b00011},   {718,0,0b10011},   {719,0,0b11011},   {720,1,0b11111},   {721,1,0b00001},   {722,0,0b00001},   {723,0,0b10011},   {724,1,0b11011},   {725,1,0b01001},   {726,0,0b00001},   {727,1,0b00011},   {728,1,0b10111},   {731,1,0b00101},   {732,1,0b11101},   {734,1,0b01111},   {735,0,0b10011},   {736,1,0b10111},   {738,0,0b00101},   {739,0,0b01101},   {740,1,0b10011},   {741,0,0b01101},   {742,1,0b01111},   {743,0,0b00101},   {744,1,0b01111},   {745,0,0b10101},   {746,1,0b10111},   {747,0,0b00111},   {748,1,0b10011},   {749,0,0b00011},   {750,1,0b10001},   {751,0,0b00011},   {752,1,0b10001},   {753,1,0b01111},   {754,1,0b11001},   {756,1,0b01101},   {760,0,0b00001},   {761,0,0b01001},   {762,0,0b11111},   {763,1,0b11111},   {764,0,0b01101},   {765,1,0b10101},   {766,1,0b01011},   {767,0,0b00111},   {768,0,0b01101},   {769,1,0b11011},   {770,1,0b00001},   {771,0,0b01011},   {772,0,0b01111},   {773,1,0b11001},   {774,0,0b00111},   {775,0,0b01011},   {776,0,0b11011},   {777,1,0b11011},   {778,0,0b01011},   {779,1,0b01011},   {780,0,0b01101},   {781,0,0b10001},   {782,1,0b11001},   {783,1,0b00101},   {784,1,0b10011},   {785,0,0b01101},   {786,1,0b11111},   {787,0,0b00111},   {788,0,0b01011},   {789,1,0b11001},   {790,1,0b11111},   {791,1,0b10111},   {792,0,0b00011},   {793,1,0b11011},   {794,0,0b11001},   {795,1,0b11011},   {796,0,0b00101},   {797,0,0b00101},   {798,1,0b11111},   {799,0,0b01011},   {800,1,0b10111},   {801,1,0b01101},   {802,1,0b01001},   {803,0,0b01001},   {804,1,0b10011},   {805,1,0b11001},   {806,0,0b10111},   {807,1,0b11011},   {808,0,0b10101},   {809,1,0b11101},   {810,1,0b11101},   {811,0,0b00111},   {812,0,0b01011},   {813,1,0b10001},   {814,0,0b00001},   {815,0,0b00011},   {816,1,0b00011},   {817,1,0b10111},   {818,1,0b00111},   {819,0,0b01001},   {820,1,0b01011},   {821,0,0b00011},   {822,1,0b10011},   {823,0,0b01001},   {824,0,0b11001},   {825,1,0b11001},   {826,1,0b10111},   {827,1,0b01011},   {828,0,0b00011},   {829,1,0b10001},   {830,0,0b00101},   {831,1,0b11001},   {832,1,0b10011},   {833,1,0b10111},   {834,0,0b00001},   {835,0,0b01001},   {836,1,0b11011},   {837,0,0b00101},   {838,0,0b01011},   {839,1,0b10001},   {840,0,0b01111},   {841,1,0b11001},   {842,1,0b00101},   {843,1,0b10011},   {844,1,0b11001},   {845,1,0b10011},   {846,1,0b10011},   {847,1,0b01111},   {848,1,0b01101},   {849,1,0b10101},   {850,0,0b00011},   {851,0,0b00111},   {852,1,0b10001},   {853,1,0b00101},   {854,0,0b00001},   {855,0,0b01101},   {856,1,0b10111},   {857,1,0b11001},   {858,0,0b11001},   {859,1,0b11011},   {860,1,0b10111},   {861,1,0b10011},   {862,1,0b00001},   {863,0,0b00111},   {864,1,0b11001},   {865,0,0b00011},   {866,1,0b10111},   {867,0,0b01101},   {868,1,0b10001},   {869,1,0b01001},   {870,0,0b10111},   {871,1,0b10111},   {872,1,0b10001},   {873,1,0b00011},   {874,1,0b01011},   {875,1,0b01101},   {876,0,0b00011},   {877,1,0b11111},   {878,1,0b11101},   {879,1,0b10111},   {880,1,0b00101},   {881,0,0b01001},   {882,1,0b11101},   {883,1,0b00111},   {884,0,0b10011},   {885,1,0b11101},   {886,0,0b00111},   {887,1,0b10101},   {888,0,0b00011},   {889,1,0b01111},   {890,0,0b01001},   {891,1,0b01111},   {892,0,0b00011},   {893,1,0b10011},   {894,0,0b01011},   {895,1,0b11001},   {896,0,0b00001},   {897,1,0b00101},   {898,1,0b01011},   {899,0,0b00011},   {900,0,0b00011},   {901,1,0b01111},   {902,0,0b01011},   {903,1,0b01101},   {904,0,0b00001},   {905,1,0b10011},   {906,0,0b00001},   {907,0,0b00001},   {908,0,0b00111},   {909,0,0b10011},   {910,0,0b11001},   {911,1,0b11001},   {912,1,0b10001},   {913,1,0b10111},   {914,0,0b00001},   {915,0,0b00011},   {916,1,0b11011},   {917,1,0b11101},   {918,0,0b00011},   {919,0,0b10001},   {920,1,0b10111},   {921,0,0b01001},   {922,0,0b10011},   {923,1,0b10111},   {924,0,0b00111},   {925,1,0b11101},   {926,1,0b00111},   {927,0,0b00001},   {928,1,0b00011},   {929,0,0b00011},   {930,1,0b11011},   {931,0,0b00001},   {932,0,0b01011},   {933,1,0b01011},   {934,0,0b00001},   {935,0,0b00111},   {936,0,0b01011},   {937,0,0b11101},   {938,1,0b11111},   {939,1,0b11101},   {940,0,0b00101},   {941,1,0b00111},   {942,1,0b00111},   {943,0,0b11001},   {944,1,0b11111},   {945,0,0b00111},   {946,1,0b11101},   {947,1,0b10101},   {948,1,0b11011},   {949,0,0b00101},   {950,1,0b11011},   {951,1,0b01001},   {952,1,0b00001},   {953,1,0b11011},   {954,1,0b11101},   {955,0,0b00001},   {956,1,0b00001},   {957,0,0b00101},   {958,0,0b00101},   {959,1,0b01111},   {960,1,0b00111},   {961,1,0b11101},   {962,0,0b11011},   {963,1,0b11111},   {964,0,0b00001},   {965,1,0b01101},   {966,0,0b00101},   {967,0,0b00111},   {968,1,0b10101},   {969,1,0b11001},   {970,0,0b00001},   {971,1,0b01011},   {972,0,0b00011},   {973,0,0b01011},   {974,1,0b10001},   {975,0,0b01111},   {976,0,0b10011},   {977,1,0b11011},   {978,0,0b01101},   {979,1,0b11101},   {980,0,0b10001},   {981,1,0b11101},   {982,0,0b01111},   {983,1,0b01111},   {984,0,0b01001},   {985,0,0b01001},   {986,0,0b01101},   {987,1,0b11111},   {988,1,0b10111},   {989,1,0b00111},   {990,0,0b00101},   {991,1,0b01101},   {992,0,0b01001},   {993,0,0b10101},   {994,1,0b11001},   {995,1,0b00101},   {996,1,0b00101},   {997,0,0b01011},   {998,0,0b01011},   {999,1,0b01011},   {1000,1,0b10111},   {1001,0,0b01001},   {1002,1,0b01111},   {1003,0,0b00001},   {1004,0,0b01001},   {1005,0,0b01001},   {1006,0,0b01011},   {1007,1,0b11011},   {1008,1,0b10101},   {1009,1,0b11111},   {1010,0,0b01001},   {1011,1,0b01101},   {1012,0,0b00001},   {1013,1,0b11101},   {1014,1,0b00001},   {1015,1,0b10111},   {1016,1,0b00001},   {1017,1,0b11011},   {1018,1,0b10011},   {1019,0,0b00001},   {1020,1,0b11101},   {1021,0,0b01001},   {1022,1,0b10101},   {1023,0,0b11001},   {1024,1,0b11101},   {1025,0,0b00001},   {1026,1,0b01011},   {1027,0,0b01111},   {1028,1,0b10101},   {1029,1,0b01001},   {1030,1,0b01101},   {1031,0,0b01111},   {1032,0,0b11011},   {1033,0,0b11101},   {1034,1,0b11111},   {1035,0,0b00001},   {1036,0,0b00011},   {1037,1,0b01111},   {1038,0,0b11001},   {1039,1,0b11111},   {1040,1,0b00111},   {1041,0,0b00001},   {1042,1,0b00011},   {1043,0,0b01011},   {1044,0,0b10011},   {1045,1,0b11101},   {1046,1,0b11011},   {1047,1,0b01001},   {1048,1,0b00101},   {1049,1,0b11001},   {1050,1,0b01011},   {1051,1,0b01111},   {1052,1,0b10101},   {1056,1,0b11011},   {1057,0,0b01011},   {1058,0,0b01101},   {1059,1,0b11011},   {1061,0,0b00111},   {1062,0,0b11011},   {1063,1,0b11101},   {1064,0,0b00101},   {1065,1,0b00101},   {1066,0,0b00101},   {1067,1,0b11001},   {1068,0,0b00011},   {1069,1,0b01101},   {1070,0,0b01101},   {1071,1,0b11011},   {1073,0,0b00101},   {1074,0,0b10001},   {1075,1,0b11001},   {1076,1,0b00011}};
-                    const uint8_t *res_key;
-                    uint32_t res_size, dummy;
-                    typename Diva<O>::InfixStore *store;
-                    wh_int_iter_peek_ref(it, reinterpret_cast<const void **>(&res_key), &res_size,
-                                         reinterpret_cast<void **>(&store), &dummy);
+        const uint64_t buf_size = s.Size() + 20;
+        char *buf = new char[buf_size];
+        memset(buf, 0, buf_size);
+        REQUIRE_EQ(s.Serialize(buf), s.Size());
+        Diva<O, T> reconstructed_s(buf);
+        AssertDivas(s, reconstructed_s);
+        delete[] buf;
 
-                    REQUIRE_EQ(memcmp(expected_boundary, res_key, sizeof(keys[0])), 0);
-                    REQUIRE_FALSE(store->IsPartialKey());
+        // Enough inserts to split stores, then enough deletes to merge them
+        for (int32_t i = 0; i < n_inserts; i++) {
+            keys.push_back(rng());
+            s.Insert(keys.back());
+        }
+        std::vector<uint64_t> remaining_keys;
+        for (int32_t i = 0; i < keys.size(); i++) {
+            if (i % 3 == 0)
+                s.Delete(keys[i]);
+            else
+                remaining_keys.push_back(keys[i]);
+        }
+        for (const uint64_t key : remaining_keys) {
+            REQUIRE(s.PointQuery(key));
+            REQUIRE(s.RangeQuery(key, key + 1));
+        }
+
+        uint32_t false_positives = 0;
+        for (int32_t i = 0; i < n_queries; i++)
+            false_positives += s.PointQuery(rng());
+        REQUIRE_LE(false_positives, n_queries >> (infix_size - 4));
+    }
+
+
+    template <bool O>
+    static void StoreTargetSizes() {
+        StoreTargetSize<O, 512>();
+        StoreTargetSize<O, 2048>();
+        StoreTargetSize<O, 4096>();
+    }
+
+
+    template <bool O, class t_int>
+    static void IntKeyWidth() {
+        const uint32_t infix_size = 8;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_inserts = 50000;
+        const uint32_t n_queries = 100000;
+
+        // Few distinct upper halves of 16-byte keys, so that boundary keys share
+        // more than 64 bits, and no 4-byte key close enough to the top of the
+        // domain for the ranges below to wrap
+        std::mt19937_64 rng(seed);
+        auto random_key = [&rng]() -> t_int {
+            if constexpr (sizeof(t_int) == 16)
+                return (static_cast<t_int>(rng() % 16) << 64) | rng();
+            else
+                return rng() >> 33;
+        };
+        constexpr uint32_t half_bits = 4 * sizeof(t_int);
+        std::vector<t_int> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(random_key());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<t_int> conv_keys(keys);
+        if constexpr (!O) {
+            for (int32_t i = 0; i < conv_keys.size(); i++)
+                conv_keys[i] = to_big_endian_order(conv_keys[i]);
+        }
+        Diva<O, 1024, t_int> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(t_int), seed, load_factor);
+        for (const t_int key : keys)
+            REQUIRE(s.PointQuery(key));
+
+        for (int32_t i = 0; i < n_inserts; i++) {
+            keys.push_back(random_key());
+            s.Insert(keys.back());
+        }
+        std::vector<t_int> remaining_keys;
+        for (int32_t i = 0; i < keys.size(); i++) {
+            if (i % 3 == 0)
+                s.Delete(keys[i]);
+            else
+                remaining_keys.push_back(keys[i]);
+        }
+        for (const t_int key : remaining_keys) {
+            REQUIRE(s.PointQuery(key));
+            REQUIRE(s.RangeQuery(key, key + 1));
+            REQUIRE(s.RangeQuery(key >> half_bits << half_bits, key));
+        }
+
+        uint32_t false_positives = 0;
+        std::vector<t_int> queries;
+        for (int32_t i = 0; i < n_queries; i++) {
+            queries.push_back(random_key());
+            false_positives += s.PointQuery(queries.back());
+        }
+        REQUIRE_LE(false_positives, n_queries >> (infix_size - 4));
+
+        const uint64_t buf_size = s.Size() + 20;
+        char *buf = new char[buf_size];
+        memset(buf, 0, buf_size);
+        REQUIRE_EQ(s.Serialize(buf), s.Size());
+        Diva<O, 1024, t_int> reconstructed_s(buf);
+        for (const t_int key : remaining_keys)
+            REQUIRE(reconstructed_s.PointQuery(key));
+        for (const t_int key : queries) {
+            REQUIRE_EQ(reconstructed_s.PointQuery(key), s.PointQuery(key));
+            REQUIRE_EQ(reconstructed_s.RangeQuery(key, key + 1000), s.RangeQuery(key, key + 1000));
+        }
+        delete[] buf;
+    }
+
+
+    template <bool O>
+    static void IntKeyWidths() {
+        IntKeyWidth<O, uint32_t>();
+        IntKeyWidth<O, unsigned __int128>();
+    }
+
+
+    template <bool O>
+    static void SingleThreadPolicy() {
+        const uint32_t infix_size = 8;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_inserts = 100000;
+        const uint32_t n_queries = 100000;
+
+        // The same operations on a concurrent and a single-threaded instance
+        // leave the same filter behind
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<uint64_t> conv_keys(keys);
+        if constexpr (!O) {
+            for (int32_t i = 0; i < conv_keys.size(); i++)
+                conv_keys[i] = to_big_endian_order(conv_keys[i]);
+        }
+        Diva<O> c(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+        Diva<O, 1024, uint64_t, ThreadPolicy::Single> s(infix_size, conv_keys.begin(), conv_keys.end(),
+                                                        sizeof(uint64_t), seed, load_factor);
+
+        for (int32_t i = 0; i < n_inserts; i++) {
+            keys.push_back(rng());
+            c.Insert(keys.back());
+            s.Insert(keys.back());
+        }
+        std::vector<uint64_t> remaining_keys;
+        for (int32_t i = 0; i < keys.size(); i++) {
+            if (i % 3 == 0) {
+                c.Delete(keys[i]);
+                s.Delete(keys[i]);
+            }
+            else
+                remaining_keys.push_back(keys[i]);
+        }
+        for (const uint64_t key : remaining_keys) {
+            REQUIRE(s.PointQuery(key));
+            REQUIRE(s.RangeQuery(key, key + 1));
+        }
+
+        std::vector<uint64_t> queries;
+        for (int32_t i = 0; i < n_queries; i++) {
+            queries.push_back(rng());
+            REQUIRE_EQ(s.PointQuery(queries.back()), c.PointQuery(queries.back()));
+            REQUIRE_EQ(s.RangeQuery(queries.back(), queries.back() + (1ULL << 40)),
+                       c.RangeQuery(queries.back(), queries.back() + (1ULL << 40)));
+        }
+        std::sort(queries.begin(), queries.end());
+        bool *c_res = new bool[n_queries], *s_res = new bool[n_queries];
+        c.PointQuerySorted(queries.begin(), queries.end(), c_res);
+        s.PointQuerySorted(queries.begin(), queries.end(), s_res);
+        REQUIRE_EQ(memcmp(c_res, s_res, n_queries), 0);
+
+        c.ShrinkInfixSize(infix_size - 2);
+        s.ShrinkInfixSize(infix_size - 2);
+        REQUIRE_EQ(s.Size(), c.Size());
+        char *c_buf = new char[c.Size()];
+        char *s_buf = new char[s.Size()];
+        REQUIRE_EQ(c.Serialize(c_buf), c.Size());
+        REQUIRE_EQ(s.Serialize(s_buf), s.Size());
+        REQUIRE_EQ(memcmp(c_buf, s_buf, s.Size()), 0);
+
+        Diva<O, 1024, uint64_t, ThreadPolicy::Single> reconstructed_s(c_buf);
+        reconstructed_s.PointQuerySorted(queries.begin(), queries.end(), s_res);
+        c.PointQuerySorted(queries.begin(), queries.end(), c_res);
+        REQUIRE_EQ(memcmp(c_res, s_res, n_queries), 0);
+        delete[] c_buf;
+        delete[] s_buf;
+        delete[] c_res;
+        delete[] s_res;
+    }
+
+
+    template <bool O, template <class> class t_index>
+    static void BoundaryIndex() {
+        const uint32_t infix_size = 8;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_inserts = 100000;
+        const uint32_t n_queries = 100000;
+        using IndexedDiva = Diva<O, 1024, uint64_t, ThreadPolicy::Concurrent, t_index>;
+
+        // The same operations on a wormhole-backed instance and one on the
+        // given boundary index leave the same filter behind
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<uint64_t> conv_keys(keys);
+        if constexpr (!O) {
+            for (int32_t i = 0; i < conv_keys.size(); i++)
+                conv_keys[i] = to_big_endian_order(conv_keys[i]);
+        }
+        Diva<O> w(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+        IndexedDiva s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+
+        for (int32_t i = 0; i < n_inserts; i++) {
+            keys.push_back(rng());
+            w.Insert(keys.back());
+            s.Insert(keys.back());
+        }
+        std::vector<uint64_t> remaining_keys;
+        for (int32_t i = 0; i < keys.size(); i++) {
+            if (i % 3 == 0) {
+                w.Delete(keys[i]);
+                s.Delete(keys[i]);
+            }
+            else
+                remaining_keys.push_back(keys[i]);
+        }
+        for (const uint64_t key : remaining_keys) {
+            REQUIRE(s.PointQuery(key));
+            REQUIRE(s.RangeQuery(key, key + 1));
+        }
+
+        std::vector<uint64_t> queries;
+        for (int32_t i = 0; i < n_queries; i++) {
+            queries.push_back(rng());
+            REQUIRE_EQ(s.PointQuery(queries.back()), w.PointQuery(queries.back()));
+            REQUIRE_EQ(s.RangeQuery(queries.back(), queries.back() + (1ULL << 40)),
+                       w.RangeQuery(queries.back(), queries.back() + (1ULL << 40)));
+        }
+        std::sort(queries.begin(), queries.end());
+        bool *w_res = new bool[n_queries], *s_res = new bool[n_queries];
+        w.PointQuerySorted(queries.begin(), queries.end(), w_res);
+        s.PointQuerySorted(queries.begin(), queries.end(), s_res);
+        REQUIRE_EQ(memcmp(w_res, s_res, n_queries), 0);
+
+        w.ShrinkInfixSize(infix_size - 2);
+        s.ShrinkInfixSize(infix_size - 2);
+        REQUIRE_EQ(s.Size(), w.Size());
+        char *w_buf = new char[w.Size()];
+        char *s_buf = new char[s.Size()];
+        REQUIRE_EQ(w.Serialize(w_buf), w.Size());
+        REQUIRE_EQ(s.Serialize(s_buf), s.Size());
+        REQUIRE_EQ(memcmp(w_buf, s_buf, s.Size()), 0);
+
+        IndexedDiva reconstructed_s(w_buf);
+        reconstructed_s.PointQuerySorted(queries.begin(), queries.end(), s_res);
+        w.PointQuerySorted(queries.begin(), queries.end(), w_res);
+        REQUIRE_EQ(memcmp(w_res, s_res, n_queries), 0);
+        delete[] w_buf;
+        delete[] s_buf;
+        delete[] w_res;
+        delete[] s_res;
+    }
+
+
+    template <bool O>
+    static void BoundaryIndexes() {
+        BoundaryIndex<O, SortedArrayIndex>();
+        BoundaryIndex<O, BTreeIndex>();
+    }
+
+
+    template <bool O>
+    static void Freeze() {
+        const uint32_t infix_size = 8;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_inserts = 50000;
+        const uint32_t n_queries = 50000;
+
+        // A frozen instance answers like a live one that went through the same
+        // operations, also once serialized, and keeps doing so after thawing
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        std::vector<uint64_t> conv_keys(keys);
+        if constexpr (!O) {
+            for (int32_t i = 0; i < conv_keys.size(); i++)
+                conv_keys[i] = to_big_endian_order(conv_keys[i]);
+        }
+        Diva<O> w(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+        Diva<O> s(infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t), seed, load_factor);
+        for (int32_t i = 0; i < n_inserts; i++) {
+            keys.push_back(rng());
+            w.Insert(keys.back());
+            s.Insert(keys.back());
+        }
+        std::vector<uint64_t> remaining_keys;
+        for (int32_t i = 0; i < keys.size(); i++) {
+            if (i % 3 == 0) {
+                w.Delete(keys[i]);
+                s.Delete(keys[i]);
+            }
+            else
+                remaining_keys.push_back(keys[i]);
+        }
+
+        std::vector<uint64_t> queries;
+        std::vector<std::pair<uint64_t, uint64_t>> range_queries;
+        for (int32_t i = 0; i < n_queries; i++) {
+            queries.push_back(rng());
+            range_queries.emplace_back(queries.back(), queries.back() + std::min<uint64_t>(1ULL << (i % 48), ~queries.back()));
+        }
+        std::sort(queries.begin(), queries.end());
+        bool *w_res = new bool[n_queries], *s_res = new bool[n_queries];
+        auto assert_same = [&](const Diva<O> &frozen) {
+            for (const uint64_t key : remaining_keys)
+                REQUIRE(frozen.PointQuery(key));
+            for (const auto [l, r] : range_queries) {
+                REQUIRE_EQ(frozen.PointQuery(l), w.PointQuery(l));
+                REQUIRE_EQ(frozen.RangeQuery(l, r), w.RangeQuery(l, r));
+            }
+            w.PointQuerySorted(queries.begin(), queries.end(), w_res);
+            frozen.PointQuerySorted(queries.begin(), queries.end(), s_res);
+            REQUIRE_EQ(memcmp(w_res, s_res, n_queries), 0);
+            w.RangeQueryBatch(range_queries.begin(), range_queries.end(), w_res);
+            frozen.RangeQueryBatch(range_queries.begin(), range_queries.end(), s_res);
+            REQUIRE_EQ(memcmp(w_res, s_res, n_queries), 0);
+        };
+
+        s.Freeze();
+        REQUIRE(s.IsFrozen());
+        REQUIRE_LT(s.Size(), w.Size());
+        REQUIRE_EQ(s.AllocatorStats().reserved_bytes, 0);
+        assert_same(s);
+
+        const uint64_t buf_size = s.Size();
+        char *buf = new char[buf_size];
+        REQUIRE_EQ(s.Serialize(buf), buf_size);
+        Diva<O> reconstructed_s(buf);
+        REQUIRE(reconstructed_s.IsFrozen());
+        assert_same(reconstructed_s);
+
+        char file_path[] = "/tmp/diva_frozen_XXXXXX";
+        const int fd = mkstemp(file_path);
+        REQUIRE_NE(fd, -1);
+        unlink(file_path);
+        REQUIRE_EQ(write(fd, buf, buf_size), buf_size);
+        delete[] buf;
+        Diva<O> mapped_s(fd);
+        close(fd);
+        REQUIRE(mapped_s.IsFrozen());
+        assert_same(mapped_s);
+
+        s.Thaw();
+        mapped_s.Thaw();
+        REQUIRE_FALSE(s.IsFrozen());
+        assert_same(s);
+        for (int32_t i = 0; i < n_inserts; i++) {
+            keys.push_back(rng());
+            remaining_keys.push_back(keys.back());
+            w.Insert(keys.back());
+            s.Insert(keys.back());
+            mapped_s.Insert(keys.back());
+        }
+        for (int32_t i = 0; i < n_inserts; i += 2) {
+            w.Delete(remaining_keys[i]);
+            s.Delete(remaining_keys[i]);
+            mapped_s.Delete(remaining_keys[i]);
+        }
+        remaining_keys.erase(remaining_keys.begin(), remaining_keys.begin() + n_inserts);
+        assert_same(s);
+        // Deserialized instances reseed the splits, so only their true positives match
+        for (const uint64_t key : remaining_keys)
+            REQUIRE(mapped_s.PointQuery(key));
+        delete[] w_res;
+        delete[] s_res;
+    }
+
+
+    template <bool O>
+    static void ShortestSeparators() {
+        const uint32_t infix_size = 8;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_inserts = 50000;
+        const uint32_t n_queries = 100000;
+
+        if constexpr (O) {
+            // Integer boundary keys are kept inline, so there is nothing to cut
+            Diva<O> s(infix_size, seed, load_factor, true);
+            REQUIRE_FALSE(s.shortest_separators_);
+            return;
+        }
+
+        // URL-like keys with a binary identifier, whose shared prefixes and
+        // suffixes make whole boundary keys much longer than what tells
+        // adjacent stores apart
+        std::mt19937_64 rng(seed);
+        auto random_key = [&rng]() -> std::string {
+            const uint64_t host = rng() % 4, id = rng();
+            return "https://www.host-" + std::to_string(host) + ".com/items/"
+                   + std::string(reinterpret_cast<const char *>(&id), sizeof(id)) + "/details.html";
+        };
+        std::vector<std::string> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(random_key());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        Diva<O> s(infix_size, keys.begin(), keys.end(), seed, load_factor, 1, true);
+        Diva<O> whole_s(infix_size, keys.begin(), keys.end(), seed, load_factor);
+        REQUIRE(s.shortest_separators_);
+        REQUIRE_LT(s.Size(), whole_s.Size());
+        for (const std::string &key : keys) {
+            REQUIRE(s.PointQuery(key));
+            REQUIRE(s.RangeQuery(key, key));
+        }
+        // Keys under a cut boundary key also match the infix of the key it was cut from
+        uint32_t false_positives = 0, whole_false_positives = 0;
+        for (int32_t i = 0; i < n_queries; i++) {
+            const std::string key = random_key();
+            false_positives += s.PointQuery(key);
+            whole_false_positives += whole_s.PointQuery(key);
+        }
+        REQUIRE_LE(false_positives, whole_false_positives + (n_queries >> 10));
+
+        SUBCASE("bulk loading paths") {
+            for (uint32_t thread_count : {2, 3, 64}) {
+                Diva<O> parallel_s(infix_size, keys.begin(), keys.end(), seed, load_factor, thread_count, true);
+                AssertDivas(s, parallel_s);
+            }
+            // Streaming puts in sentinels as long as the longest key, so only
+            // the answers are compared
+            Diva<O> streamed_s(infix_size, seed, load_factor, true);
+            for (const std::string &key : keys)
+                streamed_s.BulkLoadStreaming(key);
+            streamed_s.BulkLoadStreamingFinish();
+            for (const std::string &key : keys)
+                REQUIRE(streamed_s.PointQuery(key));
+            for (int32_t i = 0; i < n_queries; i++) {
+                const std::string key = random_key();
+                REQUIRE_EQ(streamed_s.PointQuery(key), s.PointQuery(key));
+            }
+        }
+
+        SUBCASE("updates and queries") {
+            for (int32_t i = 0; i < n_inserts; i++) {
+                keys.push_back(random_key());
+                s.Insert(keys.back());
+            }
+            std::vector<std::string> remaining_keys;
+            for (int32_t i = 0; i < keys.size(); i++) {
+                if (i % 3 == 0)
+                    s.Delete(keys[i]);
+                else
+                    remaining_keys.push_back(keys[i]);
+            }
+            for (const std::string &key : remaining_keys) {
+                REQUIRE(s.PointQuery(key));
+                REQUIRE(s.RangeQuery(key, key + "0"));
+                REQUIRE(s.RangeQuery(key.substr(0, key.size() - 4), key));
+            }
+
+            false_positives = 0;
+            std::vector<std::string> queries;
+            for (int32_t i = 0; i < n_queries; i++) {
+                queries.push_back(random_key());
+                false_positives += s.PointQuery(queries.back());
+            }
+            REQUIRE_LE(false_positives, n_queries >> (infix_size - 5));
+
+            const uint64_t buf_size = s.Size() + 20;
+            char *buf = new char[buf_size];
+            memset(buf, 0, buf_size);
+            REQUIRE_EQ(s.Serialize(buf), s.Size());
+            Diva<O> reconstructed_s(buf);
+            AssertDivas(s, reconstructed_s);
+            for (const std::string &key : queries)
+                REQUIRE_EQ(reconstructed_s.PointQuery(key), s.PointQuery(key));
+            for (int32_t i = 0; i < n_inserts; i++) {
+                remaining_keys.push_back(random_key());
+                reconstructed_s.Insert(remaining_keys.back());
+            }
+            for (const std::string &key : remaining_keys)
+                REQUIRE(reconstructed_s.PointQuery(key));
+            delete[] buf;
+        }
+    }
+
+
+    template <bool O>
+    static void BulkLoad() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 2600;
+
+        const uint32_t rng_seed = 2;
+        std::mt19937_64 rng(rng_seed);
+        SUBCASE("fixed length") {
+            std::vector<uint64_t> keys;
+            for (int32_t i = 0; i < n_keys; i++)
+                keys.push_back(rng());
+            std::sort(keys.begin(), keys.end());
+            if constexpr (!O) {
+                for (int32_t i = 0; i < n_keys; i++)
+                    keys[i] = to_big_endian_order(keys[i]);
+            }
+
+            Diva<O> s(infix_size, keys.begin(), keys.end(), sizeof(uint64_t), seed, load_factor);
+
+            if constexpr (O) {
+                wormhole_int_iter *it = wh_int_iter_create(s.better_tree_int_);
+                wh_int_iter_seek(it, nullptr, 0);
+                {
+                    const uint8_t expected_boundary[] = {0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000};
+                    const std::vector<uint32_t> occupieds_pos = {};
+                    const std::vector<std::tuple<uint32_t, bool, uint64_t>> checks = {};
+
+                    const uint8_t *res_key;
+                    uint32_t res_size, dummy;
+                    typename Diva<O>::InfixStore *store;
+                    wh_int_iter_peek_ref(it, reinterpret_cast<const void **>(&res_key), &res_size,
+                                         reinterpret_cast<void **>(&store), &dummy);
+
+                    REQUIRE_EQ(memcmp(expected_boundary, res_key, sizeof(keys[0])), 0);
+                    REQUIRE_FALSE(store->IsPartialKey());
+                    REQUIRE_EQ(store->GetInvalidBits(), 0);
+                    AssertStoreContents(s, *store, occupieds_pos, checks);
+                }
+
+                wh_int_iter_skip1(it);
+                {
+                    const uint8_t expected_boundary[] = {0b00000000, 0b00010000, 0b00001100, 0b00111101, 0b11110111, 0b11101011, 0b00011100, 0b10100010};
+                    const std::vector<uint32_t> occupieds_pos = {1, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 14, 15, 16, 17, 20, 22, 23, 25, 27, 28, 29, 32, 34, 35, 36, 37, 38, 39, 40, 41, 42, 44, 45, 46, 47, 49, 51, 52, 54, 55, 56, 57, 59, 60, 61, 63, 64, 70, 71, 72, 73, 74, 75, 78, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 92, 94, 95, 98, 99, 100, 101, 102, 103, 104, 107, 108, 111, 113, 114, 115, 116, 117, 118, 120, 121, 122, 123, 125, 126, 127, 131, 132, 133, 134, 135, 137, 138, 139, 141, 144, 145, 146, 147, 148, 149, 151, 152, 153, 154, 155, 157, 159, 160, 162, 164, 165, 167, 168, 170, 174, 175, 176, 177, 179, 180, 181, 182, 184, 185, 186, 187, 189, 190, 192, 196, 197, 199, 201, 202, 203, 204, 205, 206, 207, 208, 210, 212, 213, 214, 216, 218, 220, 221, 222, 223, 225, 226, 228, 229, 230, 231, 234, 235, 237, 238, 239, 241, 242, 243, 244, 246, 248, 249, 250, 251, 253, 254, 255, 256, 257, 259, 261, 262, 263, 264, 265, 267, 268, 270, 271, 272, 274, 276, 277, 278, 280, 281, 282, 283, 285, 287, 288, 289, 291, 292, 293, 294, 296, 297, 298, 301, 302, 303, 304, 305, 308, 309, 310, 311, 313, 314, 315, 320, 321, 322, 323, 325, 326, 327, 328, 331, 332, 334, 335, 336, 338, 339, 340, 341, 342, 344, 345, 346, 348, 349, 351, 354, 355, 356, 357, 358, 359, 360, 363, 364, 365, 366, 367, 369, 371, 372, 373, 374, 375, 376, 378, 379, 381, 382, 383, 384, 385, 386, 388, 389, 390, 391, 394, 395, 396, 397, 398, 399, 400, 402, 403, 404, 406, 408, 409, 410, 411, 414, 415, 416, 417, 419, 420, 421, 422, 424, 428, 429, 430, 432, 433, 435, 437, 438, 439, 440, 441, 443, 444, 445, 447, 448, 449, 450, 451, 452, 453, 454, 455, 456, 457, 459, 460, 461, 462, 463, 464, 466, 467, 468, 469, 470, 471, 472, 473, 474, 476, 477, 479, 480, 481, 482, 483, 484, 485, 486, 487, 488, 489, 492, 494, 495, 496, 498, 499, 500, 501, 502, 503, 504, 506, 508, 509, 510, 511, 512, 513, 514, 516, 517, 519, 520, 521, 522, 523, 524, 525, 526, 527, 528, 529, 531, 532, 535, 537, 538, 540, 541, 542, 546, 548, 549, 550, 551, 552, 553, 554, 555, 557, 558, 559, 561, 562, 564, 565, 566, 568, 570, 572, 573, 574, 575, 578, 579, 580, 584, 585, 586, 587, 588, 589, 590, 591, 594, 595, 596, 597, 598, 599, 601, 602, 603, 604, 607, 608, 612, 613, 614, 616, 617, 618, 619, 620, 621, 623, 624, 625, 628, 629, 631, 632, 633, 634, 635, 636, 637, 638, 639, 640, 641, 642, 643, 644, 645, 646, 647, 648, 649, 650, 651, 653, 655, 657, 658, 659, 660, 662, 664, 665, 666, 668, 669, 670, 672, 673, 674, 676, 677, 678, 679, 680, 681, 682, 683, 684, 685, 686, 687, 689, 690, 691, 692, 693, 694, 697, 698, 700, 701, 702, 703, 705, 706, 707, 708, 709, 710, 711, 713, 714, 715, 718, 720, 721, 722, 724, 725, 727, 728, 730, 731, 732, 733, 736, 737, 738, 744, 745, 746, 747, 748, 750, 753, 754, 755, 756, 758, 759, 761, 762, 763, 765, 767, 768, 769, 770, 771, 772, 773, 774, 775, 777, 778, 779, 780, 781, 783, 784};
+                    const std::vector<std::tuple<uint32_t, bool, uint64_t>> checks = {{  1,0,0b00001},   {  2,0,0b01101},   {  3,0,0b10011},   {  4,0,0b10101},   {  5,1,0b11111},   {  6,1,0b11011},   {  7,0,0b10101},   {  8,1,0b10111},   {  9,1,0b01101},   { 10,0,0b00011},   { 11,0,0b10101},   { 12,1,0b11101},   { 13,1,0b00011},   { 14,0,0b00001},   { 15,0,0b00001},   { 16,1,0b01101},   { 17,1,0b10011},   { 18,0,0b10101},   { 19,1,0b11011},   { 20,1,0b00011},   { 21,1,0b01011},   { 22,0,0b00111},   { 23,0,0b01011},   { 24,0,0b11011},   { 25,1,0b11111},   { 26,0,0b00101},   { 27,1,0b11101},   { 28,1,0b01001},   { 29,1,0b10001},   { 30,1,0b10011},   { 31,1,0b11011},   { 32,0,0b00001},   { 33,0,0b00111},   { 34,0,0b11011},   { 35,0,0b11011},   { 36,1,0b11101},   { 37,1,0b00101},   { 38,1,0b11111},   { 39,0,0b01001},   { 40,0,0b10011},   { 41,0,0b10011},   { 42,1,0b11111},   { 43,1,0b11101},   { 44,0,0b01101},   { 45,0,0b01101},   { 46,1,0b11101},   { 47,1,0b01101},   { 48,0,0b00011},   { 49,0,0b11001},   { 50,1,0b11011},   { 51,1,0b01001},   { 52,1,0b00111},   { 53,0,0b00011},   { 54,1,0b00111},   { 55,1,0b10011},   { 56,0,0b00001},   { 57,1,0b11001},   { 58,0,0b00001},   { 59,0,0b00001},   { 60,1,0b01001},   { 61,0,0b00101},   { 62,0,0b10011},   { 63,1,0b10111},   { 64,1,0b00011},   { 65,1,0b00111},   { 66,0,0b10001},   { 67,1,0b10001},   { 68,1,0b01101},   { 69,0,0b00001},   { 70,0,0b01101},   { 71,1,0b11011},   { 72,0,0b01101},   { 73,0,0b10111},   { 74,0,0b11001},   { 75,1,0b11101},   { 76,0,0b00111},   { 77,0,0b00111},   { 78,0,0b01011},   { 79,1,0b11011},   { 80,0,0b01001},   { 81,0,0b01101},   { 82,0,0b01101},   { 83,1,0b11111},   { 84,1,0b11111},   { 85,0,0b10011},   { 86,0,0b11001},   { 87,1,0b11001},   { 88,1,0b00101},   { 89,0,0b00001},   { 90,1,0b00111},   { 91,1,0b01011},   { 92,0,0b01011},   { 93,0,0b11011},   { 94,1,0b11011},   { 95,1,0b10111},   { 96,0,0b01001},   { 97,1,0b10111},   { 98,0,0b10011},   { 99,1,0b11011},   {100,1,0b11001},   {101,1,0b00101},   {102,1,0b11001},   {103,1,0b01101},   {104,0,0b10111},   {105,1,0b11111},   {106,1,0b11001},   {109,0,0b00101},   {110,1,0b01111},   {111,1,0b01001},   {112,0,0b11101},   {113,1,0b11101},   {114,0,0b01111},   {115,0,0b10001},   {116,1,0b11101},   {117,0,0b00101},   {118,1,0b11001},   {119,1,0b11011},   {120,1,0b00111},   {121,0,0b01011},   {122,0,0b01011},   {123,0,0b01101},   {124,1,0b11111},   {125,1,0b10101},   {126,0,0b10011},   {127,1,0b10101},   {128,1,0b11001},   {129,0,0b00011},   {130,1,0b10111},   {131,1,0b01111},   {134,1,0b01011},   {135,1,0b00111},   {137,1,0b10111},   {138,0,0b01001},   {139,1,0b01111},   {140,1,0b00101},   {141,0,0b01001},   {142,1,0b01011},   {143,0,0b01111},   {144,1,0b10011},   {146,1,0b01011},   {148,0,0b00001},   {149,0,0b10011},   {150,1,0b11001},   {152,1,0b01011},   {154,0,0b10001},   {155,0,0b10101},   {156,1,0b10101},   {157,1,0b10011},   {158,1,0b11001},   {159,0,0b10001},   {160,0,0b10101},   {161,1,0b11111},   {162,0,0b00001},   {163,0,0b00111},   {164,1,0b01011},   {165,1,0b01011},   {166,1,0b11101},   {167,0,0b00111},   {168,1,0b01011},   {169,0,0b00101},   {170,1,0b10101},   {171,1,0b11101},   {172,0,0b00101},   {173,1,0b11001},   {174,0,0b00111},   {175,1,0b11101},   {176,0,0b00111},   {177,1,0b11001},   {179,0,0b01001},   {180,1,0b11011},   {181,0,0b00011},   {182,1,0b11111},   {183,1,0b11111},   {184,0,0b10111},   {185,1,0b10111},   {186,0,0b00101},   {187,1,0b11101},   {188,0,0b10001},   {189,0,0b10101},   {190,1,0b11111},   {191,0,0b01111},   {192,0,0b10111},   {193,1,0b11111},   {194,1,0b10111},   {195,1,0b01011},   {197,0,0b01011},   {198,1,0b10101},   {199,1,0b10111},   {200,0,0b10101},   {201,1,0b11001},   {202,1,0b00101},   {203,1,0b11011},   {204,1,0b01011},   {207,0,0b00001},   {208,0,0b01011},   {209,0,0b01011},   {210,1,0b01111},   {211,1,0b11111},   {212,1,0b10111},   {213,1,0b01111},   {214,1,0b11011},   {215,0,0b01011},   {216,1,0b01101},   {218,1,0b01001},   {219,0,0b11011},   {220,0,0b11011},   {221,1,0b11111},   {222,1,0b10101},   {224,1,0b01011},   {226,1,0b11111},   {229,1,0b11001},   {230,1,0b01011},   {233,0,0b01011},   {234,1,0b10111},   {238,1,0b01111},   {239,0,0b11101},   {240,0,0b11101},   {241,0,0b11111},   {242,1,0b11111},   {243,0,0b00001},   {244,0,0b01001},   {245,1,0b10101},   {246,1,0b01111},   {247,0,0b00011},   {248,1,0b11001},   {249,0,0b00011},   {250,0,0b00101},   {251,1,0b11011},   {252,0,0b00101},   {253,1,0b01111},   {254,0,0b00001},   {255,0,0b11001},   {256,1,0b11111},   {257,0,0b00001},   {258,0,0b01011},   {259,1,0b11101},   {260,1,0b01011},   {261,0,0b01101},   {262,1,0b01111},   {263,0,0b11011},   {264,1,0b11101},   {265,1,0b00011},   {266,0,0b00011},   {267,1,0b11011},   {268,0,0b00101},   {269,1,0b10001},   {270,1,0b11101},   {271,1,0b11001},   {272,0,0b01101},   {273,1,0b11001},   {275,1,0b10101},   {277,0,0b11001},   {278,1,0b11001},   {279,1,0b10101},   {280,0,0b00011},   {281,1,0b00101},   {282,1,0b00101},   {283,0,0b10001},   {284,1,0b11111},   {285,1,0b10101},   {286,1,0b10111},   {287,0,0b00101},   {288,1,0b01101},   {290,1,0b01011},   {292,1,0b01111},   {293,1,0b00111},   {296,0,0b01011},   {297,1,0b01101},   {298,1,0b11001},   {301,0,0b00001},   {302,1,0b10101},   {303,0,0b00001},   {304,1,0b01011},   {305,1,0b11001},   {306,1,0b01011},   {308,0,0b01001},   {309,1,0b10001},   {310,1,0b01001},   {312,0,0b01011},   {313,1,0b01011},   {314,0,0b01011},   {315,0,0b01011},   {316,1,0b01111},   {317,0,0b00011},   {318,1,0b11011},   {319,1,0b10011},   {320,0,0b10001},   {321,1,0b11001},   {322,1,0b00001},   {325,0,0b01101},   {326,0,0b01101},   {327,1,0b11001},   {328,0,0b01101},   {329,1,0b10111},   {330,0,0b00001},   {331,1,0b10011},   {332,0,0b00011},   {333,1,0b10111},   {334,1,0b11101},   {335,0,0b01111},   {336,0,0b10111},   {337,1,0b11001},   {338,1,0b10011},   {339,1,0b01101},   {340,1,0b01011},   {341,1,0b11111},   {342,0,0b01001},   {343,1,0b11001},   {344,1,0b00001},   {346,0,0b10001},   {347,0,0b10111},   {348,1,0b11101},   {349,0,0b00111},   {350,1,0b10001},   {351,1,0b10001},   {352,0,0b01011},   {353,1,0b11001},   {354,1,0b00011},   {355,1,0b00111},   {357,0,0b10011},   {358,1,0b11101},   {359,1,0b00011},   {360,0,0b01111},   {361,1,0b10001},   {362,1,0b01111},   {363,1,0b10101},   {366,1,0b11111},   {367,1,0b00111},   {370,1,0b11001},   {371,1,0b11101},   {373,1,0b00011},   {375,1,0b00101},   {378,1,0b00111},   {379,1,0b11111},   {381,0,0b01001},   {382,0,0b10011},   {383,0,0b11001},   {384,1,0b11011},   {385,0,0b00111},   {386,1,0b01101},   {387,0,0b00011},   {388,0,0b00101},   {389,0,0b01101},   {390,0,0b10111},   {391,0,0b11001},   {392,1,0b11111},   {393,1,0b10111},   {394,1,0b00001},   {395,0,0b01101},   {396,1,0b01101},   {397,0,0b00001},   {398,0,0b01011},   {399,1,0b10111},   {400,1,0b11111},   {401,0,0b00101},   {402,1,0b01001},   {403,1,0b01101},   {404,0,0b10001},   {405,0,0b10011},   {406,1,0b10101},   {407,1,0b01011},   {408,1,0b10001},   {409,0,0b01011},   {410,1,0b01111},   {411,1,0b11011},   {412,0,0b00101},   {413,1,0b10001},   {414,0,0b00111},   {415,0,0b11001},   {416,0,0b11001},   {417,1,0b11101},   {418,1,0b01001},   {419,0,0b00111},   {420,1,0b11011},   {421,1,0b11101},   {422,1,0b01111},   {423,1,0b11001},   {424,0,0b00011},   {425,1,0b10111},   {426,0,0b00101},   {427,1,0b11001},   {428,0,0b10011},   {429,1,0b10111},   {430,1,0b10011},   {431,1,0b01011},   {432,0,0b01111},   {433,1,0b11111},   {438,1,0b10111},   {440,1,0b00011},   {441,1,0b10011},   {442,1,0b01111},   {445,1,0b11111},   {446,1,0b01001},   {447,0,0b00001},   {448,0,0b00001},   {449,0,0b01101},   {450,0,0b01111},   {451,0,0b10101},   {452,0,0b11101},   {453,1,0b11111},   {454,0,0b10001},   {455,1,0b11111},   {456,0,0b10001},   {457,1,0b11101},   {458,0,0b00101},   {459,1,0b01001},   {460,0,0b00101},   {461,0,0b10011},   {462,0,0b11001},   {463,0,0b11101},   {464,1,0b11101},   {465,1,0b01111},   {466,0,0b00011},   {467,1,0b10111},   {468,1,0b00001},   {469,1,0b01111},   {470,1,0b00111},   {471,1,0b10011},   {472,0,0b11001},   {473,0,0b11001},   {474,1,0b11101},   {475,1,0b10111},   {476,1,0b11111},   {477,0,0b00011},   {478,1,0b01001},   {479,0,0b00001},   {480,0,0b10101},   {481,1,0b11101},   {482,0,0b10001},   {483,1,0b10011},   {484,1,0b00001},   {485,1,0b00001},   {486,0,0b01111},   {487,1,0b01111},   {488,1,0b00111},   {489,0,0b00011},   {490,0,0b00101},   {491,0,0b01101},   {492,1,0b10001},   {493,0,0b00011},   {494,1,0b10111},   {495,0,0b01001},   {496,1,0b10101},   {497,0,0b00111},   {498,1,0b01011},   {499,0,0b00001},   {500,1,0b10001},   {501,0,0b01011},   {502,0,0b10011},   {503,1,0b11111},   {504,1,0b11011},   {505,1,0b10011},   {506,1,0b10001},   {507,0,0b00111},   {508,1,0b10001},   {509,1,0b01101},   {510,0,0b10111},   {511,1,0b11101},   {512,1,0b11101},   {513,0,0b00111},   {514,0,0b11001},   {515,1,0b11101},   {516,1,0b01011},   {517,0,0b10001},   {518,1,0b10111},   {519,0,0b00011},   {520,1,0b00111},   {521,1,0b00101},   {522,0,0b10101},   {523,1,0b11001},   {524,0,0b00101},   {525,1,0b10101},   {526,1,0b10001},   {527,0,0b01001},   {528,1,0b11111},   {529,0,0b01101},   {530,1,0b01111},   {531,1,0b11001},   {532,0,0b00101},   {533,1,0b00111},   {534,1,0b01011},   {535,0,0b00111},   {536,0,0b10001},   {537,0,0b10101},   {538,1,0b10111},   {539,0,0b00011},   {540,0,0b01001},   {541,1,0b10011},   {542,1,0b11101},   {543,0,0b01001},   {544,0,0b01001},   {545,0,0b01011},   {546,1,0b11011},   {547,0,0b01101},   {548,0,0b10101},   {549,1,0b10101},   {550,0,0b00001},   {551,0,0b00101},   {552,1,0b01111},   {553,1,0b01011},   {554,0,0b10101},   {555,1,0b11101},   {556,1,0b10011},   {557,0,0b01001},   {558,0,0b10001},   {559,1,0b10101},   {560,0,0b00101},   {561,0,0b01111},   {562,0,0b10101},   {563,0,0b10111},   {564,1,0b11101},   {565,1,0b01111},   {566,1,0b00101},   {567,0,0b00101},   {568,0,0b00111},   {569,1,0b01001},   {570,1,0b01011},   {571,1,0b01111},   {572,1,0b00101},   {573,1,0b00111},   {574,1,0b11011},   {575,0,0b00111},   {576,1,0b10101},   {577,1,0b01111},   {578,1,0b11001},   {579,1,0b00001},   {580,1,0b00001},   {581,1,0b00001},   {582,0,0b01011},   {583,1,0b11011},   {584,0,0b00011},   {585,0,0b01001},   {586,0,0b10011},   {587,1,0b11011},   {588,0,0b10001},   {589,1,0b11001},   {590,1,0b00101},   {591,1,0b10111},   {592,0,0b10011},   {593,0,0b10101},   {594,1,0b11001},   {595,0,0b10011},   {596,1,0b10101},   {597,1,0b10011},   {598,1,0b11001},   {599,0,0b00111},   {600,0,0b10101},   {601,0,0b10101},   {602,1,0b11101},   {603,0,0b10011},   {604,1,0b10011},   {605,1,0b01001},   {606,1,0b01011},   {607,1,0b00111},   {608,0,0b00001},   {609,0,0b00011},   {610,0,0b10001},   {611,1,0b11001},   {612,0,0b00001},   {613,0,0b01011},   {614,1,0b11001},   {615,1,0b00111},   {616,1,0b11001},   {617,0,0b00111},   {618,0,0b01101},   {619,0,0b10001},   {620,1,0b10001},   {621,1,0b11011},   {622,0,0b01101},   {623,1,0b11101},   {624,0,0b00011},   {625,1,0b01111},   {626,1,0b11101},   {627,0,0b00111},   {628,1,0b01001},   {629,0,0b00001},   {630,1,0b11011},   {631,0,0b00101},   {632,1,0b10111},   {633,0,0b00111},   {634,1,0b11011},   {635,1,0b11101},   {636,1,0b00011},   {637,1,0b01111},   {638,0,0b00011},   {639,0,0b01101},   {640,1,0b11011},   {641,1,0b00011},   {642,0,0b00111},   {643,0,0b01001},   {644,0,0b01011},   {645,0,0b10111},   {646,0,0b11001},   {647,1,0b11101},   {648,1,0b01011},   {649,1,0b10111},   {650,1,0b00011},   {651,0,0b00101},   {652,0,0b10111},   {653,0,0b10111},   {654,1,0b11011},   {655,0,0b01011},   {656,1,0b11011},   {657,0,0b00111},   {658,0,0b01101},   {659,0,0b10011},   {660,1,0b11111},   {661,1,0b01011},   {662,0,0b10101},   {663,1,0b11011},   {664,0,0b01011},   {665,0,0b01111},   {666,1,0b11001},   {667,1,0b11011},   {668,1,0b00111},   {669,1,0b00101},   {670,1,0b01001},   {671,1,0b01011},   {672,1,0b11101},   {673,1,0b10011},   {674,0,0b01001},   {675,1,0b11001},   {676,0,0b00101},   {677,1,0b01111},   {678,0,0b00001},   {679,1,0b10001},   {680,0,0b00101},   {681,1,0b11011},   {682,1,0b10101},   {683,0,0b01111},   {684,0,0b10111},   {685,1,0b11111},   {686,0,0b00101},   {687,0,0b01011},   {688,0,0b10011},   {689,1,0b11011},   {690,1,0b01001},   {691,0,0b00101},   {692,1,0b11001},   {693,0,0b10011},   {694,1,0b10101},   {695,1,0b10001},   {696,1,0b10111},   {697,1,0b00111},   {698,1,0b11001},   {699,1,0b00001},   {700,1,0b01101},   {701,1,0b11111},   {702,1,0b00001},   {703,0,0b00111},   {704,1,0b11001},   {705,1,0b10001},   {706,0,0b11101},   {707,1,0b11101},   {708,0,0b10111},   {709,1,0b11111},   {710,0,0b00001},   {711,0,0b00101},   {712,1,0b01011},   {713,0,0b00011},   {714,1,0b10111},   {715,0,0b00011},   {716,1,0b00101},   {717,0,0b01001},   {718,0,0b10101},   {719,1,0b11111},   {720,0,0b01011},   {721,1,0b10111},   {722,1,0b01111},   {723,0,0b01011},   {724,1,0b10101},   {725,0,0b01111},   {726,1,0b11011},   {727,0,0b00111},   {728,0,0b10011},   {729,1,0b10111},   {730,0,0b00111},   {731,0,0b10001},   {732,1,0b10011},   {733,1,0b00001},   {734,0,0b01111},   {735,0,0b01111},   {736,1,0b10001},   {737,1,0b01001},   {738,0,0b00001},   {739,1,0b00111},   {740,1,0b11011},   {741,0,0b10001},   {742,0,0b10001},   {743,0,0b10001},   {744,1,0b10111},   {745,1,0b10001},   {746,1,0b10001},   {747,0,0b01001},   {748,0,0b01101},   {749,0,0b11001},   {750,1,0b11011},   {751,1,0b10001},   {752,0,0b00001},   {753,0,0b00011},   {754,1,0b00101},   {755,1,0b00111},   {756,0,0b00011},   {757,1,0b01001},   {758,1,0b00111},   {759,0,0b00001},   {760,1,0b11101},   {761,1,0b01111},   {762,1,0b00111},   {763,0,0b01001},   {764,1,0b10001},   {765,1,0b00111},   {766,1,0b01011},   {767,1,0b10011},   {768,0,0b01101},   {769,1,0b10001},   {770,1,0b10001},   {771,0,0b00011},   {772,0,0b00101},   {773,1,0b11101},   {774,1,0b10111},   {775,1,0b10101},   {776,1,0b10001},   {777,1,0b11101},   {778,0,0b11001},   {779,1,0b11101},   {780,0,0b01011},   {781,1,0b11001},   {782,0,0b10001},   {783,1,0b10101},   {784,1,0b00001},   {785,0,0b10001},   {786,1,0b11101},   {787,1,0b11111},   {788,0,0b00011},   {789,1,0b10001},   {790,1,0b01011},   {791,1,0b10101},   {792,0,0b11001},   {793,1,0b11101},   {794,0,0b10001},   {795,1,0b10101},   {796,1,0b01001},   {797,1,0b11011},   {798,0,0b00111},   {799,0,0b01001},   {800,0,0b10111},   {801,1,0b11111},   {802,1,0b11101},   {803,1,0b10101},   {804,0,0b00011},   {805,1,0b10001},   {806,1,0b11111},   {807,1,0b10111},   {808,1,0b01111},   {809,0,0b01011},   {810,1,0b11011},   {811,1,0b10101},   {812,0,0b00011},   {813,1,0b01101},   {814,0,0b00101},   {815,0,0b01001},   {816,1,0b10001},   {817,0,0b01101},   {818,1,0b11111},   {819,1,0b01001},   {820,0,0b10101},   {821,0,0b10111},   {822,1,0b11111},   {823,0,0b00001},   {824,1,0b10011},   {825,1,0b00011},   {826,1,0b01101},   {827,1,0b11011},   {828,1,0b00001},   {829,1,0b11011},   {830,1,0b10011},   {831,0,0b01101},   {832,1,0b10001},   {833,0,0b00011},   {834,1,0b10011},   {835,0,0b00101},   {836,1,0b01001},   {837,0,0b01111},   {838,1,0b10011},   {839,0,0b10011},   {840,1,0b11111},   {841,1,0b01001},   {842,1,0b01101},   {843,0,0b01111},   {844,1,0b10101},   {845,0,0b00011},   {846,1,0b11111},   {847,1,0b00111},   {848,0,0b00001},   {849,0,0b00111},   {850,0,0b10101},   {851,0,0b10111},   {852,1,0b11101},   {853,0,0b01111},   {854,1,0b11001},   {855,1,0b10001},   {856,1,0b01111},   {857,0,0b10111},   {858,0,0b11001},   {859,1,0b11001},   {860,0,0b10101},   {861,1,0b11111},   {862,1,0b10011},   {863,0,0b01011},   {864,1,0b11011},   {865,1,0b11011},   {866,0,0b10011},   {867,1,0b10101},   {868,0,0b00101},   {869,1,0b00101},   {870,0,0b00011},   {871,0,0b10111},   {872,1,0b11011},   {873,0,0b01001},   {874,0,0b01001},   {875,1,0b11101},   {876,0,0b01001},   {877,0,0b10101},   {878,1,0b11101},   {879,0,0b11001},   {880,0,0b11111},   {881,1,0b11111},   {882,0,0b01011},   {883,1,0b11101},   {884,0,0b00111},   {885,1,0b10111},   {886,0,0b00101},   {887,1,0b01011},   {888,0,0b00001},   {889,1,0b00011},   {890,0,0b00111},   {891,0,0b01001},   {892,1,0b01101},   {893,0,0b00011},   {894,1,0b10011},   {895,1,0b01111},   {896,1,0b10111},   {897,0,0b01001},   {898,0,0b01111},   {899,0,0b10011},   {900,1,0b11111},   {901,1,0b11001},   {902,0,0b00011},   {903,1,0b10001},   {904,1,0b01011},   {905,0,0b00101},   {906,1,0b01001},   {907,0,0b10011},   {908,0,0b10111},   {909,0,0b11011},   {910,1,0b11111},   {911,1,0b11111},   {912,1,0b00111},   {913,1,0b01101},   {914,1,0b11101},   {915,0,0b10101},   {916,0,0b11011},   {917,1,0b11011},   {918,0,0b01111},   {919,0,0b10001},   {920,1,0b11101},   {921,0,0b01011},   {922,1,0b10111},   {923,0,0b00001},   {924,0,0b01011},   {925,1,0b10001},   {926,0,0b00011},   {927,1,0b01101},   {928,1,0b11001},   {929,0,0b00111},   {930,0,0b01101},   {931,0,0b11011},   {932,1,0b11111},   {933,1,0b11011},   {934,1,0b11011},   {935,0,0b10101},   {936,1,0b11001},   {937,1,0b00111},   {938,1,0b01011},   {939,0,0b00101},   {940,1,0b00111},   {941,1,0b01001},   {942,1,0b11111},   {943,0,0b01101},   {944,1,0b11101},   {945,0,0b00001},   {946,1,0b11001},   {947,0,0b01001},   {948,1,0b01111},   {949,1,0b00001},   {950,0,0b00101},   {951,0,0b01111},   {952,0,0b11001},   {953,1,0b11001},   {954,0,0b10001},   {955,1,0b11011},   {956,0,0b01101},   {957,1,0b01101},   {958,1,0b01101},   {959,0,0b00111},   {960,0,0b01011},   {961,1,0b10011},   {962,0,0b00111},   {963,0,0b10001},   {964,0,0b10101},   {965,1,0b11001},   {966,1,0b11011},   {967,1,0b11101},   {968,1,0b01001},   {969,0,0b00101},   {970,0,0b00111},   {971,1,0b10111},   {972,1,0b00001},   {973,0,0b01101},   {974,1,0b10101},   {975,1,0b11111},   {976,1,0b01111},   {977,0,0b00101},   {978,0,0b10001},   {979,1,0b11111},   {980,1,0b10111},   {981,0,0b01011},   {982,0,0b01101},   {983,1,0b10101},   {984,1,0b11101},   {985,1,0b10011},   {986,0,0b10101},   {987,1,0b11111},   {988,0,0b10011},   {989,1,0b11111},   {990,0,0b00111},   {991,1,0b10111},   {992,0,0b10101},   {993,0,0b10101},   {994,1,0b11011},   {995,0,0b01001},   {996,1,0b10101},   {997,1,0b01011},   {998,1,0b10101},   {999,1,0b11001},   {1000,1,0b01111},   {1001,1,0b00011},   {1002,0,0b00001},   {1003,0,0b00011},   {1004,0,0b00101},   {1005,1,0b01011},   {1006,1,0b00101},   {1007,1,0b00101},   {1008,0,0b00111},   {1009,1,0b01011},   {1010,0,0b11001},   {1011,1,0b11111},   {1012,0,0b10101},   {1013,0,0b11101},   {1014,1,0b11111},   {1015,1,0b10101},   {1016,0,0b01011},   {1017,0,0b10111},   {1018,1,0b11111},   {1019,1,0b11011},   {1020,1,0b10101},   {1021,0,0b01001},   {1022,0,0b10001},   {1023,1,0b11111},   {1024,1,0b11001},   {1025,0,0b00101},   {1026,0,0b10001},   {1027,1,0b11001},   {1028,0,0b10111},   {1029,1,0b10111},   {1030,0,0b11011},   {1031,1,0b11111},   {1032,1,0b11111},   {1033,0,0b01011},   {1034,0,0b01011},   {1035,1,0b10011},   {1036,0,0b01101},   {1037,1,0b10011},   {1038,0,0b00001},   {1039,1,0b01111},   {1040,1,0b00011},   {1041,0,0b10101},   {1042,1,0b11101},   {1043,0,0b11001},   {1044,1,0b11011},   {1045,1,0b01101},   {1046,0,0b00101},   {1047,0,0b01011},   {1048,0,0b10101},   {1049,0,0b11101},   {1050,1,0b11101},   {1051,0,0b00001},   {1052,0,0b01101},   {1053,1,0b10001},   {1054,0,0b00101},   {1055,0,0b00111},   {1056,1,0b01001},   {1057,0,0b11101},   {1058,1,0b11101},   {1059,1,0b10001},   {1060,1,0b10101},   {1061,0,0b00101},   {1062,1,0b10101},   {1063,0,0b00011},   {1064,0,0b00101},   {1065,1,0b10111},   {1066,0,0b01011},   {1067,1,0b01011},   {1068,0,0b00101},   {1069,1,0b01011},   {1070,1,0b01001},   {1071,0,0b00011},   {1072,1,0b00101},   {1073,0,0b10001},   {1074,1,0b11101},   {1075,1,0b01011},   {1076,1,0b11001}};
+                    const uint8_t *res_key;
+                    uint32_t res_size, dummy;
+                    typename Diva<O>::InfixStore *store;
+                    wh_int_iter_peek_ref(it, reinterpret_cast<const void **>(&res_key), &res_size,
+                                         reinterpret_cast<void **>(&store), &dummy);
+
+                    REQUIRE_EQ(memcmp(expected_boundary, res_key, sizeof(keys[0])), 0);
+                    REQUIRE_FALSE(store->IsPartialKey());
+                    REQUIRE_EQ(store->GetInvalidBits(), 0);
+                    AssertStoreContents(s, *store, occupieds_pos, checks);
+                }
+
+                wh_int_iter_skip1(it);
+                {
+                    const uint8_t expected_boundary[] = {0b01100010, 0b00101001, 0b11111000, 0b10110111, 0b10010000, 0b00101011, 0b01101111, 0b10111011};
+                    const std::vector<uint32_t> occupieds_pos = {0, 2, 4, 6, 7, 8, 9, 10, 12, 13, 14, 15, 17, 18, 20, 21, 23, 26, 27, 28, 29, 30, 31, 32, 33, 34, 36, 37, 39, 40, 41, 42, 43, 44, 47, 49, 50, 52, 53, 54, 55, 56, 57, 58, 60, 63, 64, 65, 66, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 95, 96, 97, 98, 100, 101, 102, 104, 105, 107, 108, 109, 110, 111, 112, 113, 115, 116, 118, 119, 120, 121, 122, 123, 125, 126, 127, 128, 131, 134, 135, 136, 138, 139, 140, 141, 142, 143, 145, 146, 147, 148, 150, 152, 154, 155, 156, 157, 158, 159, 160, 163, 164, 165, 166, 170, 171, 172, 173, 175, 176, 177, 179, 180, 181, 185, 186, 187, 188, 189, 190, 193, 195, 196, 198, 199, 200, 201, 202, 203, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215, 216, 219, 220, 222, 223, 224, 225, 226, 227, 229, 230, 231, 232, 233, 234, 235, 236, 237, 239, 240, 241, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 254, 255, 256, 257, 258, 260, 261, 262, 264, 265, 266, 268, 269, 271, 273, 274, 275, 276, 277, 279, 280, 281, 282, 283, 284, 285, 286, 287, 288, 289, 291, 292, 297, 298, 300, 301, 302, 303, 304, 305, 308, 309, 310, 311, 312, 313, 314, 316, 317, 318, 321, 322, 323, 324, 326, 327, 328, 329, 331, 332, 335, 338, 340, 341, 343, 345, 346, 347, 348, 349, 350, 351, 352, 353, 354, 355, 356, 358, 361, 362, 364, 365, 367, 368, 369, 370, 371, 372, 373, 374, 377, 378, 380, 382, 383, 384, 387, 388, 389, 391, 392, 393, 394, 395, 396, 398, 399, 400, 401, 403, 404, 406, 409, 410, 411, 413, 415, 417, 418, 420, 421, 424, 425, 429, 430, 431, 432, 433, 434, 435, 437, 438, 439, 440, 442, 443, 444, 445, 446, 447, 448, 450, 451, 452, 453, 454, 455, 456, 457, 458, 459, 461, 462, 463, 464, 466, 468, 471, 472, 474, 475, 477, 478, 479, 480, 481, 482, 484, 485, 486, 487, 489, 490, 491, 492, 493, 494, 497, 498, 499, 502, 503, 505, 506, 507, 508, 509, 511, 512, 513, 516, 517, 521, 523, 525, 526, 527, 528, 530, 532, 537, 538, 539, 541, 542, 543, 544, 545, 549, 551, 552, 553, 554, 556, 557, 558, 559, 560, 562, 564, 567, 568, 570, 573, 574, 575, 576, 577, 578, 579, 580, 581, 582, 583, 584, 585, 589, 590, 591, 592, 593, 594, 595, 596, 597, 598, 601, 602, 603, 604, 606, 607, 608, 609, 610, 612, 613, 616, 617, 618, 619, 620, 621, 622, 623, 624, 625, 626, 627, 629, 630, 631, 632, 634, 636, 637, 638, 639, 640, 641, 642, 643, 644, 645, 647, 649, 650, 651, 654, 655, 656, 657, 658, 659, 661, 662, 664, 668, 669, 670, 671, 673, 675, 676, 677, 678, 680, 681, 682, 683, 684, 686, 687, 688, 689, 691, 692, 693, 694, 698, 700, 702, 703, 704, 705, 706, 708, 709, 710, 714, 715, 717, 718, 719, 720, 721, 722, 724, 725, 730, 731, 732, 733, 734, 735, 736, 737, 740, 741, 742, 743, 744, 745, 746, 747, 748, 749, 750, 751, 752, 753, 756, 757, 758, 762, 763, 765, 767, 768, 770, 771, 772, 774, 776, 777, 778, 779, 781, 783, 784, 786, 787, 789, 790, 792, 793, 796, 797, 800, 801, 802, 803, 805, 809, 811};
+                    const std::vector<std::tuple<uint32_t, bool, uint64_t>> checks = {{  0,0,0b11101},   {  1,1,0b11111},   {  2,0,0b10101},   {  3,1,0b11011},   {  5,0,0b01001},   {  6,0,0b01011},   {  7,1,0b10011},   {  8,0,0b00101},   {  9,1,0b10001},   { 10,0,0b01101},   { 11,1,0b11001},   { 12,0,0b00001},   { 13,1,0b11111},   { 14,1,0b10001},   { 15,1,0b00001},   { 16,0,0b01001},   { 17,1,0b11111},   { 18,0,0b01101},   { 19,1,0b01111},   { 20,0,0b01111},   { 21,0,0b10111},   { 22,1,0b11111},   { 23,1,0b01111},   { 24,0,0b00001},   { 25,0,0b01001},   { 26,1,0b11001},   { 27,1,0b10001},   { 28,1,0b10111},   { 29,1,0b01011},   { 30,0,0b00011},   { 31,1,0b11001},   { 34,0,0b01001},   { 35,0,0b01111},   { 36,0,0b10101},   { 37,1,0b11001},   { 38,0,0b00011},   { 39,0,0b00101},   { 40,0,0b01101},   { 41,0,0b10011},   { 42,1,0b11011},   { 43,1,0b11001},   { 44,1,0b00011},   { 45,1,0b01111},   { 46,1,0b11011},   { 47,1,0b11111},   { 48,1,0b10011},   { 49,1,0b11111},   { 50,1,0b00001},   { 51,1,0b10001},   { 52,0,0b01101},   { 53,0,0b01111},   { 54,1,0b10101},   { 55,1,0b10101},   { 56,0,0b10111},   { 57,1,0b11101},   { 58,1,0b10101},   { 59,0,0b00001},   { 60,1,0b10001},   { 61,1,0b01111},   { 62,0,0b01101},   { 63,0,0b10111},   { 64,1,0b11001},   { 65,0,0b01001},   { 66,0,0b01011},   { 67,1,0b01111},   { 68,1,0b00111},   { 69,1,0b00111},   { 70,0,0b00111},   { 71,1,0b01101},   { 72,1,0b11101},   { 73,1,0b10101},   { 74,0,0b10001},   { 75,1,0b11111},   { 76,1,0b11111},   { 77,0,0b01001},   { 78,0,0b10111},   { 79,1,0b11001},   { 80,0,0b00111},   { 81,1,0b11111},   { 83,0,0b01011},   { 84,1,0b10101},   { 85,0,0b00001},   { 86,0,0b01101},   { 87,0,0b10011},   { 88,1,0b10101},   { 89,1,0b01011},   { 90,0,0b01101},   { 91,1,0b01111},   { 92,1,0b00101},   { 93,1,0b11101},   { 94,0,0b00111},   { 95,1,0b01001},   { 96,0,0b00101},   { 97,1,0b10001},   { 98,0,0b10001},   { 99,0,0b10001},   {100,1,0b11001},   {101,1,0b01101},   {102,1,0b01001},   {103,0,0b00101},   {104,0,0b00111},   {105,0,0b00111},   {106,1,0b10011},   {107,1,0b00001},   {108,0,0b01101},   {109,1,0b10101},   {110,0,0b10101},   {111,1,0b11001},   {112,0,0b01111},   {113,1,0b01111},   {114,1,0b00101},   {115,0,0b10001},   {116,0,0b10101},   {117,0,0b10111},   {118,1,0b11011},   {119,1,0b10111},   {120,1,0b10101},   {121,0,0b01111},   {122,0,0b01111},   {123,0,0b10101},   {124,1,0b10101},   {125,0,0b00111},   {126,0,0b01011},   {127,1,0b10001},   {128,0,0b01011},   {129,1,0b11101},   {130,0,0b01001},   {131,1,0b10111},   {132,0,0b10111},   {133,1,0b11001},   {134,0,0b01111},   {135,1,0b11001},   {136,0,0b00101},   {137,1,0b11101},   {138,1,0b00011},   {139,1,0b11011},   {140,1,0b00011},   {141,0,0b10001},   {142,1,0b10111},   {143,0,0b00001},   {144,0,0b01101},   {145,0,0b10001},   {146,1,0b11011},   {147,0,0b00101},   {148,0,0b10111},   {149,1,0b11011},   {150,0,0b01111},   {151,1,0b11001},   {152,0,0b10011},   {153,1,0b10101},   {154,1,0b10111},   {155,0,0b01011},   {156,1,0b01111},   {157,0,0b00111},   {158,0,0b10001},   {159,1,0b11011},   {160,1,0b00001},   {161,0,0b11111},   {162,1,0b11111},   {163,0,0b01001},   {164,0,0b10001},   {165,1,0b10011},   {166,1,0b01111},   {167,0,0b00111},   {168,0,0b01111},   {169,1,0b10101},   {170,0,0b01101},   {171,1,0b11001},   {172,1,0b11011},   {173,1,0b01011},   {174,1,0b10101},   {175,1,0b01101},   {176,1,0b01101},   {177,0,0b00111},   {178,1,0b11001},   {179,0,0b01011},   {180,1,0b11011},   {181,0,0b00011},   {182,1,0b01001},   {183,0,0b01101},   {184,0,0b11001},   {185,1,0b11101},   {186,1,0b10011},   {187,0,0b00011},   {188,1,0b00011},   {189,0,0b00011},   {190,0,0b00101},   {191,1,0b10101},   {192,1,0b00001},   {193,1,0b10001},   {194,1,0b11011},   {195,0,0b10001},   {196,0,0b10111},   {197,0,0b11101},   {198,1,0b11101},   {199,1,0b00101},   {200,0,0b01101},   {201,1,0b11111},   {202,1,0b01101},   {203,1,0b00101},   {204,1,0b01001},   {205,1,0b10001},   {206,0,0b01001},   {207,1,0b01011},   {208,0,0b10111},   {209,1,0b10111},   {210,1,0b01101},   {211,0,0b01011},   {212,1,0b10101},   {213,0,0b01011},   {214,1,0b10001},   {215,0,0b00001},   {216,0,0b11011},   {217,0,0b11011},   {218,1,0b11011},   {219,1,0b11101},   {220,0,0b00001},   {221,1,0b00101},   {222,0,0b00011},   {223,1,0b01001},   {224,1,0b10101},   {225,1,0b11001},   {226,1,0b11101},   {227,1,0b00001},   {228,1,0b01001},   {229,0,0b00111},   {230,0,0b01001},   {231,1,0b11011},   {232,1,0b01111},   {233,0,0b01001},   {234,0,0b01011},   {235,1,0b01111},   {236,0,0b00111},   {237,0,0b00111},   {238,1,0b11011},   {239,1,0b10101},   {240,0,0b00001},   {241,0,0b10001},   {242,1,0b11011},   {243,0,0b00101},   {244,1,0b10011},   {245,0,0b00111},   {246,1,0b10001},   {247,1,0b11001},   {248,1,0b11001},   {249,1,0b00111},   {250,1,0b10111},   {251,0,0b00001},   {252,1,0b10101},   {253,1,0b10011},   {254,1,0b00101},   {255,1,0b10101},   {256,1,0b01111},   {257,0,0b01001},   {258,1,0b10001},   {259,0,0b00011},   {260,0,0b10001},   {261,1,0b11111},   {262,0,0b00011},   {263,0,0b01011},   {264,1,0b10011},   {265,1,0b00011},   {266,0,0b01101},   {267,1,0b11001},   {268,0,0b00101},   {269,0,0b10111},   {270,1,0b11011},   {271,1,0b11101},   {272,1,0b10001},   {273,0,0b00001},   {274,1,0b11101},   {275,0,0b10111},   {276,1,0b11111},   {277,0,0b01101},   {278,0,0b10111},   {279,1,0b11111},   {280,0,0b00111},   {281,1,0b11101},   {282,0,0b01011},   {283,1,0b10101},   {284,0,0b01101},   {285,1,0b10001},   {286,0,0b00101},   {287,0,0b10001},   {288,0,0b11001},   {289,1,0b11101},   {290,1,0b00111},   {291,0,0b01011},   {292,1,0b11001},   {293,0,0b01011},   {294,1,0b11001},   {295,0,0b00001},   {296,0,0b00011},   {297,0,0b00101},   {298,1,0b11011},   {299,0,0b00011},   {300,0,0b00111},   {301,1,0b10001},   {302,1,0b11011},   {303,0,0b11001},   {304,1,0b11111},   {305,1,0b11101},   {306,0,0b11001},   {307,1,0b11111},   {308,0,0b01001},   {309,1,0b01101},   {310,1,0b11011},   {311,1,0b10101},   {312,0,0b00101},   {313,0,0b01101},   {314,1,0b10111},   {315,0,0b00111},   {316,0,0b11011},   {317,1,0b11011},   {318,1,0b00011},   {319,0,0b01111},   {320,0,0b11001},   {321,1,0b11111},   {322,1,0b10011},   {323,1,0b01101},   {324,1,0b11101},   {325,1,0b00001},   {326,1,0b01101},   {327,0,0b01001},   {328,1,0b11011},   {329,0,0b00111},   {330,1,0b10001},   {331,1,0b10011},   {332,0,0b01111},   {333,0,0b10101},   {334,1,0b11101},   {335,1,0b11001},   {336,0,0b01101},   {337,1,0b10111},   {338,1,0b00001},   {339,1,0b00011},   {340,1,0b01111},   {341,1,0b11011},   {342,0,0b10101},   {343,1,0b10111},   {344,1,0b10101},   {345,1,0b11011},   {346,0,0b01011},   {347,1,0b11001},   {348,1,0b01001},   {349,1,0b01101},   {350,0,0b11001},   {351,1,0b11111},   {352,1,0b01001},   {353,1,0b11011},   {354,1,0b00101},   {355,1,0b00111},   {356,0,0b01111},   {357,1,0b11001},   {358,0,0b10011},   {359,1,0b11011},   {360,0,0b01001},   {361,1,0b10001},   {362,1,0b10101},   {363,0,0b01101},   {364,1,0b11101},   {365,1,0b01111},   {366,1,0b01101},   {367,0,0b00111},   {368,0,0b01101},   {369,1,0b11001},   {370,0,0b10011},   {371,1,0b11101},   {372,0,0b01001},   {373,0,0b01011},   {374,1,0b01111},   {375,0,0b10101},   {376,1,0b11101},   {377,0,0b00101},   {378,0,0b01011},   {379,1,0b11001},   {380,1,0b10001},   {381,0,0b00101},   {382,1,0b11101},   {383,0,0b01111},   {384,1,0b11111},   {385,0,0b10111},   {386,1,0b11111},   {387,1,0b01101},   {388,0,0b10011},   {389,1,0b10101},   {390,0,0b00001},   {391,0,0b00011},   {392,1,0b10011},   {393,0,0b01001},   {394,0,0b10011},   {395,1,0b11001},   {396,0,0b01011},   {397,1,0b01111},   {398,0,0b00111},   {399,1,0b11011},   {400,1,0b10111},   {401,0,0b01111},   {402,1,0b01111},   {403,1,0b00101},   {404,1,0b11111},   {405,1,0b11101},   {406,1,0b10101},   {407,1,0b01101},   {408,0,0b01111},   {409,0,0b10001},   {410,1,0b10001},   {411,0,0b10101},   {412,1,0b11111},   {413,0,0b01111},   {414,1,0b11101},   {415,0,0b00111},   {416,0,0b01001},   {417,1,0b10001},   {418,0,0b10011},   {419,1,0b11101},   {420,0,0b00001},   {421,1,0b01111},   {422,0,0b11001},   {423,1,0b11101},   {424,1,0b01101},   {425,1,0b11111},   {426,1,0b01101},   {427,0,0b00011},   {428,0,0b00101},   {429,0,0b11101},   {430,1,0b11111},   {431,0,0b00011},   {432,0,0b01001},   {433,1,0b11011},   {434,0,0b01101},   {435,1,0b11111},   {436,1,0b11001},   {437,0,0b01111},   {438,1,0b11101},   {439,1,0b11101},   {440,1,0b00101},   {441,0,0b01011},   {442,1,0b11011},   {443,0,0b00011},   {444,1,0b00101},   {445,1,0b11011},   {446,0,0b11111},   {447,1,0b11111},   {448,1,0b10101},   {449,0,0b00011},   {450,0,0b01111},   {451,0,0b10001},   {452,1,0b11011},   {453,0,0b01101},   {454,0,0b10101},   {455,1,0b11111},   {456,1,0b10111},   {457,1,0b01111},   {458,0,0b01101},   {459,1,0b10101},   {460,0,0b10101},   {461,1,0b11101},   {462,1,0b00111},   {463,1,0b11101},   {464,1,0b01101},   {465,0,0b00001},   {466,0,0b10001},   {467,1,0b10101},   {468,1,0b10001},   {469,0,0b00011},   {470,1,0b01101},   {471,1,0b00001},   {472,0,0b00001},   {473,1,0b01101},   {474,1,0b10011},   {475,1,0b11101},   {476,0,0b00001},   {477,1,0b11011},   {478,1,0b00001},   {479,1,0b01101},   {480,1,0b10011},   {481,1,0b00111},   {482,1,0b01111},   {483,1,0b01001},   {484,0,0b00111},   {485,1,0b11101},   {486,0,0b01011},   {487,1,0b10101},   {488,1,0b00111},   {489,0,0b00111},   {490,1,0b01001},   {491,1,0b11101},   {492,0,0b10001},   {493,1,0b11101},   {494,1,0b01001},   {495,1,0b10001},   {496,1,0b10101},   {497,0,0b00011},   {498,1,0b00111},   {500,0,0b00011},   {501,1,0b01101},   {502,1,0b10001},   {504,0,0b01111},   {505,1,0b10111},   {507,1,0b00011},   {508,1,0b10001},   {509,1,0b10101},   {513,0,0b01101},   {514,1,0b10001},   {515,0,0b00101},   {516,0,0b00111},   {517,1,0b11101},   {518,1,0b11111},   {519,0,0b00011},   {520,1,0b00011},   {521,0,0b00101},   {522,1,0b01111},   {523,0,0b00001},   {524,1,0b10111},   {525,0,0b00001},   {526,1,0b00101},   {527,1,0b01001},   {528,0,0b00101},   {529,1,0b01111},   {530,1,0b10111},   {531,1,0b00011},   {532,0,0b10001},   {533,1,0b11101},   {534,1,0b01001},   {535,0,0b00111},   {536,0,0b10111},   {537,1,0b11111},   {538,1,0b11001},   {539,0,0b00001},   {540,1,0b01101},   {542,1,0b11001},   {544,1,0b00011},   {545,0,0b00111},   {546,1,0b10111},   {548,0,0b00101},   {549,0,0b10101},   {550,1,0b11011},   {551,1,0b01101},   {553,0,0b01011},   {554,0,0b10001},   {555,1,0b11011},   {556,0,0b01111},   {557,1,0b11111},   {558,0,0b00011},   {559,0,0b01101},   {560,0,0b10011},   {561,1,0b10011},   {562,0,0b00001},   {563,1,0b11111},   {564,1,0b11001},   {565,1,0b01001},   {569,1,0b10101},   {570,0,0b10011},   {571,1,0b11001},   {572,1,0b10011},   {573,1,0b01011},   {574,1,0b01111},   {576,0,0b00011},   {577,0,0b01101},   {578,1,0b11111},   {579,0,0b00111},   {580,1,0b01001},   {581,1,0b01001},   {582,1,0b11001},   {583,1,0b10001},   {584,1,0b10011},   {586,0,0b01001},   {587,1,0b10101},   {588,0,0b10111},   {589,1,0b11111},   {590,1,0b10111},   {591,0,0b00001},   {592,0,0b00001},   {593,1,0b01011},   {594,1,0b01001},   {595,0,0b00011},   {596,1,0b10001},   {597,0,0b11101},   {598,1,0b11111},   {599,1,0b11111},   {600,1,0b11101},   {601,1,0b10111},   {602,1,0b01011},   {603,0,0b11101},   {604,1,0b11111},   {605,1,0b01011},   {606,1,0b11011},   {607,1,0b01011},   {608,0,0b10111},   {609,1,0b11011},   {610,0,0b01101},   {611,1,0b01111},   {612,1,0b01001},   {613,0,0b01111},   {614,1,0b10111},   {615,0,0b10011},   {616,0,0b10111},   {617,1,0b11001},   {618,1,0b01111},   {619,0,0b10011},   {620,1,0b10011},   {621,0,0b00101},   {622,1,0b01111},   {625,1,0b00011},   {626,0,0b00001},   {627,1,0b11011},   {629,1,0b11111},   {630,1,0b00101},   {633,0,0b01011},   {634,1,0b01101},   {635,0,0b01111},   {636,1,0b10101},   {637,1,0b10111},   {638,0,0b10101},   {639,0,0b11011},   {640,1,0b11011},   {641,1,0b00111},   {642,0,0b01111},   {643,1,0b01111},   {644,0,0b00011},   {645,0,0b00011},   {646,0,0b01111},   {647,0,0b10011},   {648,1,0b11011},   {649,1,0b01111},   {650,1,0b01111},   {651,1,0b00111},   {652,0,0b00001},   {653,1,0b00011},   {654,1,0b10011},   {655,0,0b11011},   {656,1,0b11101},   {657,0,0b00001},   {658,1,0b00011},   {659,1,0b00101},   {660,1,0b01011},   {661,1,0b00101},   {662,0,0b00011},   {663,1,0b01001},   {664,0,0b01101},   {665,1,0b11011},   {666,0,0b10001},   {667,1,0b10011},   {668,1,0b11101},   {670,1,0b11111},   {671,1,0b11001},   {673,0,0b10001},   {674,1,0b11011},   {675,0,0b00111},   {676,1,0b11001},   {677,0,0b00101},   {678,0,0b00101},   {679,1,0b01101},   {680,1,0b00011},   {681,1,0b10001},   {682,0,0b01111},   {683,1,0b01111},   {684,1,0b00001},   {686,1,0b10001},   {691,0,0b10001},   {692,1,0b11001},   {694,1,0b11001},   {696,0,0b10001},   {697,0,0b10001},   {698,1,0b10111},   {699,1,0b11011},   {700,1,0b11111},   {701,1,0b11111},   {703,1,0b00001},   {706,0,0b00111},   {707,0,0b01111},   {708,1,0b10111},   {712,0,0b00101},   {713,1,0b01101},   {714,1,0b01101},   {715,1,0b00011},   {718,0,0b10011},   {719,0,0b11011},   {720,1,0b11111},   {721,1,0b00001},   {722,0,0b00001},   {723,0,0b10011},   {724,1,0b11011},   {725,1,0b01001},   {726,0,0b00001},   {727,1,0b00011},   {728,1,0b10111},   {731,1,0b00101},   {732,1,0b11101},   {734,1,0b01111},   {735,0,0b10011},   {736,1,0b10111},   {738,0,0b00101},   {739,0,0b01101},   {740,1,0b10011},   {741,0,0b01101},   {742,1,0b01111},   {743,0,0b00101},   {744,1,0b01111},   {745,0,0b10101},   {746,1,0b10111},   {747,0,0b00111},   {748,1,0b10011},   {749,0,0b00011},   {750,1,0b10001},   {751,0,0b00011},   {752,1,0b10001},   {753,1,0b01111},   {754,1,0b11001},   {756,1,0b01101},   {760,0,0b00001},   {761,0,0b01001},   {762,0,0b11111},   {763,1,0b11111},   {764,0,0b01101},   {765,1,0b10101},   {766,1,0b01011},   {767,0,0b00111},   {768,0,0b01101},   {769,1,0b11011},   {770,1,0b00001},   {771,0,0b01011},   {772,0,0b01111},   {773,1,0b11001},   {774,0,0b00111},   {775,0,0b01011},   {776,0,0b11011},   {777,1,0b11011},   {778,0,0b01011},   {779,1,0b01011},   {780,0,0b01101},   {781,0,0b10001},   {782,1,0b11001},   {783,1,0b00101},   {784,1,0b10011},   {785,0,0b01101},   {786,1,0b11111},   {787,0,0b00111},   {788,0,0b01011},   {789,1,0b11001},   {790,1,0b11111},   {791,1,0b10111},   {792,0,0b00011},   {793,1,0b11011},   {794,0,0b11001},   {795,1,0b11011},   {796,0,0b00101},   {797,0,0b00101},   {798,1,0b11111},   {799,0,0b01011},   {800,1,0b10111},   {801,1,0b01101},   {802,1,0b01001},   {803,0,0b01001},   {804,1,0b10011},   {805,1,0b11001},   {806,0,0b10111},   {807,1,0b11011},   {808,0,0b10101},   {809,1,0b11101},   {810,1,0b11101},   {811,0,0b00111},   {812,0,0b01011},   {813,1,0b10001},   {814,0,0b00001},   {815,0,0b00011},   {816,1,0b00011},   {817,1,0b10111},   {818,1,0b00111},   {819,0,0b01001},   {820,1,0b01011},   {821,0,0b00011},   {822,1,0b10011},   {823,0,0b01001},   {824,0,0b11001},   {825,1,0b11001},   {826,1,0b10111},   {827,1,0b01011},   {828,0,0b00011},   {829,1,0b10001},   {830,0,0b00101},   {831,1,0b11001},   {832,1,0b10011},   {833,1,0b10111},   {834,0,0b00001},   {835,0,0b01001},   {836,1,0b11011},   {837,0,0b00101},   {838,0,0b01011},   {839,1,0b10001},   {840,0,0b01111},   {841,1,0b11001},   {842,1,0b00101},   {843,1,0b10011},   {844,1,0b11001},   {845,1,0b10011},   {846,1,0b10011},   {847,1,0b01111},   {848,1,0b01101},   {849,1,0b10101},   {850,0,0b00011},   {851,0,0b00111},   {852,1,0b10001},   {853,1,0b00101},   {854,0,0b00001},   {855,0,0b01101},   {856,1,0b10111},   {857,1,0b11001},   {858,0,0b11001},   {859,1,0b11011},   {860,1,0b10111},   {861,1,0b10011},   {862,1,0b00001},   {863,0,0b00111},   {864,1,0b11001},   {865,0,0b00011},   {866,1,0b10111},   {867,0,0b01101},   {868,1,0b10001},   {869,1,0b01001},   {870,0,0b10111},   {871,1,0b10111},   {872,1,0b10001},   {873,1,0b00011},   {874,1,0b01011},   {875,1,0b01101},   {876,0,0b00011},   {877,1,0b11111},   {878,1,0b11101},   {879,1,0b10111},   {880,1,0b00101},   {881,0,0b01001},   {882,1,0b11101},   {883,1,0b00111},   {884,0,0b10011},   {885,1,0b11101},   {886,0,0b00111},   {887,1,0b10101},   {888,0,0b00011},   {889,1,0b01111},   {890,0,0b01001},   {891,1,0b01111},   {892,0,0b00011},   {893,1,0b10011},   {894,0,0b01011},   {895,1,0b11001},   {896,0,0b00001},   {897,1,0b00101},   {898,1,0b01011},   {899,0,0b00011},   {900,0,0b00011},   {901,1,0b01111},   {902,0,0b01011},   {903,1,0b01101},   {904,0,0b00001},   {905,1,0b10011},   {906,0,0b00001},   {907,0,0b00001},   {908,0,0b00111},   {909,0,0b10011},   {910,0,0b11001},   {911,1,0b11001},   {912,1,0b10001},   {913,1,0b10111},   {914,0,0b00001},   {915,0,0b00011},   {916,1,0b11011},   {917,1,0b11101},   {918,0,0b00011},   {919,0,0b10001},   {920,1,0b10111},   {921,0,0b01001},   {922,0,0b10011},   {923,1,0b10111},   {924,0,0b00111},   {925,1,0b11101},   {926,1,0b00111},   {927,0,0b00001},   {928,1,0b00011},   {929,0,0b00011},   {930,1,0b11011},   {931,0,0b00001},   {932,0,0b01011},   {933,1,0b01011},   {934,0,0b00001},   {935,0,0b00111},   {936,0,0b01011},   {937,0,0b11101},   {938,1,0b11111},   {939,1,0b11101},   {940,0,0b00101},   {941,1,0b00111},   {942,1,0b00111},   {943,0,0b11001},   {944,1,0b11111},   {945,0,0b00111},   {946,1,0b11101},   {947,1,0b10101},   {948,1,0b11011},   {949,0,0b00101},   {950,1,0b11011},   {951,1,0b01001},   {952,1,0b00001},   {953,1,0b11011},   {954,1,0b11101},   {955,0,0b00001},   {956,1,0b00001},   {957,0,0b00101},   {958,0,0b00101},   {959,1,0b01111},   {960,1,0b00111},   {961,1,0b11101},   {962,0,0b11011},   {963,1,0b11111},   {964,0,0b00001},   {965,1,0b01101},   {966,0,0b00101},   {967,0,0b00111},   {968,1,0b10101},   {969,1,0b11001},   {970,0,0b00001},   {971,1,0b01011},   {972,0,0b00011},   {973,0,0b01011},   {974,1,0b10001},   {975,0,0b01111},   {976,0,0b10011},   {977,1,0b11011},   {978,0,0b01101},   {979,1,0b11101},   {980,0,0b10001},   {981,1,0b11101},   {982,0,0b01111},   {983,1,0b01111},   {984,0,0b01001},   {985,0,0b01001},   {986,0,0b01101},   {987,1,0b11111},   {988,1,0b10111},   {989,1,0b00111},   {990,0,0b00101},   {991,1,0b01101},   {992,0,0b01001},   {993,0,0b10101},   {994,1,0b11001},   {995,1,0b00101},   {996,1,0b00101},   {997,0,0b01011},   {998,0,0b01011},   {999,1,0b01011},   {1000,1,0b10111},   {1001,0,0b01001},   {1002,1,0b01111},   {1003,0,0b00001},   {1004,0,0b01001},   {1005,0,0b01001},   {1006,0,0b01011},   {1007,1,0b11011},   {1008,1,0b10101},   {1009,1,0b11111},   {1010,0,0b01001},   {1011,1,0b01101},   {1012,0,0b00001},   {1013,1,0b11101},   {1014,1,0b00001},   {1015,1,0b10111},   {1016,1,0b00001},   {1017,1,0b11011},   {1018,1,0b10011},   {1019,0,0b00001},   {1020,1,0b11101},   {1021,0,0b01001},   {1022,1,0b10101},   {1023,0,0b11001},   {1024,1,0b11101},   {1025,0,0b00001},   {1026,1,0b01011},   {1027,0,0b01111},   {1028,1,0b10101},   {1029,1,0b01001},   {1030,1,0b01101},   {1031,0,0b01111},   {1032,0,0b11011},   {1033,0,0b11101},   {1034,1,0b11111},   {1035,0,0b00001},   {1036,0,0b00011},   {1037,1,0b01111},   {1038,0,0b11001},   {1039,1,0b11111},   {1040,1,0b00111},   {1041,0,0b00001},   {1042,1,0b00011},   {1043,0,0b01011},   {1044,0,0b10011},   {1045,1,0b11101},   {1046,1,0b11011},   {1047,1,0b01001},   {1048,1,0b00101},   {1049,1,0b11001},   {1050,1,0b01011},   {1051,1,0b01111},   {1052,1,0b10101},   {1056,1,0b11011},   {1057,0,0b01011},   {1058,0,0b01101},   {1059,1,0b11011},   {1061,0,0b00111},   {1062,0,0b11011},   {1063,1,0b11101},   {1064,0,0b00101},   {1065,1,0b00101},   {1066,0,0b00101},   {1067,1,0b11001},   {1068,0,0b00011},   {1069,1,0b01101},   {1070,0,0b01101},   {1071,1,0b11011},   {1073,0,0b00101},   {1074,0,0b10001},   {1075,1,0b11001},   {1076,1,0b00011}};
+                    const uint8_t *res_key;
+                    uint32_t res_size, dummy;
+                    typename Diva<O>::InfixStore *store;
+                    wh_int_iter_peek_ref(it, reinterpret_cast<const void **>(&res_key), &res_size,
+                                         reinterpret_cast<void **>(&store), &dummy);
+
+                    REQUIRE_EQ(memcmp(expected_boundary, res_key, sizeof(keys[0])), 0);
+                    REQUIRE_FALSE(store->IsPartialKey());
                     REQUIRE_EQ(store->GetInvalidBits(), 0);
                     AssertStoreContents(s, *store, occupieds_pos, checks);
                 }
@@ -2042,10 +3075,10 @@ public:
 
         Diva<O> s(infix_size, string_keys.begin(), string_keys.end(), seed, load_factor);
 
-        const uint32_t buf_size = s.Size() + 20;
+        const uint64_t buf_size = s.Size() + 20;
         char *buf = new char[buf_size];
         memset(buf, 0, buf_size);
-        const uint32_t serialized_size = s.Serialize(buf);
+        const uint64_t serialized_size = s.Serialize(buf);
         REQUIRE_EQ(s.Size(), serialized_size);
 
         Diva<O> reconstructed_s(buf);
@@ -2055,6 +3088,137 @@ public:
     }
 
 
+    template <bool O>
+    static void StreamSerializeDeserialize() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 40000;
+
+        const uint32_t rng_seed = 2;
+        std::mt19937_64 rng(rng_seed);
+
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        std::vector<std::string> string_keys;
+        for (int32_t i = 0; i < n_keys; i++) {
+            size_t str_length;
+            if constexpr (O)
+                str_length = 8;
+            else
+                str_length = 6 + rng() % 3;
+            const uint64_t value = to_big_endian_order(keys[i]);
+            string_keys.emplace_back(reinterpret_cast<const char *>(&value), str_length);
+        }
+        Diva<O> s(infix_size, string_keys.begin(), string_keys.end(), seed, load_factor);
+        Diva<O> t(infix_size, string_keys.begin(), string_keys.begin() + n_keys / 2, seed, load_factor);
+
+        const uint64_t buf_size = s.Size();
+        std::string buf(buf_size, 0);
+        REQUIRE_EQ(s.Serialize(buf.data()), buf_size);
+
+        SUBCASE("callback") {
+            std::string out;
+            uint64_t max_chunk_size = 0;
+            REQUIRE_EQ(s.SerializeTo([&](const char *data, size_t len) {
+                           out.append(data, len);
+                           max_chunk_size = std::max<uint64_t>(max_chunk_size, len);
+                       }), buf_size);
+            REQUIRE(out == buf);
+            REQUIRE_LE(max_chunk_size, Diva<O>::stream_buffer_size);
+
+            uint64_t ind = 0;
+            Diva<O> reconstructed_s([&](char *data, size_t len) -> size_t {
+                len = std::min<uint64_t>(len, out.size() - ind);
+                memcpy(data, out.data() + ind, len);
+                ind += len;
+                return len;
+            });
+            REQUIRE_EQ(ind, buf_size);
+            AssertDivas(s, reconstructed_s);
+        }
+
+        SUBCASE("stream") {
+            std::stringstream stream;
+            REQUIRE_EQ(s.SerializeTo(stream), buf_size);
+            REQUIRE_EQ(t.SerializeTo(stream), t.Size());
+            REQUIRE(stream.str().substr(0, buf_size) == buf);
+            Diva<O> reconstructed_s(stream);
+            Diva<O> reconstructed_t(stream);
+            AssertDivas(s, reconstructed_s);
+            AssertDivas(t, reconstructed_t);
+        }
+
+        SUBCASE("file descriptor") {
+            char file_path[] = "/tmp/diva_stream_XXXXXX";
+            const int fd = mkstemp(file_path);
+            REQUIRE_NE(fd, -1);
+            unlink(file_path);
+            REQUIRE_EQ(s.SerializeTo(fd), buf_size);
+            REQUIRE_EQ(t.SerializeTo(fd), t.Size());
+            lseek(fd, 0, SEEK_SET);
+            Diva<O> reconstructed_s(fd, false);
+            Diva<O> reconstructed_t(fd, false);
+            close(fd);
+            AssertDivas(s, reconstructed_s);
+            AssertDivas(t, reconstructed_t);
+        }
+    }
+
+
+    template <bool O>
+    static void MappedDeserialize() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 40000;
+        const uint32_t n_updates = 20000;
+
+        const uint32_t rng_seed = 2;
+        std::mt19937_64 rng(rng_seed);
+
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        if constexpr (!O) {
+            for (int32_t i = 0; i < n_keys; i++)
+                keys[i] = to_big_endian_order(keys[i]);
+        }
+        Diva<O> s(infix_size, keys.begin(), keys.end(), sizeof(uint64_t), seed, load_factor);
+
+        const uint64_t buf_size = s.Size();
+        char *buf = new char[buf_size];
+        REQUIRE_EQ(s.Serialize(buf), buf_size);
+        char file_path[] = "/tmp/diva_mapped_XXXXXX";
+        const int fd = mkstemp(file_path);
+        REQUIRE_NE(fd, -1);
+        unlink(file_path);
+        REQUIRE_EQ(write(fd, buf, buf_size), buf_size);
+        delete[] buf;
+
+        Diva<O> mapped_s(fd);
+        close(fd);
+        AssertDivas(s, mapped_s);
+
+        // The mapping is read-only, so updates only go through if stores get copied
+        std::vector<uint64_t> inserted_keys;
+        for (int32_t i = 0; i < n_updates; i++) {
+            inserted_keys.push_back(to_big_endian_order(rng()));
+            s.Insert(reinterpret_cast<const uint8_t *>(&inserted_keys.back()), sizeof(uint64_t));
+            mapped_s.Insert(reinterpret_cast<const uint8_t *>(&inserted_keys.back()), sizeof(uint64_t));
+        }
+        AssertDivas(s, mapped_s);
+        for (int32_t i = 0; i < n_updates; i += 2) {
+            s.Delete(reinterpret_cast<const uint8_t *>(&inserted_keys[i]), sizeof(uint64_t));
+            mapped_s.Delete(reinterpret_cast<const uint8_t *>(&inserted_keys[i]), sizeof(uint64_t));
+        }
+        AssertDivas(s, mapped_s);
+    }
+
+
     template <bool O>
     static void BulkLoadStreaming() {
         const uint32_t infix_size = 5;
@@ -2091,6 +3255,56 @@ public:
     }
 
 
+    template <bool O>
+    static void ParallelBulkLoad() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t n_keys = 40000;
+        const std::vector<uint32_t> thread_counts = {2, 3, 64};
+
+        const uint32_t rng_seed = 2;
+        std::mt19937_64 rng(rng_seed);
+
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+
+        SUBCASE("fixed length") {
+            if constexpr (!O) {
+                for (int32_t i = 0; i < n_keys; i++)
+                    keys[i] = to_big_endian_order(keys[i]);
+            }
+            Diva<O> s(infix_size, keys.begin(), keys.end(), sizeof(uint64_t), seed, load_factor);
+            for (uint32_t thread_count : thread_counts) {
+                Diva<O> parallel_s(infix_size, keys.begin(), keys.end(), sizeof(uint64_t), seed, load_factor,
+                                   thread_count);
+                AssertDivas(s, parallel_s);
+            }
+        }
+
+        SUBCASE("variable length") {
+            std::vector<std::string> string_keys;
+            for (int32_t i = 0; i < n_keys; i++) {
+                size_t str_length;
+                if constexpr (O)
+                    str_length = 8;
+                else
+                    str_length = 6 + rng() % 3;
+                const uint64_t value = to_big_endian_order(keys[i]);
+                string_keys.emplace_back(reinterpret_cast<const char *>(&value), str_length);
+            }
+            Diva<O> s(infix_size, string_keys.begin(), string_keys.end(), seed, load_factor);
+            for (uint32_t thread_count : thread_counts) {
+                Diva<O> parallel_s(infix_size, string_keys.begin(), string_keys.end(), seed, load_factor,
+                                   thread_count);
+                AssertDivas(s, parallel_s);
+            }
+        }
+    }
+
+
 private:
     template <bool O>
     static void AssertStoreContents(const Diva<O>& s, const typename Diva<O>::InfixStore& store,
@@ -2098,9 +3312,8 @@ private:
                                     const std::vector<std::tuple<uint32_t, bool, uint64_t>>& checks) {
         REQUIRE_NE(store.ptr, nullptr);
         REQUIRE_EQ(store.GetElemCount(), checks.size());
-        const uint32_t *popcnts = reinterpret_cast<const uint32_t *>(store.ptr);
-        const uint64_t *occupieds = store.ptr + 1;
-        const uint64_t *runends = store.ptr + 1 + Diva<O>::infix_store_target_size / 64;
+        const uint64_t *occupieds = store.ptr + Diva<O>::header_word_count;
+        const uint64_t *runends = store.ptr + Diva<O>::header_word_count + Diva<O>::infix_store_target_size / 64;
         uint32_t ind = 0;
         for (uint32_t i = 0; i < Diva<O>::infix_store_target_size; i++) {
             if (ind < occupieds_pos.size() && i == occupieds_pos[ind]) {
@@ -2136,22 +3349,20 @@ private:
         }
         REQUIRE_EQ(occupieds_pos.size(), runend_count);
 
-        uint32_t check_popcnts[2] = {};
-        for (int32_t i = 0; i < Diva<O>::infix_store_target_size / 128; i++) {
-            check_popcnts[0] += __builtin_popcountll(occupieds[i]);
-            if (static_cast<int32_t>(s.scaled_sizes_[store.GetSizeGrade()]) - i * 64 > 0) {
-                const uint64_t mask = BITMASK(std::min(64UL, s.scaled_sizes_[store.GetSizeGrade()] - i * 64));
-                check_popcnts[1] += __builtin_popcountll(runends[i] & mask);
+        for (int32_t i = 0; i < Diva<O>::rank_directory_size; i++) {
+            uint32_t occupied_count = 0, runend_count = 0;
+            for (int32_t j = 0; j < (i + 1) * Diva<O>::rank_block_size; j++) {
+                occupied_count += get_bitmap_bit(occupieds, j);
+                runend_count += j < total_size && get_bitmap_bit(runends, j);
             }
+            REQUIRE_EQ(Diva<O>::GetOccupiedsDirectory(store)[i], occupied_count);
+            REQUIRE_EQ(Diva<O>::GetRunendsDirectory(store)[i], runend_count);
         }
-
-        REQUIRE_EQ(popcnts[0], check_popcnts[0]);
-        REQUIRE_EQ(popcnts[1], check_popcnts[1]);
     }
 
 
-    template <bool O>
-    static void AssertDivas(const Diva<O>& a, const Diva<O>& b) {
+    template <bool O, uint32_t T>
+    static void AssertDivas(const Diva<O, T>& a, const Diva<O, T>& b) {
         REQUIRE_EQ(a.infix_store_target_size, b.infix_store_target_size);
         REQUIRE_EQ(a.base_implicit_size, b.base_implicit_size);
         REQUIRE_EQ(a.scale_shift, b.scale_shift);
@@ -2163,16 +3374,18 @@ private:
 
         REQUIRE_EQ(a.infix_size_, b.infix_size_);
         REQUIRE_EQ(a.rng_seed_, b.rng_seed_);
+        REQUIRE_EQ(a.shortest_separators_, b.shortest_separators_);
 
         for (int32_t i = 0; i < a.size_scalar_count; i++) {
             REQUIRE_EQ(a.size_scalars_[i], b.size_scalars_[i]);
             REQUIRE_EQ(a.scaled_sizes_[i], b.scaled_sizes_[i]);
-            REQUIRE_EQ(a.implicit_scalars_[i], b.implicit_scalars_[i]);
         }
+        for (int32_t i = 0; i <= a.infix_store_target_size / 2; i++)
+            REQUIRE_EQ(a.implicit_scalars_[i], b.implicit_scalars_[i]);
 
         const uint8_t *tree_key_a, *tree_key_b;
         uint32_t tree_key_a_len, tree_key_b_len, dummy;
-        typename Diva<O>::InfixStore *store_a, *store_b;
+        typename Diva<O, T>::InfixStore *store_a, *store_b;
         if constexpr (O) {
             wormhole_int_iter it_a, it_b;
             it_a.ref = a.better_tree_int_;
@@ -2243,14 +3456,16 @@ private:
     template <bool O>
     static void PrintStore(const Diva<O>& s, const typename Diva<O>::InfixStore& store) {
         const uint32_t size_grade = store.GetSizeGrade();
-        const uint32_t *popcnts = reinterpret_cast<const uint32_t *>(store.ptr);
-        const uint64_t *occupieds = store.ptr + 1;
-        const uint64_t *runends = store.ptr + 1 + Diva<O>::infix_store_target_size / 64;
+        const uint64_t *occupieds = store.ptr + Diva<O>::header_word_count;
+        const uint64_t *runends = store.ptr + Diva<O>::header_word_count + Diva<O>::infix_store_target_size / 64;
 
         std::cerr << "is_partial=" << store.IsPartialKey() << " invalid_bits=" << store.GetInvalidBits();
         std::cerr << " size_grade=" << size_grade << " elem_count=" << store.GetElemCount();
         std::cerr << " --- ptr=" << store.ptr << std::endl;
-        std::cerr << "popcnts=[" << popcnts[0] << ", " << popcnts[1] << ']' << std::endl;
+        std::cerr << "rank directories:";
+        for (int32_t i = 0; i < Diva<O>::rank_directory_size; i++)
+            std::cerr << " (" << Diva<O>::GetOccupiedsDirectory(store)[i] << ", " << Diva<O>::GetRunendsDirectory(store)[i] << ')';
+        std::cerr << std::endl;
         std::cerr << "occupieds: ";
         for (int32_t i = 0; i < Diva<O>::infix_store_target_size; i++) {
             if ((occupieds[i / 64] >> (i % 64)) & 1ULL)
@@ -2285,30 +3500,99 @@ TEST_SUITE("diva") {
         DivaTests::RandomInsert<false>();
     }
 
+    TEST_CASE("batched inserts") {
+        DivaTests::InsertBatch<false>();
+    }
+
     TEST_CASE("point query") {
         DivaTests::PointQuery<false>();
     }
 
+    TEST_CASE("sorted point query") {
+        DivaTests::PointQuerySorted<false>();
+    }
+
     TEST_CASE("range query") {
         DivaTests::RangeQuery<false>();
     }
 
+    TEST_CASE("batched range query") {
+        DivaTests::RangeQueryBatch<false>();
+    }
+
     TEST_CASE("delete") {
         DivaTests::Delete<false>();
     }
 
+    TEST_CASE("batched delete") {
+        DivaTests::DeleteBatch<false>();
+    }
+
+    TEST_CASE("allocator stats") {
+        DivaTests::AllocatorStats<false>();
+    }
+
+    TEST_CASE("huge pages") {
+        DivaTests::HugePages<false>();
+    }
+
+    TEST_CASE("concurrent sessions") {
+        DivaTests::ConcurrentSessions<false>();
+    }
+
+    TEST_CASE("concurrent readers") {
+        DivaTests::ConcurrentReaders<false>();
+    }
+
     TEST_CASE("shrink infix size") {
         DivaTests::ShrinkInfixSize<false>();
     }
 
+    TEST_CASE("infix sizes") {
+        DivaTests::InfixSizes<false>();
+    }
+
+    TEST_CASE("store target sizes") {
+        DivaTests::StoreTargetSizes<false>();
+    }
+
+    TEST_CASE("integer key widths") {
+        DivaTests::IntKeyWidths<false>();
+    }
+
+    TEST_CASE("single thread policy") {
+        DivaTests::SingleThreadPolicy<false>();
+    }
+
+    TEST_CASE("boundary indexes") {
+        DivaTests::BoundaryIndexes<false>();
+    }
+
+    TEST_CASE("freeze") {
+        DivaTests::Freeze<false>();
+    }
+
+    TEST_CASE("shortest separators") {
+        DivaTests::ShortestSeparators<false>();
+    }
+
     TEST_CASE("bulk load") {
         DivaTests::BulkLoad<false>();
         DivaTests::BulkLoadStreaming<false>();
+        DivaTests::ParallelBulkLoad<false>();
     }
 
     TEST_CASE("serialize and deserialize") {
         DivaTests::SerializeDeserialize<false>();
     }
+
+    TEST_CASE("streaming serialize and deserialize") {
+        DivaTests::StreamSerializeDeserialize<false>();
+    }
+
+    TEST_CASE("mapped deserialize") {
+        DivaTests::MappedDeserialize<false>();
+    }
 }
 
 TEST_SUITE("diva (int optimized)") {
@@ -2320,29 +3604,98 @@ TEST_SUITE("diva (int optimized)") {
         DivaTests::RandomInsert<true>();
     }
 
+    TEST_CASE("batched inserts") {
+        DivaTests::InsertBatch<true>();
+    }
+
     TEST_CASE("point query") {
         DivaTests::PointQuery<true>();
     }
 
+    TEST_CASE("sorted point query") {
+        DivaTests::PointQuerySorted<true>();
+    }
+
     TEST_CASE("range query") {
         DivaTests::RangeQuery<true>();
     }
 
+    TEST_CASE("batched range query") {
+        DivaTests::RangeQueryBatch<true>();
+    }
+
     TEST_CASE("delete") {
         DivaTests::Delete<true>();
     }
 
+    TEST_CASE("batched delete") {
+        DivaTests::DeleteBatch<true>();
+    }
+
+    TEST_CASE("allocator stats") {
+        DivaTests::AllocatorStats<true>();
+    }
+
+    TEST_CASE("huge pages") {
+        DivaTests::HugePages<true>();
+    }
+
+    TEST_CASE("concurrent sessions") {
+        DivaTests::ConcurrentSessions<true>();
+    }
+
+    TEST_CASE("concurrent readers") {
+        DivaTests::ConcurrentReaders<true>();
+    }
+
     TEST_CASE("shrink infix size") {
         DivaTests::ShrinkInfixSize<true>();
     }
 
+    TEST_CASE("infix sizes") {
+        DivaTests::InfixSizes<true>();
+    }
+
+    TEST_CASE("store target sizes") {
+        DivaTests::StoreTargetSizes<true>();
+    }
+
+    TEST_CASE("integer key widths") {
+        DivaTests::IntKeyWidths<true>();
+    }
+
+    TEST_CASE("single thread policy") {
+        DivaTests::SingleThreadPolicy<true>();
+    }
+
+    TEST_CASE("boundary indexes") {
+        DivaTests::BoundaryIndexes<true>();
+    }
+
+    TEST_CASE("freeze") {
+        DivaTests::Freeze<true>();
+    }
+
+    TEST_CASE("shortest separators") {
+        DivaTests::ShortestSeparators<true>();
+    }
+
     TEST_CASE("bulk load") {
         DivaTests::BulkLoad<true>();
         DivaTests::BulkLoadStreaming<true>();
+        DivaTests::ParallelBulkLoad<true>();
     }
 
     TEST_CASE("serialize and deserialize") {
         DivaTests::SerializeDeserialize<true>();
     }
+
+    TEST_CASE("streaming serialize and deserialize") {
+        DivaTests::StreamSerializeDeserialize<true>();
+    }
+
+    TEST_CASE("mapped deserialize") {
+        DivaTests::MappedDeserialize<true>();
+    }
 }
 
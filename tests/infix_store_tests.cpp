@@ -26,7 +26,7 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
 
         const uint32_t total_words = (Diva<false>::infix_store_target_size 
                 + (s.infix_size_ + 1) * s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep] + 63) / 64;
@@ -40,7 +40,7 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep],
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep],
                                       s.infix_size_);
 
         const uint32_t total_slots = s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep];
@@ -160,9 +160,9 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
 
-        uint64_t *runends = store.ptr + 1 + Diva<false>::infix_store_target_size / 64;
+        uint64_t *runends = store.ptr + Diva<false>::header_word_count + Diva<false>::infix_store_target_size / 64;
         runends[0] = 0b1000100010001000100010001000100010001000100010001000100010001000;
         runends[1] = 0b0101010101010101010101010101010101010101010101010101010101010101;
         runends[2] = 0b1010101010101010101010101010101010101010101010101010101010101010;
@@ -238,8 +238,8 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
-        uint64_t *runends = store.ptr + 1 + Diva<false>::infix_store_target_size / 64;
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        uint64_t *runends = store.ptr + Diva<false>::header_word_count + Diva<false>::infix_store_target_size / 64;
         uint64_t inserts[100];
 
         inserts[0] = 0b0100000000001100;
@@ -385,7 +385,7 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
 
         const uint32_t rng_seed = 20;
         std::mt19937_64 rng(rng_seed);
@@ -496,7 +496,7 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
 
         const std::vector<uint64_t> keys {0b000000010011000, 0b000000010010100,
             0b000000010010110, 0b000000010010101, 0b000000010011111,
@@ -520,7 +520,7 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
 
         const std::vector<uint64_t> keys {0b000000000000001, 0b000000000000101,
             0b000000000010101, 0b000000000100001, 0b000000000100011,
@@ -544,7 +544,7 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
 
         SUBCASE("fetch") {
             const std::vector<uint64_t> keys {0b0000000000000001, 0b0000000000000101,
@@ -593,7 +593,7 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
 
         const std::vector<uint64_t> keys {0b000000000000001, 0b000000000000101,
             0b000000000010101, 0b000000000100001, 0b000000000101000,
@@ -644,7 +644,7 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
         
         const uint32_t n_queries = 100000;
         const uint32_t rng_seed = 2;
@@ -715,7 +715,7 @@ public:
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
         
         const std::vector<uint64_t> keys {0b000000000000001, 0b000000000000101,
             0b000000000010101, 0b000000000100001, 0b000000000101000,
@@ -766,12 +766,39 @@ public:
     }
 
 
+    static void RankSelectKernels() {
+        std::mt19937_64 rng(1);
+        for (uint32_t word_count = 0; word_count <= 40; word_count++) {
+            for (int32_t rep = 0; rep < 100; rep++) {
+                uint64_t words[40];
+                for (int32_t i = 0; i < word_count; i++)
+                    words[i] = rep % 2 ? rng() : rng() & rng() & rng();
+                const uint32_t total = popcount_words_scalar(words, word_count);
+                if (cpu_features.avx2)
+                    REQUIRE_EQ(popcount_words_avx2(words, word_count), total);
+                if (cpu_features.avx512_popcnt)
+                    REQUIRE_EQ(popcount_words_avx512(words, word_count), total);
+
+                const uint32_t rank = rng() % (total + 2);
+                uint32_t expected_before, rank_before;
+                const uint32_t expected = select_word_scalar(words, word_count, rank, expected_before);
+                REQUIRE_EQ(select_word(words, word_count, rank, rank_before), expected);
+                REQUIRE_EQ(rank_before, expected_before);
+                if (cpu_features.avx512_popcnt) {
+                    REQUIRE_EQ(select_word_avx512(words, word_count, rank, rank_before), expected);
+                    REQUIRE_EQ(rank_before, expected_before);
+                }
+            }
+        }
+    }
+
+
     static void Resize() {
         const uint32_t infix_size = 5;
         const uint32_t seed = 1;
         const float load_factor = 0.95;
         Diva<false> s(infix_size, seed, load_factor);
-        Diva<false>::InfixStore store(s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
+        Diva<false>::InfixStore store(s.allocator_, s.scaled_sizes_[Diva<false>::size_scalar_shrink_grow_sep], s.infix_size_);
         
         const uint32_t n_keys = Diva<false>::infix_store_target_size;
         const uint32_t rng_seed = 2;
@@ -802,9 +829,8 @@ private:
                                     const std::vector<std::tuple<uint32_t, bool, uint64_t>>& checks) {
         REQUIRE_NE(store.ptr, nullptr);
         REQUIRE_EQ(store.GetElemCount(), checks.size());
-        const uint32_t *popcnts = reinterpret_cast<const uint32_t *>(store.ptr);
-        const uint64_t *occupieds = store.ptr + 1;
-        const uint64_t *runends = store.ptr + 1 + Diva<false>::infix_store_target_size / 64;
+        const uint64_t *occupieds = store.ptr + Diva<false>::header_word_count;
+        const uint64_t *runends = store.ptr + Diva<false>::header_word_count + Diva<false>::infix_store_target_size / 64;
         uint32_t ind = 0;
         for (uint32_t i = 0; i < Diva<false>::infix_store_target_size; i++) {
             if (ind < occupieds_pos.size() && i == occupieds_pos[ind]) {
@@ -840,24 +866,28 @@ private:
         }
         REQUIRE_EQ(occupieds_pos.size(), runend_count);
 
-        uint32_t check_popcnts[2] = {};
-        for (int32_t i = 0; i < Diva<false>::infix_store_target_size / 128; i++) {
-            check_popcnts[0] += __builtin_popcountll(occupieds[i]);
-            check_popcnts[1] += __builtin_popcountll(runends[i]);
+        for (int32_t i = 0; i < Diva<false>::rank_directory_size; i++) {
+            uint32_t occupied_count = 0, runend_count = 0;
+            for (int32_t j = 0; j < (i + 1) * Diva<false>::rank_block_size; j++) {
+                occupied_count += get_bitmap_bit(occupieds, j);
+                runend_count += j < total_size && get_bitmap_bit(runends, j);
+            }
+            REQUIRE_EQ(Diva<false>::GetOccupiedsDirectory(store)[i], occupied_count);
+            REQUIRE_EQ(Diva<false>::GetRunendsDirectory(store)[i], runend_count);
         }
-        REQUIRE_EQ(popcnts[0], check_popcnts[0]);
-        REQUIRE_EQ(popcnts[1], check_popcnts[1]);
     }
 
     static void PrintStore(const Diva<false>& s, const Diva<false>::InfixStore& store) {
         const uint32_t size_grade = store.GetSizeGrade();
-        const uint32_t *popcnts = reinterpret_cast<const uint32_t *>(store.ptr);
-        const uint64_t *occupieds = store.ptr + 1;
-        const uint64_t *runends = store.ptr + 1 + Diva<false>::infix_store_target_size / 64;
+        const uint64_t *occupieds = store.ptr + Diva<false>::header_word_count;
+        const uint64_t *runends = store.ptr + Diva<false>::header_word_count + Diva<false>::infix_store_target_size / 64;
 
         std::cerr << "is_partial=" << store.IsPartialKey() << " invalid_bits=" << store.GetInvalidBits();
         std::cerr << " size_grade=" << size_grade << " elem_count=" << store.GetElemCount() << std::endl;
-        std::cerr << "popcnts=[" << popcnts[0] << ", " << popcnts[1] << ']' << std::endl;
+        std::cerr << "rank directories:";
+        for (int32_t i = 0; i < Diva<false>::rank_directory_size; i++)
+            std::cerr << " (" << Diva<false>::GetOccupiedsDirectory(store)[i] << ", " << Diva<false>::GetRunendsDirectory(store)[i] << ')';
+        std::cerr << std::endl;
         std::cerr << "occupieds: ";
         for (int32_t i = 0; i < Diva<false>::infix_store_target_size; i++) {
             if ((occupieds[i / 64] >> (i % 64)) & 1ULL)
@@ -931,5 +961,9 @@ TEST_SUITE("infix_store") {
     TEST_CASE("resize") {
         InfixStoreTests::Resize();
     }
+
+    TEST_CASE("rank select kernels") {
+        InfixStoreTests::RankSelectKernels();
+    }
 }
 
@@ -0,0 +1,245 @@
+/**
+ * @file sharded diva tests
+ * @author ---
+ */
+
+#include <endian.h>
+#include <limits>
+#include <random>
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "sharded_diva.hpp"
+
+class ShardedDivaTests {
+public:
+    template <bool O>
+    static void InsertDeleteQuery() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t shard_count = 8;
+        const uint32_t n_keys = 200000;
+        const uint32_t n_inserts = 50000;
+
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        ShardedDiva<O> s = MakeShardedDiva<O>(shard_count, infix_size, keys, seed, load_factor);
+        REQUIRE_EQ(s.ShardCount(), shard_count);
+        for (int32_t i = 1; i < shard_count; i++)
+            REQUIRE(s.shards_[i - 1]->lower_key < s.shards_[i]->lower_key);
+
+        for (uint64_t key : keys)
+            REQUIRE(s.PointQuery(key));
+        // Ranges between consecutive keys cross every shard boundary once
+        for (int32_t i = 1; i < keys.size(); i++)
+            REQUIRE(s.RangeQuery(keys[i - 1], keys[i]));
+
+        std::vector<uint64_t> inserted_keys;
+        for (int32_t i = 0; i < n_inserts; i++) {
+            inserted_keys.push_back(rng());
+            s.Insert(inserted_keys.back());
+        }
+        for (int32_t i = 0; i < keys.size(); i += 2)
+            s.Delete(keys[i]);
+        for (int32_t i = 1; i < keys.size(); i += 2)
+            REQUIRE(s.PointQuery(keys[i]));
+        for (uint64_t key : inserted_keys) {
+            REQUIRE(s.PointQuery(key));
+            REQUIRE(s.RangeQuery(key, key));
+        }
+    }
+
+
+    template <bool O>
+    static void Rebalance() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t shard_count = 4;
+        const uint32_t n_keys = 20000;
+        const uint32_t n_inserts = 50000;
+
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        ShardedDiva<O> s = MakeShardedDiva<O>(shard_count, infix_size, keys, seed, load_factor);
+
+        // All new keys land in the first shard, which has to be split
+        std::vector<uint64_t> inserted_keys;
+        for (int32_t i = 0; i < n_inserts; i++) {
+            inserted_keys.push_back(rng() % keys[keys.size() / shard_count - 1]);
+            s.Insert(inserted_keys.back());
+        }
+        REQUIRE_GT(s.ShardCount(), shard_count);
+        uint64_t max_key_count = 0;
+        for (auto *shard : s.shards_)
+            max_key_count = std::max(max_key_count, shard->key_count);
+        REQUIRE_LE(max_key_count, std::max<uint64_t>(ShardedDiva<O>::hot_shard_factor * (n_keys + n_inserts)
+                                                        / s.ShardCount(),
+                                                     ShardedDiva<O>::min_split_key_count));
+
+        for (uint64_t key : keys)
+            REQUIRE(s.PointQuery(key));
+        for (uint64_t key : inserted_keys) {
+            REQUIRE(s.PointQuery(key));
+            REQUIRE(s.RangeQuery(key, key));
+        }
+        for (int32_t i = 0; i < n_inserts; i += 2)
+            s.Delete(inserted_keys[i]);
+        for (int32_t i = 1; i < n_inserts; i += 2)
+            REQUIRE(s.PointQuery(inserted_keys[i]));
+    }
+
+
+    template <bool O>
+    static void ParallelInserts() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t shard_count = 8;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_threads = 4;
+        const uint32_t n_inserts_per_thread = 50000;
+
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        ShardedDiva<O> s = MakeShardedDiva<O>(shard_count, infix_size, keys, seed, load_factor);
+
+        std::vector<uint64_t> inserted_keys[n_threads];
+        for (int32_t i = 0; i < n_threads; i++) {
+            for (int32_t j = 0; j < n_inserts_per_thread; j++)
+                inserted_keys[i].push_back(rng());
+        }
+        std::vector<std::thread> threads;
+        for (int32_t i = 0; i < n_threads; i++) {
+            threads.emplace_back([&, i]() {
+                for (uint64_t key : inserted_keys[i])
+                    s.Insert(key);
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+
+        for (uint64_t key : keys)
+            REQUIRE(s.PointQuery(key));
+        for (int32_t i = 0; i < n_threads; i++) {
+            for (uint64_t key : inserted_keys[i])
+                REQUIRE(s.PointQuery(key));
+        }
+    }
+
+
+    template <bool O>
+    static void SerializeDeserialize() {
+        const uint32_t infix_size = 5;
+        const uint32_t seed = 1;
+        const float load_factor = 0.95;
+        const uint32_t shard_count = 4;
+        const uint32_t n_keys = 100000;
+        const uint32_t n_inserts = 100000;
+        const uint32_t n_queries = 100000;
+
+        std::mt19937_64 rng(seed);
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < n_keys; i++)
+            keys.push_back(rng());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        ShardedDiva<O> s = MakeShardedDiva<O>(shard_count, infix_size, keys, seed, load_factor);
+        for (int32_t i = 0; i < n_inserts; i++)
+            s.Insert(rng() % keys[keys.size() / shard_count - 1]);
+
+        const uint64_t size = s.Size();
+        char *buf = new char[size];
+        REQUIRE_EQ(s.Serialize(buf), size);
+        ShardedDiva<O> t(buf);
+        delete[] buf;
+
+        REQUIRE_EQ(t.ShardCount(), s.ShardCount());
+        for (int32_t i = 0; i < s.ShardCount(); i++) {
+            REQUIRE(t.shards_[i]->lower_key == s.shards_[i]->lower_key);
+            REQUIRE_EQ(t.shards_[i]->key_count, s.shards_[i]->key_count);
+        }
+        for (int32_t i = 0; i < n_queries; i++) {
+            const uint64_t l = rng();
+            const uint64_t r = l + (rng() & BITMASK(20));
+            REQUIRE_EQ(t.PointQuery(l), s.PointQuery(l));
+            if (l <= r)
+                REQUIRE_EQ(t.RangeQuery(l, r), s.RangeQuery(l, r));
+        }
+    }
+
+private:
+    template <bool O>
+    static ShardedDiva<O> MakeShardedDiva(const uint32_t shard_count, const uint32_t infix_size,
+                                          const std::vector<uint64_t> &keys, const uint32_t seed,
+                                          const float load_factor) {
+        if constexpr (O)
+            return ShardedDiva<O>(shard_count, infix_size, keys.begin(), keys.end(), sizeof(uint64_t),
+                                  seed, load_factor);
+        else {
+            std::vector<uint64_t> conv_keys(keys);
+            for (int32_t i = 0; i < conv_keys.size(); i++)
+                conv_keys[i] = to_big_endian_order(conv_keys[i]);
+            return ShardedDiva<O>(shard_count, infix_size, conv_keys.begin(), conv_keys.end(), sizeof(uint64_t),
+                                  seed, load_factor);
+        }
+    }
+};
+
+
+TEST_SUITE("sharded diva") {
+    TEST_CASE("insert, delete and query") {
+        ShardedDivaTests::InsertDeleteQuery<false>();
+    }
+
+    TEST_CASE("rebalance") {
+        ShardedDivaTests::Rebalance<false>();
+    }
+
+    TEST_CASE("parallel inserts") {
+        ShardedDivaTests::ParallelInserts<false>();
+    }
+
+    TEST_CASE("serialize and deserialize") {
+        ShardedDivaTests::SerializeDeserialize<false>();
+    }
+}
+
+
+TEST_SUITE("sharded diva (int optimized)") {
+    TEST_CASE("insert, delete and query") {
+        ShardedDivaTests::InsertDeleteQuery<true>();
+    }
+
+    TEST_CASE("rebalance") {
+        ShardedDivaTests::Rebalance<true>();
+    }
+
+    TEST_CASE("parallel inserts") {
+        ShardedDivaTests::ParallelInserts<true>();
+    }
+
+    TEST_CASE("serialize and deserialize") {
+        ShardedDivaTests::SerializeDeserialize<true>();
+    }
+}
+
@@ -0,0 +1,166 @@
+/**
+ * @file wormhole int128 tests
+ * @author ---
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <x86intrin.h>
+#include "wh_int128.h"
+
+constexpr size_t value_size = 12;
+
+static unsigned __int128 bswap128(const unsigned __int128 key) {
+    return (static_cast<unsigned __int128>(__builtin_bswap64(key)) << 64) | __builtin_bswap64(key >> 64);
+}
+
+TEST_SUITE("wormhole_int128") {
+    TEST_CASE("put") {
+        wormhole_int128 *wh = wh_int128_create();
+        wormref_int128 *better_tree = wh_int128_ref(wh);
+        const uint32_t total_puts = 10000;
+        const uint32_t rng_seed = 1380;
+        std::mt19937_64 rng(rng_seed);
+
+        uint8_t value[value_size];
+        memset(value, 0, sizeof(value));
+
+        std::vector<unsigned __int128> keys;
+
+        SUBCASE("increasing keys") {
+            for (int32_t i = 0; i < total_puts; i++)
+                keys.push_back(static_cast<unsigned __int128>(i / 100) << 64 | 550 * i);
+        }
+        SUBCASE("increasing random keys") {
+            for (int32_t i = 0; i < total_puts; i++)
+                keys.push_back(static_cast<unsigned __int128>(rng()) << 64 | rng());
+            std::sort(keys.begin(), keys.end());
+        }
+        SUBCASE("random keys") {
+            for (int32_t i = 0; i < total_puts; i++)
+                keys.push_back(static_cast<unsigned __int128>(rng()) << 64 | rng());
+        }
+
+        for (unsigned __int128 key : keys) {
+            const unsigned __int128 key_rev = bswap128(key);
+            memcpy(value + 3, &key, sizeof(uint64_t));
+            wh_int128_put(better_tree, &key_rev, sizeof(key_rev), value, value_size);
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        wormhole_int128_iter *it = wh_int128_iter_create(better_tree);
+        int32_t ind = 0;
+        for (wh_int128_iter_seek(it, "", 0); wh_int128_iter_valid(it); wh_int128_iter_skip1(it)) {
+            const uint8_t *fetched_key;
+            uint8_t *fetched_value;
+            uint32_t fetched_key_size, fetched_value_size;
+            wh_int128_iter_peek_ref(it, reinterpret_cast<const void **>(&fetched_key), &fetched_key_size,
+                                        reinterpret_cast<void **>(&fetched_value), &fetched_value_size);
+            unsigned __int128 recovered_key;
+            memcpy(&recovered_key, fetched_key, sizeof(recovered_key));
+            recovered_key = bswap128(recovered_key);
+            REQUIRE(recovered_key == keys[ind++]);
+        }
+        const unsigned __int128 tmp = bswap128(keys[keys.size() - 1]);
+        for (wh_int128_iter_seek(it, &tmp, sizeof(tmp)); wh_int128_iter_valid(it); wh_int128_iter_skip1_rev(it)) {
+            const uint8_t *fetched_key;
+            uint8_t *fetched_value;
+            uint32_t fetched_key_size, fetched_value_size;
+            wh_int128_iter_peek_ref(it, reinterpret_cast<const void **>(&fetched_key), &fetched_key_size,
+                                        reinterpret_cast<void **>(&fetched_value), &fetched_value_size);
+            unsigned __int128 recovered_key;
+            memcpy(&recovered_key, fetched_key, sizeof(recovered_key));
+            recovered_key = bswap128(recovered_key);
+            REQUIRE(recovered_key == keys[--ind]);
+        }
+        wh_int128_iter_destroy(it);
+    }
+
+    TEST_CASE("seek le") {
+        wormhole_int128 *wh = wh_int128_create();
+        wormref_int128 *better_tree = wh_int128_ref(wh);
+        const uint32_t total_puts = 10000;
+        const uint32_t total_seeks = 20000;
+        const uint32_t rng_seed = 1380;
+        std::mt19937_64 rng(rng_seed);
+
+        uint8_t value[value_size];
+        memset(value, 0, sizeof(value));
+
+        // Odd keys away from both ends of the key space, so that seeks land
+        // on keys, between keys, and before or after all of them
+        std::vector<unsigned __int128> keys;
+        for (int32_t i = 0; i < total_puts; i++)
+            keys.push_back(static_cast<unsigned __int128>(rng() >> 2 | 1ULL << 62) << 64 | (rng() | 1));
+        for (unsigned __int128 key : keys) {
+            const unsigned __int128 key_rev = bswap128(key);
+            memcpy(value + 3, &key, sizeof(uint64_t));
+            wh_int128_put(better_tree, &key_rev, sizeof(key_rev), value, value_size);
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::vector<unsigned __int128> queries {0, ~static_cast<unsigned __int128>(0), keys.front(), keys.back(), keys.back() + 1};
+        for (int32_t i = 0; i < total_seeks; i++) {
+            const unsigned __int128 key = keys[rng() % keys.size()];
+            queries.push_back(key);
+            queries.push_back(key + 1);
+            queries.push_back(key - 1);
+        }
+        auto recover = [](const uint8_t *fetched_key) {
+            unsigned __int128 key;
+            memcpy(&key, fetched_key, sizeof(key));
+            return bswap128(key);
+        };
+
+        wormhole_int128_iter *it = wh_int128_iter_create(better_tree);
+        for (unsigned __int128 query : queries) {
+            const unsigned __int128 query_rev = bswap128(query);
+            const auto gt = std::upper_bound(keys.begin(), keys.end(), query);
+
+            wh_int128_iter_seek_le(it, &query_rev, sizeof(query_rev));
+            REQUIRE_EQ(wh_int128_iter_valid(it), gt != keys.begin());
+            if (gt != keys.begin()) {
+                const uint8_t *fetched_key;
+                uint8_t *fetched_value;
+                uint32_t fetched_key_size, fetched_value_size;
+                wh_int128_iter_peek_ref(it, reinterpret_cast<const void **>(&fetched_key), &fetched_key_size,
+                                            reinterpret_cast<void **>(&fetched_value), &fetched_value_size);
+                REQUIRE(recover(fetched_key) == *(gt - 1));
+            }
+
+            const uint8_t *le_key, *gt_key;
+            uint8_t *le_value, *gt_value;
+            uint32_t le_key_size, gt_key_size;
+            wh_int128_iter_seek_near(it, &query_rev, sizeof(query_rev),
+                                     reinterpret_cast<const void **>(&le_key), &le_key_size, reinterpret_cast<void **>(&le_value),
+                                     reinterpret_cast<const void **>(&gt_key), &gt_key_size, reinterpret_cast<void **>(&gt_value));
+            if (gt == keys.begin()) {
+                REQUIRE(le_key == nullptr);
+                REQUIRE_FALSE(wh_int128_iter_valid(it));
+            }
+            else {
+                REQUIRE(recover(le_key) == *(gt - 1));
+                REQUIRE_EQ(memcmp(le_value + 3, &*(gt - 1), sizeof(uint64_t)), 0);
+            }
+            if (gt == keys.end()) {
+                REQUIRE(gt_key == nullptr);
+            }
+            else {
+                REQUIRE(recover(gt_key) == *gt);
+                REQUIRE_EQ(memcmp(gt_value + 3, &*gt, sizeof(uint64_t)), 0);
+            }
+        }
+        wh_int128_iter_destroy(it);
+    }
+}
+
+
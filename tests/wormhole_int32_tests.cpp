@@ -0,0 +1,159 @@
+/**
+ * @file wormhole int32 tests
+ * @author ---
+ */
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <x86intrin.h>
+#include "wh_int32.h"
+
+constexpr size_t value_size = 12;
+
+TEST_SUITE("wormhole_int32") {
+    TEST_CASE("put") {
+        wormhole_int32 *wh = wh_int32_create();
+        wormref_int32 *better_tree = wh_int32_ref(wh);
+        const uint32_t total_puts = 10000;
+        const uint32_t rng_seed = 1380;
+        std::mt19937_64 rng(rng_seed);
+
+        uint8_t value[value_size];
+        memset(value, 0, sizeof(value));
+
+        std::vector<uint32_t> keys;
+
+        SUBCASE("increasing keys") {
+            for (int32_t i = 0; i < total_puts; i++)
+                keys.push_back(550 * i);
+        }
+        SUBCASE("increasing random keys") {
+            for (int32_t i = 0; i < total_puts; i++)
+                keys.push_back(static_cast<uint32_t>(rng()));
+            std::sort(keys.begin(), keys.end());
+        }
+        SUBCASE("random keys") {
+            for (int32_t i = 0; i < total_puts; i++)
+                keys.push_back(static_cast<uint32_t>(rng()));
+        }
+
+        for (uint32_t key : keys) {
+            const uint32_t key_rev = __builtin_bswap32(key);
+            memcpy(value + 3, &key, sizeof(key));
+            wh_int32_put(better_tree, &key_rev, sizeof(key_rev), value, value_size);
+        }
+
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        wormhole_int32_iter *it = wh_int32_iter_create(better_tree);
+        int32_t ind = 0;
+        for (wh_int32_iter_seek(it, "", 0); wh_int32_iter_valid(it); wh_int32_iter_skip1(it)) {
+            const uint8_t *fetched_key;
+            uint8_t *fetched_value;
+            uint32_t fetched_key_size, fetched_value_size;
+            wh_int32_iter_peek_ref(it, reinterpret_cast<const void **>(&fetched_key), &fetched_key_size,
+                                       reinterpret_cast<void **>(&fetched_value), &fetched_value_size);
+            const uint32_t recovered_key = __builtin_bswap32(*((uint32_t *) fetched_key));
+            REQUIRE_EQ(recovered_key, keys[ind++]);
+        }
+        const uint32_t tmp = __builtin_bswap32(keys[keys.size() - 1]);
+        for (wh_int32_iter_seek(it, &tmp, sizeof(tmp)); wh_int32_iter_valid(it); wh_int32_iter_skip1_rev(it)) {
+            const uint8_t *fetched_key;
+            uint8_t *fetched_value;
+            uint32_t fetched_key_size, fetched_value_size;
+            wh_int32_iter_peek_ref(it, reinterpret_cast<const void **>(&fetched_key), &fetched_key_size,
+                                       reinterpret_cast<void **>(&fetched_value), &fetched_value_size);
+            const uint32_t recovered_key = __builtin_bswap32(*((uint32_t *) fetched_key));
+            REQUIRE_EQ(recovered_key, keys[--ind]);
+        }
+        wh_int32_iter_destroy(it);
+    }
+
+    TEST_CASE("seek le") {
+        wormhole_int32 *wh = wh_int32_create();
+        wormref_int32 *better_tree = wh_int32_ref(wh);
+        const uint32_t total_puts = 10000;
+        const uint32_t total_seeks = 20000;
+        const uint32_t rng_seed = 1380;
+        std::mt19937_64 rng(rng_seed);
+
+        uint8_t value[value_size];
+        memset(value, 0, sizeof(value));
+
+        // Odd keys away from both ends of the key space, so that seeks land
+        // on keys, between keys, and before or after all of them
+        std::vector<uint32_t> keys;
+        for (int32_t i = 0; i < total_puts; i++)
+            keys.push_back(static_cast<uint32_t>(rng() >> 34) << 1 | 1U << 30 | 1);
+        for (uint32_t key : keys) {
+            const uint32_t key_rev = __builtin_bswap32(key);
+            memcpy(value + 3, &key, sizeof(key));
+            wh_int32_put(better_tree, &key_rev, sizeof(key_rev), value, value_size);
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::vector<uint32_t> queries {0, ~static_cast<uint32_t>(0), keys.front(), keys.back(), keys.back() + 1};
+        for (int32_t i = 0; i < total_seeks; i++) {
+            const uint32_t key = keys[rng() % keys.size()];
+            queries.push_back(key);
+            queries.push_back(key + 1);
+            queries.push_back(key - 1);
+        }
+        auto recover = [](const uint8_t *fetched_key) {
+            uint32_t key;
+            memcpy(&key, fetched_key, sizeof(key));
+            return __builtin_bswap32(key);
+        };
+
+        wormhole_int32_iter *it = wh_int32_iter_create(better_tree);
+        for (uint32_t query : queries) {
+            const uint32_t query_rev = __builtin_bswap32(query);
+            const auto gt = std::upper_bound(keys.begin(), keys.end(), query);
+
+            wh_int32_iter_seek_le(it, &query_rev, sizeof(query_rev));
+            REQUIRE_EQ(wh_int32_iter_valid(it), gt != keys.begin());
+            if (gt != keys.begin()) {
+                const uint8_t *fetched_key;
+                uint8_t *fetched_value;
+                uint32_t fetched_key_size, fetched_value_size;
+                wh_int32_iter_peek_ref(it, reinterpret_cast<const void **>(&fetched_key), &fetched_key_size,
+                                           reinterpret_cast<void **>(&fetched_value), &fetched_value_size);
+                REQUIRE(recover(fetched_key) == *(gt - 1));
+            }
+
+            const uint8_t *le_key, *gt_key;
+            uint8_t *le_value, *gt_value;
+            uint32_t le_key_size, gt_key_size;
+            wh_int32_iter_seek_near(it, &query_rev, sizeof(query_rev),
+                                    reinterpret_cast<const void **>(&le_key), &le_key_size, reinterpret_cast<void **>(&le_value),
+                                    reinterpret_cast<const void **>(&gt_key), &gt_key_size, reinterpret_cast<void **>(&gt_value));
+            if (gt == keys.begin()) {
+                REQUIRE(le_key == nullptr);
+                REQUIRE_FALSE(wh_int32_iter_valid(it));
+            }
+            else {
+                REQUIRE(recover(le_key) == *(gt - 1));
+                REQUIRE_EQ(memcmp(le_value + 3, &*(gt - 1), sizeof(uint32_t)), 0);
+            }
+            if (gt == keys.end()) {
+                REQUIRE(gt_key == nullptr);
+            }
+            else {
+                REQUIRE(recover(gt_key) == *gt);
+                REQUIRE_EQ(memcmp(gt_value + 3, &*gt, sizeof(uint32_t)), 0);
+            }
+        }
+        wh_int32_iter_destroy(it);
+    }
+}
+
+
@@ -7,6 +7,7 @@
 
 #include <doctest/doctest.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <random>
@@ -74,6 +75,84 @@ TEST_SUITE("wormhole_int") {
         }
         wh_int_iter_destroy(it);
     }
+
+    TEST_CASE("seek le") {
+        wormhole_int *wh = wh_int_create();
+        wormref_int *better_tree = wh_int_ref(wh);
+        const uint32_t total_puts = 10000;
+        const uint32_t total_seeks = 20000;
+        const uint32_t rng_seed = 1380;
+        std::mt19937_64 rng(rng_seed);
+
+        uint8_t value[value_size];
+        memset(value, 0, sizeof(value));
+
+        // Odd keys away from both ends of the key space, so that seeks land
+        // on keys, between keys, and before or after all of them
+        std::vector<uint64_t> keys;
+        for (int32_t i = 0; i < total_puts; i++)
+            keys.push_back((rng() >> 2) << 1 | 1ULL << 62 | 1);
+        for (uint64_t key : keys) {
+            const uint64_t key_rev = _bswap64(key);
+            memcpy(value + 3, &key, sizeof(key));
+            wh_int_put(better_tree, &key_rev, sizeof(key_rev), value, value_size);
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::vector<uint64_t> queries {0, ~static_cast<uint64_t>(0), keys.front(), keys.back(), keys.back() + 1};
+        for (int32_t i = 0; i < total_seeks; i++) {
+            const uint64_t key = keys[rng() % keys.size()];
+            queries.push_back(key);
+            queries.push_back(key + 1);
+            queries.push_back(key - 1);
+        }
+        auto recover = [](const uint8_t *fetched_key) {
+            uint64_t key;
+            memcpy(&key, fetched_key, sizeof(key));
+            return _bswap64(key);
+        };
+
+        wormhole_int_iter *it = wh_int_iter_create(better_tree);
+        for (uint64_t query : queries) {
+            const uint64_t query_rev = _bswap64(query);
+            const auto gt = std::upper_bound(keys.begin(), keys.end(), query);
+
+            wh_int_iter_seek_le(it, &query_rev, sizeof(query_rev));
+            REQUIRE_EQ(wh_int_iter_valid(it), gt != keys.begin());
+            if (gt != keys.begin()) {
+                const uint8_t *fetched_key;
+                uint8_t *fetched_value;
+                uint32_t fetched_key_size, fetched_value_size;
+                wh_int_iter_peek_ref(it, reinterpret_cast<const void **>(&fetched_key), &fetched_key_size,
+                                         reinterpret_cast<void **>(&fetched_value), &fetched_value_size);
+                REQUIRE(recover(fetched_key) == *(gt - 1));
+            }
+
+            const uint8_t *le_key, *gt_key;
+            uint8_t *le_value, *gt_value;
+            uint32_t le_key_size, gt_key_size;
+            wh_int_iter_seek_near(it, &query_rev, sizeof(query_rev),
+                                  reinterpret_cast<const void **>(&le_key), &le_key_size, reinterpret_cast<void **>(&le_value),
+                                  reinterpret_cast<const void **>(&gt_key), &gt_key_size, reinterpret_cast<void **>(&gt_value));
+            if (gt == keys.begin()) {
+                REQUIRE(le_key == nullptr);
+                REQUIRE_FALSE(wh_int_iter_valid(it));
+            }
+            else {
+                REQUIRE(recover(le_key) == *(gt - 1));
+                REQUIRE_EQ(memcmp(le_value + 3, &*(gt - 1), sizeof(uint64_t)), 0);
+            }
+            if (gt == keys.end()) {
+                REQUIRE(gt_key == nullptr);
+            }
+            else {
+                REQUIRE(recover(gt_key) == *gt);
+                REQUIRE_EQ(memcmp(gt_value + 3, &*gt, sizeof(uint64_t)), 0);
+            }
+        }
+        wh_int_iter_destroy(it);
+    }
 }
 
 